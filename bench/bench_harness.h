@@ -0,0 +1,231 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @file bench_harness.h
+ * @brief Host microbenchmark harness with a baseline regression gate
+ *
+ * Each case is timed in batches on the host's steady clock (the mocked
+ * Arduino clocks are virtual and don't move on their own). The batch
+ * size is calibrated so one batch takes at least MIN_BATCH_NS, which
+ * keeps clock overhead out of the numbers; warmup batches are run and
+ * discarded first. Per-operation times across SAMPLES batches give the
+ * median, p99 and ops/s.
+ *
+ * The whole suite runs ROUNDS times and each case keeps its fastest
+ * round, so a burst of load from another process on a shared machine
+ * doesn't show up as a regression of whichever case it landed on.
+ *
+ * Results are written as JSON with one case per line, so the baseline
+ * can be diffed in review and read back without a JSON library.
+ *
+ * Usage:
+ *   BenchSuite suite;
+ *   suite.add("validate_message", &benchValidate, &input);
+ *   suite.run();
+ *   suite.writeJson("bench/results.json");
+ *   int regressions = suite.compare("bench/baseline.json", 25.0);
+ */
+
+struct BenchStats {
+    std::string name;
+    uint32_t batch;      // Operations per timed batch
+    double medianNs;     // Per operation
+    double p99Ns;        // Per operation
+    double opsPerSec;    // From the median
+};
+
+class BenchSuite {
+public:
+    typedef void (*BenchFn)(void* context, uint32_t iteration);
+
+    static constexpr uint32_t WARMUP_BATCHES = 20;
+    static constexpr uint32_t SAMPLES = 200;
+    static constexpr uint64_t MIN_BATCH_NS = 50000;
+    static constexpr uint32_t MAX_BATCH = 1u << 20;
+    static constexpr uint32_t ROUNDS = 3;
+
+private:
+    struct Case {
+        const char* name;
+        BenchFn fn;
+        void* context;
+    };
+
+    std::vector<Case> cases;
+    std::vector<BenchStats> results;
+    const char* filter;
+
+    static uint64_t nowNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static uint64_t timeBatch(BenchFn fn, void* context, uint32_t batch, uint32_t& iteration) {
+        uint64_t start = nowNs();
+        for (uint32_t i = 0; i < batch; i++) {
+            fn(context, iteration++);
+        }
+        return nowNs() - start;
+    }
+
+    /**
+     * @brief Read "medianNs" for a case from a results/baseline file
+     * @return false if the file or case is missing
+     */
+    static bool findMedian(const std::string& json, const std::string& name, double& medianNs) {
+        std::string key = "\"name\":\"" + name + "\"";
+        size_t at = json.find(key);
+        if (at == std::string::npos) return false;
+
+        size_t field = json.find("\"medianNs\":", at);
+        size_t lineEnd = json.find('\n', at);
+        if (field == std::string::npos || field > lineEnd) return false;
+
+        return sscanf(json.c_str() + field + strlen("\"medianNs\":"), "%lf", &medianNs) == 1;
+    }
+
+    static bool readFile(const char* path, std::string& contents) {
+        FILE* f = fopen(path, "rb");
+        if (f == nullptr) return false;
+
+        char chunk[512];
+        size_t n;
+        contents.clear();
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+            contents.append(chunk, n);
+        }
+        fclose(f);
+        return true;
+    }
+
+    /**
+     * @brief Time one round of a case
+     */
+    static BenchStats measure(const Case& c) {
+        BenchFn fn = c.fn;
+        void* context = c.context;
+        uint32_t iteration = 0;
+        uint32_t batch = 1;
+        while (batch < MAX_BATCH && timeBatch(fn, context, batch, iteration) < MIN_BATCH_NS) {
+            batch *= 2;
+        }
+        for (uint32_t w = 0; w < WARMUP_BATCHES; w++) {
+            timeBatch(fn, context, batch, iteration);
+        }
+
+        std::vector<double> perOp(SAMPLES);
+        for (uint32_t s = 0; s < SAMPLES; s++) {
+            perOp[s] = (double)timeBatch(fn, context, batch, iteration) / batch;
+        }
+        std::sort(perOp.begin(), perOp.end());
+
+        BenchStats stats;
+        stats.name = c.name;
+        stats.batch = batch;
+        stats.medianNs = perOp[SAMPLES / 2];
+        stats.p99Ns = perOp[(SAMPLES * 99) / 100];
+        stats.opsPerSec = stats.medianNs > 0 ? 1e9 / stats.medianNs : 0;
+        return stats;
+    }
+
+public:
+    explicit BenchSuite(const char* nameFilter = nullptr) : filter(nameFilter) {}
+
+    /**
+     * @brief Register a case
+     * @param name Case name (stable: it keys the baseline)
+     * @param fn Called once per operation with a running iteration index
+     * @param context Passed through to fn (state carries across rounds)
+     */
+    void add(const char* name, BenchFn fn, void* context) {
+        if (filter && strstr(name, filter) == nullptr) return;
+        Case c = { name, fn, context };
+        cases.push_back(c);
+    }
+
+    /**
+     * @brief Run every case ROUNDS times and print the kept results
+     */
+    void run() {
+        results.clear();
+        for (uint32_t round = 0; round < ROUNDS; round++) {
+            for (size_t i = 0; i < cases.size(); i++) {
+                BenchStats stats = measure(cases[i]);
+                if (round == 0) {
+                    results.push_back(stats);
+                } else if (stats.medianNs < results[i].medianNs) {
+                    results[i] = stats;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchStats& r = results[i];
+            printf("%-28s %10.1f ns  p99 %10.1f ns  %12.0f ops/s\n",
+                   r.name.c_str(), r.medianNs, r.p99Ns, r.opsPerSec);
+        }
+    }
+
+    const std::vector<BenchStats>& getResults() const {
+        return results;
+    }
+
+    /**
+     * @brief Write results as JSON, one case per line
+     * @return false if the file couldn't be written
+     */
+    bool writeJson(const char* path) const {
+        FILE* f = fopen(path, "wb");
+        if (f == nullptr) return false;
+
+        fprintf(f, "{\"unit\":\"ns\",\"samples\":%u,\"cases\":[\n", (unsigned)SAMPLES);
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchStats& r = results[i];
+            fprintf(f, "{\"name\":\"%s\",\"batch\":%lu,\"medianNs\":%.1f,\"p99Ns\":%.1f,"
+                       "\"opsPerSec\":%.0f}%s\n",
+                    r.name.c_str(), (unsigned long)r.batch, r.medianNs, r.p99Ns, r.opsPerSec,
+                    i + 1 < results.size() ? "," : "");
+        }
+        fprintf(f, "]}\n");
+        return fclose(f) == 0;
+    }
+
+    /**
+     * @brief Compare medians against a baseline file
+     * @param path Baseline written by writeJson()
+     * @param thresholdPct Allowed slowdown before a case counts as a regression
+     * @return Number of regressed cases, or -1 if the baseline can't be read
+     *
+     * Cases missing from the baseline are reported but don't fail.
+     */
+    int compare(const char* path, double thresholdPct) const {
+        std::string baseline;
+        if (!readFile(path, baseline)) return -1;
+
+        int regressions = 0;
+        printf("\n%-28s %12s %12s %9s\n", "case", "baseline ns", "current ns", "change");
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchStats& r = results[i];
+            double before;
+            if (!findMedian(baseline, r.name, before) || before <= 0) {
+                printf("%-28s %12s %12.1f %9s\n", r.name.c_str(), "-", r.medianNs, "new");
+                continue;
+            }
+
+            double change = (r.medianNs - before) * 100.0 / before;
+            bool regressed = change > thresholdPct;
+            if (regressed) regressions++;
+            printf("%-28s %12.1f %12.1f %+8.1f%%%s\n", r.name.c_str(), before, r.medianNs,
+                   change, regressed ? "  REGRESSION" : "");
+        }
+        return regressions;
+    }
+};
@@ -0,0 +1,257 @@
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <stdlib.h>
+#include "bench_harness.h"
+#include "utils/rate_limiter.h"
+#include "utils/validation.h"
+#include "utils/time_utils.h"
+#include "utils/logger.h"
+#include "utils/metrics.h"
+#include "utils/boot_profiler.h"
+
+/**
+ * @file bench_main.cpp
+ * @brief Host benchmarks for the request hot paths ([env:bench])
+ *
+ *   pio run -e bench -t exec
+ *   .pio/build/bench/program --update-baseline   # After an intended change
+ *
+ * Options:
+ *   --filter TEXT        Only cases whose name contains TEXT
+ *   --out PATH           Results file (default BENCH_RESULTS_PATH)
+ *   --baseline PATH      Baseline to gate against (default BENCH_BASELINE_PATH)
+ *   --threshold PCT      Allowed median slowdown (default BENCH_THRESHOLD_PCT)
+ *   --update-baseline    Write results to the baseline instead of comparing
+ *
+ * Exits 1 if any case's median regressed past the threshold. Baselines
+ * are per machine: regenerate on the machine that runs the gate.
+ */
+
+#ifndef BENCH_RESULTS_PATH
+#define BENCH_RESULTS_PATH "bench/results.json"
+#endif
+#ifndef BENCH_BASELINE_PATH
+#define BENCH_BASELINE_PATH "bench/baseline.json"
+#endif
+#ifndef BENCH_THRESHOLD_PCT
+#define BENCH_THRESHOLD_PCT 25
+#endif
+
+static volatile uint32_t sink;  // Keeps results observable to the optimiser
+
+static IPAddress client(uint32_t index) {
+    return IPAddress(10, 0, (uint8_t)(index >> 8), (uint8_t)index);
+}
+
+// Rate limiting
+
+struct RateLimitFixture {
+    RateLimiter limiter;
+    uint32_t clients;
+
+    explicit RateLimitFixture(uint32_t count) : limiter(60000, 255), clients(count) {
+        for (uint32_t c = 0; c < clients; c++) {
+            limiter.checkLimit(client(c));
+        }
+    }
+};
+
+static void benchRateLimit(void* context, uint32_t iteration) {
+    RateLimitFixture* f = static_cast<RateLimitFixture*>(context);
+    sink += f->limiter.checkLimit(client(iteration % f->clients));
+}
+
+static void benchRateLimitCleanup(void* context, uint32_t iteration) {
+    (void)iteration;
+    RateLimitFixture* f = static_cast<RateLimitFixture*>(context);
+    f->limiter.cleanup();  // Nothing expires: measures the full scan
+    sink += (uint32_t)f->limiter.getTrackedClientCount();
+}
+
+// Validation
+
+static void benchValidate(void* context, uint32_t iteration) {
+    (void)iteration;
+    const String* message = static_cast<const String*>(context);
+    sink += Validation::validateMessage(*message).valid;
+}
+
+static void benchSanitize(void* context, uint32_t iteration) {
+    (void)iteration;
+    const String* message = static_cast<const String*>(context);
+    sink += (uint32_t)Validation::sanitizeForLog(*message).length();
+}
+
+// Time
+
+static void benchHasElapsed(void* context, uint32_t iteration) {
+    (void)context;
+    mock_millis_value = iteration;
+    sink += TimeUtils::hasElapsed(iteration - 500, 1000);
+}
+
+static void benchTimeDiffWrap(void* context, uint32_t iteration) {
+    (void)context;
+    sink += TimeUtils::timeDiff(0xFFFFFF00u + (iteration & 0xFF), iteration & 0xFFFF);
+}
+
+// Logging
+
+static void benchLogFormat(void* context, uint32_t iteration) {
+    char* line = static_cast<char*>(context);
+    mock_millis_value = iteration;
+    mock_micros_value = (uint64_t)iteration * 1000;
+    sink += (uint32_t)Logger::formatLine(line, Logger::LINE_SIZE, "[INFO] ",
+                                         "Typing: %s (%lu chars, job %lu)",
+                                         "The quick brown fox", 19UL, (unsigned long)iteration);
+}
+
+// Response generation
+
+struct MetricsFixture {
+    MetricsRegistry registry;
+    Counter requests[12];
+    Gauge gauges[8];
+    LogLinearHistogram latency;
+    LogLinearHistogram jitter;
+    char chunk[Config::Metrics::CHUNK_SIZE];
+    char json[1024];
+
+    MetricsFixture() {
+        static const char* const routes[] = {
+            "/", "/status", "/metrics", "/profile", "/trace", "/diag/memory",
+            "/diag/boot", "/bench", "/ctrlaltdel", "/sleep", "/led/toggle", "/type"
+        };
+        for (size_t i = 0; i < 12; i++) {
+            requests[i].inc((uint32_t)(i * 37));
+            registry.addCounter("http_requests_total", "Requests handled", requests[i],
+                                "route", routes[i]);
+        }
+        for (size_t i = 0; i < 8; i++) {
+            gauges[i].set((int32_t)(i * 1000));
+            registry.addGauge("heap_free_bytes", "Free heap", gauges[i]);
+        }
+        for (uint32_t v = 1; v < 5000; v += 7) {
+            latency.record(v * 13);
+            jitter.record(v % 400);
+        }
+        registry.addHistogram("http_request_duration_seconds", "Handler time", latency, 1e-6);
+        registry.addHistogram("hid_report_jitter_seconds", "Report jitter", jitter, 1e-6);
+    }
+};
+
+static void discardChunk(const char* data, size_t length, void* context) {
+    (void)data;
+    *static_cast<size_t*>(context) += length;
+}
+
+static void benchMetricsRender(void* context, uint32_t iteration) {
+    (void)iteration;
+    MetricsFixture* f = static_cast<MetricsFixture*>(context);
+    size_t bytes = 0;
+    ChunkedWriter out(f->chunk, sizeof(f->chunk), &discardChunk, &bytes);
+    f->registry.render(out);
+    out.flush();
+    sink += (uint32_t)bytes;
+}
+
+static void benchHistogramJson(void* context, uint32_t iteration) {
+    (void)iteration;
+    MetricsFixture* f = static_cast<MetricsFixture*>(context);
+    sink += (uint32_t)f->latency.toJson(f->json, sizeof(f->json));
+}
+
+static void benchBootJson(void* context, uint32_t iteration) {
+    (void)iteration;
+    MetricsFixture* f = static_cast<MetricsFixture*>(context);
+    sink += (uint32_t)Profiling::boot().toJson(f->json, sizeof(f->json));
+}
+
+static void fillBootProfile() {
+    BootProfiler& boot = Profiling::boot();
+    mock_micros_value = 300000;
+    boot.begin();
+    for (uint8_t p = 0; p < BootProfiler::PHASES; p++) {
+        mock_micros_value += 10000 * (p + 1);
+        boot.phaseDone(static_cast<BootPhase>(p));
+    }
+    boot.setupDone();
+    boot.reach(BootMilestone::WIFI_CONNECTED);
+}
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* outPath = BENCH_RESULTS_PATH;
+    const char* baselinePath = BENCH_BASELINE_PATH;
+    double threshold = BENCH_THRESHOLD_PCT;
+    bool updateBaseline = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && hasValue) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--update-baseline") == 0) {
+            updateBaseline = true;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    BenchSuite suite(filter);
+
+    static RateLimitFixture limit1(1), limit64(64), limit255(255);
+    suite.add("ratelimit_check_1", &benchRateLimit, &limit1);
+    suite.add("ratelimit_check_64", &benchRateLimit, &limit64);
+    suite.add("ratelimit_check_255", &benchRateLimit, &limit255);
+    suite.add("ratelimit_cleanup_64", &benchRateLimitCleanup, &limit64);
+
+    static char longText[Config::BLE::MAX_MESSAGE_LENGTH + 1];
+    memset(longText, 'a', Config::BLE::MAX_MESSAGE_LENGTH);
+    String shortMessage("The quick brown fox jumps over the lazy dog.\n"
+                        "Pack my box with five dozen liquor jugs, 0123456789.");
+    String longMessage(longText);
+    suite.add("validate_message_100", &benchValidate, &shortMessage);
+    suite.add("validate_message_1000", &benchValidate, &longMessage);
+    suite.add("sanitize_for_log", &benchSanitize, &shortMessage);
+
+    suite.add("time_has_elapsed", &benchHasElapsed, nullptr);
+    suite.add("time_diff_wrap", &benchTimeDiffWrap, nullptr);
+
+    static char line[Logger::LINE_SIZE];
+    suite.add("log_format", &benchLogFormat, line);
+
+    static MetricsFixture metrics;
+    fillBootProfile();
+    suite.add("metrics_render", &benchMetricsRender, &metrics);
+    suite.add("histogram_json", &benchHistogramJson, &metrics);
+    suite.add("boot_json", &benchBootJson, &metrics);
+
+    suite.run();
+
+    const char* writePath = updateBaseline ? baselinePath : outPath;
+    if (!suite.writeJson(writePath)) {
+        fprintf(stderr, "Can't write %s\n", writePath);
+        return 2;
+    }
+    printf("\nWrote %s\n", writePath);
+    if (updateBaseline) return 0;
+
+    int regressions = suite.compare(baselinePath, threshold);
+    if (regressions < 0) {
+        printf("No baseline at %s (run with --update-baseline); not gating\n", baselinePath);
+        return 0;
+    }
+    if (regressions > 0) {
+        printf("%d case(s) regressed more than %.0f%%\n", regressions, threshold);
+        return 1;
+    }
+    printf("No regressions over %.0f%%\n", threshold);
+    return 0;
+}
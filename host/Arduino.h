@@ -0,0 +1,135 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+/**
+ * @file Arduino.h
+ * @brief Arduino core for the Linux host-emulation build
+ *
+ * Unlike test/mocks/Arduino.h, time is real: millis()/micros() run from
+ * CLOCK_MONOTONIC at process start and delay() sleeps. Pins are a plain
+ * array, Serial is stdout.
+ */
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define LOW 0
+#define HIGH 1
+
+#define PROGMEM
+
+// millis()/micros() wrap at 32 bits like the ESP32
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+uint8_t digitalRead(uint8_t pin);
+
+template <typename T, typename U>
+inline T min(T a, U b) { return (b < a) ? (T)b : a; }
+template <typename T, typename U>
+inline T max(T a, U b) { return (a < b) ? (T)b : a; }
+
+class HostSerial {
+private:
+    FILE* out;  // nullptr (static zero-init) = stdout, safe before constructors run
+
+    FILE* stream() const { return out ? out : stdout; }
+
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void print(const char* str) { fputs(str, stream()); }
+    void println(const char* str = "") {
+        fputs(str, stream());
+        fputc('\n', stream());
+    }
+    void printf(const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        vfprintf(stream(), format, args);
+        va_end(args);
+    }
+    void flush() { fflush(stream()); }
+
+    // Where the firmware's log goes (tools keep stdout for their report)
+    void setOutput(FILE* stream) { out = stream; }
+};
+
+extern HostSerial Serial;
+
+/**
+ * @class String
+ * @brief Arduino String subset used by the firmware, over std::string
+ */
+class String {
+private:
+    std::string value;
+
+public:
+    String() {}
+    String(const char* str) : value(str ? str : "") {}
+    String(const char* str, size_t length) : value(str, length) {}
+    explicit String(const std::string& str) : value(str) {}
+    explicit String(int number) : value(std::to_string(number)) {}
+    explicit String(unsigned long number) : value(std::to_string(number)) {}
+
+    size_t length() const { return value.size(); }
+    const char* c_str() const { return value.c_str(); }
+    bool isEmpty() const { return value.empty(); }
+
+    char charAt(size_t index) const {
+        return index < value.size() ? value[index] : 0;
+    }
+    char operator[](size_t index) const { return charAt(index); }
+
+    String substring(size_t start) const {
+        return start < value.size() ? String(value.substr(start)) : String();
+    }
+    String substring(size_t start, size_t end) const {
+        if (start >= value.size() || end <= start) return String();
+        return String(value.substr(start, end - start));
+    }
+
+    int indexOf(char c, size_t from = 0) const {
+        size_t at = value.find(c, from);
+        return at == std::string::npos ? -1 : (int)at;
+    }
+
+    void toCharArray(char* buf, size_t bufsize) const {
+        if (!buf || bufsize == 0) return;
+        size_t n = value.size() < bufsize - 1 ? value.size() : bufsize - 1;
+        memcpy(buf, value.data(), n);
+        buf[n] = '\0';
+    }
+
+    bool equals(const char* str) const { return value == (str ? str : ""); }
+    bool equals(const String& other) const { return value == other.value; }
+    bool equalsIgnoreCase(const String& other) const {
+        return value.size() == other.value.size() &&
+               strncasecmp(value.c_str(), other.value.c_str(), value.size()) == 0;
+    }
+
+    String& operator+=(const char* str) { value += str; return *this; }
+    String& operator+=(const String& other) { value += other.value; return *this; }
+    String& operator+=(char c) { value += c; return *this; }
+
+    const std::string& str() const { return value; }
+};
+
+inline bool operator==(const String& a, const String& b) { return a.equals(b); }
+inline bool operator!=(const String& a, const String& b) { return !a.equals(b); }
+
+// Sketch entry points (src/main.cpp)
+void setup();
+void loop();
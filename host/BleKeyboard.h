@@ -0,0 +1,65 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include "Arduino.h"
+
+/**
+ * @file BleKeyboard.h
+ * @brief BleKeyboard stand-in for the host build
+ *
+ * Same interface as T-vK/ESP32 BLE Keyboard for the calls the firmware
+ * makes; reports go to the active HidSink (hid_sink.h) with a
+ * timestamp, so pacing can be checked from the output.
+ *
+ * The simulated host pairs HostOptions::bleConnectMs after begin();
+ * SIGUSR2 toggles the connection (see host_main.cpp).
+ */
+
+#define KEY_LEFT_CTRL 0x80
+#define KEY_LEFT_SHIFT 0x81
+#define KEY_LEFT_ALT 0x82
+#define KEY_LEFT_GUI 0x83
+#define KEY_RIGHT_CTRL 0x84
+#define KEY_RIGHT_SHIFT 0x85
+#define KEY_RIGHT_ALT 0x86
+#define KEY_RIGHT_GUI 0x87
+#define KEY_RETURN 0xB0
+#define KEY_ESC 0xB1
+#define KEY_BACKSPACE 0xB2
+#define KEY_TAB 0xB3
+#define KEY_DELETE 0xD4
+
+class BleKeyboard {
+private:
+    std::string deviceName;
+    bool started;
+    uint32_t beganMs;
+
+public:
+    BleKeyboard(std::string name = "ESP32 Keyboard", std::string manufacturer = "Espressif",
+                uint8_t batteryLevel = 100)
+        : deviceName(name), started(false), beganMs(0) {
+        (void)manufacturer;
+        (void)batteryLevel;
+    }
+
+    void begin();
+    void end() { started = false; }
+    bool isConnected();
+    void setBatteryLevel(uint8_t level) { (void)level; }
+
+    size_t print(const char* text);
+    size_t write(uint8_t key);
+    size_t press(uint8_t key);
+    size_t release(uint8_t key);
+    void releaseAll();
+};
+
+namespace HostHid {
+    /**
+     * @brief Connect or disconnect the simulated BLE host
+     */
+    void setHostConnected(bool connected);
+    bool isHostConnected();
+}
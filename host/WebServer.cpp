@@ -0,0 +1,566 @@
+#include "WebServer.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <deque>
+#include "host_options.h"
+
+/**
+ * @file WebServer.cpp
+ * @brief POSIX-socket WebServer for the host build (see WebServer.h)
+ */
+
+static std::vector<int> listeners;
+static std::deque<HostRequest> injectedRequests;
+static std::deque<HostResponse> injectedResponses;
+
+static const char* reasonPhrase(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 404: return "Not Found";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 507: return "Insufficient Storage";
+        default: return "";
+    }
+}
+
+static HTTPMethod parseMethod(const std::string& name) {
+    if (name == "GET") return HTTP_GET;
+    if (name == "HEAD") return HTTP_HEAD;
+    if (name == "POST") return HTTP_POST;
+    if (name == "PUT") return HTTP_PUT;
+    if (name == "PATCH") return HTTP_PATCH;
+    if (name == "DELETE") return HTTP_DELETE;
+    if (name == "OPTIONS") return HTTP_OPTIONS;
+    return HTTP_ANY;  // Unknown: matches no method-specific route
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static std::string urlDecode(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (c == '+') {
+            out += ' ';
+        } else if (c == '%' && i + 2 < text.size() &&
+                   hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+            out += (char)(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+            i += 2;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+WebServer::WebServer(int port)
+    : port(port), listenFd(-1), clientFd(-1), currentMethod(HTTP_ANY),
+      contentLength(CONTENT_LENGTH_NOT_SET), requestLength(0), chunked(false), responded(false), finished(false),
+      injected(false), responseStatus(0) {
+}
+
+WebServer::~WebServer() {
+    close();
+}
+
+void WebServer::begin() {
+    if (listenFd >= 0 || !Host::options().listen) return;
+
+    // The firmware's port 80 needs root on Linux: the host port wins
+    int bindPort = Host::options().httpPort ? Host::options().httpPort : port;
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        perror("socket");
+        return;
+    }
+
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)bindPort);
+
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 64) < 0) {
+        fprintf(stderr, "host: can't listen on port %d: %s\n", bindPort, strerror(errno));
+        ::close(listenFd);
+        listenFd = -1;
+        return;
+    }
+
+    listeners.push_back(listenFd);
+    fprintf(stderr, "host: HTTP listening on http://127.0.0.1:%d\n", bindPort);
+}
+
+void WebServer::close() {
+    if (listenFd < 0) return;
+    for (size_t i = 0; i < listeners.size(); i++) {
+        if (listeners[i] == listenFd) {
+            listeners.erase(listeners.begin() + i);
+            break;
+        }
+    }
+    ::close(listenFd);
+    listenFd = -1;
+}
+
+void WebServer::on(const String& uri, THandlerFunction handler) {
+    on(uri, HTTP_ANY, handler);
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+    on(uri, method, handler, THandlerFunction());
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler,
+                   THandlerFunction upload) {
+    Route route;
+    route.uri = uri.c_str();
+    route.method = method;
+    route.handler = handler;
+    route.upload = upload;
+    routes.push_back(route);
+}
+
+void WebServer::onNotFound(THandlerFunction handler) {
+    notFoundHandler = handler;
+}
+
+String WebServer::arg(const String& name) const {
+    for (size_t i = 0; i < currentArgs.size(); i++) {
+        if (currentArgs[i].name == name.c_str()) return String(currentArgs[i].value);
+    }
+    return String();
+}
+
+bool WebServer::hasArg(const String& name) const {
+    for (size_t i = 0; i < currentArgs.size(); i++) {
+        if (currentArgs[i].name == name.c_str()) return true;
+    }
+    return false;
+}
+
+String WebServer::header(const String& name) const {
+    for (size_t i = 0; i < currentHeaders.size(); i++) {
+        if (strcasecmp(currentHeaders[i].name.c_str(), name.c_str()) == 0) {
+            return String(currentHeaders[i].value);
+        }
+    }
+    return String();
+}
+
+bool WebServer::hasHeader(const String& name) const {
+    for (size_t i = 0; i < currentHeaders.size(); i++) {
+        if (strcasecmp(currentHeaders[i].name.c_str(), name.c_str()) == 0) return true;
+    }
+    return false;
+}
+
+void WebServer::parseArgs(const std::string& encoded) {
+    size_t start = 0;
+    while (start < encoded.size()) {
+        size_t end = encoded.find('&', start);
+        if (end == std::string::npos) end = encoded.size();
+
+        std::string pair = encoded.substr(start, end - start);
+        if (!pair.empty()) {
+            size_t eq = pair.find('=');
+            Pair arg;
+            arg.name = urlDecode(pair.substr(0, eq));
+            arg.value = eq == std::string::npos ? "" : urlDecode(pair.substr(eq + 1));
+            currentArgs.push_back(arg);
+        }
+        start = end + 1;
+    }
+}
+
+bool WebServer::readRequest() {
+    std::string data;
+    char chunk[1024];
+    size_t headerEnd = std::string::npos;
+
+    while (headerEnd == std::string::npos) {
+        ssize_t n = recv(clientFd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;  // Closed or timed out
+        data.append(chunk, (size_t)n);
+        headerEnd = data.find("\r\n\r\n");
+        if (headerEnd == std::string::npos && data.size() > MAX_HEADER_BYTES) {
+            send(431, "text/plain", "Headers too large");
+            return false;
+        }
+    }
+
+    // Request line
+    size_t lineEnd = data.find("\r\n");
+    std::string requestLine = data.substr(0, lineEnd);
+    size_t sp1 = requestLine.find(' ');
+    size_t sp2 = requestLine.find(' ', sp1 == std::string::npos ? 0 : sp1 + 1);
+    if (sp1 == std::string::npos || sp2 == std::string::npos) {
+        send(400, "text/plain", "Bad request line");
+        return false;
+    }
+    currentMethod = parseMethod(requestLine.substr(0, sp1));
+    std::string target = requestLine.substr(sp1 + 1, sp2 - sp1 - 1);
+
+    size_t query = target.find('?');
+    currentUri = urlDecode(target.substr(0, query));
+    if (query != std::string::npos) {
+        parseArgs(target.substr(query + 1));
+    }
+
+    // Headers
+    size_t bodyLength = 0;
+    std::string contentType;
+    size_t pos = lineEnd + 2;
+    while (pos < headerEnd) {
+        size_t end = data.find("\r\n", pos);
+        std::string line = data.substr(pos, end - pos);
+        pos = end + 2;
+
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        Pair h;
+        h.name = line.substr(0, colon);
+        size_t valueStart = line.find_first_not_of(" \t", colon + 1);
+        h.value = valueStart == std::string::npos ? "" : line.substr(valueStart);
+        currentHeaders.push_back(h);
+
+        if (strcasecmp(h.name.c_str(), "Content-Length") == 0) {
+            bodyLength = (size_t)strtoul(h.value.c_str(), nullptr, 10);
+        } else if (strcasecmp(h.name.c_str(), "Content-Type") == 0) {
+            contentType = h.value;
+        }
+    }
+
+    // Body
+    requestLength = bodyLength;
+    const Route* route = findRoute();
+    if (bodyLength > 0 && wantsRaw(route, contentType)) {
+        return streamRaw(route, data.substr(headerEnd + 4), bodyLength);
+    }
+    if (bodyLength > MAX_BODY_BYTES) {
+        send(413, "text/plain", "Body too large");
+        return false;
+    }
+    std::string body = data.substr(headerEnd + 4);
+    while (body.size() < bodyLength) {
+        ssize_t n = recv(clientFd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        body.append(chunk, (size_t)n);
+    }
+    body.resize(bodyLength);
+
+    if (bodyLength > 0) {
+        if (contentType.compare(0, 33, "application/x-www-form-urlencoded") == 0) {
+            parseArgs(body);
+        } else {
+            Pair plain;
+            plain.name = "plain";
+            plain.value = body;
+            currentArgs.push_back(plain);
+        }
+    }
+    return true;
+}
+
+void WebServer::writeAll(const char* data, size_t length) {
+    if (injected) {
+        injectedResponse.append(data, length);
+        return;
+    }
+    while (length > 0 && clientFd >= 0) {
+        ssize_t n = ::send(clientFd, data, length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ::close(clientFd);  // Peer went away; drop the rest of the response
+            clientFd = -1;
+            return;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+    Pair h;
+    h.name = name.c_str();
+    h.value = value.c_str();
+    if (first) {
+        responseHeaders.insert(responseHeaders.begin(), h);
+    } else {
+        responseHeaders.push_back(h);
+    }
+}
+
+void WebServer::sendStatusAndHeaders(int code, const char* contentType, size_t length) {
+    std::string head = "HTTP/1.1 " + std::to_string(code) + " " + reasonPhrase(code) + "\r\n";
+    head += "Content-Type: ";
+    head += contentType ? contentType : "text/html";
+    head += "\r\n";
+    if (length == CONTENT_LENGTH_UNKNOWN) {
+        head += "Transfer-Encoding: chunked\r\n";
+    } else {
+        head += "Content-Length: " + std::to_string(length) + "\r\n";
+    }
+    for (size_t i = 0; i < responseHeaders.size(); i++) {
+        head += responseHeaders[i].name + ": " + responseHeaders[i].value + "\r\n";
+    }
+    head += "Connection: close\r\n\r\n";
+    writeAll(head.data(), head.size());
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+    if (responded) return;
+    responded = true;
+    responseStatus = code;
+
+    if (contentLength == CONTENT_LENGTH_UNKNOWN) {
+        chunked = true;
+        sendStatusAndHeaders(code, contentType, CONTENT_LENGTH_UNKNOWN);
+        if (content.length() > 0) sendContent(content);
+        return;
+    }
+
+    size_t length = contentLength == CONTENT_LENGTH_NOT_SET ? content.length() : contentLength;
+    sendStatusAndHeaders(code, contentType, length);
+    if (currentMethod != HTTP_HEAD) {
+        writeAll(content.c_str(), content.length());
+    }
+}
+
+void WebServer::sendContent(const char* content, size_t length) {
+    if (!chunked) {
+        writeAll(content, length);
+        return;
+    }
+    if (finished) return;
+
+    char size[16];
+    int n = snprintf(size, sizeof(size), "%zx\r\n", length);
+    writeAll(size, (size_t)n);
+    if (length == 0) {
+        writeAll("\r\n", 2);  // Terminating chunk
+        finished = true;
+        return;
+    }
+    writeAll(content, length);
+    writeAll("\r\n", 2);
+}
+
+void WebServer::finishResponse() {
+    if (chunked && !finished) {
+        sendContent("", 0);
+    }
+    if (clientFd >= 0) {
+        shutdown(clientFd, SHUT_WR);
+        ::close(clientFd);
+        clientFd = -1;
+    }
+}
+
+void WebServer::resetRequest() {
+    currentArgs.clear();
+    currentHeaders.clear();
+    responseHeaders.clear();
+    currentUri.clear();
+    currentMethod = HTTP_ANY;
+    contentLength = CONTENT_LENGTH_NOT_SET;
+    chunked = false;
+    responded = false;
+    finished = false;
+    responseStatus = 0;
+    requestLength = 0;
+}
+
+const WebServer::Route* WebServer::findRoute() const {
+    for (size_t i = 0; i < routes.size(); i++) {
+        const Route& route = routes[i];
+        if (route.uri == currentUri &&
+            (route.method == HTTP_ANY || route.method == currentMethod)) {
+            return &route;
+        }
+    }
+    return nullptr;
+}
+
+bool WebServer::wantsRaw(const Route* route, const std::string& contentType) const {
+    return route != nullptr && route->upload && currentMethod != HTTP_GET &&
+           contentType.compare(0, 10, "multipart/") != 0;
+}
+
+/**
+ * @brief Hand the body to the route's upload handler, HTTP_RAW_BUFLEN at a time
+ * @param pending Body bytes already read with the headers
+ * @return false if the client went away first
+ */
+bool WebServer::streamRaw(const Route* route, std::string pending, size_t bodyLength) {
+    currentRaw.totalSize = 0;
+    currentRaw.data = nullptr;
+    rawEvent(route, RAW_START, 0);
+
+    char chunk[1024];
+    while (currentRaw.totalSize < bodyLength) {
+        size_t want = bodyLength - currentRaw.totalSize;
+        if (want > HTTP_RAW_BUFLEN) want = HTTP_RAW_BUFLEN;
+        while (pending.size() < want) {
+            ssize_t n = injected ? 0 : recv(clientFd, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                rawEvent(route, RAW_ABORTED, 0);
+                return false;
+            }
+            pending.append(chunk, (size_t)n);
+        }
+        memcpy(currentRaw.buf, pending.data(), want);
+        pending.erase(0, want);
+        currentRaw.totalSize += want;
+        rawEvent(route, RAW_WRITE, want);
+    }
+
+    rawEvent(route, RAW_END, 0);
+    return true;
+}
+
+void WebServer::rawEvent(const Route* route, HTTPRawStatus status, size_t length) {
+    currentRaw.status = status;
+    currentRaw.currentSize = length;
+    route->upload();
+}
+
+void WebServer::dispatch() {
+    const Route* route = findRoute();
+    if (route != nullptr) {
+        route->handler();
+        return;
+    }
+    if (notFoundHandler) {
+        notFoundHandler();
+    } else {
+        send(404, "text/plain", String(("Not found: " + currentUri).c_str()));
+    }
+}
+
+void WebServer::serveInjected() {
+    HostRequest request = injectedRequests.front();
+    injectedRequests.pop_front();
+
+    resetRequest();
+    injected = true;
+    injectedResponse.clear();
+    clientIp = request.client;
+    currentMethod = request.method;
+    currentUri = request.uri;
+    parseArgs(request.query);
+    std::string contentType;
+    for (size_t i = 0; i < request.headers.size(); i++) {
+        Pair h;
+        h.name = request.headers[i].first;
+        h.value = request.headers[i].second;
+        currentHeaders.push_back(h);
+        if (strcasecmp(h.name.c_str(), "Content-Type") == 0) contentType = h.value;
+    }
+
+    requestLength = request.body.size();
+    const Route* route = findRoute();
+    bool served = true;
+    if (!request.body.empty() && wantsRaw(route, contentType)) {
+        served = streamRaw(route, request.body, request.body.size());
+    } else if (!request.body.empty()) {
+        Pair plain;
+        plain.name = "plain";
+        plain.value = request.body;
+        currentArgs.push_back(plain);
+    }
+
+    if (served) dispatch();
+    if (chunked && !finished) {
+        sendContent("", 0);
+    }
+
+    HostResponse response;
+    response.status = responseStatus;
+    response.raw.swap(injectedResponse);
+    injectedResponses.push_back(response);
+    injected = false;
+}
+
+void WebServer::handleClient() {
+    if (!injectedRequests.empty()) {
+        serveInjected();  // One request per call, like a connection
+        return;
+    }
+    if (listenFd < 0) return;
+
+    sockaddr_in peer = {};
+    socklen_t peerLength = sizeof(peer);
+    clientFd = accept4(listenFd, (sockaddr*)&peer, &peerLength, SOCK_CLOEXEC);
+    if (clientFd < 0) return;  // Nothing waiting (EAGAIN)
+
+    timeval timeout;
+    timeout.tv_sec = READ_TIMEOUT_MS / 1000;
+    timeout.tv_usec = (READ_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    int one = 1;
+    setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    clientIp = IPAddress(ntohl(peer.sin_addr.s_addr));
+    resetRequest();
+
+    if (readRequest()) {
+        dispatch();
+    }
+
+    finishResponse();
+}
+
+void HostNet::waitForClient(int timeoutMs) {
+    if (listeners.empty()) {
+        if (timeoutMs > 0) delay((unsigned long)timeoutMs);
+        return;
+    }
+
+    pollfd fds[8];
+    size_t count = listeners.size() < 8 ? listeners.size() : 8;
+    for (size_t i = 0; i < count; i++) {
+        fds[i].fd = listeners[i];
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+    poll(fds, count, timeoutMs);
+}
+
+void HostNet::inject(const HostRequest& request) {
+    injectedRequests.push_back(request);
+}
+
+size_t HostNet::pendingInjected() {
+    return injectedRequests.size();
+}
+
+bool HostNet::takeResponse(HostResponse& response) {
+    if (injectedResponses.empty()) return false;
+    response = injectedResponses.front();
+    injectedResponses.pop_front();
+    return true;
+}
@@ -0,0 +1,214 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "WiFi.h"
+
+/**
+ * @file WebServer.h
+ * @brief POSIX-socket WebServer for the host build
+ *
+ * Mirrors the ESP32 Arduino WebServer the firmware is written against:
+ * handleClient() serves at most one connection per call, requests are
+ * read with a timeout, one response per connection (Connection: close),
+ * and setContentLength(CONTENT_LENGTH_UNKNOWN) switches the response to
+ * chunked transfer encoding. All request headers are collected.
+ *
+ * Query parameters and urlencoded form bodies become args; any other
+ * body is available as arg("plain"). A route registered with an upload
+ * handler instead gets the body streamed to it in HTTP_RAW_BUFLEN
+ * pieces before its handler runs, with no size limit, as on the device:
+ * raw() holds RAW_START, then RAW_WRITE per piece, then RAW_END (or
+ * RAW_ABORTED if the client went away, and the handler isn't called).
+ *
+ * The listening socket is non-blocking, so an idle handleClient() costs
+ * one accept() call, as on the device. host_main.cpp sleeps in
+ * HostNet::waitForClient() between loop() passes instead of spinning.
+ *
+ * Tools can also HostNet::inject() requests without a socket: the next
+ * handleClient() serves one of them through the same routes, and the
+ * response (status and raw bytes) is kept for HostNet::takeResponse().
+ */
+
+enum HTTPMethod {
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+};
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+#define HTTP_RAW_BUFLEN 1436
+
+enum HTTPRawStatus {
+    RAW_START,
+    RAW_WRITE,
+    RAW_END,
+    RAW_ABORTED
+};
+
+/**
+ * @brief A piece of a streamed request body (see WebServer::raw())
+ */
+struct HTTPRaw {
+    HTTPRawStatus status;
+    size_t totalSize;    // Body bytes delivered so far, this piece included
+    size_t currentSize;  // Bytes in buf
+    uint8_t buf[HTTP_RAW_BUFLEN];
+    void* data;
+};
+
+class WiFiClient {
+private:
+    IPAddress ip;
+
+public:
+    WiFiClient() {}
+    explicit WiFiClient(IPAddress address) : ip(address) {}
+
+    IPAddress remoteIP() const { return ip; }
+};
+
+/**
+ * @brief A request handed to handleClient() without a connection
+ */
+struct HostRequest {
+    HTTPMethod method;
+    std::string uri;     // Path only
+    std::string query;   // urlencoded args, without '?'
+    std::string body;    // Raw body: arg("plain"), or streamed to an upload handler
+    std::vector<std::pair<std::string, std::string> > headers;
+    IPAddress client;
+
+    HostRequest() : method(HTTP_GET) {}
+};
+
+struct HostResponse {
+    int status;          // 0 if the handler sent nothing
+    std::string raw;     // Status line, headers and body as written
+};
+
+class WebServer {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    static constexpr size_t MAX_HEADER_BYTES = 8192;
+    static constexpr size_t MAX_BODY_BYTES = 16384;
+    static constexpr uint32_t READ_TIMEOUT_MS = 2000;
+
+private:
+    struct Route {
+        std::string uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+        THandlerFunction upload;  // Receives the body as raw() pieces
+    };
+
+    struct Pair {
+        std::string name;
+        std::string value;
+    };
+
+    int port;
+    int listenFd;
+    std::vector<Route> routes;
+    THandlerFunction notFoundHandler;
+
+    // Current request
+    int clientFd;
+    IPAddress clientIp;
+    HTTPMethod currentMethod;
+    std::string currentUri;
+    std::vector<Pair> currentArgs;
+    std::vector<Pair> currentHeaders;
+    std::vector<Pair> responseHeaders;
+    size_t contentLength;
+    size_t requestLength;  // Content-Length of the request
+    HTTPRaw currentRaw;
+    bool chunked;
+    bool responded;
+    bool finished;
+    bool injected;       // Serving a HostNet::inject() request
+    int responseStatus;
+    std::string injectedResponse;
+
+    void resetRequest();
+    const Route* findRoute() const;
+    bool wantsRaw(const Route* route, const std::string& contentType) const;
+    bool streamRaw(const Route* route, std::string pending, size_t bodyLength);
+    void rawEvent(const Route* route, HTTPRawStatus status, size_t length);
+    void dispatch();
+    void serveInjected();
+    bool readRequest();
+    void parseArgs(const std::string& encoded);
+    void writeAll(const char* data, size_t length);
+    void sendStatusAndHeaders(int code, const char* contentType, size_t length);
+    void finishResponse();
+
+public:
+    explicit WebServer(int port = 80);
+    ~WebServer();
+
+    void begin();
+    void close();
+    void handleClient();
+
+    void on(const String& uri, THandlerFunction handler);
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler, THandlerFunction upload);
+    void onNotFound(THandlerFunction handler);
+
+    // Request
+    String uri() const { return String(currentUri.c_str()); }
+    HTTPMethod method() const { return currentMethod; }
+    String arg(const String& name) const;
+    bool hasArg(const String& name) const;
+    int args() const { return (int)currentArgs.size(); }
+    String header(const String& name) const;
+    bool hasHeader(const String& name) const;
+    void collectHeaders(const char* headerKeys[], size_t count) {
+        (void)headerKeys;
+        (void)count;  // Every header is kept
+    }
+    WiFiClient client() const { return WiFiClient(clientIp); }
+    HTTPRaw& raw() { return currentRaw; }
+    size_t clientContentLength() const { return requestLength; }
+
+    // Response
+    void setContentLength(size_t length) { contentLength = length; }
+    void sendHeader(const String& name, const String& value, bool first = false);
+    void send(int code, const char* contentType = nullptr, const String& content = String());
+    void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+    void sendContent(const char* content, size_t length);
+};
+
+namespace HostNet {
+    /**
+     * @brief Sleep until a listening socket has a connection waiting
+     * @param timeoutMs Longest wait (the loop's next timer deadline)
+     */
+    void waitForClient(int timeoutMs);
+
+    /**
+     * @brief Queue a request for the next handleClient() (no socket needed)
+     */
+    void inject(const HostRequest& request);
+
+    size_t pendingInjected();
+
+    /**
+     * @brief Take the oldest response to an injected request
+     * @return false if none is waiting
+     */
+    bool takeResponse(HostResponse& response);
+}
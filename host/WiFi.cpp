@@ -0,0 +1,53 @@
+#include "WiFi.h"
+#include "host_options.h"
+
+/**
+ * @file WiFi.cpp
+ * @brief Simulated WiFi station for the host build (see WiFi.h)
+ */
+
+WiFiClass WiFi;
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password) {
+    (void)ssid;
+    (void)password;
+    started = true;
+    attemptStartMs = millis();
+    return status();
+}
+
+wl_status_t WiFiClass::status() {
+    if (!started) return WL_IDLE_STATUS;
+    if (!linkUp) return WL_DISCONNECTED;
+    if ((uint32_t)(millis() - attemptStartMs) < Host::options().wifiConnectMs) {
+        return WL_DISCONNECTED;  // Still associating
+    }
+    return WL_CONNECTED;
+}
+
+bool WiFiClass::reconnect() {
+    started = true;
+    attemptStartMs = millis();
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+    (void)wifiOff;
+    started = false;
+    return true;
+}
+
+IPAddress WiFiClass::localIP() const {
+    return linkUp && started ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+int32_t WiFiClass::RSSI() const {
+    return linkUp && started ? -50 : 0;
+}
+
+void WiFiClass::setLinkUp(bool up) {
+    if (up && !linkUp) {
+        attemptStartMs = millis();  // The station re-associates once the AP is back
+    }
+    linkUp = up;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include "Arduino.h"
+#include "IPAddress.h"
+
+/**
+ * @file WiFi.h
+ * @brief Simulated WiFi station for the host build
+ *
+ * begin() and reconnect() "associate" after HostOptions::wifiConnectMs,
+ * as long as the simulated link is up. SIGUSR1 toggles the link (see
+ * host_main.cpp), which exercises the firmware's disconnect handling
+ * and LED alert without touching a real network.
+ */
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class WiFiClass {
+private:
+    bool started;
+    bool linkUp;
+    uint32_t attemptStartMs;
+
+public:
+    WiFiClass() : started(false), linkUp(true), attemptStartMs(0) {}
+
+    wl_status_t begin(const char* ssid, const char* password);
+    wl_status_t status();
+    bool reconnect();
+    bool disconnect(bool wifiOff = false);
+
+    IPAddress localIP() const;
+    int32_t RSSI() const;
+
+    /**
+     * @brief Raise or drop the simulated access point (host only)
+     */
+    void setLinkUp(bool up);
+    bool isLinkUp() const { return linkUp; }
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,99 @@
+#include "Arduino.h"
+#include "esp_timer.h"
+#include "host_clock.h"
+#include <sched.h>
+#include <time.h>
+
+/**
+ * @file arduino_host.cpp
+ * @brief Clocks, delay and pins for the host build
+ */
+
+HostSerial Serial;
+
+static uint8_t pinStates[64];
+static bool virtualTime = false;
+static uint64_t virtualUs = 0;
+
+static uint64_t monotonicUs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+int64_t esp_timer_get_time() {
+    if (virtualTime) return (int64_t)virtualUs;
+
+    // Like the ESP32's clocks, count from "reset": the first call, which
+    // happens during static initialisation
+    static const uint64_t startUs = monotonicUs();
+    return (int64_t)(monotonicUs() - startUs);
+}
+
+unsigned long millis() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+void delay(unsigned long ms) {
+    if (virtualTime) {
+        virtualUs += (uint64_t)ms * 1000ULL;
+        return;
+    }
+
+    timespec ts;
+    ts.tv_sec = (time_t)(ms / 1000);
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0) {
+        // Interrupted by a signal: sleep the remainder
+    }
+}
+
+void delayMicroseconds(unsigned int us) {
+    if (virtualTime) {
+        virtualUs += us;
+        return;
+    }
+
+    uint64_t until = monotonicUs() + us;
+    while (monotonicUs() < until) {
+        // Busy-wait, as on the device
+    }
+}
+
+void yield() {
+    sched_yield();
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < sizeof(pinStates)) pinStates[pin] = value;
+}
+
+uint8_t digitalRead(uint8_t pin) {
+    return pin < sizeof(pinStates) ? pinStates[pin] : 0;
+}
+
+void HostClock::useVirtual(uint64_t startUs) {
+    virtualTime = true;
+    virtualUs = startUs;
+}
+
+bool HostClock::isVirtual() {
+    return virtualTime;
+}
+
+void HostClock::advanceTo(uint64_t us) {
+    if (us > virtualUs) virtualUs = us;
+}
+
+uint64_t HostClock::nowUs() {
+    return (uint64_t)esp_timer_get_time();
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file esp_task_wdt.h
+ * @brief Task watchdog for the host build (no-op)
+ *
+ * Stalls are still caught by the heartbeat supervisor, which runs from
+ * the timing wheel off-device.
+ */
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+
+inline esp_err_t esp_task_wdt_init(uint32_t timeoutSeconds, bool panic) {
+    (void)timeoutSeconds;
+    (void)panic;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_task_wdt_add(void* task) {
+    (void)task;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_task_wdt_reset() {
+    return ESP_OK;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file esp_timer.h
+ * @brief esp_timer_get_time() for the host build: CLOCK_MONOTONIC since start
+ *        (or virtual time, see host_clock.h)
+ *
+ * Only the clock is provided; periodic esp_timers are device-only and
+ * the firmware uses the timing wheel instead off-device.
+ */
+
+int64_t esp_timer_get_time();
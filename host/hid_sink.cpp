@@ -0,0 +1,173 @@
+#include "hid_sink.h"
+#include <stdlib.h>
+#include <string.h>
+#include "BleKeyboard.h"
+#include "esp_timer.h"
+#include "host_options.h"
+
+/**
+ * @file hid_sink.cpp
+ * @brief HID report sinks and the BleKeyboard stand-in for the host build
+ */
+
+static HidSink* activeSink = nullptr;
+static NullHidSink nullSink;
+static bool hostConnected = true;
+
+// ===== StreamHidSink =====
+
+StreamHidSink::~StreamHidSink() {
+    if (owned) {
+        fclose(out);
+    } else {
+        fflush(out);
+    }
+}
+
+void StreamHidSink::onText(uint64_t us, const char* text, size_t length) {
+    fprintf(out, "%llu text \"", (unsigned long long)us);
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        switch (c) {
+            case '\n': fputs("\\n", out); break;
+            case '\r': fputs("\\r", out); break;
+            case '\t': fputs("\\t", out); break;
+            case '"': fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            default:
+                if (c < 0x20 || c == 0x7F) {
+                    fprintf(out, "\\x%02x", c);
+                } else {
+                    fputc(c, out);
+                }
+        }
+    }
+    fputs("\"\n", out);
+    fflush(out);
+}
+
+void StreamHidSink::onPress(uint64_t us, uint8_t key) {
+    fprintf(out, "%llu press 0x%02x\n", (unsigned long long)us, key);
+    fflush(out);
+}
+
+void StreamHidSink::onReleaseAll(uint64_t us) {
+    fprintf(out, "%llu release_all\n", (unsigned long long)us);
+    fflush(out);
+}
+
+// ===== MemoryHidSink =====
+
+void MemoryHidSink::onText(uint64_t us, const char* text, size_t length) {
+    Event e;
+    e.us = us;
+    e.kind = Kind::TEXT;
+    e.key = 0;
+    e.text.assign(text, length);
+    events.push_back(e);
+    typed.append(text, length);
+}
+
+void MemoryHidSink::onPress(uint64_t us, uint8_t key) {
+    Event e;
+    e.us = us;
+    e.kind = Kind::PRESS;
+    e.key = key;
+    events.push_back(e);
+}
+
+void MemoryHidSink::onReleaseAll(uint64_t us) {
+    Event e;
+    e.us = us;
+    e.kind = Kind::RELEASE_ALL;
+    e.key = 0;
+    events.push_back(e);
+}
+
+// ===== Sink selection =====
+
+HidSink* HostHid::open(const char* spec) {
+    if (strcmp(spec, "null") == 0) {
+        return new NullHidSink();
+    }
+    if (strcmp(spec, "memory") == 0) {
+        return new MemoryHidSink();
+    }
+    if (strcmp(spec, "stdout") == 0) {
+        return new StreamHidSink(stdout, false);
+    }
+    if (strncmp(spec, "fd:", 3) == 0) {
+        FILE* f = fdopen(atoi(spec + 3), "w");
+        return f ? new StreamHidSink(f, true) : nullptr;
+    }
+    if (strncmp(spec, "file:", 5) == 0) {
+        FILE* f = fopen(spec + 5, "w");  // Blocks on a FIFO until a reader opens it
+        return f ? new StreamHidSink(f, true) : nullptr;
+    }
+    return nullptr;
+}
+
+HidSink* HostHid::sink() {
+    return activeSink ? activeSink : &nullSink;
+}
+
+void HostHid::setSink(HidSink* sink) {
+    activeSink = sink;
+}
+
+MemoryHidSink* HostHid::recorder() {
+    return dynamic_cast<MemoryHidSink*>(activeSink);
+}
+
+void HostHid::setHostConnected(bool connected) {
+    hostConnected = connected;
+}
+
+bool HostHid::isHostConnected() {
+    return hostConnected;
+}
+
+// ===== BleKeyboard =====
+
+static uint64_t nowUs() {
+    return (uint64_t)esp_timer_get_time();
+}
+
+void BleKeyboard::begin() {
+    started = true;
+    beganMs = millis();
+}
+
+bool BleKeyboard::isConnected() {
+    return started && HostHid::isHostConnected() &&
+           (uint32_t)(millis() - beganMs) >= Host::options().bleConnectMs;
+}
+
+size_t BleKeyboard::print(const char* text) {
+    if (!isConnected()) return 0;
+    size_t length = strlen(text);
+    HostHid::sink()->onText(nowUs(), text, length);
+    return length;
+}
+
+size_t BleKeyboard::write(uint8_t key) {
+    if (!isConnected()) return 0;
+    char text[2] = { (char)key, '\0' };
+    HostHid::sink()->onText(nowUs(), text, 1);
+    return 1;
+}
+
+size_t BleKeyboard::press(uint8_t key) {
+    if (!isConnected()) return 0;
+    HostHid::sink()->onPress(nowUs(), key);
+    return 1;
+}
+
+size_t BleKeyboard::release(uint8_t key) {
+    (void)key;
+    return isConnected() ? 1 : 0;
+}
+
+void BleKeyboard::releaseAll() {
+    if (isConnected()) HostHid::sink()->onReleaseAll(nowUs());
+}
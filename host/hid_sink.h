@@ -0,0 +1,98 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/**
+ * @file hid_sink.h
+ * @brief Where the host build's BleKeyboard sends HID reports
+ *
+ * - NullHidSink drops everything (pure request-path profiling).
+ * - StreamHidSink writes one line per event to a FILE*: a regular file,
+ *   stdout, an inherited pipe fd or a FIFO.
+ *     <us> text "<escaped>"
+ *     <us> press 0x80
+ *     <us> release_all
+ * - MemoryHidSink records events in memory, for in-process tools that
+ *   check what was typed.
+ *
+ * Usage (host_main.cpp):
+ *   HidSink* sink = HostHid::open("file:/tmp/hid.log");
+ *   HostHid::setSink(sink);
+ */
+
+class HidSink {
+public:
+    virtual ~HidSink() {}
+    virtual void onText(uint64_t us, const char* text, size_t length) = 0;
+    virtual void onPress(uint64_t us, uint8_t key) = 0;
+    virtual void onReleaseAll(uint64_t us) = 0;
+};
+
+class NullHidSink : public HidSink {
+public:
+    void onText(uint64_t, const char*, size_t) override {}
+    void onPress(uint64_t, uint8_t) override {}
+    void onReleaseAll(uint64_t) override {}
+};
+
+class StreamHidSink : public HidSink {
+private:
+    FILE* out;
+    bool owned;
+
+public:
+    StreamHidSink(FILE* stream, bool closeOnDelete) : out(stream), owned(closeOnDelete) {}
+    ~StreamHidSink() override;
+
+    void onText(uint64_t us, const char* text, size_t length) override;
+    void onPress(uint64_t us, uint8_t key) override;
+    void onReleaseAll(uint64_t us) override;
+};
+
+class MemoryHidSink : public HidSink {
+public:
+    enum class Kind : uint8_t { TEXT, PRESS, RELEASE_ALL };
+
+    struct Event {
+        uint64_t us;
+        Kind kind;
+        uint8_t key;
+        std::string text;
+    };
+
+private:
+    std::vector<Event> events;
+    std::string typed;
+
+public:
+    void onText(uint64_t us, const char* text, size_t length) override;
+    void onPress(uint64_t us, uint8_t key) override;
+    void onReleaseAll(uint64_t us) override;
+
+    const std::vector<Event>& getEvents() const { return events; }
+    const std::string& getTyped() const { return typed; }  // All text, in order
+
+    void clear() {
+        events.clear();
+        typed.clear();
+    }
+};
+
+namespace HostHid {
+    /**
+     * @brief Create a sink from a --hid spec
+     * @return nullptr if the spec is invalid or the file can't be opened
+     */
+    HidSink* open(const char* spec);
+
+    HidSink* sink();
+    void setSink(HidSink* sink);
+
+    /**
+     * @brief The memory recorder, if that's the active sink
+     */
+    MemoryHidSink* recorder();
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file host_clock.h
+ * @brief Virtual time for the host build
+ *
+ * By default the host clocks follow CLOCK_MONOTONIC. After useVirtual()
+ * they stand still until advanceTo() moves them, and delay() advances
+ * them instead of sleeping, so a tool can replay hours of traffic
+ * through the real firmware in seconds and get the same timing every run.
+ *
+ * Usage (tools/replay):
+ *   HostClock::useVirtual(0);
+ *   setup();
+ *   HostClock::advanceTo(HostClock::nowUs() + 1000);
+ *   loop();
+ */
+
+namespace HostClock {
+    /**
+     * @brief Switch to virtual time (call before setup())
+     * @param startUs Initial esp_timer_get_time() value
+     */
+    void useVirtual(uint64_t startUs);
+
+    bool isVirtual();
+
+    /**
+     * @brief Move virtual time forward (never backwards)
+     */
+    void advanceTo(uint64_t us);
+
+    uint64_t nowUs();
+}
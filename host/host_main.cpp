@@ -0,0 +1,124 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <BleKeyboard.h>
+#include <WebServer.h>
+#include <signal.h>
+#include "host_options.h"
+#include "hid_sink.h"
+#include "utils/timing_wheel.h"
+
+/**
+ * @file host_main.cpp
+ * @brief Linux entry point: runs the real setup()/loop() from src/main.cpp
+ *
+ *   pio run -e host -t exec
+ *   .pio/build/host/program --port 8080 --hid file:/tmp/hid.log
+ *
+ * Options:
+ *   --port N          HTTP port (default 8080)
+ *   --hid SPEC        null | memory | stdout | fd:N | file:PATH (default memory)
+ *   --wifi-ms N       Simulated association time (default 300)
+ *   --ble-ms N        Time until the BLE host connects (default 0)
+ *   --run-ms N        Exit after N ms (default: run until SIGINT)
+ *
+ * Signals:
+ *   SIGUSR1           Drop / restore the simulated WiFi link
+ *   SIGUSR2           Disconnect / reconnect the simulated BLE host
+ *   SIGINT, SIGTERM   Print a summary and exit
+ *
+ * Between loop() passes the process sleeps in poll() until the next
+ * timer is due or a client connects, so an idle emulator uses no CPU
+ * while request handling and timer work run exactly as on the device.
+ */
+
+static volatile sig_atomic_t stopRequested = 0;
+static volatile sig_atomic_t wifiToggles = 0;
+static volatile sig_atomic_t bleToggles = 0;
+
+static void onSignal(int signal) {
+    switch (signal) {
+        case SIGUSR1: wifiToggles = wifiToggles + 1; break;
+        case SIGUSR2: bleToggles = bleToggles + 1; break;
+        default: stopRequested = 1; break;
+    }
+}
+
+static bool parseOptions(int argc, char** argv, HostOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--port") == 0 && hasValue) {
+            options.httpPort = (uint16_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--hid") == 0 && hasValue) {
+            options.hidSink = argv[++i];
+        } else if (strcmp(argv[i], "--wifi-ms") == 0 && hasValue) {
+            options.wifiConnectMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--ble-ms") == 0 && hasValue) {
+            options.bleConnectMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--run-ms") == 0 && hasValue) {
+            options.runMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    HostOptions& options = Host::options();
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    HidSink* sink = HostHid::open(options.hidSink);
+    if (sink == nullptr) {
+        fprintf(stderr, "host: bad --hid sink: %s\n", options.hidSink);
+        return 2;
+    }
+    HostHid::setSink(sink);
+
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGUSR1, onSignal);
+    signal(SIGUSR2, onSignal);
+
+    setup();
+
+    sig_atomic_t wifiSeen = 0;
+    sig_atomic_t bleSeen = 0;
+    while (!stopRequested) {
+        if (wifiToggles != wifiSeen) {
+            wifiSeen = wifiToggles;
+            WiFi.setLinkUp(!WiFi.isLinkUp());
+            fprintf(stderr, "host: WiFi link %s\n", WiFi.isLinkUp() ? "up" : "down");
+        }
+        if (bleToggles != bleSeen) {
+            bleSeen = bleToggles;
+            HostHid::setHostConnected(!HostHid::isHostConnected());
+            fprintf(stderr, "host: BLE host %s\n",
+                    HostHid::isHostConnected() ? "connected" : "disconnected");
+        }
+
+        loop();
+
+        if (options.runMs && millis() >= options.runMs) {
+            break;
+        }
+
+        // Sleep until the next timer or a connection; cap so signals and
+        // heartbeats are serviced promptly
+        uint32_t idleMs = SystemTimers::wheel().ticksUntilNext();
+        HostNet::waitForClient(idleMs < 50 ? (int)idleMs : 50);
+    }
+
+    MemoryHidSink* recorder = HostHid::recorder();
+    if (recorder) {
+        fprintf(stderr, "host: HID recorder: %zu events, %zu chars typed\n",
+                recorder->getEvents().size(), recorder->getTyped().size());
+    }
+    HostHid::setSink(nullptr);
+    delete sink;
+    return 0;
+}
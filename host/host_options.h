@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file host_options.h
+ * @brief Command-line settings for the Linux host-emulation build
+ *
+ * Parsed by host_main.cpp before setup() runs; read by the shims.
+ */
+
+struct HostOptions {
+    uint16_t httpPort;        // Replaces Config::HTTP::SERVER_PORT (80 needs root)
+    const char* hidSink;      // "null", "memory", "stdout", "fd:N" or "file:PATH"
+    uint32_t wifiConnectMs;   // Simulated association time
+    uint32_t bleConnectMs;    // Time until a BLE host "pairs"
+    uint32_t runMs;           // Exit after this long (0 = until SIGINT)
+    bool listen;              // Open the HTTP socket (off: injected requests only)
+
+    HostOptions()
+        : httpPort(8080), hidSink("memory"), wifiConnectMs(300), bleConnectMs(0), runMs(0),
+          listen(true) {}
+};
+
+namespace Host {
+    /**
+     * @brief Get the process-wide host options
+     */
+    inline HostOptions& options() {
+        static HostOptions instance;
+        return instance;
+    }
+}
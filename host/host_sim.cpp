@@ -0,0 +1,43 @@
+#include "host_sim.h"
+#include "host_clock.h"
+#include "utils/timing_wheel.h"
+#include "utils/heap_trap.h"
+
+/**
+ * @file host_sim.cpp
+ * @brief Virtual-time loop() driver for host tools (see host_sim.h)
+ */
+
+/**
+ * @brief One loop() pass with the heap trap in force, even when the
+ *        tool driving it holds a HeapTrap::Allow
+ */
+static void firmwarePass() {
+    HeapTrap::Forbid firmware;
+    loop();
+}
+
+uint64_t HostSim::runUntil(uint64_t untilUs, uint32_t maxStepMs) {
+    uint64_t passes = 0;
+    while (HostClock::nowUs() < untilUs) {
+        firmwarePass();
+        passes++;
+        uint32_t stepMs = SystemTimers::wheel().ticksUntilNext();
+        if (stepMs > maxStepMs) stepMs = maxStepMs;
+        uint64_t next = HostClock::nowUs() + (uint64_t)stepMs * 1000ULL;
+        HostClock::advanceTo(next < untilUs ? next : untilUs);
+    }
+    return passes;
+}
+
+HostResponse HostSim::serve(const HostRequest& request) {
+    HostNet::inject(request);
+    while (HostNet::pendingInjected() > 0) {
+        firmwarePass();  // handleClient() takes one injected request per pass
+    }
+
+    HostResponse response;
+    response.status = 0;
+    HostNet::takeResponse(response);
+    return response;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+#include "WebServer.h"
+
+/**
+ * @file host_sim.h
+ * @brief Drive the host build's setup()/loop() on virtual time
+ *
+ * Shared by the tools that run the firmware faster than real time
+ * (tools/replay, tools/soak). Call HostClock::useVirtual() and setup()
+ * first. All periodic work off-device runs from the timing wheel, so
+ * jumping the clock straight to the wheel's next due tick skips only
+ * idle loop() passes.
+ *
+ * In a HEAP_TRAP_AFTER_BOOT build, loop() runs under HeapTrap::Forbid,
+ * so a tool can hold a HeapTrap::Allow for its own bookkeeping and
+ * still have every allocation the firmware makes trapped.
+ *
+ * Usage:
+ *   HostClock::useVirtual(0);
+ *   setup();
+ *   HostSim::runUntil(60 * 1000000ULL, 250);
+ *   HostResponse r = HostSim::serve(request);
+ */
+
+namespace HostSim {
+    /**
+     * @brief Run loop() until the clock reaches untilUs
+     * @param maxStepMs Longest jump between loop() passes
+     * @return loop() passes run
+     */
+    uint64_t runUntil(uint64_t untilUs, uint32_t maxStepMs);
+
+    /**
+     * @brief Inject a request and run loop() until it has been served
+     *
+     * No virtual time passes: the handler's own delay() calls, if any,
+     * are the only thing that moves the clock.
+     */
+    HostResponse serve(const HostRequest& request);
+}
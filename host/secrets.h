@@ -0,0 +1,16 @@
+#ifndef SECRETS_H
+#define SECRETS_H
+
+/**
+ * @file secrets.h
+ * @brief Credentials for the host build when src/secrets.h doesn't exist
+ *
+ * WiFi is simulated, so the SSID is only logged. Requests need
+ * "X-API-Key: host-dev-key".
+ */
+
+#define WIFI_SSID "host-sim"
+#define WIFI_PASSWORD "unused"
+#define API_KEY "host-dev-key"
+
+#endif
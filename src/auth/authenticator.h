@@ -1,6 +1,7 @@
 #pragma once
 #include <WebServer.h>
 #include "error_codes.h"
+#include "utils/heap_trap.h"
 
 /**
  * @file authenticator.h
@@ -33,6 +34,7 @@ public:
      * @return true if request has valid API key
      */
     bool authenticate(WebServer& server) {
+        HeapTrap::Allow library;  // Header lookups build Strings
         if (!server.hasHeader("X-API-Key")) {
             return false;
         }
@@ -46,6 +48,7 @@ public:
      * @param server WebServer instance
      */
     void sendUnauthorized(WebServer& server) {
+        HeapTrap::Allow library;
         server.send(
             httpStatusCode(ErrorCode::UNAUTHORIZED),
             "application/json",
@@ -65,6 +68,7 @@ public:
             errorMessage(code),
             static_cast<int>(code)
         );
+        HeapTrap::Allow library;
         server.send(httpStatusCode(code), "application/json", json);
     }
 
@@ -79,6 +83,7 @@ public:
             "{\"status\":\"success\",\"message\":\"%s\"}",
             message
         );
+        HeapTrap::Allow library;
         server.send(200, "application/json", json);
     }
 };
@@ -24,6 +24,13 @@ namespace Config {
         constexpr size_t TEXT_CHUNK_SIZE = 4;  // Characters per chunk for reliable BLE transmission
         constexpr uint16_t CHUNK_DELAY_MS = 100;  // Delay between chunks
         constexpr size_t MAX_MESSAGE_LENGTH = 1000;  // Maximum message length to prevent DoS
+
+        // Report pacing (hardware timer driven)
+        constexpr size_t REPORT_QUEUE_DEPTH = 16;  // Pre-planned chunks; power of two
+        constexpr uint32_t PUMP_TASK_STACK = 4096;  // Bytes
+        constexpr uint8_t PUMP_TASK_PRIORITY = 5;  // Above loopTask (1)
+        constexpr uint8_t PUMP_TASK_CORE = 0;  // Protocol core; loop() runs on core 1
+        constexpr uint32_t TELEMETRY_INTERVAL_MS = 1000;  // Reports/s and chars/s sampling window
     }
 
     // WiFi Configuration
@@ -43,12 +50,77 @@ namespace Config {
     namespace HTTP {
         constexpr uint16_t SERVER_PORT = 80;
         constexpr uint32_t REQUEST_TIMEOUT_MS = 5000;
+        constexpr size_t ARENA_BYTES = 2048;  // Per-request scratch: the message, its log copy, the reply
+        constexpr size_t JSON_BYTES = 1024;  // /status, /profile and /diag/boot bodies
     }
 
     // Rate Limiting Configuration
     namespace RateLimit {
         constexpr uint32_t WINDOW_MS = 1000;  // Rate limit window (1 second)
         constexpr uint8_t MAX_REQUESTS = 5;  // Max requests per window
+        constexpr uint32_t CLEANUP_INTERVAL_MS = 60000;  // Drop idle clients every minute
+        constexpr size_t MAX_CLIENTS = 256;  // Pooled client entries (power of two)
+    }
+
+    // Metrics Configuration
+    namespace Metrics {
+        constexpr size_t MAX_METRICS = 96;  // Registry slots (one per series)
+        constexpr size_t CHUNK_SIZE = 512;  // /metrics streaming buffer (bytes)
+    }
+
+    // Memory Instrumentation Configuration
+    namespace Memory {
+        constexpr uint32_t HEAP_SAMPLE_INTERVAL_MS = 1000;  // Heap gauge refresh
+        constexpr size_t MAX_TASKS = 24;  // FreeRTOS tasks listed by /diag/memory
+    }
+
+    // On-device Benchmark Configuration
+    namespace Bench {
+        constexpr size_t MAX_CASES = 16;   // Result slots per /bench run
+        constexpr uint32_t BATCHES = 5;    // Timed batches per case (yield between)
+    }
+
+    // Request Tracing Configuration
+    namespace Trace {
+        constexpr size_t RING_SIZE = 256;  // Span events kept for /trace (~24 bytes each)
+    }
+
+    // Request Capture Configuration
+    namespace Capture {
+        constexpr bool ENABLED_AT_BOOT = false;  // Toggle with POST /capture?mode=on
+        constexpr size_t RECORDS = 64;     // Requests kept for GET /capture (~100 bytes each)
+        constexpr size_t BODY_BYTES = 64;  // Prefix of "msg" kept per request
+    }
+
+    // Snippet Store Configuration (flash partition "snippets" in partitions.csv)
+    namespace Snippets {
+        constexpr const char* PARTITION = "snippets";
+        constexpr size_t SLOTS = 16;  // One 4 KB flash sector per snippet, plus one spare
+        constexpr size_t MAX_NAME_LENGTH = 23;
+        constexpr size_t MAX_TEXT_LENGTH = 3500;  // Template as uploaded (RAM scratch at upload)
+        constexpr size_t MAX_VARIABLES = 8;  // Distinct {name} placeholders per snippet
+        constexpr size_t MAX_VARIABLE_NAME = 15;
+        constexpr size_t VALUE_BYTES = 256;  // All variable values of one /type job
+        constexpr size_t MAX_TYPED_LENGTH = 8000;  // Expanded text of one job
+    }
+
+    // Spool Configuration (flash partition "spool" in partitions.csv)
+    namespace Spool {
+        constexpr const char* PARTITION = "spool";
+        constexpr size_t NATIVE_BYTES = 132 * 1024;  // RAM stand-in off-device (512 KB on the device)
+        constexpr uint32_t CHECKPOINT_INTERVAL_MS = 1000;  // Typing progress saved at most this often
+    }
+
+    // Job Journal Configuration (RTC memory, survives warm resets)
+    namespace Jobs {
+        constexpr size_t JOURNAL_ENTRIES = 4;  // Recent jobs kept; 32 bytes each
+    }
+
+    // Loop Profiler Configuration
+    namespace Profiler {
+        constexpr uint32_t LOOP_BUDGET_US = 20000;  // Iterations longer than this are overruns
+        constexpr uint32_t OVERRUN_LOG_INTERVAL_MS = 1000;  // At most one overrun log line per second
+        constexpr uint32_t SUMMARY_INTERVAL_MS = 10000;  // RTC summary refresh for the next boot
     }
 
     // Logging Configuration
@@ -70,5 +142,14 @@ namespace Config {
     // Watchdog Configuration
     namespace Watchdog {
         constexpr uint32_t TIMEOUT_SECONDS = 30;  // 30 second watchdog timeout
+
+        // Per-manager heartbeat budgets (well inside TIMEOUT_SECONDS)
+        constexpr size_t MAX_HEARTBEATS = 8;
+        constexpr uint32_t CHECK_INTERVAL_MS = 250;  // Supervisor esp_timer period
+        constexpr uint32_t LOOP_BUDGET_MS = 5000;    // Whole loop() iteration
+        constexpr uint32_t TIMERS_BUDGET_MS = 500;   // Timing wheel callbacks
+        constexpr uint32_t BLE_BUDGET_MS = 500;      // BLEKeyboardManager::update()
+        constexpr uint32_t PUMP_BUDGET_MS = 1000;    // Pump task between reports while pacing
+        constexpr uint32_t HTTP_BUDGET_MS = 3000;    // One handleClient() call, incl. handler
     }
 }
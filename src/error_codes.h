@@ -1,4 +1,6 @@
 #pragma once
+#include <stdint.h>
+#include <stddef.h>
 
 /**
  * @file error_codes.h
@@ -17,9 +19,61 @@ enum class ErrorCode {
     RATE_LIMIT_EXCEEDED = 8,
     UNAUTHORIZED = 9,
     BUSY = 10,
+    NOT_FOUND = 11,
+    STORAGE_FULL = 12,
     INTERNAL_ERROR = 99
 };
 
+/**
+ * @brief Number of distinct error codes (for per-code tables)
+ */
+constexpr size_t ERROR_CODE_COUNT = 14;
+
+/**
+ * @brief Map an error code to a dense index 0..ERROR_CODE_COUNT-1
+ */
+inline size_t errorCodeIndex(ErrorCode code) {
+    int value = static_cast<int>(code);
+    if (value >= 0 && value <= static_cast<int>(ErrorCode::STORAGE_FULL)) {
+        return static_cast<size_t>(value);
+    }
+    return ERROR_CODE_COUNT - 1;  // INTERNAL_ERROR and anything unknown
+}
+
+/**
+ * @brief Inverse of errorCodeIndex()
+ */
+inline ErrorCode errorCodeAt(size_t index) {
+    if (index < ERROR_CODE_COUNT - 1) {
+        return static_cast<ErrorCode>(index);
+    }
+    return ErrorCode::INTERNAL_ERROR;
+}
+
+/**
+ * @brief Get stable identifier for an error code (for logs and metric labels)
+ * @param code Error code
+ * @return Upper-case name matching the enumerator
+ */
+inline const char* errorCodeName(ErrorCode code) {
+    switch (code) {
+        case ErrorCode::SUCCESS: return "SUCCESS";
+        case ErrorCode::BLE_NOT_CONNECTED: return "BLE_NOT_CONNECTED";
+        case ErrorCode::BLE_SEND_FAILED: return "BLE_SEND_FAILED";
+        case ErrorCode::WIFI_NOT_CONNECTED: return "WIFI_NOT_CONNECTED";
+        case ErrorCode::MESSAGE_TOO_LONG: return "MESSAGE_TOO_LONG";
+        case ErrorCode::MESSAGE_EMPTY: return "MESSAGE_EMPTY";
+        case ErrorCode::INVALID_PARAMETER: return "INVALID_PARAMETER";
+        case ErrorCode::INVALID_CHARACTERS: return "INVALID_CHARACTERS";
+        case ErrorCode::RATE_LIMIT_EXCEEDED: return "RATE_LIMIT_EXCEEDED";
+        case ErrorCode::UNAUTHORIZED: return "UNAUTHORIZED";
+        case ErrorCode::BUSY: return "BUSY";
+        case ErrorCode::NOT_FOUND: return "NOT_FOUND";
+        case ErrorCode::STORAGE_FULL: return "STORAGE_FULL";
+        default: return "INTERNAL_ERROR";
+    }
+}
+
 /**
  * @brief Get human-readable error message
  * @param code Error code
@@ -49,6 +103,10 @@ inline const char* errorMessage(ErrorCode code) {
             return "Unauthorized - valid API key required";
         case ErrorCode::BUSY:
             return "System busy - another operation in progress";
+        case ErrorCode::NOT_FOUND:
+            return "Not found - no such snippet, spooled text or job";
+        case ErrorCode::STORAGE_FULL:
+            return "Snippet storage full - delete one first";
         default:
             return "Internal error";
     }
@@ -69,6 +127,10 @@ inline uint16_t httpStatusCode(ErrorCode code) {
             return 429;
         case ErrorCode::BUSY:
             return 409;
+        case ErrorCode::NOT_FOUND:
+            return 404;
+        case ErrorCode::STORAGE_FULL:
+            return 507;
         case ErrorCode::BLE_NOT_CONNECTED:
         case ErrorCode::MESSAGE_TOO_LONG:
         case ErrorCode::MESSAGE_EMPTY:
@@ -8,6 +8,14 @@
 #include "managers/WebServerManager.h"
 #include "auth/authenticator.h"
 #include "utils/logger.h"
+#include "utils/timing_wheel.h"
+#include "utils/loop_profiler.h"
+#include "utils/heartbeat.h"
+#include "utils/alloc_tracker.h"
+#include "utils/alloc_hooks.h"
+#include "utils/memory_diagnostics.h"
+#include "utils/boot_profiler.h"
+#include "utils/heap_trap.h"
 
 /**
  * @file main.cpp
@@ -21,8 +29,12 @@
  *
  * Flow:
  * 1. setup() initializes all managers
- * 2. loop() calls update() on each manager
- * 3. Managers handle their own state and timing
+ * 2. loop() advances the timing wheel, which runs periodic and delayed
+ *    work, then services BLE planning and HTTP
+ * 3. Managers handle their own state and arm their own timers
+ * 4. The loop profiler charges each step's time to its manager
+ * 5. Each step arms a heartbeat; the supervisor records which one
+ *    stalled (and where) before the task watchdog resets the chip
  */
 
 // ===== Global Manager Instances =====
@@ -32,40 +44,88 @@ LEDManager ledManager(Config::LED::PIN);
 WebServerManager webServer(Config::HTTP::SERVER_PORT);
 Authenticator authenticator(API_KEY);
 
+// Heartbeats for the parts of loop() not owned by a manager
+Heartbeat* loopHeartbeat = nullptr;
+Heartbeat* timersHeartbeat = nullptr;
+AllocStats timerAllocs;
+
+// Static RAM per object, reported by /diag/memory
+static const MemoryFootprint staticFootprint[] = {
+    MEMORY_FOOTPRINT("bleManager", BLEKeyboardManager),
+    MEMORY_FOOTPRINT("wifiManager", WiFiManager),
+    MEMORY_FOOTPRINT("ledManager", LEDManager),
+    MEMORY_FOOTPRINT("webServer", WebServerManager),
+    MEMORY_FOOTPRINT("authenticator", Authenticator),
+    MEMORY_FOOTPRINT("timingWheel", TimingWheel),
+    MEMORY_FOOTPRINT("metrics", MetricsRegistry),
+    MEMORY_FOOTPRINT("tracer", Tracer),
+    MEMORY_FOOTPRINT("loopProfiler", LoopProfiler),
+    MEMORY_FOOTPRINT("heartbeats", HeartbeatSupervisor),
+    MEMORY_FOOTPRINT("allocTracker", AllocTracker),
+};
+
 // ====== Setup ======
 
 void setup() {
+    BootProfiler& boot = Profiling::boot();
+    boot.begin();
+
     Serial.begin(115200);
     delay(100);  // Allow serial to stabilize
 
     LOG_HEADER("ESP32 BLE Keyboard - Secure Edition v2.0");
     LOG_RAW("");
+    boot.phaseDone(BootPhase::CONSOLE);
 
     // Initialize watchdog timer
     esp_task_wdt_init(Config::Watchdog::TIMEOUT_SECONDS, true);
     esp_task_wdt_add(NULL);
     LOG_INFO_F("Watchdog timer enabled (%d seconds)", Config::Watchdog::TIMEOUT_SECONDS);
+    boot.phaseDone(BootPhase::WATCHDOG);
+
+    // Report the previous boot's stall (if any) and start supervising
+    HeartbeatSupervisor& supervisor = Heartbeats::supervisor();
+    supervisor.begin();
+    loopHeartbeat = supervisor.add("loop", Config::Watchdog::LOOP_BUDGET_MS);
+    timersHeartbeat = supervisor.add("timers", Config::Watchdog::TIMERS_BUDGET_MS);
+
+    // Count allocations made on this (the loop) task from here on
+    Allocations::tracker().begin();
+    AllocTracker::registerStats("timers", timerAllocs);
+
+    // Memory report: static footprint, plus this task for builds that
+    // can't enumerate tasks
+    Diagnostics::memory().setFootprint(staticFootprint,
+                                       sizeof(staticFootprint) / sizeof(staticFootprint[0]));
+#ifdef ESP_PLATFORM
+    Diagnostics::memory().addTask(xTaskGetCurrentTaskHandle());
+#endif
+
+    // Report the previous boot's loop profile and start profiling this one
+    Profiling::mainLoop().begin();
+    boot.registerMetrics();
+    boot.phaseDone(BootPhase::DIAGNOSTICS);
 
     // Initialize LED
     ledManager.begin();
     LOG_INFO("LED manager initialized");
+    boot.phaseDone(BootPhase::LED);
+
+    // Start WiFi first: association runs in the WiFi task while the BLE
+    // stack comes up, instead of after it
+    LOG_INFO_F("Connecting to WiFi: %s", WIFI_SSID);
+    wifiManager.begin(WIFI_SSID, WIFI_PASSWORD);
+    boot.phaseDone(BootPhase::WIFI_START);
 
     // Initialize BLE keyboard
     bleManager.begin();
     LOG_INFO_F("BLE keyboard started: %s", bleManager.getDeviceName());
+    boot.phaseDone(BootPhase::BLE);
 
-    // Connect to WiFi
-    LOG_INFO_F("Connecting to WiFi: %s", WIFI_SSID);
-    bool wifiConnected = wifiManager.begin(WIFI_SSID, WIFI_PASSWORD);
-
-    if (wifiConnected) {
-        LOG_INFO_F("WiFi connected! IP: %s", wifiManager.getIP().toString().c_str());
-    } else {
-        LOG_ERROR("WiFi connection timeout. Will retry in background.");
-    }
-
-    // Initialize web server with dependencies
+    // Initialize web server with dependencies (listens on any interface,
+    // so it doesn't wait for an IP)
     webServer.begin(&bleManager, &ledManager, &authenticator);
+    boot.phaseDone(BootPhase::HTTP);
 
     // Print startup summary
     LOG_RAW("");
@@ -86,37 +146,76 @@ void setup() {
     LOG_RAW("⚠️  SECURITY: API key required in X-API-Key header");
     LOG_SEPARATOR();
     LOG_RAW("");
+    boot.phaseDone(BootPhase::SUMMARY);
+    boot.setupDone();
+    LOG_INFO_F("Setup took %lu ms", (unsigned long)(boot.setupUs() / 1000));
+
+    loopHeartbeat->arm("loop");
+
+    // Boot is done: from here on the loop task runs from static storage
+    HeapTrap::arm();
 }
 
 // ====== Loop ======
 
 void loop() {
+    LoopProfiler& profiler = Profiling::mainLoop();
+    profiler.beginIteration();
+
     // Reset watchdog timer
     esp_task_wdt_reset();
+    loopHeartbeat->beat("loop");
 
-    // Update all managers (all non-blocking)
-    wifiManager.update();
+    // Run expired timers (LED flash, WiFi monitoring, combos, cleanup)
+    {
+        HeartbeatScope watch(timersHeartbeat, "wheel.advance");
+        AllocScope scope(&timerAllocs);
+        SystemTimers::wheel().advance(SystemTimers::nowTick());
+    }
+    profiler.mark(LoopProfiler::TIMERS);
+
+    // Update managers with per-iteration work (all non-blocking)
     bleManager.update();
-    ledManager.update();
+    profiler.mark(LoopProfiler::BLE);
     webServer.handleClient();
+    profiler.mark(LoopProfiler::HTTP);
+    loopHeartbeat->beat("housekeeping");
 
     // Update LED status based on WiFi state
     static bool lastWiFiState = false;
+    static bool lastConnecting = true;
     bool currentWiFiState = wifiManager.isConnected();
+    bool connecting = wifiManager.isConnecting();
 
     if (lastWiFiState != currentWiFiState) {
         // WiFi state changed
         if (currentWiFiState) {
-            LOG_INFO_F("WiFi reconnected! IP: %s", wifiManager.getIP().toString().c_str());
+            IPAddress ip = wifiManager.getIP();
+            LOG_INFO_F("WiFi connected! IP: %u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
             ledManager.setFlashing(false);
+            if (Profiling::boot().reach(BootMilestone::WIFI_CONNECTED)) {
+                LOG_INFO_F("WiFi up %lu ms after reset",
+                           (unsigned long)(Profiling::boot().milestoneAtUs(BootMilestone::WIFI_CONNECTED) / 1000));
+            }
         } else {
             LOG_ERROR("WiFi disconnected!");
         }
         lastWiFiState = currentWiFiState;
     }
 
+    if (lastConnecting && !connecting && !currentWiFiState) {
+        LOG_ERROR("WiFi connection timeout. Will retry in background.");
+    }
+    lastConnecting = connecting;
+
+    if (bleManager.isConnected()) {
+        Profiling::boot().reach(BootMilestone::BLE_CONNECTED);
+    }
+
     // Check for long-term WiFi disconnect
     if (wifiManager.isDisconnectedLongTerm()) {
         ledManager.setFlashing(true);
     }
+
+    profiler.endIteration();
 }
@@ -3,6 +3,22 @@
 #include "config.h"
 #include "error_codes.h"
 #include "utils/time_utils.h"
+#include "utils/system_snapshot.h"
+#include "utils/report_pacer.h"
+#include "utils/coroutine.h"
+#include "utils/timing_wheel.h"
+#include "utils/metrics.h"
+#include "utils/tracer.h"
+#include "utils/heartbeat.h"
+#include "utils/alloc_tracker.h"
+#include "utils/memory_diagnostics.h"
+#include "utils/job_journal.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
 
 /**
  * @class BLEKeyboardManager
@@ -10,7 +26,11 @@
  *
  * This class encapsulates all BLE keyboard operations including:
  * - Connection management
- * - Non-blocking text sending via queue
+ * - Non-blocking text sending via queue, paced by a hardware timer
+ * - Streamed jobs longer than the queue (snippets), read as they are typed
+ * - Jobs typed in place from text that outlives them (the flash spool)
+ * - Each job's progress journaled to RTC memory per report, so a reset
+ *   leaves behind where it stopped
  * - Special key combinations (Ctrl+Alt+Del, Sleep)
  *
  * Example usage:
@@ -27,78 +47,457 @@
  *   }
  */
 class BLEKeyboardManager {
+public:
+    /**
+     * @brief Supplies the next bytes of a streamed job (loop task only)
+     * @return Bytes written to out; 0 means the text has ended
+     */
+    typedef size_t (*TextReader)(char* out, size_t max, void* context);
+
+    /**
+     * @brief Told when a job ends, from update() (loop task)
+     * @param typed Characters the host was sent
+     * @param completed false if the job failed or was aborted
+     */
+    typedef void (*JobEndHandler)(size_t typed, bool completed, void* context);
+
 private:
-    BleKeyboard keyboard;
+    mutable BleKeyboard keyboard;  // library accessors are not const-qualified
 
-    // Non-blocking send queue
+    // Non-blocking send queue (planning side; emission is in the pacer).
+    // A text job is held whole in buffer. A streamed job passes through
+    // it as a window, refilled from the reader as reports are planned.
+    // A mapped job is planned straight from the caller's text.
     struct SendQueue {
         char buffer[Config::BLE::MAX_MESSAGE_LENGTH + 1];
-        size_t position;
-        unsigned long lastSendTime;
+        const char* text;        // buffer, or the caller's text for a mapped job
+        size_t length;           // Whole job
+        size_t windowStart;      // Job offset of text[0]
+        size_t filled;           // Bytes held in text
+        size_t plannedPosition;  // Next character to plan into a report (job offset)
+        TextReader reader;       // nullptr for a text job
+        void* readerContext;
+        bool truncated;          // Reader ended before length
         bool active;
+        JobEndHandler onEnd;
+        void* onEndContext;
 
         void reset() {
             buffer[0] = '\0';
-            position = 0;
-            lastSendTime = 0;
+            text = buffer;
+            length = 0;
+            windowStart = 0;
+            filled = 0;
+            plannedPosition = 0;
+            reader = nullptr;
+            readerContext = nullptr;
+            truncated = false;
             active = false;
+            onEnd = nullptr;
+            onEndContext = nullptr;
         }
 
         void start(const char* text) {
+            reset();
             strncpy(buffer, text, Config::BLE::MAX_MESSAGE_LENGTH);
             buffer[Config::BLE::MAX_MESSAGE_LENGTH] = '\0';
-            position = 0;
-            lastSendTime = millis();
+            length = strlen(buffer);
+            filled = length;
             active = true;
         }
 
+        void startStream(TextReader fn, void* context, size_t total) {
+            reset();
+            length = total;
+            reader = fn;
+            readerContext = context;
+            active = true;
+            refill();
+        }
+
+        void startMapped(const char* data, size_t total) {
+            reset();
+            text = data;
+            length = total;
+            filled = total;
+            active = true;
+        }
+
+        /**
+         * @brief Move the unplanned tail to the front and read up to a full window
+         */
+        void refill() {
+            size_t keep = windowStart + filled - plannedPosition;
+            memmove(buffer, buffer + (plannedPosition - windowStart), keep);
+            windowStart = plannedPosition;
+            filled = keep;
+
+            size_t want = length - windowStart;
+            if (want > Config::BLE::MAX_MESSAGE_LENGTH) want = Config::BLE::MAX_MESSAGE_LENGTH;
+            while (filled < want) {
+                size_t n = reader(buffer + filled, want - filled, readerContext);
+                if (n == 0) {
+                    truncated = true;
+                    break;
+                }
+                filled += n;
+            }
+        }
+
+        bool isFinalWindow() const {
+            return windowStart + filled >= length;
+        }
+
         size_t getLength() const {
-            return strlen(buffer);
+            return length;
         }
     } sendQueue;
 
+    ReportPacer pacer;
+    bool lastConnected;
+
+    // Telemetry (updated from the pump task and the loop)
+    Counter typedChars;
+    Gauge queueDepth;
+    Counter printFailures;
+    Counter disconnectsMidJob;
+    Counter jobsCompleted;
+    Counter jobsFailed;
+    Gauge reportsPerSecond;
+    Gauge charsPerSecond;
+    Timer rateTimer;
+    uint32_t lastReportCount;
+    uint32_t lastCharCount;
+
+    // Watchdog heartbeats: update() from loop(), and the pump while pacing
+    Heartbeat* heartbeat;
+    Heartbeat* pumpHeartbeat;
+    AllocStats allocs;  // Allocations made by update()
+
+    // Trace span of the current text job. Set by queueText() before
+    // pacer.startJob() publishes the job; after that only the emitting
+    // side touches firstReportUs/firstReportSent.
+    TraceContext jobTrace;
+    uint64_t jobQueuedUs;
+    uint64_t firstReportUs;
+    bool firstReportSent;
+
+    // Key combination sequences (stackless coroutines woken by comboTimer)
+    enum class Combo : uint8_t {
+        NONE,
+        CTRL_ALT_DEL,
+        SLEEP
+    };
+    Combo activeCombo;
+    Coroutine comboCo;
+    Timer comboTimer;
+
+    static void onComboTimer(void* context) {
+        static_cast<BLEKeyboardManager*>(context)->processCombo();
+    }
+
     /**
-     * @brief Process send queue (called by update())
+     * @brief Turn report/char counters into per-second rates
      */
-    void processSendQueue() {
-        if (!sendQueue.active) return;
+    static void onRateTimer(void* context) {
+        BLEKeyboardManager* self = static_cast<BLEKeyboardManager*>(context);
+        uint32_t reports = self->pacer.getReportCounter().get();
+        uint32_t chars = self->typedChars.get();
+
+        uint32_t scale = 1000 / Config::BLE::TELEMETRY_INTERVAL_MS;
+        self->reportsPerSecond.set((int32_t)((reports - self->lastReportCount) * scale));
+        self->charsPerSecond.set((int32_t)((chars - self->lastCharCount) * scale));
+        self->lastReportCount = reports;
+        self->lastCharCount = chars;
+    }
 
-        // Check if enough time has passed since last chunk
-        if (!TimeUtils::hasElapsed(sendQueue.lastSendTime, Config::BLE::CHUNK_DELAY_MS)) {
-            return;
+#ifdef ESP_PLATFORM
+    esp_timer_handle_t pacerTimer;
+    TaskHandle_t pumpTask;
+
+    /**
+     * @brief Periodic timer callback - wakes the pump task
+     *
+     * Runs in the esp_timer task; the BLE write itself happens in the
+     * pump task so a slow notify never delays other esp_timer users.
+     */
+    static void onPacerTimer(void* arg) {
+        BLEKeyboardManager* self = static_cast<BLEKeyboardManager*>(arg);
+        xTaskNotifyGive(self->pumpTask);
+    }
+
+    /**
+     * @brief Pump task - emits one queued report per timer period
+     */
+    static void pumpTaskMain(void* arg) {
+        BLEKeyboardManager* self = static_cast<BLEKeyboardManager*>(arg);
+        for (;;) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            if (self->pumpHeartbeat) self->pumpHeartbeat->beat("pacer.tick");
+            self->pacer.tick(TimeUtils::nowUs());
         }
+    }
+#else
+    // No hardware timer off-device: tick the pacer from the timing wheel
+    Timer pacerTimer;
+
+    static void onPacerTimer(void* context) {
+        BLEKeyboardManager* self = static_cast<BLEKeyboardManager*>(context);
+        if (self->pumpHeartbeat) self->pumpHeartbeat->beat("pacer.tick");
+        self->pacer.tick(TimeUtils::nowUs());
+    }
+#endif
 
-        // Verify BLE is still connected
+    /**
+     * @brief Pacer sink - send one report over BLE
+     *
+     * Called from the pump task on device, from the timing wheel on native.
+     */
+    static bool emitReport(const HidReport& report, void* context) {
+        BLEKeyboardManager* self = static_cast<BLEKeyboardManager*>(context);
+
+        // Disconnects are counted when the failed job is retired
+        if (!self->keyboard.isConnected()) {
+            return false;
+        }
+
+        if (self->pumpHeartbeat) self->pumpHeartbeat->beat("keyboard.print");
+        if (!self->keyboard.print(report.text)) {
+            self->printFailures.inc();
+            return false;
+        }
+
+        if (report.last) {
+            self->keyboard.releaseAll();
+        }
+
+        self->traceReport(report);
+        self->typedChars.inc(report.length);
+        Jobs::journal().progress(report.length);
+        self->queueDepth.set((int32_t)self->pacer.queuedReports());
+        self->publishState();
+        return true;
+    }
+
+    /**
+     * @brief Record queue-wait, typing and end-to-end stages of the job's span
+     */
+    void traceReport(const HidReport& report) {
+        if (!jobTrace.isActive()) return;
+
+        Tracer& tracer = Tracing::tracer();
+        uint64_t now = TimeUtils::nowUs();
+
+        if (!firstReportSent) {
+            tracer.record(jobTrace, TraceStage::QUEUE_WAIT, jobQueuedUs, now);
+            firstReportUs = now;
+            firstReportSent = true;
+        }
+
+        if (report.last) {
+            tracer.record(jobTrace, TraceStage::TYPING, firstReportUs, now);
+            tracer.record(jobTrace, TraceStage::END_TO_END, jobTrace.startUs, now);
+        }
+    }
+
+    /**
+     * @brief Publish BLE state to the system snapshot
+     */
+    void publishState() {
+        bool connected = keyboard.isConnected();
+        bool busy = sendQueue.active || activeCombo != Combo::NONE;
+        uint8_t progress = getSendProgress();
+
+        SystemStatus::publish([connected, busy, progress](SystemSnapshot& s) {
+            s.ble.connected = connected;
+            s.ble.busy = busy;
+            s.ble.progress = progress;
+        });
+    }
+
+    /**
+     * @brief Plan queued text into reports until the pacer queue is full
+     */
+    void planReports() {
+        for (;;) {
+            size_t planned = pacer.plan(sendQueue.text, sendQueue.filled,
+                                        sendQueue.plannedPosition - sendQueue.windowStart,
+                                        sendQueue.isFinalWindow());
+            sendQueue.plannedPosition = sendQueue.windowStart + planned;
+            if (sendQueue.isFinalWindow() ||
+                sendQueue.filled - planned >= Config::BLE::TEXT_CHUNK_SIZE) {
+                break;  // Job fully read, or the report queue is full
+            }
+            sendQueue.refill();
+            if (sendQueue.truncated) {
+                pacer.abort();  // Snippet unreadable; don't leave the job hanging
+                break;
+            }
+        }
+        queueDepth.set((int32_t)pacer.queuedReports());
+    }
+
+    /**
+     * @brief Journal the job in sendQueue and hand it to the pacer
+     */
+    void beginJob(const TraceContext& trace, const JobTag& job) {
+        Jobs::journal().start(job);  // Before the pump can write a report
+        jobTrace = trace;
+        jobQueuedUs = TimeUtils::nowUs();
+        firstReportSent = false;
+        pacer.startJob();
+        planReports();
+        startPacing();
+        publishState();
+    }
+
+    /**
+     * @brief Start periodic report emission
+     */
+    void startPacing() {
+        if (pumpHeartbeat) pumpHeartbeat->arm("startPacing");
+#ifdef ESP_PLATFORM
+        esp_timer_start_periodic(pacerTimer, pacer.getPeriodUs());
+#else
+        SystemTimers::wheel().armPeriodic(pacerTimer, Config::BLE::CHUNK_DELAY_MS);
+#endif
+    }
+
+    /**
+     * @brief Stop periodic report emission
+     */
+    void stopPacing() {
+#ifdef ESP_PLATFORM
+        esp_timer_stop(pacerTimer);
+#else
+        SystemTimers::wheel().cancel(pacerTimer);
+#endif
+        if (pumpHeartbeat) pumpHeartbeat->disarm();
+    }
+
+    /**
+     * @brief Ctrl+Alt+Del sequence
+     * @return true while still running
+     */
+    bool runCtrlAltDel() {
+        CO_BEGIN(comboCo);
+
+        keyboard.press(KEY_LEFT_CTRL);
+        keyboard.press(KEY_LEFT_ALT);
+        keyboard.press(KEY_DELETE);
+        CO_SLEEP(comboCo, comboTimer, Config::BLE::KEY_PRESS_DURATION_MS);
+        keyboard.releaseAll();
+
+        CO_END(comboCo);
+    }
+
+    /**
+     * @brief Windows sleep sequence (Win+X, U, S)
+     * @return true while still running
+     */
+    bool runSleepCombo() {
+        CO_BEGIN(comboCo);
+
+        // Win+X
+        keyboard.press(KEY_LEFT_GUI);
+        keyboard.press('x');
+        keyboard.releaseAll();
+        CO_SLEEP(comboCo, comboTimer, Config::BLE::SLEEP_COMBO_DELAY_MS);
+
+        // U
+        keyboard.press('u');
+        keyboard.releaseAll();
+        CO_SLEEP(comboCo, comboTimer, Config::BLE::SLEEP_COMBO_DELAY_MS);
+
+        // S
+        keyboard.press('s');
+        keyboard.releaseAll();
+
+        CO_END(comboCo);
+    }
+
+    /**
+     * @brief Resume the active key combination (called by comboTimer)
+     */
+    void processCombo() {
+        if (activeCombo == Combo::NONE) return;
+
+        // Abandon the sequence if the host went away mid-way
         if (!keyboard.isConnected()) {
-            sendQueue.reset();
-            return;
+            comboCo.cancel();
+            SystemTimers::wheel().cancel(comboTimer);
+        }
+
+        bool running = false;
+        if (comboCo.isRunning()) {
+            running = (activeCombo == Combo::CTRL_ALT_DEL) ? runCtrlAltDel() : runSleepCombo();
+        }
+
+        if (!running) {
+            activeCombo = Combo::NONE;
+            publishState();
         }
+    }
 
-        // Calculate chunk to send
-        size_t totalLength = sendQueue.getLength();
-        size_t remaining = totalLength - sendQueue.position;
-        size_t chunkLen = (remaining < Config::BLE::TEXT_CHUNK_SIZE)
-            ? remaining
-            : Config::BLE::TEXT_CHUNK_SIZE;
+    /**
+     * @brief Start a key combination and run its first step immediately
+     */
+    ErrorCode startCombo(Combo combo) {
+        if (!keyboard.isConnected()) {
+            return ErrorCode::BLE_NOT_CONNECTED;
+        }
 
-        // Create chunk
-        char chunk[Config::BLE::TEXT_CHUNK_SIZE + 1];
-        strncpy(chunk, sendQueue.buffer + sendQueue.position, chunkLen);
-        chunk[chunkLen] = '\0';
+        if (sendQueue.active || activeCombo != Combo::NONE) {
+            return ErrorCode::BUSY;
+        }
 
-        // Send chunk
-        if (keyboard.print(chunk)) {
-            sendQueue.position += chunkLen;
-            sendQueue.lastSendTime = millis();
+        activeCombo = combo;
+        comboCo.reset();
+        processCombo();
+        publishState();
+        return ErrorCode::SUCCESS;
+    }
 
-            // Check if done
-            if (sendQueue.position >= totalLength) {
-                keyboard.releaseAll();
-                sendQueue.reset();
+    /**
+     * @brief Refill the pacer and retire finished jobs (called by update())
+     *
+     * Timing is owned by the pacer; the loop only has to keep the report
+     * queue from running dry.
+     */
+    void processSendQueue() {
+        if (!sendQueue.active) return;
+
+        // Job finished on the emitting side (completed, failed or aborted)
+        if (!pacer.isJobActive()) {
+            bool completed = pacer.getLastOutcome() == ReportPacer::JobOutcome::COMPLETED;
+            Jobs::journal().finish(completed);
+            if (completed) {
+                jobsCompleted.inc();
+            } else {
+                jobsFailed.inc();
+                if (!keyboard.isConnected()) {
+                    disconnectsMidJob.inc();
+                }
             }
-        } else {
-            // Send failed
+
+            JobEndHandler onEnd = sendQueue.onEnd;
+            void* onEndContext = sendQueue.onEndContext;
+
+            stopPacing();
             sendQueue.reset();
+            queueDepth.set(0);
+            publishState();
+            if (onEnd) {
+                onEnd(pacer.getEmittedChars(), completed, onEndContext);
+            }
+            return;
+        }
+
+        // Verify BLE is still connected
+        if (!keyboard.isConnected()) {
+            pacer.abort();
+        } else {
+            planReports();
         }
     }
 
@@ -111,8 +510,20 @@ public:
             Config::BLE::DEVICE_NAME,
             Config::BLE::MANUFACTURER,
             Config::BLE::BATTERY_LEVEL
-        ) {
+        ), lastConnected(false), lastReportCount(0), lastCharCount(0),
+          heartbeat(nullptr), pumpHeartbeat(nullptr),
+          jobQueuedUs(0), firstReportUs(0),
+          firstReportSent(false), activeCombo(Combo::NONE) {
         sendQueue.reset();
+        pacer.setSink(&BLEKeyboardManager::emitReport, this);
+        comboTimer.setCallback(&BLEKeyboardManager::onComboTimer, this);
+        rateTimer.setCallback(&BLEKeyboardManager::onRateTimer, this);
+#ifdef ESP_PLATFORM
+        pacerTimer = nullptr;
+        pumpTask = nullptr;
+#else
+        pacerTimer.setCallback(&BLEKeyboardManager::onPacerTimer, this);
+#endif
     }
 
     /**
@@ -121,7 +532,64 @@ public:
      * Call this in setup()
      */
     void begin() {
+        Jobs::journal().begin();  // Before any job overwrites the previous boot's entries
         keyboard.begin();
+
+#ifdef ESP_PLATFORM
+        xTaskCreatePinnedToCore(
+            &BLEKeyboardManager::pumpTaskMain, "hid_pump",
+            Config::BLE::PUMP_TASK_STACK, this,
+            Config::BLE::PUMP_TASK_PRIORITY, &pumpTask,
+            Config::BLE::PUMP_TASK_CORE);
+        Diagnostics::memory().addTask(pumpTask);
+
+        esp_timer_create_args_t timerArgs = {};
+        timerArgs.callback = &BLEKeyboardManager::onPacerTimer;
+        timerArgs.arg = this;
+        timerArgs.dispatch_method = ESP_TIMER_TASK;
+        timerArgs.name = "hid_pacer";
+        esp_timer_create(&timerArgs, &pacerTimer);
+#endif
+
+        MetricsRegistry& registry = Metrics::registry();
+        registry.addCounter("ble_typed_chars_total",
+                            "Characters sent to the host (rate() gives chars/s)", typedChars);
+        registry.addGauge("ble_report_queue_depth", "HID reports planned but not yet sent",
+                          queueDepth);
+        registry.addCounter("ble_report_underruns_total",
+                            "Pacer ticks that found the report queue empty mid-job",
+                            pacer.getUnderrunCounter());
+        registry.addHistogram("ble_report_jitter_seconds",
+                              "Deviation of inter-report interval from the nominal period",
+                              pacer.getJitterHistogram(), 1e-6);
+        registry.addHistogram("ble_report_interval_seconds", "Time between consecutive reports",
+                              pacer.getIntervalHistogram(), 1e-6);
+        registry.addHistogram("ble_report_pacing_wait_seconds",
+                              "Time a planned report waited for its pacer tick",
+                              pacer.getPacingWaitHistogram(), 1e-6);
+        registry.addHistogram("ble_report_loop_blocked_seconds",
+                              "Time the pacer sat starved until loop() refilled the queue",
+                              pacer.getLoopBlockedHistogram(), 1e-6);
+        registry.addCounter("ble_reports_total", "HID reports sent", pacer.getReportCounter());
+        registry.addGauge("ble_reports_per_second", "Reports sent in the last second",
+                          reportsPerSecond);
+        registry.addCounter("ble_print_failures_total", "Report writes rejected by the BLE stack",
+                            printFailures);
+        registry.addCounter("ble_disconnects_mid_job_total",
+                            "Text jobs cut short by the host disconnecting", disconnectsMidJob);
+        registry.addCounter("ble_jobs_total", "Text jobs finished, by outcome",
+                            jobsCompleted, "outcome", "completed");
+        registry.addCounter("ble_jobs_total", "Text jobs finished, by outcome",
+                            jobsFailed, "outcome", "failed");
+        AllocTracker::registerStats("ble", allocs);
+
+        SystemTimers::wheel().armPeriodic(rateTimer, Config::BLE::TELEMETRY_INTERVAL_MS);
+
+        HeartbeatSupervisor& supervisor = Heartbeats::supervisor();
+        heartbeat = supervisor.add("ble", Config::Watchdog::BLE_BUDGET_MS);
+        pumpHeartbeat = supervisor.add("hid_pump", Config::Watchdog::PUMP_BUDGET_MS);
+
+        publishState();
     }
 
     /**
@@ -130,7 +598,18 @@ public:
      * Call this in loop() to process send queue
      */
     void update() {
+        HeartbeatScope watch(heartbeat, "processSendQueue");
+        AllocScope scope(&allocs);
         processSendQueue();
+
+        if (heartbeat) heartbeat->beat("publishState");
+
+        // Connection changes come from the BLE stack; publish on edge
+        bool connected = keyboard.isConnected();
+        if (connected != lastConnected) {
+            lastConnected = connected;
+            publishState();
+        }
     }
 
     /**
@@ -142,11 +621,11 @@ public:
     }
 
     /**
-     * @brief Check if currently sending text
-     * @return true if send queue is active
+     * @brief Check if currently sending text or a key combination
+     * @return true if send queue or a combo is active
      */
     bool isBusy() const {
-        return sendQueue.active;
+        return sendQueue.active || activeCombo != Combo::NONE;
     }
 
     /**
@@ -159,66 +638,82 @@ public:
         size_t total = sendQueue.getLength();
         if (total == 0) return 100;
 
-        return (sendQueue.position * 100) / total;
+        return (pacer.getEmittedChars() * 100) / total;
     }
 
     /**
-     * @brief Send Ctrl+Alt+Del key combination
-     * @return Error code
+     * @brief Get report pacer (cadence jitter, underruns)
+     * @return Pacer instance
      */
-    ErrorCode sendCtrlAltDel() {
-        if (!keyboard.isConnected()) {
-            return ErrorCode::BLE_NOT_CONNECTED;
-        }
+    const ReportPacer& getPacer() const {
+        return pacer;
+    }
 
-        keyboard.press(KEY_LEFT_CTRL);
-        keyboard.press(KEY_LEFT_ALT);
-        keyboard.press(KEY_DELETE);
-        delay(Config::BLE::KEY_PRESS_DURATION_MS);
-        keyboard.releaseAll();
+    /**
+     * @brief Pump telemetry counters since boot
+     */
+    struct Telemetry {
+        uint32_t reports;
+        uint32_t chars;
+        int32_t reportsPerSecond;
+        int32_t charsPerSecond;
+        uint32_t printFailures;
+        uint32_t disconnectsMidJob;
+        uint32_t jobsCompleted;
+        uint32_t jobsFailed;
+    };
 
-        return ErrorCode::SUCCESS;
+    /**
+     * @brief Get pump telemetry
+     * @return Copy of the counters (histograms are on getPacer())
+     */
+    Telemetry getTelemetry() const {
+        Telemetry t;
+        t.reports = pacer.getReportCounter().get();
+        t.chars = typedChars.get();
+        t.reportsPerSecond = reportsPerSecond.get();
+        t.charsPerSecond = charsPerSecond.get();
+        t.printFailures = printFailures.get();
+        t.disconnectsMidJob = disconnectsMidJob.get();
+        t.jobsCompleted = jobsCompleted.get();
+        t.jobsFailed = jobsFailed.get();
+        return t;
     }
 
     /**
-     * @brief Send Windows sleep command sequence (Win+X, U, S)
+     * @brief Send Ctrl+Alt+Del key combination (non-blocking)
      * @return Error code
+     *
+     * Keys are pressed immediately; the release happens from a timer
+     * after KEY_PRESS_DURATION_MS.
      */
-    ErrorCode sendSleepCombo() {
-        if (!keyboard.isConnected()) {
-            return ErrorCode::BLE_NOT_CONNECTED;
-        }
-
-        // Win+X
-        keyboard.press(KEY_LEFT_GUI);
-        keyboard.press('x');
-        keyboard.releaseAll();
-        delay(Config::BLE::SLEEP_COMBO_DELAY_MS);
-
-        // U
-        keyboard.press('u');
-        keyboard.releaseAll();
-        delay(Config::BLE::SLEEP_COMBO_DELAY_MS);
-
-        // S
-        keyboard.press('s');
-        keyboard.releaseAll();
+    ErrorCode sendCtrlAltDel() {
+        return startCombo(Combo::CTRL_ALT_DEL);
+    }
 
-        return ErrorCode::SUCCESS;
+    /**
+     * @brief Send Windows sleep command sequence (Win+X, U, S) (non-blocking)
+     * @return Error code
+     *
+     * Win+X is sent immediately; U and S follow from a timer.
+     */
+    ErrorCode sendSleepCombo() {
+        return startCombo(Combo::SLEEP);
     }
 
     /**
      * @brief Queue text for non-blocking transmission
      * @param text Text to send (max 1000 characters)
+     * @param trace Span to attribute queue wait and typing to (optional)
+     * @param job Journal entry when text is the rest of a longer job
+     *            (resuming); by default the job is text itself
      * @return Error code
      */
-    ErrorCode queueText(const char* text) {
-        if (!keyboard.isConnected()) {
-            return ErrorCode::BLE_NOT_CONNECTED;
-        }
-
-        if (sendQueue.active) {
-            return ErrorCode::BUSY;
+    ErrorCode queueText(const char* text, const TraceContext& trace = TraceContext(),
+                        const JobTag& job = JobTag()) {
+        ErrorCode ready = checkReady();
+        if (ready != ErrorCode::SUCCESS) {
+            return ready;
         }
 
         if (text == nullptr || text[0] == '\0') {
@@ -231,9 +726,102 @@ public:
         }
 
         sendQueue.start(text);
+        if (job.length == 0) {
+            beginJob(trace, JobTag(JobKind::TEXT, Crc32::compute(sendQueue.buffer, len), len));
+        } else {
+            beginJob(trace, job);
+        }
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Queue text that is read as it is typed (non-blocking)
+     * @param reader Called from update() for the next bytes; context must
+     *               stay valid until the job ends (isBusy() is false)
+     * @param context Passed through to reader
+     * @param length Characters the reader will supply
+     * @param trace Span to attribute queue wait and typing to (optional)
+     * @param job Journal entry (by default a snippet with no hash)
+     * @param onEnd Called once when the job ends (optional)
+     * @param endContext Passed through to onEnd
+     * @return Error code
+     *
+     * If the reader ends early the job is aborted (counted as failed).
+     */
+    ErrorCode queueStream(TextReader reader, void* context, size_t length,
+                          const TraceContext& trace = TraceContext(),
+                          const JobTag& job = JobTag(), JobEndHandler onEnd = nullptr,
+                          void* endContext = nullptr) {
+        ErrorCode ready = checkReady();
+        if (ready != ErrorCode::SUCCESS) {
+            return ready;
+        }
+
+        if (reader == nullptr || length == 0) {
+            return ErrorCode::MESSAGE_EMPTY;
+        }
+
+        sendQueue.startStream(reader, context, length);
+        sendQueue.onEnd = onEnd;
+        sendQueue.onEndContext = endContext;
+        beginJob(trace, job.length == 0 ? JobTag(JobKind::SNIPPET, 0, length) : job);
         return ErrorCode::SUCCESS;
     }
 
+    /**
+     * @brief Queue text that is typed in place, without a copy (non-blocking)
+     * @param text Stays valid and unchanged until the job ends (e.g.
+     *             mapped flash); validated by the caller
+     * @param length Characters to type (no limit)
+     * @param trace Span to attribute queue wait and typing to
+     * @param job Journal entry (the whole document and where this run starts)
+     * @param onEnd Called once when the job ends (optional)
+     * @param context Passed through to onEnd
+     * @return Error code
+     */
+    ErrorCode queueMapped(const char* text, size_t length, const TraceContext& trace,
+                          const JobTag& job, JobEndHandler onEnd = nullptr,
+                          void* context = nullptr) {
+        ErrorCode ready = checkReady();
+        if (ready != ErrorCode::SUCCESS) {
+            return ready;
+        }
+
+        if (text == nullptr || length == 0) {
+            return ErrorCode::MESSAGE_EMPTY;
+        }
+
+        sendQueue.startMapped(text, length);
+        sendQueue.onEnd = onEnd;
+        sendQueue.onEndContext = context;
+        beginJob(trace, job);
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Whether a job could be queued now
+     * @return BLE_NOT_CONNECTED, BUSY or SUCCESS
+     */
+    ErrorCode checkReady() const {
+        if (!keyboard.isConnected()) {
+            return ErrorCode::BLE_NOT_CONNECTED;
+        }
+
+        if (sendQueue.active || activeCombo != Combo::NONE) {
+            return ErrorCode::BUSY;
+        }
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Journal ID of the job being typed
+     * @return 0 if idle
+     */
+    uint32_t getJobId() const {
+        const JobEntry* job = Jobs::journal().getCurrent();
+        return job ? job->id : 0;
+    }
+
     /**
      * @brief Get BLE device name
      * @return Device name string
@@ -2,6 +2,8 @@
 #include <Arduino.h>
 #include "config.h"
 #include "utils/time_utils.h"
+#include "utils/system_snapshot.h"
+#include "utils/timing_wheel.h"
 
 /**
  * @class LEDManager
@@ -20,11 +22,8 @@
  *   ledManager.toggle();
  *   ledManager.setManual(true);
  *
- *   // Automatic flashing
+ *   // Automatic flashing (driven by SystemTimers::wheel())
  *   ledManager.setFlashing(true);
- *
- *   // In loop:
- *   ledManager.update();
  */
 class LEDManager {
 private:
@@ -32,7 +31,32 @@ private:
     bool manualState;
     bool flashingEnabled;
     bool flashState;
-    unsigned long lastFlashToggle;
+    Timer flashTimer;
+
+    /**
+     * @brief Flash timer callback - toggle the LED
+     */
+    static void onFlashTimer(void* context) {
+        LEDManager* self = static_cast<LEDManager*>(context);
+        self->flashState = !self->flashState;
+        digitalWrite(self->pin, self->flashState ? HIGH : LOW);
+        self->publishState();
+    }
+
+    /**
+     * @brief Publish LED state to the system snapshot
+     */
+    void publishState() {
+        bool manual = manualState;
+        bool flashing = flashingEnabled;
+        bool lit = flashingEnabled ? flashState : manualState;
+
+        SystemStatus::publish([manual, flashing, lit](SystemSnapshot& s) {
+            s.led.manualState = manual;
+            s.led.flashing = flashing;
+            s.led.lit = lit;
+        });
+    }
 
 public:
     /**
@@ -41,7 +65,9 @@ public:
      */
     explicit LEDManager(uint8_t ledPin = Config::LED::PIN)
         : pin(ledPin), manualState(false), flashingEnabled(false),
-          flashState(false), lastFlashToggle(0) {}
+          flashState(false) {
+        flashTimer.setCallback(&LEDManager::onFlashTimer, this);
+    }
 
     /**
      * @brief Initialize LED
@@ -54,25 +80,7 @@ public:
         manualState = false;
         flashingEnabled = false;
         flashState = false;
-    }
-
-    /**
-     * @brief Update LED state (non-blocking)
-     *
-     * Call this in loop() to handle flashing
-     */
-    void update() {
-        if (flashingEnabled) {
-            // Handle automatic flashing
-            if (TimeUtils::hasElapsed(lastFlashToggle, Config::LED::FLASH_INTERVAL_MS)) {
-                flashState = !flashState;
-                digitalWrite(pin, flashState ? HIGH : LOW);
-                lastFlashToggle = millis();
-            }
-        } else {
-            // Use manual state
-            digitalWrite(pin, manualState ? HIGH : LOW);
-        }
+        publishState();
     }
 
     /**
@@ -86,6 +94,7 @@ public:
         if (!flashingEnabled) {
             digitalWrite(pin, manualState ? HIGH : LOW);
         }
+        publishState();
         return manualState;
     }
 
@@ -100,6 +109,7 @@ public:
         if (!flashingEnabled) {
             digitalWrite(pin, manualState ? HIGH : LOW);
         }
+        publishState();
     }
 
     /**
@@ -110,16 +120,22 @@ public:
      * When disabled, manual state takes effect.
      */
     void setFlashing(bool enabled) {
+        // Called every loop while WiFi is down; don't restart the cycle
+        if (enabled == flashingEnabled) return;
+
         flashingEnabled = enabled;
 
         if (enabled) {
-            // Start flashing - reset timing
-            lastFlashToggle = millis();
+            // Start flashing - toggles come from the timing wheel
             flashState = false;
+            SystemTimers::wheel().armPeriodic(flashTimer, Config::LED::FLASH_INTERVAL_MS);
         } else {
             // Restore manual state
+            SystemTimers::wheel().cancel(flashTimer);
             digitalWrite(pin, manualState ? HIGH : LOW);
         }
+
+        publishState();
     }
 
     /**
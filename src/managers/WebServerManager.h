@@ -6,8 +6,28 @@
 #include "utils/rate_limiter.h"
 #include "utils/validation.h"
 #include "utils/logger.h"
+#include "utils/system_snapshot.h"
+#include "utils/timing_wheel.h"
+#include "utils/metrics.h"
+#include "utils/loop_profiler.h"
+#include "utils/tracer.h"
+#include "utils/heartbeat.h"
+#include "utils/alloc_tracker.h"
+#include "utils/memory_diagnostics.h"
+#include "utils/boot_profiler.h"
+#include "utils/microbench.h"
+#include "utils/request_capture.h"
+#include "utils/request_arena.h"
+#include "utils/heap_trap.h"
+#include "utils/snippet_store.h"
+#include "utils/flash_spool.h"
+#include "utils/job_journal.h"
 #include "config.h"
 
+#ifdef ESP_PLATFORM
+#include <esp_task_wdt.h>
+#endif
+
 /**
  * @class WebServerManager
  * @brief Manages HTTP web server and endpoints
@@ -17,6 +37,18 @@
  * - Authentication checks
  * - Rate limiting
  * - Request handling
+ * - Per-route latency and rejection metrics (GET /metrics)
+ * - Per-request tracing of control routes (GET /trace)
+ * - Optional request capture for offline replay (/capture)
+ * - Stored text snippets with variables, typed straight from flash (/snippets)
+ * - One long document spooled to flash, typed in place and resumable
+ *   after a reset (/spool)
+ * - Jobs a reset (or disconnect) stopped short, listed with where they
+ *   stopped (/jobs) and resumable by ID
+ * - A request arena for argument copies and response bodies, reset
+ *   when each request ends
+ * - Handlers run under HeapTrap::Forbid; only the library calls that
+ *   build Strings (arguments, response headers) may allocate
  * - Dependency injection for BLE and LED managers
  *
  * Example usage:
@@ -33,6 +65,385 @@ private:
     LEDManager* ledManager;
     Authenticator* authenticator;
     RateLimiter rateLimiter;
+    Timer cleanupTimer;
+    Heartbeat* heartbeat;  // Armed while handleClient() runs
+
+    // Routes, indexed for per-route metrics
+    enum Route : uint8_t {
+        ROUTE_ROOT,
+        ROUTE_STATUS,
+        ROUTE_METRICS,
+        ROUTE_PROFILE,
+        ROUTE_TRACE,
+        ROUTE_DIAG_MEMORY,
+        ROUTE_DIAG_BOOT,
+        ROUTE_BENCH,
+        ROUTE_CAPTURE,
+        ROUTE_CTRLALTDEL,
+        ROUTE_SLEEP,
+        ROUTE_LED_TOGGLE,
+        ROUTE_TYPE,
+        ROUTE_SNIPPETS,
+        ROUTE_SPOOL,
+        ROUTE_JOBS,
+        ROUTE_COUNT
+    };
+
+    typedef void (WebServerManager::*Handler)();
+
+    // Metrics
+    LogLinearHistogram routeLatency[ROUTE_COUNT];  // Microseconds
+    Counter rejections[ERROR_CODE_COUNT];
+    Gauge trackedClients;
+    Gauge uptimeSeconds;
+    LogLinearHistogram requestAllocs;      // Allocations per request
+    LogLinearHistogram requestAllocBytes;  // Bytes allocated per request
+    LogLinearHistogram requestArenaBytes;  // Arena bytes used per request
+    AllocStats allocs;                     // Everything under handleClient()
+
+    TraceContext trace;  // Span of the request being handled
+
+    RequestCapture capture;
+    ErrorCode requestResult;  // Outcome of the request being handled
+
+    // Scratch for the request being handled; the cached "msg" lives in it
+    RequestArena arena;
+    const char* message;      // Up to MAX_MESSAGE_LENGTH bytes of "msg"
+    size_t messageLength;     // Full length of "msg"
+    bool messageLoaded;
+
+    SnippetStore snippets;
+    SnippetReader snippetReader;  // Feeds the BLE job of the snippet being typed
+
+    FlashSpool spool;
+    Timer spoolTimer;          // Saves typing progress while the spool is typed
+    size_t spoolJobStart;      // Document offset the running job started at
+    bool spoolTyping;
+    ErrorCode spoolUpload;     // Outcome of the body streamed to POST /spool
+    bool spoolUploadSeen;
+
+    static void onCleanupTimer(void* context) {
+        static_cast<WebServerManager*>(context)->rateLimiter.cleanup();
+    }
+
+    static void onSpoolTimer(void* context) {
+        WebServerManager* self = static_cast<WebServerManager*>(context);
+        self->spool.checkpoint(self->spoolJobStart + self->bleManager->getPacer().getEmittedChars());
+    }
+
+    /**
+     * @brief Save where the spool job stopped (BLE job-end callback)
+     */
+    static void onSpoolJobEnd(size_t typed, bool completed, void* context) {
+        WebServerManager* self = static_cast<WebServerManager*>(context);
+        SystemTimers::wheel().cancel(self->spoolTimer);
+        self->spoolTyping = false;
+        self->spool.checkpoint(self->spoolJobStart + typed);
+        LOG_INFO_F("Spooled text %s at %u of %u chars", completed ? "typed" : "stopped",
+                   (unsigned)self->spool.getTyped(), (unsigned)self->spool.getLength());
+    }
+
+    /**
+     * @brief Release the snippet the job was typing (BLE job-end callback)
+     */
+    static void onSnippetJobEnd(size_t typed, bool completed, void* context) {
+        static_cast<WebServerManager*>(context)->snippets.close();
+    }
+
+    static const char* routePath(Route route) {
+        static const char* const paths[ROUTE_COUNT] = {
+            "/", "/status", "/metrics", "/profile", "/trace", "/diag/memory", "/diag/boot", "/bench",
+            "/capture", "/ctrlaltdel", "/sleep", "/led/toggle", "/type", "/snippets",
+            "/spool", "/jobs"
+        };
+        return paths[route];
+    }
+
+    /**
+     * @brief Count and send an error response
+     */
+    void reject(ErrorCode code) {
+        requestResult = code;
+        rejections[errorCodeIndex(code)].inc();
+        if (code == ErrorCode::UNAUTHORIZED) {
+            authenticator->sendUnauthorized(server);
+        } else {
+            Authenticator::sendError(server, code);
+        }
+    }
+
+    /**
+     * @brief Authenticate and rate-limit the current request
+     * @return SUCCESS, UNAUTHORIZED or RATE_LIMIT_EXCEEDED (nothing sent)
+     */
+    ErrorCode checkAdmission() {
+        Tracer& tracer = Tracing::tracer();
+
+        uint64_t start = TimeUtils::nowUs();
+        bool authorized = authenticator->authenticate(server);
+        tracer.record(trace, TraceStage::AUTH, start);
+        if (!authorized) {
+            return ErrorCode::UNAUTHORIZED;
+        }
+
+        start = TimeUtils::nowUs();
+        bool allowed = rateLimiter.checkLimit(clientIp());
+        tracer.record(trace, TraceStage::RATE_LIMIT, start);
+        if (!allowed) {
+            return ErrorCode::RATE_LIMIT_EXCEEDED;
+        }
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Authenticate and rate-limit the current request
+     * @return false if rejected (response already sent)
+     */
+    bool admit() {
+        ErrorCode result = checkAdmission();
+        if (result != ErrorCode::SUCCESS) {
+            reject(result);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Register a route whose handler time is recorded per route
+     *
+     * Control (POST) routes also get a trace span; diagnostic GETs are
+     * not traced so scraping doesn't flush the trace ring.
+     */
+    void on(Route route, HTTPMethod method, Handler handler) {
+        server.on(routePath(route), method, routeHandler(route, method, handler));
+    }
+
+    /**
+     * @brief Register a route whose body is streamed to upload as it arrives
+     *
+     * upload runs (under Forbid) for each piece of the body, before
+     * handler; its time is not part of the route's latency.
+     */
+    void on(Route route, HTTPMethod method, Handler handler, Handler upload) {
+        server.on(routePath(route), method, routeHandler(route, method, handler),
+                  [this, route, upload]() {
+            HeapTrap::Forbid strict;
+            if (heartbeat) heartbeat->beat(routePath(route));
+            (this->*upload)();
+        });
+    }
+
+    /**
+     * @brief handler wrapped with timing, tracing, capture and the arena reset
+     */
+    WebServer::THandlerFunction routeHandler(Route route, HTTPMethod method, Handler handler) {
+        return [this, route, method, handler]() {
+            HeapTrap::Forbid strict;  // Only library calls inside may allocate
+            if (heartbeat) heartbeat->beat(routePath(route));
+            AllocScope alloc;
+            Profiling::boot().reach(BootMilestone::FIRST_REQUEST);
+            uint64_t start = TimeUtils::nowUs();
+            trace = (method == HTTP_POST) ? Tracing::tracer().startSpan() : TraceContext();
+            requestResult = ErrorCode::SUCCESS;
+
+            // Exports and mode changes aren't replayable traffic
+            CapturedRequest record;
+            bool capturing = capture.isEnabled() && route != ROUTE_CAPTURE;
+            if (capturing) beginCapture(record, route, start);
+
+            (this->*handler)();
+
+            uint64_t end = TimeUtils::nowUs();
+            Tracing::tracer().record(trace, TraceStage::REQUEST, trace.startUs, end);
+            routeLatency[route].record(TimeUtils::saturateUs(end - start));
+            requestAllocs.record(alloc.calls());
+            requestAllocBytes.record(alloc.bytes());
+            trace = TraceContext();
+
+            if (capturing) {
+                record.durationUs = TimeUtils::saturateUs(end - start);
+                record.result = requestResult;
+                capture.add(record);
+            }
+
+            requestArenaBytes.record(arena.getUsed());
+            arena.reset();
+            messageLoaded = false;
+        };
+    }
+
+    /**
+     * @brief Copy of an argument in the request arena
+     * @param name Argument name
+     * @param maxLength Bytes to copy at most
+     * @param length Set to the argument's full length
+     * @return nullptr if the argument is absent or the arena is full
+     */
+    const char* argInArena(const char* name, size_t maxLength, size_t& length) {
+        length = 0;
+        HeapTrap::Allow library;
+        if (!server.hasArg(name)) return nullptr;
+
+        String value = server.arg(name);  // The library's copy, freed on return
+        length = value.length();
+        return arena.copy(value.c_str(), length < maxLength ? length : maxLength);
+    }
+
+    /**
+     * @brief The "msg" argument, copied into the arena once per request
+     * @param length Set to its full length
+     * @return nullptr if absent (or the arena is full)
+     *
+     * Longer messages keep only MAX_MESSAGE_LENGTH bytes; validation
+     * rejects them by length before reading the text.
+     */
+    const char* messageArg(size_t& length) {
+        if (!messageLoaded) {
+            message = argInArena("msg", Config::BLE::MAX_MESSAGE_LENGTH, messageLength);
+            messageLoaded = true;
+        }
+        length = messageLength;
+        return message;
+    }
+
+    /**
+     * @brief The "resume" argument: ID of a stopped job to continue
+     * @param id Set to the ID, or 0 if the argument is absent
+     * @return false if present but not a job ID
+     */
+    bool resumeArg(uint32_t& id) {
+        id = 0;
+        size_t length;
+        const char* value = argInArena("resume", 11, length);
+        if (value == nullptr) return true;
+
+        char* end = nullptr;
+        unsigned long parsed = strtoul(value, &end, 10);
+        if (length == 0 || length > 10 || *end != '\0' || parsed == 0 || parsed > 0xFFFFFFFFul) {
+            return false;
+        }
+        id = (uint32_t)parsed;
+        return true;
+    }
+
+    static const char* methodName(HTTPMethod method) {
+        switch (method) {
+            case HTTP_GET: return "GET";
+            case HTTP_POST: return "POST";
+            case HTTP_PUT: return "PUT";
+            case HTTP_DELETE: return "DELETE";
+            default: return "OTHER";
+        }
+    }
+
+    /**
+     * @brief Fill the parts of a capture record known at arrival
+     */
+    void beginCapture(CapturedRequest& record, Route route, uint64_t startUs) {
+        IPAddress ip = clientIp();
+        SystemSnapshot snap = SystemStatus::read();
+
+        record.atUs = startUs;
+        record.durationUs = 0;
+        record.clientIp = ((uint32_t)ip[0] << 24) | ((uint32_t)ip[1] << 16) |
+                          ((uint32_t)ip[2] << 8) | (uint32_t)ip[3];
+        record.path = routePath(route);
+        record.method = methodName(server.method());
+        record.result = ErrorCode::SUCCESS;
+        record.bleConnected = snap.ble.connected;
+        record.bleBusy = snap.ble.busy;
+        size_t length;
+        const char* msg = messageArg(length);
+        if (msg != nullptr) {
+            RequestCapture::setBody(record, msg, length);  // Reads only a short prefix
+        } else {
+            RequestCapture::setBody(record, "", 0);
+        }
+    }
+
+    /**
+     * @brief Register this server's metrics with the global registry
+     */
+    void registerMetrics() {
+        MetricsRegistry& registry = Metrics::registry();
+
+        for (uint8_t r = 0; r < ROUTE_COUNT; r++) {
+            registry.addHistogram("http_request_duration_seconds",
+                                  "Time spent in the route handler, including the response write",
+                                  routeLatency[r], 1e-6, "route", routePath(static_cast<Route>(r)));
+        }
+
+        // Auth failures and rate-limit hits are the UNAUTHORIZED and
+        // RATE_LIMIT_EXCEEDED series
+        for (size_t i = 1; i < ERROR_CODE_COUNT; i++) {
+            registry.addCounter("http_rejections_total",
+                                "Requests answered with an error, by ErrorCode",
+                                rejections[i], "code", errorCodeName(errorCodeAt(i)));
+        }
+
+        registry.addGauge("ratelimit_tracked_clients", "Client IPs held by the rate limiter",
+                          trackedClients);
+        registry.addGauge("uptime_seconds", "Seconds since boot", uptimeSeconds);
+        registry.addHistogram("http_request_allocations", "Heap allocations per request",
+                              requestAllocs);
+        registry.addHistogram("http_request_alloc_bytes", "Bytes allocated per request",
+                              requestAllocBytes);
+        registry.addHistogram("http_request_arena_bytes", "Request arena bytes used per request",
+                              requestArenaBytes);
+        AllocTracker::registerStats("http", allocs);
+    }
+
+    /**
+     * @brief Sample gauges that are read rather than pushed
+     */
+    void refreshGauges() {
+        trackedClients.set((int32_t)rateLimiter.getTrackedClientCount());
+        uptimeSeconds.set((int32_t)(TimeUtils::nowUs() / 1000000ULL));
+    }
+
+    IPAddress clientIp() {
+        HeapTrap::Allow library;
+        return server.client().remoteIP();
+    }
+
+    bool hasArg(const char* name) {
+        HeapTrap::Allow library;
+        return server.hasArg(name);
+    }
+
+    /**
+     * @brief Send a complete response (the library builds its headers on the heap)
+     */
+    void respond(int code, const char* contentType, const char* body) {
+        HeapTrap::Allow library;
+        server.send(code, contentType, body);
+    }
+
+    static void writeChunk(const char* data, size_t length, void* context) {
+        HeapTrap::Allow library;
+        static_cast<WebServerManager*>(context)->server.sendContent(data, length);
+    }
+
+    /**
+     * @brief Start a chunked 200 response
+     * @return CHUNK_SIZE buffer from the arena, or nullptr (request rejected)
+     */
+    char* beginStream(const char* contentType) {
+        char* buffer = arena.allocChars(Config::Metrics::CHUNK_SIZE);
+        if (buffer == nullptr) {
+            reject(ErrorCode::INTERNAL_ERROR);
+            return nullptr;
+        }
+        HeapTrap::Allow library;
+        server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        server.send(200, contentType, "");
+        return buffer;
+    }
+
+    void endStream() {
+        HeapTrap::Allow library;
+        server.sendContent("");  // Terminating chunk
+    }
 
     /**
      * @brief Root endpoint - returns API help
@@ -45,10 +456,28 @@ private:
             "  POST /sleep           - Send Win+X, U, S (Sleep)\n"
             "  POST /led/toggle      - Toggle LED\n"
             "  POST /type?msg=TEXT   - Type text via BLE keyboard\n"
+            "  POST /type?snippet=N&VAR=VALUE - Type a stored snippet\n"
+            "  POST /snippets?name=N - Store the body as snippet N ({VAR} placeholders)\n"
+            "  DELETE /snippets?name=N - Delete a snippet\n"
+            "  GET  /snippets        - List snippets (auth)\n"
+            "  POST /spool           - Spool the body to flash for typing (auth)\n"
+            "  GET  /spool           - Spooled text length and progress (auth)\n"
+            "  DELETE /spool         - Delete the spooled text\n"
+            "  POST /type?spool=resume|restart - Type the spooled text\n"
+            "  POST /type?...&resume=ID - Continue stopped job ID (same text)\n"
+            "  GET  /jobs            - Recent jobs and where they stopped (auth)\n"
+            "  POST /bench           - Run on-device microbenchmarks\n"
+            "  POST /capture?mode=X  - Request capture: on, off or clear\n"
+            "  GET  /capture         - Captured requests as JSON (auth)\n"
             "  GET  /status          - Get system status\n"
+            "  GET  /metrics         - Prometheus metrics\n"
+            "  GET  /profile         - loop() time per manager\n"
+            "  GET  /trace           - Recent requests as Chrome trace JSON\n"
+            "  GET  /diag/memory     - Heap, task stacks, static RAM\n"
+            "  GET  /diag/boot       - setup() phase timings\n"
             "  GET  /                - Show this help\n\n"
             "Authentication:\n"
-            "  All endpoints (except / and /status) require X-API-Key header\n\n"
+            "  Control endpoints (POST) require X-API-Key header\n\n"
             "Rate Limiting:\n"
             "  Maximum 5 requests per second per IP\n\n"
             "Security:\n"
@@ -62,46 +491,329 @@ private:
             "  - Overflow-safe timing\n"
             "  - Watchdog protection\n";
 
-        server.send(200, "text/plain", help);
+        respond(200, "text/plain", help);
     }
 
     /**
-     * @brief Status endpoint - returns system status (no auth required)
+     * @brief Format the /status JSON
+     *
+     * Reads one seqlock snapshot so BLE/LED fields are mutually consistent
+     * even while the BLE task is publishing.
      */
-    void handleStatus() {
-        char json[512];
-        snprintf(json, sizeof(json),
+    void formatStatus(char* json, size_t size) {
+        SystemSnapshot snap = SystemStatus::read();
+        const ReportPacer& pacer = bleManager->getPacer();
+        const LogLinearHistogram& jitter = pacer.getJitterHistogram();
+        const LogLinearHistogram& pacingWait = pacer.getPacingWaitHistogram();
+        const LogLinearHistogram& loopBlocked = pacer.getLoopBlockedHistogram();
+        BLEKeyboardManager::Telemetry pump = bleManager->getTelemetry();
+
+        snprintf(json, size,
             "{"
             "\"ble\":{\"connected\":%s,\"busy\":%s,\"progress\":%d},"
+            "\"cadence\":{\"periodUs\":%lu,\"samples\":%lu,"
+            "\"jitterP50Us\":%lu,\"jitterP99Us\":%lu,\"jitterMaxUs\":%lu,"
+            "\"underruns\":%lu},"
+            "\"pump\":{\"reports\":%lu,\"reportsPerSec\":%ld,\"charsPerSec\":%ld,"
+            "\"printFailures\":%lu,\"disconnectsMidJob\":%lu,"
+            "\"jobsCompleted\":%lu,\"jobsFailed\":%lu,"
+            "\"pacingWaitP99Us\":%lu,\"loopBlockedMs\":%lu,\"loopBlockedP99Us\":%lu},"
             "\"led\":{\"state\":%s,\"flashing\":%s},"
+            "\"wifi\":{\"connected\":%s},"
             "\"uptime\":%lu,"
             "\"rateLimit\":{\"tracked\":%d}"
             "}",
-            bleManager->isConnected() ? "true" : "false",
-            bleManager->isBusy() ? "true" : "false",
-            bleManager->getSendProgress(),
-            ledManager->getManualState() ? "true" : "false",
-            ledManager->isFlashing() ? "true" : "false",
-            millis() / 1000,
+            snap.ble.connected ? "true" : "false",
+            snap.ble.busy ? "true" : "false",
+            snap.ble.progress,
+            (unsigned long)pacer.getPeriodUs(),
+            (unsigned long)jitter.count(),
+            (unsigned long)jitter.percentile(50.0f),
+            (unsigned long)jitter.percentile(99.0f),
+            (unsigned long)jitter.max(),
+            (unsigned long)pacer.getUnderruns(),
+            (unsigned long)pump.reports,
+            (long)pump.reportsPerSecond,
+            (long)pump.charsPerSecond,
+            (unsigned long)pump.printFailures,
+            (unsigned long)pump.disconnectsMidJob,
+            (unsigned long)pump.jobsCompleted,
+            (unsigned long)pump.jobsFailed,
+            (unsigned long)pacingWait.percentile(99.0f),
+            (unsigned long)(loopBlocked.getSum() / 1000ULL),
+            (unsigned long)loopBlocked.percentile(99.0f),
+            snap.led.manualState ? "true" : "false",
+            snap.led.flashing ? "true" : "false",
+            snap.wifi.connected ? "true" : "false",
+            (unsigned long)(TimeUtils::nowUs() / 1000000ULL),
             rateLimiter.getTrackedClientCount()
         );
+    }
 
-        server.send(200, "application/json", json);
+    /**
+     * @brief Status endpoint - returns system status (no auth required)
+     */
+    void handleStatus() {
+        char* json = arena.allocChars(Config::HTTP::JSON_BYTES);
+        if (json == nullptr) {
+            reject(ErrorCode::INTERNAL_ERROR);
+            return;
+        }
+        formatStatus(json, Config::HTTP::JSON_BYTES);
+        respond(200, "application/json", json);
     }
 
     /**
-     * @brief Handle Ctrl+Alt+Del request
+     * @brief Metrics endpoint - Prometheus text format (no auth required)
+     *
+     * Streamed with chunked transfer encoding, one CHUNK_SIZE buffer at
+     * a time, so the page size is not bounded by free heap.
      */
-    void handleCtrlAlt() {
-        // Authentication
-        if (!authenticator->authenticate(server)) {
-            authenticator->sendUnauthorized(server);
+    void handleMetrics() {
+        refreshGauges();
+
+        char* buffer = beginStream("text/plain; version=0.0.4");
+        if (buffer == nullptr) {
+            return;
+        }
+        ChunkedWriter out(buffer, Config::Metrics::CHUNK_SIZE, &WebServerManager::writeChunk, this);
+        Metrics::registry().render(out);
+        out.flush();
+
+        endStream();
+    }
+
+    /**
+     * @brief Profile endpoint - loop() time attribution (no auth required)
+     */
+    void handleProfile() {
+        char* json = arena.allocChars(Config::HTTP::JSON_BYTES);
+        if (json == nullptr) {
+            reject(ErrorCode::INTERNAL_ERROR);
+            return;
+        }
+        Profiling::mainLoop().toJson(json, Config::HTTP::JSON_BYTES);
+        respond(200, "application/json", json);
+    }
+
+    /**
+     * @brief Trace endpoint - recent request spans as Chrome trace JSON (no auth required)
+     *
+     * Save the response and open it in Perfetto or chrome://tracing.
+     */
+    void handleTrace() {
+        char* buffer = beginStream("application/json");
+        if (buffer == nullptr) {
+            return;
+        }
+        ChunkedWriter out(buffer, Config::Metrics::CHUNK_SIZE, &WebServerManager::writeChunk, this);
+        Tracing::tracer().writeChromeJson(out);
+        out.flush();
+
+        endStream();
+    }
+
+    /**
+     * @brief Memory endpoint - heap, task stack headroom, static RAM (no auth required)
+     */
+    void handleDiagMemory() {
+        char* buffer = beginStream("application/json");
+        if (buffer == nullptr) {
+            return;
+        }
+        ChunkedWriter out(buffer, Config::Metrics::CHUNK_SIZE, &WebServerManager::writeChunk, this);
+        Diagnostics::memory().writeJson(out);
+        out.flush();
+
+        endStream();
+    }
+
+    /**
+     * @brief Boot endpoint - setup() phases and milestones (no auth required)
+     */
+    void handleDiagBoot() {
+        char* json = arena.allocChars(Config::HTTP::JSON_BYTES);
+        if (json == nullptr) {
+            reject(ErrorCode::INTERNAL_ERROR);
+            return;
+        }
+        Profiling::boot().toJson(json, Config::HTTP::JSON_BYTES);
+        respond(200, "application/json", json);
+    }
+
+    /**
+     * @brief Inputs for the /bench cases (heap-allocated per run)
+     */
+    struct BenchFixture {
+        WebServerManager* self;
+        String message;
+        RateLimiter limiter;
+        uint32_t limiterClients;
+        ReportPacer pacer;
+        char text[Config::BLE::MAX_MESSAGE_LENGTH];
+        char json[1024];
+        char line[Logger::LINE_SIZE];
+
+        BenchFixture(WebServerManager* server)
+            : self(server),
+              message("The quick brown fox jumps over the lazy dog. "
+                      "Pack my box with five dozen liquor jugs, 0123456789."),
+              limiter(60000, 255), limiterClients(0) {
+            memset(text, 'a', sizeof(text));
+        }
+    };
+
+    static IPAddress benchClient(uint32_t index) {
+        return IPAddress(10, 0, (uint8_t)(index >> 8), (uint8_t)index);
+    }
+
+    static void benchValidate(void* context, uint32_t iteration) {
+        (void)iteration;
+        BenchFixture* f = static_cast<BenchFixture*>(context);
+        Validation::validateMessage(f->message);
+    }
+
+    static void benchRateLimit(void* context, uint32_t iteration) {
+        BenchFixture* f = static_cast<BenchFixture*>(context);
+        f->limiter.checkLimit(benchClient(iteration % f->limiterClients));
+    }
+
+    static void benchStatusJson(void* context, uint32_t iteration) {
+        (void)iteration;
+        BenchFixture* f = static_cast<BenchFixture*>(context);
+        f->self->formatStatus(f->json, sizeof(f->json));
+    }
+
+    static void benchLogFormat(void* context, uint32_t iteration) {
+        BenchFixture* f = static_cast<BenchFixture*>(context);
+        Logger::formatLine(f->line, sizeof(f->line), "[INFO] ", "Typing: %s (%lu chars, job %lu)",
+                           "The quick brown fox", 19UL, (unsigned long)iteration);
+    }
+
+    static void benchReportPlan(void* context, uint32_t iteration) {
+        (void)iteration;
+        BenchFixture* f = static_cast<BenchFixture*>(context);
+        f->pacer.startJob();
+        f->pacer.plan(f->text, sizeof(f->text), 0);  // Fills the report queue
+        f->pacer.abort();
+        f->pacer.tick(0);  // Drops the job and drains the queue
+    }
+
+    /**
+     * @brief Between batches: feed the watchdog and let BLE tasks run
+     */
+    static void benchYield(void* context) {
+        WebServerManager* self = static_cast<WebServerManager*>(context);
+#ifdef ESP_PLATFORM
+        esp_task_wdt_reset();
+#endif
+        if (self->heartbeat) self->heartbeat->beat("/bench");
+        delay(1);
+    }
+
+    /**
+     * @brief Bench endpoint - cycle-counted hot-path microbenchmarks (auth required)
+     *
+     * Runs synchronously on the loop task (~100 ms), yielding between
+     * batches. Results are per iteration, in CPU cycles.
+     */
+    void handleBench() {
+        if (!admit()) {
+            return;
+        }
+        HeapTrap::Allow diagnostic;  // Fixture and tables are heap-built
+
+        BenchFixture* f = new (std::nothrow) BenchFixture(this);
+        if (f == nullptr) {
+            reject(ErrorCode::INTERNAL_ERROR);
+            return;
+        }
+
+        MicroBench bench(&WebServerManager::benchYield, this);
+        bench.run("validate_message_100", &WebServerManager::benchValidate, f, 100);
+
+        static const uint32_t tableSizes[] = { 1, 16, 64 };
+        static const char* const tableNames[] = {
+            "ratelimit_check_1", "ratelimit_check_16", "ratelimit_check_64"
+        };
+        for (size_t i = 0; i < sizeof(tableSizes) / sizeof(tableSizes[0]); i++) {
+            f->limiter.reset();
+            f->limiterClients = tableSizes[i];
+            for (uint32_t c = 0; c < f->limiterClients; c++) {
+                f->limiter.checkLimit(benchClient(c));
+            }
+            bench.run(tableNames[i], &WebServerManager::benchRateLimit, f, 200);
+        }
+
+        bench.run("status_json", &WebServerManager::benchStatusJson, f, 10);
+        bench.run("log_format", &WebServerManager::benchLogFormat, f, 50);
+        bench.run("hid_plan_queue", &WebServerManager::benchReportPlan, f, 20);
+        delete f;
+
+        char* buffer = beginStream("application/json");
+        if (buffer == nullptr) {
+            return;
+        }
+        ChunkedWriter out(buffer, Config::Metrics::CHUNK_SIZE, &WebServerManager::writeChunk, this);
+        bench.writeJson(out);
+        out.flush();
+
+        endStream();
+    }
+
+    /**
+     * @brief Capture endpoint - export or control request capture (auth required)
+     *
+     * GET streams the held records as JSON (they contain typed text).
+     * POST ?mode=on|off|clear starts, stops or empties the capture.
+     */
+    void handleCapture() {
+        if (!admit()) {
             return;
         }
 
-        // Rate limiting
-        if (!rateLimiter.checkLimit(server.client().remoteIP())) {
-            Authenticator::sendError(server, ErrorCode::RATE_LIMIT_EXCEEDED);
+        if (server.method() == HTTP_POST) {
+            size_t length;
+            const char* mode = argInArena("mode", 8, length);
+            if (mode == nullptr) {
+                reject(ErrorCode::INVALID_PARAMETER);
+                return;
+            }
+            if (strcmp(mode, "on") == 0) {
+                capture.setEnabled(true);
+            } else if (strcmp(mode, "off") == 0) {
+                capture.setEnabled(false);
+            } else if (strcmp(mode, "clear") == 0) {
+                capture.clear();
+            } else {
+                reject(ErrorCode::INVALID_PARAMETER);
+                return;
+            }
+            LOG_INFO_F("Request capture: %s", mode);
+
+            const char* msg = arena.format("Capture %s, %u records held",
+                                           capture.isEnabled() ? "on" : "off",
+                                           (unsigned)capture.size());
+            Authenticator::sendSuccess(server, msg ? msg : "Capture updated");
+            return;
+        }
+
+        char* buffer = beginStream("application/json");
+        if (buffer == nullptr) {
+            return;
+        }
+        ChunkedWriter out(buffer, Config::Metrics::CHUNK_SIZE, &WebServerManager::writeChunk, this);
+        capture.writeJson(out);
+        out.flush();
+
+        endStream();
+    }
+
+    /**
+     * @brief Handle Ctrl+Alt+Del request
+     */
+    void handleCtrlAlt() {
+        if (!admit()) {
             return;
         }
 
@@ -113,7 +825,7 @@ private:
         if (result == ErrorCode::SUCCESS) {
             Authenticator::sendSuccess(server, "Sent Ctrl+Alt+Del");
         } else {
-            Authenticator::sendError(server, result);
+            reject(result);
         }
     }
 
@@ -121,15 +833,7 @@ private:
      * @brief Handle sleep command request
      */
     void handleSleep() {
-        // Authentication
-        if (!authenticator->authenticate(server)) {
-            authenticator->sendUnauthorized(server);
-            return;
-        }
-
-        // Rate limiting
-        if (!rateLimiter.checkLimit(server.client().remoteIP())) {
-            Authenticator::sendError(server, ErrorCode::RATE_LIMIT_EXCEEDED);
+        if (!admit()) {
             return;
         }
 
@@ -141,7 +845,7 @@ private:
         if (result == ErrorCode::SUCCESS) {
             Authenticator::sendSuccess(server, "Sent Sleep Combo");
         } else {
-            Authenticator::sendError(server, result);
+            reject(result);
         }
     }
 
@@ -149,81 +853,507 @@ private:
      * @brief Handle LED toggle request
      */
     void handleLedToggle() {
-        // Authentication
-        if (!authenticator->authenticate(server)) {
-            authenticator->sendUnauthorized(server);
-            return;
-        }
-
-        // Rate limiting
-        if (!rateLimiter.checkLimit(server.client().remoteIP())) {
-            Authenticator::sendError(server, ErrorCode::RATE_LIMIT_EXCEEDED);
+        if (!admit()) {
             return;
         }
 
         // Toggle LED
         bool newState = ledManager->toggle();
 
-        char msg[64];
-        snprintf(msg, sizeof(msg), "LED is now %s", newState ? "ON" : "OFF");
+        const char* msg = arena.format("LED is now %s", newState ? "ON" : "OFF");
         LOG_INFO_F("LED toggled: %s", newState ? "ON" : "OFF");
 
-        Authenticator::sendSuccess(server, msg);
+        Authenticator::sendSuccess(server, msg ? msg : "LED toggled");
+    }
+
+    /**
+     * @brief Snippet endpoint - list, store or delete snippets (auth required)
+     *
+     * GET lists them as JSON. POST ?name=N compiles the request body
+     * (Content-Type: text/plain) and stores it as snippet N, replacing
+     * any old one. DELETE ?name=N removes it. Both are refused while
+     * a job is typing.
+     */
+    void handleSnippets() {
+        if (!admit()) {
+            return;
+        }
+
+        HTTPMethod method = server.method();
+        if (method == HTTP_GET) {
+            char* buffer = beginStream("application/json");
+            if (buffer == nullptr) {
+                return;
+            }
+            ChunkedWriter out(buffer, Config::Metrics::CHUNK_SIZE, &WebServerManager::writeChunk, this);
+            snippets.writeJson(out);
+            out.flush();
+
+            endStream();
+            return;
+        }
+
+        size_t length;
+        const char* name = argInArena("name", Config::Snippets::MAX_NAME_LENGTH + 1, length);
+        if (name == nullptr || length > Config::Snippets::MAX_NAME_LENGTH ||
+            !SnippetStore::isValidName(name)) {
+            reject(ErrorCode::INVALID_PARAMETER);
+            return;
+        }
+        if (bleManager->isBusy()) {
+            reject(ErrorCode::BUSY);  // The running job may be typing from the snippets
+            return;
+        }
+
+        if (method == HTTP_DELETE) {
+            ErrorCode result = snippets.remove(name);
+            if (result != ErrorCode::SUCCESS) {
+                reject(result);
+                return;
+            }
+            LOG_INFO_F("Snippet deleted: %s", name);
+            Authenticator::sendSuccess(server, "Snippet deleted");
+            return;
+        }
+
+        if (method != HTTP_POST) {
+            reject(ErrorCode::INVALID_PARAMETER);
+            return;
+        }
+
+        // Compiled straight from the library's copy of the body
+        ErrorCode result;
+        {
+            HeapTrap::Allow library;
+            String body = server.arg("plain");
+            HeapTrap::Forbid strict;
+            result = snippets.compile(body.c_str(), body.length());
+        }
+        if (result == ErrorCode::SUCCESS) {
+            result = snippets.save(name);
+        }
+        if (result != ErrorCode::SUCCESS) {
+            reject(result);
+            return;
+        }
+
+        const SnippetHeader& stored = snippets.getCompiled();
+        LOG_INFO_F("Snippet stored: %s (%u chars, %u variables, %u bytes)", name,
+                   (unsigned)stored.textLength, (unsigned)stored.variableCount,
+                   (unsigned)stored.storedLength);
+        const char* msg = arena.format("Stored %s: %u chars, %u variables, %u bytes in flash",
+                                       name, (unsigned)stored.textLength,
+                                       (unsigned)stored.variableCount,
+                                       (unsigned)stored.storedLength);
+        Authenticator::sendSuccess(server, msg ? msg : "Snippet stored");
+    }
+
+    /**
+     * @brief Body of POST /spool, written to flash as it arrives
+     *
+     * Runs while the library reads the body, before handleSpool(). No
+     * response can be sent yet, so the outcome is kept for handleSpool();
+     * a rejected upload leaves the old document alone.
+     */
+    void handleSpoolUpload() {
+        HTTPRaw& raw = server.raw();
+        switch (raw.status) {
+            case RAW_START:
+                spoolUploadSeen = true;
+                spoolUpload = checkAdmission();
+                if (spoolUpload == ErrorCode::SUCCESS && server.method() != HTTP_POST) {
+                    spoolUpload = ErrorCode::INVALID_PARAMETER;
+                }
+                if (spoolUpload == ErrorCode::SUCCESS && bleManager->isBusy()) {
+                    spoolUpload = ErrorCode::BUSY;  // The running job may be typing from the spool
+                }
+                if (spoolUpload == ErrorCode::SUCCESS) {
+                    spoolUpload = spool.beginUpload(server.clientContentLength());
+                }
+                break;
+
+            case RAW_WRITE:
+                if (spoolUpload == ErrorCode::SUCCESS) {
+                    spoolUpload = spool.append(raw.buf, raw.currentSize);
+                }
+                // The whole body is read inside one handleClient()
+                if (heartbeat) heartbeat->beat("spool.append");
+#ifdef ESP_PLATFORM
+                esp_task_wdt_reset();
+#endif
+                break;
+
+            case RAW_END:
+                if (spoolUpload == ErrorCode::SUCCESS) {
+                    spoolUpload = spool.commit();
+                }
+                break;
+
+            case RAW_ABORTED:
+                spoolUploadSeen = false;  // handleSpool() won't run
+                if (spool.isUploading()) {
+                    spool.cancelUpload();
+                    LOG_ERROR_F("Spool upload abandoned after %u bytes", (unsigned)raw.totalSize);
+                }
+                break;
+        }
+    }
+
+    /**
+     * @brief Spool endpoint - store, inspect or delete the spooled text (auth required)
+     *
+     * POST streams the body (Content-Type: text/plain) into flash through
+     * handleSpoolUpload(), replacing the old text. GET reports its length
+     * and typing progress; DELETE removes it.
+     */
+    void handleSpool() {
+        if (spoolUploadSeen) {
+            spoolUploadSeen = false;  // Admission was checked when the body started
+            if (spoolUpload != ErrorCode::SUCCESS) {
+                reject(spoolUpload);
+                return;
+            }
+            LOG_INFO_F("Spooled %u chars", (unsigned)spool.getLength());
+            const char* msg = arena.format("Spooled %u chars to flash", (unsigned)spool.getLength());
+            Authenticator::sendSuccess(server, msg ? msg : "Text spooled");
+            return;
+        }
+
+        if (!admit()) {
+            return;
+        }
+
+        HTTPMethod method = server.method();
+        if (method == HTTP_GET) {
+            const char* json = arena.format(
+                "{\"capacity\":%u,\"length\":%u,\"typed\":%u,\"typing\":%s,\"checkpoints\":%u}",
+                (unsigned)spool.getCapacity(), (unsigned)spool.getLength(),
+                (unsigned)spool.getTyped(), spoolTyping ? "true" : "false",
+                (unsigned)spool.getCheckpoints());
+            if (json == nullptr) {
+                reject(ErrorCode::INTERNAL_ERROR);
+                return;
+            }
+            respond(200, "application/json", json);
+            return;
+        }
+
+        if (method == HTTP_DELETE) {
+            if (spoolTyping) {
+                reject(ErrorCode::BUSY);
+                return;
+            }
+            if (spool.getLength() == 0) {
+                reject(ErrorCode::NOT_FOUND);
+                return;
+            }
+            if (!spool.discard()) {
+                reject(ErrorCode::INTERNAL_ERROR);
+                return;
+            }
+            LOG_INFO("Spooled text deleted");
+            Authenticator::sendSuccess(server, "Spooled text deleted");
+            return;
+        }
+
+        // A POST that got here had no body
+        reject(method == HTTP_POST ? ErrorCode::MESSAGE_EMPTY : ErrorCode::INVALID_PARAMETER);
+    }
+
+    /**
+     * @brief Jobs endpoint - the RTC job journal (auth required)
+     *
+     * Lists recent jobs, newest first, with the CRC-32 and length of
+     * their text and the offset each reached; "interrupted" ones were
+     * running when the device reset.
+     */
+    void handleJobs() {
+        if (!admit()) {
+            return;
+        }
+
+        char* json = arena.allocChars(Config::HTTP::JSON_BYTES);
+        if (json == nullptr || Jobs::journal().toJson(json, Config::HTTP::JSON_BYTES) == 0) {
+            reject(ErrorCode::INTERNAL_ERROR);
+            return;
+        }
+        respond(200, "application/json", json);
+    }
+
+    /**
+     * @brief Type the spooled text in place from flash
+     *
+     * spool=resume continues where the last job stopped: after a reset,
+     * from the job journal (to the report) if it still holds the job,
+     * else from the last flash checkpoint. spool=restart starts from the
+     * top.
+     */
+    void typeSpool() {
+        Tracer& tracer = Tracing::tracer();
+
+        ErrorCode result = bleManager->checkReady();
+        if (result != ErrorCode::SUCCESS) {
+            reject(result);
+            return;
+        }
+
+        uint64_t stageStart = TimeUtils::nowUs();
+        size_t length;
+        const char* mode = argInArena("spool", 8, length);
+        bool restart = mode != nullptr && strcmp(mode, "restart") == 0;
+        tracer.record(trace, TraceStage::PARSE, stageStart);
+        if (mode == nullptr || (!restart && strcmp(mode, "resume") != 0)) {
+            reject(ErrorCode::INVALID_PARAMETER);
+            return;
+        }
+        if (spool.text() == nullptr) {
+            reject(ErrorCode::NOT_FOUND);
+            return;
+        }
+        if (restart && !spool.rewind()) {
+            reject(ErrorCode::INTERNAL_ERROR);
+            return;
+        }
+        size_t from = spool.getTyped();
+        uint32_t hash = spool.getTextCrc();
+        uint32_t jobId = 0;
+        if (!restart) {
+            const JobEntry* stopped =
+                Jobs::journal().findStopped(JobKind::SPOOL, hash, spool.getLength());
+            if (stopped != nullptr) {
+                jobId = stopped->id;
+                if (stopped->position() > from) from = stopped->position();
+            }
+        }
+        if (from >= spool.getLength()) {
+            reject(ErrorCode::INVALID_PARAMETER);  // All typed; restart to type it again
+            return;
+        }
+
+        LOG_INFO_F("Typing spooled text from %u of %u chars", (unsigned)from,
+                   (unsigned)spool.getLength());
+
+        stageStart = TimeUtils::nowUs();
+        spoolJobStart = from;
+        result = bleManager->queueMapped(spool.text() + from, spool.getLength() - from, trace,
+                                         JobTag(JobKind::SPOOL, hash, spool.getLength(), from, jobId),
+                                         &WebServerManager::onSpoolJobEnd, this);
+        tracer.record(trace, TraceStage::ENQUEUE, stageStart);
+        if (result != ErrorCode::SUCCESS) {
+            reject(result);
+            return;
+        }
+        spoolTyping = true;
+        SystemTimers::wheel().armPeriodic(spoolTimer, Config::Spool::CHECKPOINT_INTERVAL_MS);
+
+        const char* response = arena.format(
+            "{\"status\":\"accepted\","
+            "\"message\":\"Spooled text queued for sending\","
+            "\"job\":%lu,\"from\":%u,\"length\":%u}",
+            (unsigned long)bleManager->getJobId(), (unsigned)from, (unsigned)spool.getLength()
+        );
+        respond(202, "application/json",
+                response ? response : "{\"status\":\"accepted\"}");
+    }
+
+    /**
+     * @brief Reject a snippet job after open(), releasing the snippet
+     */
+    void rejectSnippet(ErrorCode code) {
+        snippets.close();
+        reject(code);
+    }
+
+    /**
+     * @brief Type a stored snippet, its variables taken from same-named args
+     *
+     * With resume=ID the expansion must match that stopped job's; typing
+     * continues where it stopped.
+     */
+    void typeSnippet() {
+        Tracer& tracer = Tracing::tracer();
+
+        // snippetReader belongs to the running job until it ends
+        ErrorCode result = bleManager->checkReady();
+        if (result != ErrorCode::SUCCESS) {
+            reject(result);
+            return;
+        }
+
+        uint64_t stageStart = TimeUtils::nowUs();
+        size_t length;
+        const char* name = argInArena("snippet", Config::Snippets::MAX_NAME_LENGTH + 1, length);
+        if (name == nullptr || length > Config::Snippets::MAX_NAME_LENGTH ||
+            !SnippetStore::isValidName(name)) {
+            reject(ErrorCode::INVALID_PARAMETER);
+            return;
+        }
+        result = snippets.open(name, snippetReader);
+        tracer.record(trace, TraceStage::PARSE, stageStart);
+        if (result != ErrorCode::SUCCESS) {
+            reject(result);
+            return;
+        }
+
+        // Values are checked like messages; the template was checked at upload
+        stageStart = TimeUtils::nowUs();
+        const SnippetHeader& header = snippetReader.getHeader();
+        for (size_t i = 0; i < header.variableCount; i++) {
+            size_t mark = arena.mark();
+            const char* value = argInArena(header.variables[i], Config::Snippets::VALUE_BYTES, length);
+            if (value == nullptr) {
+                rejectSnippet(ErrorCode::INVALID_PARAMETER);
+                return;
+            }
+            if (length > 0) {
+                auto valid = Validation::validateText(value, length, Config::Snippets::VALUE_BYTES);
+                if (!valid.valid) {
+                    rejectSnippet(valid.errorCode);
+                    return;
+                }
+            }
+            if (!snippetReader.setValue(i, value, length)) {
+                rejectSnippet(ErrorCode::MESSAGE_TOO_LONG);
+                return;
+            }
+            arena.rewind(mark);
+        }
+        size_t typed = snippetReader.length();
+        uint32_t jobId;
+        bool resumeValid = resumeArg(jobId);
+        tracer.record(trace, TraceStage::VALIDATE, stageStart);
+        if (typed > Config::Snippets::MAX_TYPED_LENGTH) {
+            rejectSnippet(ErrorCode::MESSAGE_TOO_LONG);
+            return;
+        }
+        if (!resumeValid) {
+            rejectSnippet(ErrorCode::INVALID_PARAMETER);
+            return;
+        }
+
+        // The journal identifies the job by its expanded text
+        stageStart = TimeUtils::nowUs();
+        uint32_t hash = snippetReader.textCrc();
+        size_t from = 0;
+        if (jobId != 0) {
+            result = Jobs::journal().resumePoint(jobId, JobKind::SNIPPET, hash, typed, from);
+            if (result != ErrorCode::SUCCESS) {
+                rejectSnippet(result);
+                return;
+            }
+        }
+
+        LOG_INFO_F("Typing snippet %s (%u chars from %u)", name, (unsigned)typed, (unsigned)from);
+
+        snippetReader.start();
+        snippetReader.skip(from);
+        result = bleManager->queueStream(&SnippetReader::readText, &snippetReader, typed - from,
+                                         trace, JobTag(JobKind::SNIPPET, hash, typed, from, jobId),
+                                         &WebServerManager::onSnippetJobEnd, this);
+        tracer.record(trace, TraceStage::ENQUEUE, stageStart);
+
+        if (result == ErrorCode::SUCCESS) {
+            const char* response = arena.format(
+                "{\"status\":\"accepted\","
+                "\"message\":\"Snippet queued for sending\","
+                "\"snippet\":\"%s\",\"job\":%lu,\"from\":%u,\"length\":%u}",
+                name, (unsigned long)bleManager->getJobId(), (unsigned)from, (unsigned)typed
+            );
+            respond(202, "application/json",
+                    response ? response : "{\"status\":\"accepted\"}");
+        } else {
+            rejectSnippet(result);
+        }
     }
 
     /**
      * @brief Handle text typing request
+     *
+     * With resume=ID, msg must be the whole text of that stopped job
+     * (same CRC-32 and length); only the part not yet typed is sent.
      */
     void handleType() {
-        // Authentication
-        if (!authenticator->authenticate(server)) {
-            authenticator->sendUnauthorized(server);
+        if (!admit()) {
             return;
         }
 
-        // Rate limiting
-        if (!rateLimiter.checkLimit(server.client().remoteIP())) {
-            Authenticator::sendError(server, ErrorCode::RATE_LIMIT_EXCEEDED);
+        if (hasArg("snippet")) {
+            typeSnippet();
             return;
         }
-
-        // Validate parameter presence
-        if (!server.hasArg("msg")) {
-            Authenticator::sendError(server, ErrorCode::INVALID_PARAMETER);
+        if (hasArg("spool")) {
+            typeSpool();
             return;
         }
 
-        // Get message and convert to char array
-        String msgString = server.arg("msg");
-        char msg[Config::BLE::MAX_MESSAGE_LENGTH + 1];
-        msgString.toCharArray(msg, sizeof(msg));
+        Tracer& tracer = Tracing::tracer();
+
+        // Validate parameter presence; the message is copied into the arena
+        uint64_t stageStart = TimeUtils::nowUs();
+        if (!hasArg("msg")) {
+            reject(ErrorCode::INVALID_PARAMETER);
+            return;
+        }
+        size_t length;
+        const char* msg = messageArg(length);
+        tracer.record(trace, TraceStage::PARSE, stageStart);
+        if (msg == nullptr) {
+            reject(ErrorCode::INTERNAL_ERROR);
+            return;
+        }
 
         // Validate message
-        auto validationResult = Validation::validateMessage(msgString);
+        stageStart = TimeUtils::nowUs();
+        auto validationResult = Validation::validateMessage(msg, length);
+        uint32_t jobId;
+        bool resumeValid = resumeArg(jobId);
+        tracer.record(trace, TraceStage::VALIDATE, stageStart);
         if (!validationResult.valid) {
-            Authenticator::sendError(server, validationResult.errorCode);
+            reject(validationResult.errorCode);
             return;
         }
+        if (!resumeValid) {
+            reject(ErrorCode::INVALID_PARAMETER);
+            return;
+        }
+
+        uint32_t hash = Crc32::compute(msg, length);
+        size_t from = 0;
+        if (jobId != 0) {
+            ErrorCode resume = Jobs::journal().resumePoint(jobId, JobKind::TEXT, hash, length, from);
+            if (resume != ErrorCode::SUCCESS) {
+                reject(resume);
+                return;
+            }
+            LOG_INFO_F("Resuming job %lu at %u of %u chars", (unsigned long)jobId,
+                       (unsigned)from, (unsigned)length);
+        }
 
         // Log sanitized message
-        LOG_INFO_F("Typing: %s",
-                   Validation::sanitizeForLog(msgString, 50).c_str());
+        const size_t logBytes = Validation::sanitizedBytes(50);
+        char* logText = arena.allocChars(logBytes);
+        if (logText != nullptr) {
+            LOG_INFO_F("Typing: %s", Validation::sanitizeForLog(msg, length, logText, logBytes, 50));
+        }
 
-        // Queue message for non-blocking send
-        ErrorCode result = bleManager->queueText(msg);
+        // Queue message for non-blocking send; the span continues in the BLE manager
+        stageStart = TimeUtils::nowUs();
+        ErrorCode result = bleManager->queueText(msg + from, trace,
+                                                 JobTag(JobKind::TEXT, hash, length, from, jobId));
+        tracer.record(trace, TraceStage::ENQUEUE, stageStart);
 
         if (result == ErrorCode::SUCCESS) {
             // Return accepted status immediately
-            char response[128];
-            snprintf(response, sizeof(response),
+            const char* response = arena.format(
                 "{\"status\":\"accepted\","
                 "\"message\":\"Message queued for sending\","
-                "\"length\":%d}",
-                strlen(msg)
+                "\"length\":%u,\"job\":%lu,\"from\":%u}",
+                (unsigned)length, (unsigned long)bleManager->getJobId(), (unsigned)from
             );
-            server.send(202, "application/json", response);
+            respond(202, "application/json",
+                    response ? response : "{\"status\":\"accepted\"}");
         } else {
-            Authenticator::sendError(server, result);
+            reject(result);
         }
     }
 
@@ -231,12 +1361,22 @@ private:
      * @brief Register all HTTP routes
      */
     void registerRoutes() {
-        server.on("/", HTTP_GET, [this]() { handleRoot(); });
-        server.on("/status", HTTP_GET, [this]() { handleStatus(); });
-        server.on("/ctrlaltdel", HTTP_POST, [this]() { handleCtrlAlt(); });
-        server.on("/sleep", HTTP_POST, [this]() { handleSleep(); });
-        server.on("/led/toggle", HTTP_POST, [this]() { handleLedToggle(); });
-        server.on("/type", HTTP_POST, [this]() { handleType(); });
+        on(ROUTE_ROOT, HTTP_GET, &WebServerManager::handleRoot);
+        on(ROUTE_STATUS, HTTP_GET, &WebServerManager::handleStatus);
+        on(ROUTE_METRICS, HTTP_GET, &WebServerManager::handleMetrics);
+        on(ROUTE_PROFILE, HTTP_GET, &WebServerManager::handleProfile);
+        on(ROUTE_TRACE, HTTP_GET, &WebServerManager::handleTrace);
+        on(ROUTE_DIAG_MEMORY, HTTP_GET, &WebServerManager::handleDiagMemory);
+        on(ROUTE_DIAG_BOOT, HTTP_GET, &WebServerManager::handleDiagBoot);
+        on(ROUTE_CTRLALTDEL, HTTP_POST, &WebServerManager::handleCtrlAlt);
+        on(ROUTE_SLEEP, HTTP_POST, &WebServerManager::handleSleep);
+        on(ROUTE_LED_TOGGLE, HTTP_POST, &WebServerManager::handleLedToggle);
+        on(ROUTE_TYPE, HTTP_POST, &WebServerManager::handleType);
+        on(ROUTE_BENCH, HTTP_POST, &WebServerManager::handleBench);
+        on(ROUTE_CAPTURE, HTTP_ANY, &WebServerManager::handleCapture);
+        on(ROUTE_SNIPPETS, HTTP_ANY, &WebServerManager::handleSnippets);
+        on(ROUTE_SPOOL, HTTP_ANY, &WebServerManager::handleSpool, &WebServerManager::handleSpoolUpload);
+        on(ROUTE_JOBS, HTTP_GET, &WebServerManager::handleJobs);
     }
 
 public:
@@ -246,7 +1386,13 @@ public:
      */
     explicit WebServerManager(uint16_t port = Config::HTTP::SERVER_PORT)
         : server(port), bleManager(nullptr), ledManager(nullptr),
-          authenticator(nullptr) {}
+          authenticator(nullptr), heartbeat(nullptr), requestResult(ErrorCode::SUCCESS),
+          message(nullptr), messageLength(0), messageLoaded(false),
+          spoolJobStart(0), spoolTyping(false), spoolUpload(ErrorCode::SUCCESS),
+          spoolUploadSeen(false) {
+        cleanupTimer.setCallback(&WebServerManager::onCleanupTimer, this);
+        spoolTimer.setCallback(&WebServerManager::onSpoolTimer, this);
+    }
 
     /**
      * @brief Initialize web server with dependencies
@@ -259,9 +1405,27 @@ public:
         ledManager = led;
         authenticator = auth;
 
+        if (!snippets.begin()) {
+            LOG_ERROR("No \"snippets\" partition; /snippets disabled");
+        } else if (snippets.getCorrupt() > 0) {
+            LOG_ERROR_F("Dropped %u damaged snippet(s)", (unsigned)snippets.getCorrupt());
+        }
+        if (!spool.begin()) {
+            LOG_ERROR("No \"spool\" partition; /spool disabled");
+        } else if (spool.isDamaged()) {
+            LOG_ERROR("Spooled text failed its checks; dropped");
+        } else if (spool.getLength() > 0) {
+            LOG_INFO_F("Spooled text: %u of %u chars typed (/type?spool=resume)",
+                       (unsigned)spool.getTyped(), (unsigned)spool.getLength());
+        }
+
         registerRoutes();
+        registerMetrics();
+        heartbeat = Heartbeats::supervisor().add("http", Config::Watchdog::HTTP_BUDGET_MS);
         server.begin();
 
+        SystemTimers::wheel().armPeriodic(cleanupTimer, Config::RateLimit::CLEANUP_INTERVAL_MS);
+
         LOG_INFO("HTTP server started");
     }
 
@@ -271,14 +1435,10 @@ public:
      * Call this in loop()
      */
     void handleClient() {
+        HeartbeatScope watch(heartbeat, "handleClient");
+        AllocScope scope(&allocs);
+        HeapTrap::Allow library;  // Parsing; route handlers trap again
         server.handleClient();
-
-        // Periodic rate limiter cleanup
-        static unsigned long lastCleanup = 0;
-        if (TimeUtils::hasElapsed(lastCleanup, 60000)) {
-            rateLimiter.cleanup();
-            lastCleanup = millis();
-        }
     }
 
     /**
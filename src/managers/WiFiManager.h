@@ -2,6 +2,10 @@
 #include <WiFi.h>
 #include "config.h"
 #include "utils/time_utils.h"
+#include "utils/system_snapshot.h"
+#include "utils/coroutine.h"
+#include "utils/timing_wheel.h"
+#include "utils/metrics.h"
 
 /**
  * @class WiFiManager
@@ -15,10 +19,9 @@
  *
  * Example usage:
  *   WiFiManager wifiManager;
- *   wifiManager.begin("MySSID", "MyPassword");
+ *   wifiManager.begin("MySSID", "MyPassword");  // Returns immediately
  *
- *   // In loop:
- *   wifiManager.update();
+ *   // Connection progress and monitoring run from SystemTimers::wheel()
  *
  *   if (wifiManager.isConnected()) {
  *     IPAddress ip = wifiManager.getIP();
@@ -29,93 +32,144 @@ private:
     struct State {
         bool connected;
         unsigned long disconnectTime;
-        unsigned long lastStatusCheck;
         bool hasBeenConnected;  // Track if we've ever connected
 
-        State() : connected(false), disconnectTime(0),
-                  lastStatusCheck(0), hasBeenConnected(false) {}
+        State() : connected(false), disconnectTime(0), hasBeenConnected(false) {}
     } state;
 
     char ssid[64];
     char password[64];
 
-public:
+    // Initial association (stackless coroutine woken by connectTimer)
+    Coroutine connectCo;
+    Timer connectTimer;
+    uint32_t connectStart;
+    uint32_t connectTimeoutMs;
+
+    // Periodic link monitoring once the initial association is over
+    Timer statusTimer;
+
+    Counter reconnects;
+
+    static void onConnectTimer(void* context) {
+        static_cast<WiFiManager*>(context)->runConnect();
+    }
+
+    static void onStatusTimer(void* context) {
+        static_cast<WiFiManager*>(context)->checkStatus();
+    }
+
     /**
-     * @brief Construct WiFi manager
+     * @brief Poll the link and publish connect/disconnect edges
      */
-    WiFiManager() {
-        ssid[0] = '\0';
-        password[0] = '\0';
+    void checkStatus() {
+        if (WiFi.status() == WL_CONNECTED) {
+            if (!state.connected) {
+                // Just reconnected
+                if (state.hasBeenConnected) {
+                    reconnects.inc();
+                }
+                state.connected = true;
+                state.hasBeenConnected = true;
+                state.disconnectTime = 0;
+                publishState();
+            }
+        } else {
+            if (state.connected) {
+                // Just disconnected
+                state.connected = false;
+                state.disconnectTime = millis();
+                publishState();
+            }
+        }
     }
 
     /**
-     * @brief Initialize WiFi connection
-     * @param wifiSsid Network SSID
-     * @param wifiPassword Network password
-     * @param timeoutMs Connection timeout in milliseconds (default: 60000)
-     * @return true if connected successfully
+     * @brief Publish WiFi state to the system snapshot
      */
-    bool begin(const char* wifiSsid, const char* wifiPassword,
-               uint32_t timeoutMs = Config::WiFi::CONNECT_TIMEOUT_MS) {
+    void publishState() {
+        bool connected = state.connected;
+        bool hasBeenConnected = state.hasBeenConnected;
+        uint32_t disconnectTime = state.disconnectTime;
 
-        // Store credentials
-        strncpy(ssid, wifiSsid, sizeof(ssid) - 1);
-        ssid[sizeof(ssid) - 1] = '\0';
+        SystemStatus::publish([=](SystemSnapshot& s) {
+            s.wifi.connected = connected;
+            s.wifi.hasBeenConnected = hasBeenConnected;
+            s.wifi.disconnectTime = disconnectTime;
+        });
+    }
 
-        strncpy(password, wifiPassword, sizeof(password) - 1);
-        password[sizeof(password) - 1] = '\0';
+    /**
+     * @brief Initial association sequence
+     * @return true while still connecting
+     *
+     * Polls every 100 ms until connected or timed out, then hands over
+     * to background reconnection.
+     */
+    bool runConnect() {
+        CO_BEGIN(connectCo);
 
-        // Start connection
         WiFi.begin(ssid, password);
+        connectStart = millis();
 
-        // Wait for connection with timeout
-        unsigned long startTime = millis();
         while (WiFi.status() != WL_CONNECTED &&
-               !TimeUtils::hasElapsed(startTime, timeoutMs)) {
-            delay(100);
+               !TimeUtils::hasElapsed(connectStart, connectTimeoutMs)) {
+            CO_SLEEP(connectCo, connectTimer, 100);
         }
 
         if (WiFi.status() == WL_CONNECTED) {
             state.connected = true;
             state.hasBeenConnected = true;
-            return true;
         } else {
             state.disconnectTime = millis();
             WiFi.reconnect();  // Enable background reconnection
-            return false;
         }
+        publishState();
+
+        SystemTimers::wheel().armPeriodic(statusTimer, Config::WiFi::STATUS_CHECK_INTERVAL_MS);
+
+        CO_END(connectCo);
+    }
+
+public:
+    /**
+     * @brief Construct WiFi manager
+     */
+    WiFiManager() : connectStart(0), connectTimeoutMs(Config::WiFi::CONNECT_TIMEOUT_MS) {
+        ssid[0] = '\0';
+        password[0] = '\0';
+        connectTimer.setCallback(&WiFiManager::onConnectTimer, this);
+        statusTimer.setCallback(&WiFiManager::onStatusTimer, this);
     }
 
     /**
-     * @brief Update WiFi state (non-blocking)
+     * @brief Start WiFi connection (non-blocking)
+     * @param wifiSsid Network SSID
+     * @param wifiPassword Network password
+     * @param timeoutMs Time to wait for the first association before
+     *                  falling back to background reconnection (default: 60000)
      *
-     * Call this in loop() to monitor connection status.
-     * Throttled to check once per second for efficiency.
+     * Association and later link monitoring run from SystemTimers::wheel();
+     * use isConnecting() and isConnected() to follow progress.
      */
-    void update() {
-        // Throttle status checks
-        if (!TimeUtils::hasElapsed(state.lastStatusCheck,
-                                   Config::WiFi::STATUS_CHECK_INTERVAL_MS)) {
-            return;
-        }
+    void begin(const char* wifiSsid, const char* wifiPassword,
+               uint32_t timeoutMs = Config::WiFi::CONNECT_TIMEOUT_MS) {
 
-        state.lastStatusCheck = millis();
+        // Store credentials
+        strncpy(ssid, wifiSsid, sizeof(ssid) - 1);
+        ssid[sizeof(ssid) - 1] = '\0';
 
-        // Check connection status
-        if (WiFi.status() == WL_CONNECTED) {
-            if (!state.connected) {
-                // Just reconnected
-                state.connected = true;
-                state.hasBeenConnected = true;
-                state.disconnectTime = 0;
-            }
-        } else {
-            if (state.connected) {
-                // Just disconnected
-                state.connected = false;
-                state.disconnectTime = millis();
-            }
-        }
+        strncpy(password, wifiPassword, sizeof(password) - 1);
+        password[sizeof(password) - 1] = '\0';
+
+        Metrics::registry().addCounter("wifi_reconnects_total",
+                                       "Link re-established after a drop", reconnects);
+
+        // Start connection
+        connectTimeoutMs = timeoutMs;
+        SystemTimers::wheel().cancel(statusTimer);
+        connectCo.reset();
+        runConnect();
     }
 
     /**
@@ -126,6 +180,14 @@ public:
         return state.connected;
     }
 
+    /**
+     * @brief Check if the initial association is still in progress
+     * @return true until connected or the connect timeout expires
+     */
+    bool isConnecting() const {
+        return connectCo.isRunning();
+    }
+
     /**
      * @brief Check if WiFi has been disconnected for a long time
      * @return true if disconnected for more than configured alert time
@@ -169,6 +231,8 @@ public:
     const char* getStatusString() const {
         if (state.connected) {
             return "Connected";
+        } else if (isConnecting()) {
+            return "Connecting...";
         } else if (state.hasBeenConnected) {
             return "Disconnected (reconnecting...)";
         } else {
@@ -202,5 +266,6 @@ public:
     void disconnect() {
         WiFi.disconnect();
         state.connected = false;
+        publishState();
     }
 };
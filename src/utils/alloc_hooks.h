@@ -0,0 +1,73 @@
+#pragma once
+#include <stdlib.h>
+#include <new>
+#include "alloc_tracker.h"
+
+/**
+ * @file alloc_hooks.h
+ * @brief Allocation hooks feeding AllocTracker
+ *
+ * Defines global symbols: include from exactly one translation unit
+ * (main.cpp on device, the test file on native).
+ *
+ * - Device: ESP-IDF calls esp_heap_trace_alloc_hook/free_hook on every
+ *   heap_caps allocation when built with CONFIG_HEAP_USE_HOOKS. Without
+ *   it nothing is defined and AllocScope samples free heap instead.
+ * - Native: global operator new/delete are replaced, which covers
+ *   String, std::map nodes and everything else C++ allocates.
+ */
+
+#ifdef ESP_PLATFORM
+
+#ifdef CONFIG_HEAP_USE_HOOKS
+extern "C" void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+    (void)caps;
+    if (ptr) Allocations::tracker().onAlloc(size);
+}
+
+extern "C" void esp_heap_trace_free_hook(void* ptr) {
+    if (ptr) Allocations::tracker().onFree();
+}
+#endif
+
+#else
+
+void* operator new(size_t size) {
+    Allocations::tracker().onAlloc(size);
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    Allocations::tracker().onAlloc(size);
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    Allocations::tracker().onFree();
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+#endif
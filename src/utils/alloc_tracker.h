@@ -0,0 +1,255 @@
+#pragma once
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+#include "metrics.h"
+#include "timing_wheel.h"
+#include "heap_trap.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+/**
+ * @file alloc_tracker.h
+ * @brief Heap allocation counts per request and per manager, plus heap health
+ *
+ * Every allocation made by the attributed task (the Arduino loop task)
+ * bumps two lock-free counters. AllocScope snapshots them on entry and
+ * reports the difference on exit, so scopes nest freely: a request scope
+ * inside the HTTP manager's scope is counted in both.
+ *
+ * Counting needs an allocation hook, installed by alloc_hooks.h:
+ * - Device with CONFIG_HEAP_USE_HOOKS: the heap_caps alloc/free hooks.
+ * - Device without hooks (stock Arduino sdkconfig): no per-call counts;
+ *   scopes fall back to sampling the free-heap delta, which gives net
+ *   bytes retained but not the number of calls.
+ * - Native: replaced global operator new/delete, exact.
+ *
+ * Free heap, the largest free block and fragmentation are sampled once
+ * per Config::Memory::HEAP_SAMPLE_INTERVAL_MS into gauges.
+ *
+ * Usage:
+ *   AllocStats bleAllocs;
+ *   {
+ *     AllocScope scope(&bleAllocs);
+ *     bleManager.update();
+ *   }
+ *   // scope.calls() / scope.bytes() before it closes for one-off checks
+ */
+
+#if !defined(ESP_PLATFORM) || defined(CONFIG_HEAP_USE_HOOKS)
+#define ALLOC_TRACKER_EXACT 1
+#else
+#define ALLOC_TRACKER_EXACT 0
+#endif
+
+/**
+ * @brief Cumulative allocations charged to one owner
+ */
+struct AllocStats {
+    Counter calls;
+    Counter bytes;
+};
+
+class AllocTracker {
+private:
+    Counter calls;
+    Counter bytes;
+    Counter frees;
+
+#ifdef ESP_PLATFORM
+    TaskHandle_t attributedTask;
+#endif
+
+    Gauge heapFree;
+    Gauge heapMinFree;
+    Gauge heapLargestBlock;
+    Gauge heapFragmentation;
+    Timer sampleTimer;
+
+    static void onSampleTimer(void* context) {
+        static_cast<AllocTracker*>(context)->sampleHeap();
+    }
+
+public:
+    AllocTracker() {
+#ifdef ESP_PLATFORM
+        attributedTask = nullptr;
+#endif
+        sampleTimer.setCallback(&AllocTracker::onSampleTimer, this);
+    }
+
+    /**
+     * @brief Attribute allocations to the calling task and start sampling
+     *
+     * Call this in setup(), which runs on the loop task.
+     */
+    void begin() {
+#ifdef ESP_PLATFORM
+        attributedTask = xTaskGetCurrentTaskHandle();
+#endif
+        MetricsRegistry& registry = Metrics::registry();
+        registry.addCounter("heap_alloc_calls_total", "Allocations made by the loop task",
+                            calls);
+        registry.addCounter("heap_alloc_bytes_total", "Bytes allocated by the loop task",
+                            bytes);
+        registry.addGauge("heap_free_bytes", "Free internal heap", heapFree);
+        registry.addGauge("heap_min_free_bytes", "Lowest free heap since boot", heapMinFree);
+        registry.addGauge("heap_largest_free_block_bytes", "Largest allocatable block",
+                          heapLargestBlock);
+        registry.addGauge("heap_fragmentation_percent",
+                          "100 - largest block as a percentage of free heap", heapFragmentation);
+
+        sampleHeap();
+        SystemTimers::wheel().armPeriodic(sampleTimer, Config::Memory::HEAP_SAMPLE_INTERVAL_MS);
+    }
+
+    /**
+     * @brief Export an owner's stats as alloc_calls_total / alloc_bytes_total
+     * @param owner Label value (string literal)
+     */
+    static void registerStats(const char* owner, const AllocStats& stats) {
+        MetricsRegistry& registry = Metrics::registry();
+        registry.addCounter("alloc_calls_total", "Allocations made by a manager, by owner",
+                            stats.calls, "owner", owner);
+        registry.addCounter("alloc_bytes_total", "Bytes allocated by a manager, by owner",
+                            stats.bytes, "owner", owner);
+    }
+
+    /**
+     * @brief Count one allocation (called from the allocation hook)
+     *
+     * May run on any task, inside the heap lock: no logging, no allocation.
+     */
+    void onAlloc(size_t size) {
+#ifdef ESP_PLATFORM
+        if (xTaskGetCurrentTaskHandle() != attributedTask) return;
+#endif
+        calls.inc();
+        bytes.inc((uint32_t)size);
+        HeapTrap::onAlloc(size);
+    }
+
+    /**
+     * @brief Count one free (called from the free hook)
+     */
+    void onFree() {
+#ifdef ESP_PLATFORM
+        if (xTaskGetCurrentTaskHandle() != attributedTask) return;
+#endif
+        frees.inc();
+    }
+
+    uint32_t getCalls() const {
+        return calls.get();
+    }
+
+    uint32_t getBytes() const {
+        return bytes.get();
+    }
+
+    uint32_t getFrees() const {
+        return frees.get();
+    }
+
+    /**
+     * @brief Whether per-call counts are available on this build
+     */
+    static bool isExact() {
+        return ALLOC_TRACKER_EXACT != 0;
+    }
+
+    /**
+     * @brief Free heap right now (0 off-device)
+     */
+    static uint32_t freeHeap() {
+#ifdef ESP_PLATFORM
+        return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Refresh heap gauges
+     */
+    void sampleHeap() {
+#ifdef ESP_PLATFORM
+        uint32_t freeBytes = freeHeap();
+        uint32_t largest = (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        heapFree.set((int32_t)freeBytes);
+        heapMinFree.set((int32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+        heapLargestBlock.set((int32_t)largest);
+        heapFragmentation.set(freeBytes ? (int32_t)(100 - (uint64_t)largest * 100 / freeBytes) : 0);
+#endif
+    }
+};
+
+namespace Allocations {
+    /**
+     * @brief Get the process-wide allocation tracker
+     */
+    inline AllocTracker& tracker() {
+        static AllocTracker instance;
+        return instance;
+    }
+}
+
+/**
+ * @brief Counts allocations made while in scope
+ */
+class AllocScope {
+private:
+    AllocStats* stats;
+    uint32_t startCalls;
+    uint32_t startBytes;
+#if !ALLOC_TRACKER_EXACT
+    uint32_t startFree;
+#endif
+
+    AllocScope(const AllocScope&);
+    AllocScope& operator=(const AllocScope&);
+
+public:
+    /**
+     * @param target Stats to charge on exit (nullptr to only measure)
+     */
+    explicit AllocScope(AllocStats* target = nullptr) : stats(target) {
+        AllocTracker& tracker = Allocations::tracker();
+        startCalls = tracker.getCalls();
+        startBytes = tracker.getBytes();
+#if !ALLOC_TRACKER_EXACT
+        startFree = AllocTracker::freeHeap();
+#endif
+    }
+
+    ~AllocScope() {
+        if (stats) {
+            stats->calls.inc(calls());
+            stats->bytes.inc(bytes());
+        }
+    }
+
+    /**
+     * @brief Allocations so far in this scope (0 without hooks)
+     */
+    uint32_t calls() const {
+        return Allocations::tracker().getCalls() - startCalls;
+    }
+
+    /**
+     * @brief Bytes allocated so far (net heap drop without hooks)
+     */
+    uint32_t bytes() const {
+#if ALLOC_TRACKER_EXACT
+        return Allocations::tracker().getBytes() - startBytes;
+#else
+        uint32_t nowFree = AllocTracker::freeHeap();
+        return startFree > nowFree ? startFree - nowFree : 0;
+#endif
+    }
+};
@@ -0,0 +1,230 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include "metrics.h"
+#include "time_utils.h"
+
+/**
+ * @file boot_profiler.h
+ * @brief Timestamps for setup() phases and post-boot milestones
+ *
+ * setup() calls phaseDone() after each bring-up step; a phase's time is
+ * measured from the end of the previous one. Everything is on the
+ * microsecond clock, which starts at reset, so time spent in the
+ * bootloader before setup() shows up as preSetupUs.
+ *
+ * Milestones are things that complete asynchronously after setup()
+ * (WiFi association, the first BLE host, the first HTTP request). Only
+ * the first occurrence is kept; later reach() calls are one load and a
+ * branch, so they can sit on hot paths.
+ *
+ * Usage:
+ *   BootProfiler& boot = Profiling::boot();
+ *   boot.begin();
+ *   ledManager.begin();
+ *   boot.phaseDone(BootPhase::LED);
+ *   ...
+ *   boot.reach(BootMilestone::FIRST_REQUEST);  // From the request path
+ */
+
+enum class BootPhase : uint8_t {
+    CONSOLE,      // Serial port and banner
+    WATCHDOG,     // Task watchdog
+    DIAGNOSTICS,  // Heartbeats, allocation tracker, loop profiler
+    LED,
+    WIFI_START,   // Association started (completes in the background)
+    BLE,          // BLE stack up and advertising
+    HTTP,         // Routes registered, server listening
+    SUMMARY,      // Startup log
+    PHASE_COUNT
+};
+
+enum class BootMilestone : uint8_t {
+    WIFI_CONNECTED,
+    BLE_CONNECTED,
+    FIRST_REQUEST,
+    MILESTONE_COUNT
+};
+
+class BootProfiler {
+public:
+    static constexpr uint8_t PHASES = static_cast<uint8_t>(BootPhase::PHASE_COUNT);
+    static constexpr uint8_t MILESTONES = static_cast<uint8_t>(BootMilestone::MILESTONE_COUNT);
+
+private:
+    uint64_t setupStartUs;
+    uint64_t lastMarkUs;
+    uint64_t phaseStartUs[PHASES];
+    uint64_t phaseEndUs[PHASES];
+    uint64_t milestoneUs[MILESTONES];  // 0 = not reached yet
+    uint64_t setupEndUs;
+
+    Gauge setupMs;
+    Gauge milestoneMs[MILESTONES];
+
+public:
+    BootProfiler() : setupStartUs(0), lastMarkUs(0), setupEndUs(0) {
+        for (uint8_t i = 0; i < PHASES; i++) {
+            phaseStartUs[i] = 0;
+            phaseEndUs[i] = 0;
+        }
+        for (uint8_t i = 0; i < MILESTONES; i++) {
+            milestoneUs[i] = 0;
+        }
+    }
+
+    static const char* phaseName(BootPhase phase) {
+        static const char* const names[] = {
+            "console", "watchdog", "diagnostics", "led", "wifi_start", "ble", "http", "summary"
+        };
+        uint8_t index = static_cast<uint8_t>(phase);
+        return index < PHASES ? names[index] : "unknown";
+    }
+
+    static const char* milestoneName(BootMilestone milestone) {
+        static const char* const names[] = {
+            "wifi_connected", "ble_connected", "first_request"
+        };
+        uint8_t index = static_cast<uint8_t>(milestone);
+        return index < MILESTONES ? names[index] : "unknown";
+    }
+
+    /**
+     * @brief Start timing (first line of setup())
+     */
+    void begin() {
+        setupStartUs = TimeUtils::nowUs();
+        lastMarkUs = setupStartUs;
+    }
+
+    /**
+     * @brief Register boot gauges (call once the registry is in use)
+     */
+    void registerMetrics() {
+        MetricsRegistry& registry = Metrics::registry();
+        registry.addGauge("boot_setup_ms", "Time spent in setup()", setupMs);
+        for (uint8_t m = 0; m < MILESTONES; m++) {
+            registry.addGauge("boot_milestone_ms", "Time from reset to each milestone (0 = not yet)",
+                              milestoneMs[m], "milestone",
+                              milestoneName(static_cast<BootMilestone>(m)));
+        }
+    }
+
+    /**
+     * @brief Close a phase: it ran from the previous mark until now
+     */
+    void phaseDone(BootPhase phase) {
+        uint8_t index = static_cast<uint8_t>(phase);
+        if (index >= PHASES) return;
+
+        uint64_t now = TimeUtils::nowUs();
+        phaseStartUs[index] = lastMarkUs;
+        phaseEndUs[index] = now;
+        lastMarkUs = now;
+    }
+
+    /**
+     * @brief Mark the end of setup()
+     */
+    void setupDone() {
+        setupEndUs = TimeUtils::nowUs();
+        setupMs.set((int32_t)((setupEndUs - setupStartUs) / 1000));
+    }
+
+    /**
+     * @brief Record a milestone the first time it happens
+     * @return true if this call recorded it
+     */
+    bool reach(BootMilestone milestone) {
+        uint8_t index = static_cast<uint8_t>(milestone);
+        if (index >= MILESTONES || milestoneUs[index] != 0) return false;
+
+        uint64_t now = TimeUtils::nowUs();
+        milestoneUs[index] = now ? now : 1;
+        milestoneMs[index].set((int32_t)(now / 1000));
+        return true;
+    }
+
+    /**
+     * @brief Time a phase took
+     * @return 0 if it hasn't run
+     */
+    uint32_t phaseUs(BootPhase phase) const {
+        uint8_t index = static_cast<uint8_t>(phase);
+        if (index >= PHASES) return 0;
+        return TimeUtils::saturateUs(phaseEndUs[index] - phaseStartUs[index]);
+    }
+
+    /**
+     * @brief Time from reset to a milestone
+     * @return 0 if not reached yet
+     */
+    uint64_t milestoneAtUs(BootMilestone milestone) const {
+        uint8_t index = static_cast<uint8_t>(milestone);
+        return index < MILESTONES ? milestoneUs[index] : 0;
+    }
+
+    uint64_t getSetupStartUs() const {
+        return setupStartUs;
+    }
+
+    /**
+     * @brief Time spent in setup() (0 while still in it)
+     */
+    uint32_t setupUs() const {
+        return setupEndUs ? TimeUtils::saturateUs(setupEndUs - setupStartUs) : 0;
+    }
+
+    /**
+     * @brief Format the breakdown as JSON
+     * @return Length written, or 0 (and an empty string) if it didn't fit
+     */
+    size_t toJson(char* buffer, size_t bufferSize) const {
+        int pos = snprintf(buffer, bufferSize,
+                           "{\"preSetupUs\":%llu,\"setupUs\":%lu,\"phases\":[",
+                           (unsigned long long)setupStartUs, (unsigned long)setupUs());
+
+        bool first = true;
+        for (uint8_t p = 0; p < PHASES && pos > 0 && (size_t)pos < bufferSize; p++) {
+            if (phaseEndUs[p] == 0) continue;
+            pos += snprintf(buffer + pos, bufferSize - pos,
+                            "%s{\"name\":\"%s\",\"startUs\":%llu,\"durationUs\":%lu}",
+                            first ? "" : ",", phaseName(static_cast<BootPhase>(p)),
+                            (unsigned long long)phaseStartUs[p],
+                            (unsigned long)phaseUs(static_cast<BootPhase>(p)));
+            first = false;
+        }
+
+        if (pos > 0 && (size_t)pos < bufferSize) {
+            pos += snprintf(buffer + pos, bufferSize - pos, "],\"milestonesUs\":{");
+        }
+        for (uint8_t m = 0; m < MILESTONES && pos > 0 && (size_t)pos < bufferSize; m++) {
+            const char* name = milestoneName(static_cast<BootMilestone>(m));
+            if (milestoneUs[m]) {
+                pos += snprintf(buffer + pos, bufferSize - pos, "%s\"%s\":%llu",
+                                m ? "," : "", name, (unsigned long long)milestoneUs[m]);
+            } else {
+                pos += snprintf(buffer + pos, bufferSize - pos, "%s\"%s\":null", m ? "," : "", name);
+            }
+        }
+        if (pos > 0 && (size_t)pos < bufferSize) {
+            pos += snprintf(buffer + pos, bufferSize - pos, "}}");
+        }
+
+        if (pos < 0 || (size_t)pos >= bufferSize) {
+            if (bufferSize > 0) buffer[0] = '\0';
+            return 0;
+        }
+        return (size_t)pos;
+    }
+};
+
+namespace Profiling {
+    /**
+     * @brief Get the boot-phase profiler
+     */
+    inline BootProfiler& boot() {
+        static BootProfiler instance;
+        return instance;
+    }
+}
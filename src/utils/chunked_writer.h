@@ -0,0 +1,90 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+/**
+ * @file chunked_writer.h
+ * @brief Buffered text output that hands full chunks to a write function
+ *
+ * Lets large responses (metrics, traces) be formatted line by line into
+ * a small stack buffer and streamed with chunked transfer encoding,
+ * instead of building the whole body in RAM.
+ *
+ * Usage:
+ *   char buffer[256];
+ *   ChunkedWriter out(buffer, sizeof(buffer), &sendChunk, &server);
+ *   out.printf("value %d\n", 42);
+ *   out.flush();
+ */
+
+class ChunkedWriter {
+public:
+    typedef void (*WriteFn)(const char* data, size_t length, void* context);
+
+private:
+    char* buffer;
+    size_t capacity;
+    size_t used;
+    WriteFn writeFn;
+    void* writeContext;
+    size_t chunks;
+    size_t dropped;
+
+public:
+    /**
+     * @brief Construct writer over a caller-owned buffer
+     * @param buf Chunk buffer (bounds the longest line)
+     * @param size Size of buf
+     * @param fn Called with each full chunk and on flush()
+     * @param context Passed through to fn
+     */
+    ChunkedWriter(char* buf, size_t size, WriteFn fn, void* context)
+        : buffer(buf), capacity(size), used(0), writeFn(fn),
+          writeContext(context), chunks(0), dropped(0) {}
+
+    /**
+     * @brief Append formatted text, flushing first if it doesn't fit
+     * @return false if the text is longer than the whole buffer (dropped)
+     */
+    bool printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            va_list args;
+            va_start(args, format);
+            int len = vsnprintf(buffer + used, capacity - used, format, args);
+            va_end(args);
+
+            if (len < 0) break;
+            if ((size_t)len < capacity - used) {
+                used += len;
+                return true;
+            }
+            if (used == 0) break;  // Too long even for an empty buffer
+            flush();
+        }
+
+        buffer[used] = '\0';
+        dropped++;
+        return false;
+    }
+
+    /**
+     * @brief Hand any buffered text to the write function
+     */
+    void flush() {
+        if (used == 0) return;
+        if (writeFn) writeFn(buffer, used, writeContext);
+        chunks++;
+        used = 0;
+        buffer[0] = '\0';
+    }
+
+    size_t getChunkCount() const {
+        return chunks;
+    }
+
+    size_t getDroppedCount() const {
+        return dropped;
+    }
+};
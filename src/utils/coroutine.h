@@ -0,0 +1,137 @@
+#pragma once
+#include <Arduino.h>
+#include "time_utils.h"
+#include "timing_wheel.h"
+
+/**
+ * @file coroutine.h
+ * @brief Stackless (protothread-style) coroutines for multi-step sequences
+ *
+ * Lets a manager write "press; wait 100 ms; release" as straight-line
+ * code without delay(). Each coroutine is a bool-returning member
+ * function; its only state is a Coroutine (12 bytes: resume point plus
+ * one delay), so there is no per-sequence stack.
+ *
+ * CO_SLEEP suspends on a timing-wheel Timer whose callback resumes the
+ * coroutine, so a sleeping sequence costs nothing per loop. CO_DELAY
+ * polls millis() on every resume and suits code resumed from update().
+ *
+ * Rules (as with any protothread):
+ * - Local variables do NOT survive a CO_YIELD/CO_DELAY/CO_WAIT_UNTIL;
+ *   keep state in members.
+ * - Don't use switch statements that span a yield point.
+ *
+ * Usage:
+ *   Coroutine co;
+ *   Timer wake;                 // callback calls runCombo()
+ *
+ *   bool runCombo() {           // returns true while still running
+ *       CO_BEGIN(co);
+ *       keyboard.press(KEY_LEFT_CTRL);
+ *       CO_SLEEP(co, wake, 100);
+ *       keyboard.releaseAll();
+ *       CO_END(co);
+ *   }
+ *
+ *   // Start: co.reset(); runCombo();
+ */
+
+struct Coroutine {
+    static constexpr uint16_t LINE_DONE = 0xFFFF;
+
+    uint16_t line;             // Resume point (0 = not started)
+    uint32_t waitStart;        // millis() when the current CO_DELAY began
+    uint32_t waitMs;           // Length of the current CO_DELAY
+
+    Coroutine() : line(LINE_DONE), waitStart(0), waitMs(0) {}
+
+    /**
+     * @brief Rewind to the start; the next resume runs from CO_BEGIN
+     */
+    void reset() {
+        line = 0;
+    }
+
+    /**
+     * @brief Stop without finishing; isRunning() becomes false
+     */
+    void cancel() {
+        line = LINE_DONE;
+    }
+
+    bool isRunning() const {
+        return line != LINE_DONE;
+    }
+};
+
+// The resume label inside CO_WAIT_UNTIL is reached by falling through
+#if defined(__GNUC__) && __GNUC__ >= 7
+#define CO_FALLTHROUGH __attribute__((fallthrough))
+#else
+#define CO_FALLTHROUGH
+#endif
+
+/**
+ * @brief Start of a coroutine body
+ */
+#define CO_BEGIN(co) switch ((co).line) { case 0:
+
+/**
+ * @brief Suspend once; resume on the next call
+ */
+#define CO_YIELD(co)                     \
+    do {                                 \
+        (co).line = __LINE__;            \
+        return true;                     \
+        case __LINE__:;                  \
+    } while (0)
+
+/**
+ * @brief Suspend until cond is true (re-evaluated on every resume)
+ */
+#define CO_WAIT_UNTIL(co, cond)          \
+    do {                                 \
+        (co).line = __LINE__;            \
+        CO_FALLTHROUGH;                  \
+        case __LINE__:                   \
+        if (!(cond)) return true;        \
+    } while (0)
+
+/**
+ * @brief Suspend for at least ms milliseconds (overflow-safe)
+ */
+#define CO_DELAY(co, ms)                 \
+    do {                                 \
+        (co).waitStart = millis();       \
+        (co).waitMs = (ms);              \
+        CO_WAIT_UNTIL(co, TimeUtils::hasElapsed((co).waitStart, (co).waitMs)); \
+    } while (0)
+
+/**
+ * @brief Suspend for ms milliseconds on a timing-wheel timer
+ *
+ * The timer's callback must resume the coroutine; nothing polls while
+ * it sleeps. Prefer this over CO_DELAY in managers.
+ */
+#define CO_SLEEP(co, timer, ms)          \
+    do {                                 \
+        SystemTimers::wheel().arm((timer), (ms)); \
+        CO_WAIT_UNTIL(co, !(timer).isArmed()); \
+    } while (0)
+
+/**
+ * @brief Finish early
+ */
+#define CO_EXIT(co)                      \
+    do {                                 \
+        (co).line = Coroutine::LINE_DONE;\
+        return false;                    \
+    } while (0)
+
+/**
+ * @brief End of a coroutine body
+ */
+#define CO_END(co)                       \
+    }                                    \
+    (co).line = Coroutine::LINE_DONE;    \
+    return false
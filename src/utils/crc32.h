@@ -0,0 +1,42 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file crc32.h
+ * @brief CRC-32 (IEEE 802.3, as zlib) for records kept in flash
+ *
+ * Nibble-table implementation: 64 bytes of table, fast enough for the
+ * few kilobytes checked at boot or on write.
+ *
+ * Usage:
+ *   uint32_t crc = Crc32::compute(data, length);
+ *   crc = Crc32::update(crc, more, moreLength);  // Continue a running CRC
+ */
+
+namespace Crc32 {
+    /**
+     * @brief Extend a CRC over more bytes
+     * @param crc Result of a previous compute()/update(), or 0 to start
+     */
+    inline uint32_t update(uint32_t crc, const void* data, size_t length) {
+        static const uint32_t table[16] = {
+            0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+            0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+            0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+            0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+        };
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        crc = ~crc;
+        for (size_t i = 0; i < length; i++) {
+            crc ^= bytes[i];
+            crc = (crc >> 4) ^ table[crc & 0x0F];
+            crc = (crc >> 4) ^ table[crc & 0x0F];
+        }
+        return ~crc;
+    }
+
+    inline uint32_t compute(const void* data, size_t length) {
+        return update(0, data, length);
+    }
+}
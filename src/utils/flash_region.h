@@ -0,0 +1,176 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <new>
+
+#ifdef ESP_PLATFORM
+#include <esp_partition.h>
+#endif
+
+/**
+ * @file flash_region.h
+ * @brief Raw access to a data partition of the SPI flash
+ *
+ * Flash is NOR: erase() sets whole 4 KB sectors to 0xFF and write()
+ * can only clear bits, so a record is written into erased space and
+ * rewritten only after its sector is erased again.
+ *
+ * On the device this is the partition with the given label in
+ * partitions.csv. Native builds emulate one in RAM with the same rules
+ * (a write ANDs into what is there), so code that forgets to erase
+ * fails in tests too; the contents don't survive a restart.
+ *
+ * map() makes a range readable in place (esp_partition_mmap through the
+ * flash cache on the device), so large records can be read without
+ * copying them into RAM. Unmap before writing to the range.
+ *
+ * Usage:
+ *   FlashRegion region;
+ *   if (region.begin("snippets", 64 * 1024)) {
+ *     region.erase(0, FlashRegion::SECTOR_SIZE);
+ *     region.write(0, data, length);
+ *   }
+ */
+
+class FlashRegion {
+public:
+    static constexpr size_t SECTOR_SIZE = 4096;
+
+private:
+#ifdef ESP_PLATFORM
+    const esp_partition_t* partition;
+    spi_flash_mmap_handle_t mapHandle;
+    bool mapped;
+#else
+    uint8_t* memory;
+#endif
+    size_t regionSize;
+
+    bool inRange(size_t offset, size_t length) const {
+        return offset <= regionSize && length <= regionSize - offset;
+    }
+
+    FlashRegion(const FlashRegion&);
+    FlashRegion& operator=(const FlashRegion&);
+
+public:
+#ifdef ESP_PLATFORM
+    FlashRegion() : partition(nullptr), mapHandle(0), mapped(false), regionSize(0) {}
+
+    ~FlashRegion() {
+        unmap();
+    }
+#else
+    FlashRegion() : memory(nullptr), regionSize(0) {}
+
+    ~FlashRegion() {
+        delete[] memory;
+    }
+#endif
+
+    /**
+     * @brief Open the partition (call in setup())
+     * @param label Partition name in partitions.csv
+     * @param nativeSize Size of the RAM stand-in on native builds
+     * @return false if the partition table has no such partition
+     */
+    bool begin(const char* label, size_t nativeSize) {
+#ifdef ESP_PLATFORM
+        (void)nativeSize;
+        partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                             ESP_PARTITION_SUBTYPE_ANY, label);
+        regionSize = partition ? partition->size : 0;
+        return partition != nullptr;
+#else
+        (void)label;
+        if (memory == nullptr) {
+            memory = new (std::nothrow) uint8_t[nativeSize];
+            if (memory == nullptr) return false;
+            memset(memory, 0xFF, nativeSize);
+            regionSize = nativeSize;
+        }
+        return true;
+#endif
+    }
+
+    bool isOpen() const {
+        return regionSize > 0;
+    }
+
+    size_t size() const {
+        return regionSize;
+    }
+
+    bool read(size_t offset, void* out, size_t length) const {
+        if (!isOpen() || !inRange(offset, length)) return false;
+#ifdef ESP_PLATFORM
+        return esp_partition_read(partition, offset, out, length) == ESP_OK;
+#else
+        memcpy(out, memory + offset, length);
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Program erased flash (bits can only go from 1 to 0)
+     */
+    bool write(size_t offset, const void* data, size_t length) {
+        if (!isOpen() || !inRange(offset, length)) return false;
+#ifdef ESP_PLATFORM
+        return esp_partition_write(partition, offset, data, length) == ESP_OK;
+#else
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; i++) {
+            memory[offset + i] &= bytes[i];
+        }
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Erase whole sectors (offset and length multiples of SECTOR_SIZE)
+     */
+    bool erase(size_t offset, size_t length) {
+        if (!isOpen() || !inRange(offset, length)) return false;
+        if (offset % SECTOR_SIZE != 0 || length % SECTOR_SIZE != 0) return false;
+#ifdef ESP_PLATFORM
+        return esp_partition_erase_range(partition, offset, length) == ESP_OK;
+#else
+        memset(memory + offset, 0xFF, length);
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Map a range for reading in place (replaces any earlier mapping)
+     * @return Address of offset, or nullptr if it can't be mapped
+     */
+    const uint8_t* map(size_t offset, size_t length) {
+        if (!isOpen() || !inRange(offset, length)) return nullptr;
+#ifdef ESP_PLATFORM
+        unmap();
+        const void* address = nullptr;
+        if (esp_partition_mmap(partition, offset, length, SPI_FLASH_MMAP_DATA,
+                               &address, &mapHandle) != ESP_OK) {
+            return nullptr;
+        }
+        mapped = true;
+        return static_cast<const uint8_t*>(address);
+#else
+        return memory + offset;
+#endif
+    }
+
+    /**
+     * @brief Release the mapping made by map()
+     */
+    void unmap() {
+#ifdef ESP_PLATFORM
+        if (mapped) {
+            spi_flash_munmap(mapHandle);
+            mapped = false;
+        }
+#endif
+    }
+};
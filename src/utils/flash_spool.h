@@ -0,0 +1,421 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "config.h"
+#include "error_codes.h"
+#include "validation.h"
+#include "flash_region.h"
+#include "crc32.h"
+
+/**
+ * @file flash_spool.h
+ * @brief One long text document held in flash and typed straight from it
+ *
+ * For text far larger than RAM (hundreds of KB). The upload is written
+ * as it arrives, append() per received chunk, and each sector is erased
+ * just before it is first written. The text goes to the area the
+ * current document doesn't use, and commit() writes the new header
+ * (length, CRC and area) to the other header sector before it erases
+ * the old one. Until then the old document stays live: an upload that
+ * is rejected, cut short or interrupted by a reset leaves it as it was.
+ * text() maps the document into the address space, so a typing job can
+ * plan reports from it in place.
+ *
+ * Layout of the partition:
+ *   sectors 0 and 1: header and progress journal (the newer one is live)
+ *   sectors 2...:    two text areas of equal size, one per document
+ *
+ * Typing progress is saved as a journal of positions appended to the
+ * live sector: a checkpoint costs a 4-byte write, not an erase. When
+ * the journal is full, a new header and journal go to the other sector
+ * before the old one is erased, so a reset at any point leaves one
+ * valid copy. After a reset begin() takes the last saved position; text
+ * typed after it is typed again when the job resumes.
+ *
+ * Usage:
+ *   spool.begin();
+ *   spool.beginUpload(length);
+ *   spool.append(data, n);       // For each chunk received
+ *   spool.commit();
+ *
+ *   const char* text = spool.text();  // Type from text + spool.getTyped()
+ *   spool.checkpoint(position);       // Now and then while typing
+ */
+class FlashSpool {
+public:
+    static constexpr size_t SECTOR_SIZE = FlashRegion::SECTOR_SIZE;
+    static constexpr size_t TEXT_OFFSET = 2 * SECTOR_SIZE;
+    static constexpr size_t JOURNAL_OFFSET = 64;  // Within a header sector
+    static constexpr size_t JOURNAL_SLOTS = (SECTOR_SIZE - JOURNAL_OFFSET) / sizeof(uint32_t);
+
+private:
+    struct Header {
+        static constexpr uint32_t MAGIC = 0x324C5053;  // "SPL2"
+
+        uint32_t magic;
+        uint32_t sequence;   // Higher wins when both sectors are valid
+        uint32_t length;
+        uint32_t textCrc;
+        uint32_t area;       // Text area holding the document (0 or 1)
+        uint32_t headerCrc;  // Of the fields above
+    };
+
+    static constexpr uint32_t EMPTY = 0xFFFFFFFF;  // Erased journal slot
+
+    FlashRegion flash;
+    Header header;
+    size_t live;          // Header sector in use (0 or 1)
+    size_t length;        // Committed document, 0 if none
+    size_t typed;         // Last saved position
+    size_t journalUsed;
+    const char* mapped;
+    bool damaged;         // A header was found but didn't check out
+
+    // Upload in progress
+    bool uploading;
+    size_t expected;
+    size_t written;
+    size_t stageArea;     // Text area the upload is written to
+    size_t erasedTo;      // Text bytes in erased sectors
+    uint32_t crc;
+
+    static uint32_t headerCrc(const Header& h) {
+        return Crc32::compute(&h, offsetof(Header, headerCrc));
+    }
+
+    size_t capacityBytes() const {
+        if (flash.size() <= TEXT_OFFSET) return 0;
+        return (flash.size() - TEXT_OFFSET) / SECTOR_SIZE / 2 * SECTOR_SIZE;
+    }
+
+    size_t areaOffset(size_t area) const {
+        return TEXT_OFFSET + area * capacityBytes();
+    }
+
+    /**
+     * @brief Read and check the header of sector index
+     */
+    bool readHeader(size_t index, Header& h) const {
+        if (!flash.read(index * SECTOR_SIZE, &h, sizeof(h))) return false;
+        if (h.magic == EMPTY) return false;
+        if (h.magic != Header::MAGIC || h.headerCrc != headerCrc(h) ||
+            h.length == 0 || h.length > capacityBytes() || h.area > 1) {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Last position in the live journal; counts the used slots
+     *
+     * Positions only grow, so a slot that goes backwards or past the
+     * end was torn by a reset and ends the journal.
+     */
+    size_t scanJournal() {
+        size_t position = 0;
+        journalUsed = 0;
+        uint32_t words[16];
+        size_t offset = live * SECTOR_SIZE + JOURNAL_OFFSET;
+        while (journalUsed < JOURNAL_SLOTS) {
+            size_t n = JOURNAL_SLOTS - journalUsed;
+            if (n > 16) n = 16;
+            if (!flash.read(offset + journalUsed * sizeof(uint32_t), words, n * sizeof(uint32_t))) break;
+            for (size_t i = 0; i < n; i++) {
+                if (words[i] == EMPTY) return position;
+                if (words[i] < position || words[i] > length) {
+                    journalUsed = JOURNAL_SLOTS;  // Don't write after a torn slot
+                    return position;
+                }
+                position = words[i];
+                journalUsed++;
+            }
+        }
+        return position;
+    }
+
+    /**
+     * @brief Write the header (and a first checkpoint) to the other sector, then erase this one
+     */
+    bool moveHeader(size_t position) {
+        size_t target = 1 - live;
+        if (!flash.erase(target * SECTOR_SIZE, SECTOR_SIZE)) return false;
+
+        Header next = header;
+        next.sequence = header.sequence + 1;
+        next.headerCrc = headerCrc(next);
+        if (!flash.write(target * SECTOR_SIZE, &next, sizeof(next))) return false;
+        uint32_t word = (uint32_t)position;
+        if (position > 0 &&
+            !flash.write(target * SECTOR_SIZE + JOURNAL_OFFSET, &word, sizeof(word))) {
+            return false;
+        }
+
+        flash.erase(live * SECTOR_SIZE, SECTOR_SIZE);
+        live = target;
+        header = next;
+        journalUsed = position > 0 ? 1 : 0;
+        typed = position;
+        return true;
+    }
+
+    void clear() {
+        flash.unmap();
+        mapped = nullptr;
+        length = 0;
+        typed = 0;
+        journalUsed = 0;
+        live = 0;
+        memset(&header, 0, sizeof(header));
+    }
+
+public:
+    FlashSpool() : live(0), length(0), typed(0), journalUsed(0), mapped(nullptr),
+                   damaged(false), uploading(false), expected(0), written(0),
+                   stageArea(0), erasedTo(0), crc(0) {
+        memset(&header, 0, sizeof(header));
+    }
+
+    /**
+     * @brief Open the partition and pick up a spooled document (call in setup())
+     * @return false if the partition table has no "spool" partition
+     *
+     * Checks the whole text against its CRC, through the mapping.
+     */
+    bool begin() {
+        if (!flash.begin(Config::Spool::PARTITION, Config::Spool::NATIVE_BYTES)) {
+            return false;
+        }
+        clear();
+
+        Header a;
+        Header b;
+        a.magic = EMPTY;
+        b.magic = EMPTY;
+        bool haveA = readHeader(0, a);
+        bool haveB = readHeader(1, b);
+        if (!haveA && !haveB) {
+            damaged = a.magic != EMPTY || b.magic != EMPTY;
+            return true;
+        }
+        live = (haveA && (!haveB || a.sequence > b.sequence)) ? 0 : 1;
+        header = live == 0 ? a : b;
+
+        const uint8_t* text = flash.map(areaOffset(header.area), header.length);
+        if (text == nullptr || Crc32::compute(text, header.length) != header.textCrc) {
+            flash.unmap();
+            damaged = true;
+            return true;
+        }
+        mapped = reinterpret_cast<const char*>(text);
+        length = header.length;
+        typed = scanJournal();
+        return true;
+    }
+
+    bool isOpen() const {
+        return flash.isOpen();
+    }
+
+    /**
+     * @brief Largest document the partition holds (one text area)
+     */
+    size_t getCapacity() const {
+        return capacityBytes();
+    }
+
+    /**
+     * @brief Start an upload to replace the document
+     * @param total Length of the upload (Content-Length)
+     * @return MESSAGE_EMPTY, MESSAGE_TOO_LONG, or INTERNAL_ERROR if flash fails
+     *
+     * The current document stays live until commit().
+     */
+    ErrorCode beginUpload(size_t total) {
+        uploading = false;
+        if (!isOpen()) return ErrorCode::INTERNAL_ERROR;
+        if (total == 0) return ErrorCode::MESSAGE_EMPTY;
+        if (total > capacityBytes()) return ErrorCode::MESSAGE_TOO_LONG;
+
+        if (length == 0) {
+            // No document to keep: clear out anything damaged
+            clear();
+            damaged = false;
+            if (!flash.erase(0, TEXT_OFFSET)) return ErrorCode::INTERNAL_ERROR;
+        }
+
+        uploading = true;
+        stageArea = length > 0 ? 1 - header.area : 0;
+        expected = total;
+        written = 0;
+        erasedTo = 0;
+        crc = 0;
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Write the next received bytes
+     * @return Validation error, MESSAGE_TOO_LONG past the announced
+     *         length, or INTERNAL_ERROR; any error ends the upload
+     */
+    ErrorCode append(const uint8_t* data, size_t n) {
+        if (!uploading) return ErrorCode::INVALID_PARAMETER;
+        if (n == 0) return ErrorCode::SUCCESS;
+        if (n > expected - written) {
+            uploading = false;
+            return ErrorCode::MESSAGE_TOO_LONG;
+        }
+
+        Validation::ValidationResult valid =
+            Validation::validateText(reinterpret_cast<const char*>(data), n, n);
+        if (!valid.valid) {
+            uploading = false;
+            return valid.errorCode;
+        }
+
+        size_t area = areaOffset(stageArea);
+        while (erasedTo < written + n) {
+            if (!flash.erase(area + erasedTo, SECTOR_SIZE)) {
+                uploading = false;
+                return ErrorCode::INTERNAL_ERROR;
+            }
+            erasedTo += SECTOR_SIZE;
+        }
+        if (!flash.write(area + written, data, n)) {
+            uploading = false;
+            return ErrorCode::INTERNAL_ERROR;
+        }
+        crc = Crc32::update(crc, data, n);
+        written += n;
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Finish the upload: write its header, retire the old one and map the text
+     * @return INVALID_PARAMETER if fewer bytes arrived than announced
+     */
+    ErrorCode commit() {
+        if (!uploading) return ErrorCode::INVALID_PARAMETER;
+        uploading = false;
+        if (written != expected) return ErrorCode::INVALID_PARAMETER;
+
+        size_t target = length > 0 ? 1 - live : 0;
+        Header h;
+        h.magic = Header::MAGIC;
+        h.sequence = length > 0 ? header.sequence + 1 : 1;
+        h.length = (uint32_t)written;
+        h.textCrc = crc;
+        h.area = (uint32_t)stageArea;
+        h.headerCrc = headerCrc(h);
+        if (!flash.erase(target * SECTOR_SIZE, SECTOR_SIZE) ||
+            !flash.write(target * SECTOR_SIZE, &h, sizeof(h))) {
+            return ErrorCode::INTERNAL_ERROR;
+        }
+
+        // The new header wins on sequence from here; drop the old one
+        if (length > 0) flash.erase(live * SECTOR_SIZE, SECTOR_SIZE);
+        clear();
+
+        const uint8_t* text = flash.map(areaOffset(stageArea), written);
+        if (text == nullptr) return ErrorCode::INTERNAL_ERROR;
+
+        header = h;
+        live = target;
+        mapped = reinterpret_cast<const char*>(text);
+        length = written;
+        typed = 0;
+        journalUsed = 0;
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Drop an upload the client abandoned (the old document stays)
+     */
+    void cancelUpload() {
+        uploading = false;
+    }
+
+    bool isUploading() const {
+        return uploading;
+    }
+
+    /**
+     * @brief Bytes written by the upload in progress
+     */
+    size_t getWritten() const {
+        return written;
+    }
+
+    /**
+     * @brief Delete the document
+     */
+    bool discard() {
+        clear();
+        return flash.erase(0, TEXT_OFFSET);
+    }
+
+    /**
+     * @brief The document, mapped from flash (nullptr if there is none)
+     */
+    const char* text() const {
+        return mapped;
+    }
+
+    size_t getLength() const {
+        return length;
+    }
+
+    /**
+     * @brief CRC-32 of the document (0 if there is none)
+     */
+    uint32_t getTextCrc() const {
+        return length > 0 ? header.textCrc : 0;
+    }
+
+    /**
+     * @brief Characters typed as of the last checkpoint
+     */
+    size_t getTyped() const {
+        return typed;
+    }
+
+    size_t getCheckpoints() const {
+        return journalUsed;
+    }
+
+    /**
+     * @brief Whether begin() found a document that failed its checks
+     */
+    bool isDamaged() const {
+        return damaged;
+    }
+
+    /**
+     * @brief Save how far typing has got
+     * @return false if there is nothing new to save (or flash failed)
+     */
+    bool checkpoint(size_t position) {
+        if (length == 0) return false;
+        if (position > length) position = length;
+        if (position <= typed) return false;
+
+        if (journalUsed == JOURNAL_SLOTS) {
+            return moveHeader(position);
+        }
+        uint32_t word = (uint32_t)position;
+        size_t offset = live * SECTOR_SIZE + JOURNAL_OFFSET + journalUsed * sizeof(word);
+        if (!flash.write(offset, &word, sizeof(word))) return false;
+        journalUsed++;
+        typed = position;
+        return true;
+    }
+
+    /**
+     * @brief Forget the progress so the next job starts from the beginning
+     */
+    bool rewind() {
+        if (length == 0) return false;
+        if (typed == 0) return true;
+        return moveHeader(0);
+    }
+};
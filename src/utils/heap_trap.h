@@ -0,0 +1,147 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+/**
+ * @file heap_trap.h
+ * @brief Zero-heap-after-boot mode: trap any allocation once setup() is done
+ *
+ * Build with -DHEAP_TRAP_AFTER_BOOT=1. setup() calls HeapTrap::arm() as
+ * its last step; from then on an allocation on the loop task calls the
+ * trap handler, which by default aborts (a backtrace on the device, a
+ * core dump on the host) so the allocating call site is found at once.
+ *
+ * Allocations the firmware can't avoid are fenced off with Allow:
+ * the WebServer library builds String arguments, headers and response
+ * headers for every request. Forbid re-arms the trap inside an Allow
+ * (the route wrapper uses it around handlers), so only the library
+ * calls themselves are exempt.
+ *
+ * Allocations are seen through the hooks in alloc_hooks.h, so the
+ * device needs a core built with CONFIG_HEAP_USE_HOOKS. Without the
+ * flag everything here compiles to nothing.
+ *
+ * Usage:
+ *   HeapTrap::arm();                  // End of setup()
+ *   {
+ *     HeapTrap::Allow library;        // Around a library call that allocates
+ *     server.send(200, "text/plain", body);
+ *   }
+ */
+
+#ifndef HEAP_TRAP_AFTER_BOOT
+#define HEAP_TRAP_AFTER_BOOT 0
+#endif
+
+#if HEAP_TRAP_AFTER_BOOT && defined(ESP_PLATFORM) && !defined(CONFIG_HEAP_USE_HOOKS)
+#error "HEAP_TRAP_AFTER_BOOT needs CONFIG_HEAP_USE_HOOKS to see allocations"
+#endif
+
+namespace HeapTrap {
+    typedef void (*Handler)(size_t size, void* context);
+
+    struct State {
+        bool armed;
+        uint32_t allowDepth;
+        uint32_t trapped;   // Allocations that reached the handler
+        Handler handler;    // nullptr = abort()
+        void* context;
+    };
+
+    inline State& state() {
+        static State instance = { false, 0, 0, nullptr, nullptr };
+        return instance;
+    }
+
+    inline bool isEnabled() {
+        return HEAP_TRAP_AFTER_BOOT != 0;
+    }
+
+    /**
+     * @brief Start trapping (boot is complete)
+     */
+    inline void arm() {
+        state().armed = isEnabled();
+    }
+
+    inline void disarm() {
+        state().armed = false;
+    }
+
+    inline bool isArmed() {
+        return state().armed;
+    }
+
+    /**
+     * @brief Replace abort() with a handler (tests, or log-and-continue)
+     */
+    inline void setHandler(Handler handler, void* context) {
+        state().handler = handler;
+        state().context = context;
+    }
+
+    inline uint32_t getTrapped() {
+        return state().trapped;
+    }
+
+    /**
+     * @brief Called by the allocation hook for the attributed task
+     *
+     * Runs inside the heap lock on the device: no logging, no allocation.
+     */
+    inline void onAlloc(size_t size) {
+#if HEAP_TRAP_AFTER_BOOT
+        State& s = state();
+        if (!s.armed || s.allowDepth > 0) return;
+        s.trapped++;
+        if (s.handler != nullptr) {
+            s.handler(size, s.context);
+            return;
+        }
+#ifndef ESP_PLATFORM
+        fprintf(stderr, "HeapTrap: %u-byte allocation after boot\n", (unsigned)size);
+#endif
+        abort();
+#else
+        (void)size;
+#endif
+    }
+
+    /**
+     * @brief Allocations in scope are expected (library calls)
+     */
+    class Allow {
+    public:
+        Allow() {
+            state().allowDepth++;
+        }
+        ~Allow() {
+            state().allowDepth--;
+        }
+
+    private:
+        Allow(const Allow&);
+        Allow& operator=(const Allow&);
+    };
+
+    /**
+     * @brief Trap allocations in scope even inside an Allow
+     */
+    class Forbid {
+    private:
+        uint32_t savedDepth;
+
+        Forbid(const Forbid&);
+        Forbid& operator=(const Forbid&);
+
+    public:
+        Forbid() : savedDepth(state().allowDepth) {
+            state().allowDepth = 0;
+        }
+        ~Forbid() {
+            state().allowDepth = savedDepth;
+        }
+    };
+}
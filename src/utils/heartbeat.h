@@ -0,0 +1,358 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+#include "config.h"
+#include "metrics.h"
+#include "logger.h"
+#include "rtc_retained.h"
+#include "time_utils.h"
+#include "timing_wheel.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#include <esp_system.h>
+#endif
+
+/**
+ * @file heartbeat.h
+ * @brief Per-manager progress deadlines with stall attribution
+ *
+ * Each manager owns a Heartbeat with its own budget. While a heartbeat
+ * is armed, the owner must beat() at least once per budget; beat() also
+ * records where it is (a string literal), so a stall names both the
+ * manager and the last point it reached. Sections of loop() arm on
+ * entry and disarm on exit (HeartbeatScope), so only the section that
+ * is actually running can be blamed.
+ *
+ * HeartbeatSupervisor::check() runs from an esp_timer (not from loop(),
+ * which may be the thing that is stuck). The first time a heartbeat
+ * overruns it is counted and a StallRecord is written to RTC memory;
+ * the record is kept up to date while the stall lasts, so if the task
+ * watchdog resets the chip the next boot reports who hung and where.
+ * Once no heartbeat is stalled the record is cleared, so a stall that
+ * recovered is not blamed for a later, unrelated reset.
+ *
+ * Usage:
+ *   Heartbeat* hb = Heartbeats::supervisor().add("http", 5000);
+ *
+ *   void handleClient() {
+ *     HeartbeatScope watch(hb, "handleClient");
+ *     server.handleClient();
+ *   }
+ */
+
+/**
+ * @brief Last stall, persisted across resets
+ */
+struct StallRecord {
+    static constexpr uint32_t MAGIC = 0x53544C4Cu;  // "STLL"
+
+    uint32_t magic;
+    char manager[16];
+    char where[40];
+    uint32_t stalledMs;      // How long it had been stuck at the last check
+    uint32_t budgetMs;
+    uint32_t uptimeSeconds;  // When the stall was detected
+};
+
+class Heartbeat {
+    friend class HeartbeatSupervisor;
+
+private:
+    const char* name;
+    uint32_t budgetMs;
+    std::atomic<uint64_t> lastBeatMs;  // TimeUtils::nowMs64()
+    std::atomic<const char*> where;
+    std::atomic<bool> armed;
+    std::atomic<bool> stalled;  // Set by the supervisor, cleared by the owner
+    Counter stalls;
+
+    void noteProgress(const char* location) {
+        lastBeatMs.store(TimeUtils::nowMs64(), std::memory_order_relaxed);
+        where.store(location, std::memory_order_relaxed);
+
+        if (stalled.load(std::memory_order_acquire)) {
+            stalled.store(false, std::memory_order_release);
+            LOG_ERROR_F("Heartbeat '%s' recovered at %s", name, location);
+        }
+    }
+
+public:
+    Heartbeat() : name(""), budgetMs(0), lastBeatMs(0), where(""), armed(false), stalled(false) {}
+
+    /**
+     * @brief Start expecting progress
+     * @param location Where the owner is (string literal)
+     */
+    void arm(const char* location) {
+        noteProgress(location);
+        armed.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Stop expecting progress (idle)
+     */
+    void disarm() {
+        armed.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief Report progress
+     * @param location Where the owner is (string literal)
+     */
+    void beat(const char* location) {
+        noteProgress(location);
+    }
+
+    const char* getName() const {
+        return name;
+    }
+
+    uint32_t getBudgetMs() const {
+        return budgetMs;
+    }
+
+    const char* getWhere() const {
+        return where.load(std::memory_order_relaxed);
+    }
+
+    bool isArmed() const {
+        return armed.load(std::memory_order_acquire);
+    }
+
+    bool isStalled() const {
+        return stalled.load(std::memory_order_acquire);
+    }
+
+    uint32_t getStallCount() const {
+        return stalls.get();
+    }
+};
+
+/**
+ * @brief Arms a heartbeat for the lifetime of a scope
+ */
+class HeartbeatScope {
+private:
+    Heartbeat* heartbeat;
+
+    HeartbeatScope(const HeartbeatScope&);
+    HeartbeatScope& operator=(const HeartbeatScope&);
+
+public:
+    HeartbeatScope(Heartbeat* hb, const char* location) : heartbeat(hb) {
+        if (heartbeat) heartbeat->arm(location);
+    }
+
+    ~HeartbeatScope() {
+        if (heartbeat) heartbeat->disarm();
+    }
+};
+
+class HeartbeatSupervisor {
+private:
+    Heartbeat slots[Config::Watchdog::MAX_HEARTBEATS];
+    size_t count;
+
+    StallRecord previous;
+    bool hasPrevious;
+    int previousResetReason;
+
+#ifdef ESP_PLATFORM
+    esp_timer_handle_t checkTimer;
+
+    static void onCheckTimer(void* arg) {
+        static_cast<HeartbeatSupervisor*>(arg)->check(TimeUtils::nowMs64());
+    }
+#else
+    Timer checkTimer;
+
+    static void onCheckTimer(void* context) {
+        static_cast<HeartbeatSupervisor*>(context)->check(TimeUtils::nowMs64());
+    }
+#endif
+
+    static StallRecord& retained() {
+        static RTC_RETAINED StallRecord record;
+        return record;
+    }
+
+    static void copyString(char* dest, size_t size, const char* src) {
+        strncpy(dest, src ? src : "", size - 1);
+        dest[size - 1] = '\0';
+    }
+
+    static const char* resetReasonName(int reason) {
+#ifdef ESP_PLATFORM
+        switch (reason) {
+            case ESP_RST_POWERON: return "power-on";
+            case ESP_RST_SW: return "software";
+            case ESP_RST_PANIC: return "panic";
+            case ESP_RST_INT_WDT: return "interrupt watchdog";
+            case ESP_RST_TASK_WDT: return "task watchdog";
+            case ESP_RST_WDT: return "watchdog";
+            case ESP_RST_BROWNOUT: return "brownout";
+            default: return "other";
+        }
+#else
+        (void)reason;
+        return "native";
+#endif
+    }
+
+public:
+    HeartbeatSupervisor() : count(0), hasPrevious(false), previousResetReason(0) {
+        memset(&previous, 0, sizeof(previous));
+#ifdef ESP_PLATFORM
+        checkTimer = nullptr;
+#else
+        checkTimer.setCallback(&HeartbeatSupervisor::onCheckTimer, this);
+#endif
+    }
+
+    /**
+     * @brief Report the previous boot's stall (if any) and start checking
+     *
+     * Call this in setup(), after Serial is up.
+     */
+    void begin() {
+        StallRecord& record = retained();
+        hasPrevious = (record.magic == StallRecord::MAGIC);
+#ifdef ESP_PLATFORM
+        previousResetReason = (int)esp_reset_reason();
+#endif
+        if (hasPrevious) {
+            previous = record;
+            LOG_ERROR_F("Previous boot: '%s' stalled %lu ms (budget %lu ms) at %s, %lu s after boot; reset: %s",
+                        previous.manager, (unsigned long)previous.stalledMs,
+                        (unsigned long)previous.budgetMs, previous.where,
+                        (unsigned long)previous.uptimeSeconds,
+                        resetReasonName(previousResetReason));
+        }
+        record.magic = 0;
+
+#ifdef ESP_PLATFORM
+        esp_timer_create_args_t timerArgs = {};
+        timerArgs.callback = &HeartbeatSupervisor::onCheckTimer;
+        timerArgs.arg = this;
+        timerArgs.dispatch_method = ESP_TIMER_TASK;
+        timerArgs.name = "hb_supervisor";
+        if (esp_timer_create(&timerArgs, &checkTimer) == ESP_OK) {
+            esp_timer_start_periodic(checkTimer, Config::Watchdog::CHECK_INTERVAL_MS * 1000ULL);
+        }
+#else
+        SystemTimers::wheel().armPeriodic(checkTimer, Config::Watchdog::CHECK_INTERVAL_MS);
+#endif
+    }
+
+    /**
+     * @brief Register a heartbeat
+     * @param name Manager name (string literal, also the metric label)
+     * @param budgetMs Longest allowed gap between beats while armed
+     * @return Heartbeat slot, or nullptr if all slots are used
+     */
+    Heartbeat* add(const char* name, uint32_t budgetMs) {
+        for (size_t i = 0; i < count; i++) {
+            if (strcmp(slots[i].name, name) == 0) return &slots[i];
+        }
+        if (count >= Config::Watchdog::MAX_HEARTBEATS) {
+            return nullptr;
+        }
+
+        Heartbeat& hb = slots[count++];
+        hb.name = name;
+        hb.budgetMs = budgetMs;
+        Metrics::registry().addCounter("heartbeat_stalls_total",
+                                       "Times a manager overran its heartbeat budget",
+                                       hb.stalls, "manager", name);
+        return &hb;
+    }
+
+    /**
+     * @brief Look for armed heartbeats past their budget
+     * @param nowMs Current TimeUtils::nowMs64()
+     * @return Number of heartbeats currently stalled
+     *
+     * Runs on the esp_timer task on device.
+     */
+    size_t check(uint64_t nowMs) {
+        size_t stalledNow = 0;
+        const Heartbeat* worst = nullptr;
+        uint64_t worstOverMs = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            Heartbeat& hb = slots[i];
+            if (!hb.armed.load(std::memory_order_acquire)) continue;
+
+            // A beat from the other core can land after nowMs was sampled
+            uint64_t lastMs = hb.lastBeatMs.load(std::memory_order_relaxed);
+            uint64_t sinceMs = nowMs > lastMs ? nowMs - lastMs : 0;
+            if (sinceMs <= hb.budgetMs) continue;
+
+            stalledNow++;
+            if (!hb.stalled.load(std::memory_order_acquire)) {
+                hb.stalled.store(true, std::memory_order_release);
+                hb.stalls.inc();
+            }
+            if (worst == nullptr || sinceMs - hb.budgetMs > worstOverMs) {
+                worst = &hb;
+                worstOverMs = sinceMs - hb.budgetMs;
+            }
+        }
+
+        if (worst) {
+            // Keep the record current so a watchdog reset leaves the final picture
+            StallRecord& record = retained();
+            copyString(record.manager, sizeof(record.manager), worst->name);
+            copyString(record.where, sizeof(record.where), worst->getWhere());
+            uint64_t stalledMs = worstOverMs + worst->budgetMs;
+            record.stalledMs = stalledMs > 0xFFFFFFFFULL ? 0xFFFFFFFFu : (uint32_t)stalledMs;
+            record.budgetMs = worst->budgetMs;
+            record.uptimeSeconds = (uint32_t)(TimeUtils::nowUs() / 1000000ULL);
+            record.magic = StallRecord::MAGIC;
+        } else if (retained().magic == StallRecord::MAGIC) {
+            retained().magic = 0;  // Recovered
+        }
+        return stalledNow;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    Heartbeat* get(size_t index) {
+        return index < count ? &slots[index] : nullptr;
+    }
+
+    bool hasPreviousStall() const {
+        return hasPrevious;
+    }
+
+    const StallRecord& getPreviousStall() const {
+        return previous;
+    }
+
+    const char* getPreviousResetReason() const {
+        return resetReasonName(previousResetReason);
+    }
+
+    /**
+     * @brief Current stall record, as the next boot would see it
+     * @return nullptr if nothing is stalled as of the last check()
+     */
+    const StallRecord* getCurrentStall() const {
+        const StallRecord& record = retained();
+        return record.magic == StallRecord::MAGIC ? &record : nullptr;
+    }
+};
+
+namespace Heartbeats {
+    /**
+     * @brief Get the process-wide heartbeat supervisor
+     */
+    inline HeartbeatSupervisor& supervisor() {
+        static HeartbeatSupervisor instance;
+        return instance;
+    }
+}
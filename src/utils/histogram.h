@@ -0,0 +1,176 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+/**
+ * @file histogram.h
+ * @brief Fixed-size log-linear (HDR-style) histogram
+ *
+ * Values are bucketed by power of two, and each power of two is split
+ * into 2^SUB_BUCKET_BITS linear sub-buckets. Relative error is bounded
+ * by 1/2^SUB_BUCKET_BITS (25%) over the whole uint32_t range, with no
+ * allocation and a single increment per record().
+ *
+ * Usage:
+ *   LogLinearHistogram latency;
+ *   latency.record(elapsedUs);
+ *   uint32_t p99 = latency.percentile(99.0f);
+ */
+
+class LogLinearHistogram {
+public:
+    static constexpr uint8_t SUB_BUCKET_BITS = 2;
+    static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT =
+        SUB_BUCKETS + (32 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+private:
+    uint32_t buckets[BUCKET_COUNT];
+    uint32_t total;
+    uint32_t minValue;
+    uint32_t maxValue;
+    uint64_t sum;
+
+public:
+    LogLinearHistogram() {
+        reset();
+    }
+
+    /**
+     * @brief Map a value to its bucket index
+     */
+    static size_t bucketIndex(uint32_t value) {
+        if (value < SUB_BUCKETS) {
+            return value;
+        }
+        uint8_t msb = 31 - __builtin_clz(value);
+        uint8_t shift = msb - SUB_BUCKET_BITS;
+        uint32_t sub = (value >> shift) & (SUB_BUCKETS - 1);
+        return SUB_BUCKETS + (size_t)shift * SUB_BUCKETS + sub;
+    }
+
+    /**
+     * @brief Smallest value that maps to a bucket
+     */
+    static uint32_t bucketLowerBound(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return (uint32_t)index;
+        }
+        size_t shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+        uint32_t sub = (uint32_t)((index - SUB_BUCKETS) % SUB_BUCKETS);
+        return (SUB_BUCKETS | sub) << shift;
+    }
+
+    /**
+     * @brief Largest value that maps to a bucket
+     */
+    static uint32_t bucketUpperBound(size_t index) {
+        if (index + 1 >= BUCKET_COUNT) {
+            return 0xFFFFFFFFu;
+        }
+        return bucketLowerBound(index + 1) - 1;
+    }
+
+    /**
+     * @brief Record one value
+     */
+    void record(uint32_t value) {
+        buckets[bucketIndex(value)]++;
+        total++;
+        sum += value;
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }
+
+    /**
+     * @brief Clear all recorded values
+     */
+    void reset() {
+        memset(buckets, 0, sizeof(buckets));
+        total = 0;
+        minValue = 0xFFFFFFFFu;
+        maxValue = 0;
+        sum = 0;
+    }
+
+    /**
+     * @brief Add another histogram's counts into this one
+     */
+    void merge(const LogLinearHistogram& other) {
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            buckets[i] += other.buckets[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        if (other.total > 0) {
+            if (other.minValue < minValue) minValue = other.minValue;
+            if (other.maxValue > maxValue) maxValue = other.maxValue;
+        }
+    }
+
+    /**
+     * @brief Get value at percentile
+     * @param pct Percentile 0-100
+     * @return Upper bound of the bucket holding the percentile (clamped to max)
+     */
+    uint32_t percentile(float pct) const {
+        if (total == 0) return 0;
+
+        uint32_t rank = (uint32_t)((pct / 100.0f) * total + 0.5f);
+        if (rank == 0) rank = 1;
+        if (rank > total) rank = total;
+
+        uint32_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                uint32_t upper = bucketUpperBound(i);
+                return upper < maxValue ? upper : maxValue;
+            }
+        }
+        return maxValue;
+    }
+
+    uint32_t count() const { return total; }
+    uint32_t min() const { return total ? minValue : 0; }
+    uint32_t max() const { return maxValue; }
+    uint64_t getSum() const { return sum; }
+    uint32_t mean() const { return total ? (uint32_t)(sum / total) : 0; }
+    uint32_t bucketValue(size_t index) const { return buckets[index]; }
+
+    /**
+     * @brief Write non-empty buckets as JSON [[lower,upper,count],...]
+     * @param buffer Output buffer
+     * @param bufferSize Size of buffer
+     * @return Characters written (truncated output is still valid JSON)
+     */
+    size_t toJson(char* buffer, size_t bufferSize) const {
+        if (bufferSize < 3) return 0;
+
+        size_t pos = 0;
+        buffer[pos++] = '[';
+        bool first = true;
+
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            if (buckets[i] == 0) continue;
+
+            char entry[40];
+            int len = snprintf(entry, sizeof(entry), "%s[%lu,%lu,%lu]",
+                               first ? "" : ",",
+                               (unsigned long)bucketLowerBound(i),
+                               (unsigned long)bucketUpperBound(i),
+                               (unsigned long)buckets[i]);
+            if (len < 0 || pos + (size_t)len + 2 > bufferSize) break;
+
+            memcpy(buffer + pos, entry, len);
+            pos += len;
+            first = false;
+        }
+
+        buffer[pos++] = ']';
+        buffer[pos] = '\0';
+        return pos;
+    }
+};
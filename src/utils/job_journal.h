@@ -0,0 +1,405 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "config.h"
+#include "error_codes.h"
+#include "crc32.h"
+#include "logger.h"
+#include "rtc_retained.h"
+
+/**
+ * @file job_journal.h
+ * @brief Where each typing job got to, kept in RTC memory across resets
+ *
+ * A job gets an entry when it is queued, holding its ID, the CRC-32 and
+ * length of its whole text, and the offset it started at. As each
+ * report is written to the host, the pump adds its characters to the
+ * entry with a single 32-bit store. After a panic, a watchdog reset or
+ * a brownout (RTC memory held), the next boot therefore knows, to the
+ * report, where the job stopped. begin() marks jobs that were still
+ * running as interrupted and logs them.
+ *
+ * The fixed fields have their own CRC, and state is stored last when
+ * an entry is (re)written (compiler fences keep the stores in that
+ * order), so an entry torn by a reset is dropped instead of misread.
+ * RTC memory is garbage after power-on; the journal then starts empty.
+ *
+ * To resume a job the client sends the same text again with its ID.
+ * resumePoint() checks that the CRC and length match and gives the
+ * offset to continue from; the entry keeps its ID.
+ *
+ * Usage:
+ *   Jobs::journal().begin();                // setup()
+ *   uint32_t id = journal.start(tag);       // Before the first report
+ *   journal.progress(report.length);        // Each report written (pump)
+ *   journal.finish(completed);              // When the job ends (loop)
+ */
+
+enum class JobKind : uint8_t {
+    TEXT,     // /type?msg=
+    SNIPPET,  // /type?snippet=, expanded text
+    SPOOL     // /type?spool=, the whole document
+};
+
+enum class JobState : uint8_t {
+    FREE,
+    ACTIVE,
+    COMPLETED,
+    FAILED,       // Ended early (disconnect, abort) without a reset
+    INTERRUPTED   // Still active when the device reset
+};
+
+/**
+ * @brief What a queued job types
+ */
+struct JobTag {
+    JobKind kind;
+    uint32_t hash;    // CRC-32 of the whole text
+    uint32_t length;  // Whole text
+    uint32_t from;    // Offset this run starts at (0 unless resuming)
+    uint32_t id;      // Job being resumed, or 0 for a new one
+
+    JobTag() : kind(JobKind::TEXT), hash(0), length(0), from(0), id(0) {}
+    JobTag(JobKind k, uint32_t h, size_t len, size_t start = 0, uint32_t resumeId = 0)
+        : kind(k), hash(h), length((uint32_t)len), from((uint32_t)start), id(resumeId) {}
+};
+
+/**
+ * @brief One job in RTC memory
+ */
+struct JobEntry {
+    // Set when the job starts
+    uint32_t id;
+    uint32_t hash;
+    uint32_t length;
+    uint32_t from;
+    uint32_t kind;
+    uint32_t check;    // CRC-32 of the fields above
+
+    // Single stores while it runs
+    uint32_t emitted;  // Characters written to the host since from
+    uint32_t state;
+
+    /**
+     * @brief Offset in the whole text where typing stopped (or is)
+     */
+    uint32_t position() const {
+        uint32_t end = from + emitted;
+        return end < length ? end : length;
+    }
+
+    /**
+     * @brief Ended before the last character, by a reset or otherwise
+     */
+    bool isStopped() const {
+        return (state == (uint32_t)JobState::INTERRUPTED || state == (uint32_t)JobState::FAILED) &&
+               position() < length;
+    }
+};
+
+/**
+ * @brief The journal as it sits in RTC memory
+ */
+struct JobJournalRecord {
+    static constexpr uint32_t MAGIC = 0x4A424F4Au;  // "JOBJ"
+
+    uint32_t magic;
+    uint32_t nextId;
+    JobEntry entries[Config::Jobs::JOURNAL_ENTRIES];
+};
+
+class JobJournal {
+private:
+    static constexpr size_t NONE = Config::Jobs::JOURNAL_ENTRIES;
+
+    std::atomic<size_t> current;  // Entry of the running job, NONE when idle; read by the pump
+    size_t interruptedAtBoot;
+
+    static JobJournalRecord& retained() {
+        static RTC_RETAINED JobJournalRecord record;
+        return record;
+    }
+
+    static uint32_t entryCrc(const JobEntry& entry) {
+        return Crc32::compute(&entry, offsetof(JobEntry, check));
+    }
+
+    static bool isValid(const JobEntry& entry) {
+        return entry.state > (uint32_t)JobState::FREE &&
+               entry.state <= (uint32_t)JobState::INTERRUPTED &&
+               entry.kind <= (uint32_t)JobKind::SPOOL &&
+               entry.id != 0 && entry.check == entryCrc(entry);
+    }
+
+    /**
+     * @brief Entry to reuse for a new job: free, else the oldest ended
+     *        one, else the oldest interrupted one
+     */
+    size_t pickSlot() const {
+        const JobJournalRecord& record = retained();
+        size_t best = NONE;
+        for (size_t i = 0; i < Config::Jobs::JOURNAL_ENTRIES; i++) {
+            const JobEntry& e = record.entries[i];
+            if (e.state == (uint32_t)JobState::FREE) return i;
+            if (best == NONE) {
+                best = i;
+                continue;
+            }
+            const JobEntry& b = record.entries[best];
+            bool eStopped = e.state == (uint32_t)JobState::INTERRUPTED;
+            bool bStopped = b.state == (uint32_t)JobState::INTERRUPTED;
+            if (eStopped != bStopped ? bStopped : e.id < b.id) best = i;
+        }
+        return best;
+    }
+
+    size_t indexOf(uint32_t id) const {
+        if (id == 0) return NONE;
+        const JobJournalRecord& record = retained();
+        for (size_t i = 0; i < Config::Jobs::JOURNAL_ENTRIES; i++) {
+            if (record.entries[i].state != (uint32_t)JobState::FREE &&
+                record.entries[i].id == id) {
+                return i;
+            }
+        }
+        return NONE;
+    }
+
+public:
+    static const char* kindName(uint32_t kind) {
+        switch ((JobKind)kind) {
+            case JobKind::TEXT: return "text";
+            case JobKind::SNIPPET: return "snippet";
+            case JobKind::SPOOL: return "spool";
+            default: return "unknown";
+        }
+    }
+
+    static const char* stateName(uint32_t state) {
+        switch ((JobState)state) {
+            case JobState::ACTIVE: return "active";
+            case JobState::COMPLETED: return "completed";
+            case JobState::FAILED: return "failed";
+            case JobState::INTERRUPTED: return "interrupted";
+            default: return "free";
+        }
+    }
+
+    JobJournal() : current(NONE), interruptedAtBoot(0) {}
+
+    /**
+     * @brief Pick up the previous boot's journal (call in setup(), before any job)
+     *
+     * Jobs that were running are marked interrupted and logged; torn
+     * entries are dropped.
+     */
+    void begin() {
+        JobJournalRecord& record = retained();
+        current = NONE;
+        interruptedAtBoot = 0;
+
+        if (record.magic != JobJournalRecord::MAGIC) {
+            clear();
+            return;
+        }
+
+        uint32_t highest = 0;
+        for (size_t i = 0; i < Config::Jobs::JOURNAL_ENTRIES; i++) {
+            JobEntry& e = record.entries[i];
+            if (!isValid(e)) {
+                e.state = (uint32_t)JobState::FREE;
+                continue;
+            }
+            if (e.id > highest) highest = e.id;
+            if (e.state != (uint32_t)JobState::ACTIVE) continue;
+
+            e.state = (uint32_t)JobState::INTERRUPTED;
+            interruptedAtBoot++;
+            LOG_ERROR_F("Job %lu (%s) interrupted by reset at %lu of %lu chars",
+                        (unsigned long)e.id, kindName(e.kind),
+                        (unsigned long)e.position(), (unsigned long)e.length);
+        }
+        if (record.nextId <= highest) record.nextId = highest + 1;
+        if (record.nextId == 0) record.nextId = 1;
+    }
+
+    /**
+     * @brief Forget every job
+     */
+    void clear() {
+        JobJournalRecord& record = retained();
+        memset(&record, 0, sizeof(record));
+        record.nextId = 1;
+        record.magic = JobJournalRecord::MAGIC;
+        current = NONE;
+    }
+
+    /**
+     * @brief Journal a job about to be queued (loop task)
+     * @param tag tag.id continues that job's entry; 0 starts a new one
+     * @return The job's ID
+     */
+    uint32_t start(const JobTag& tag) {
+        JobJournalRecord& record = retained();
+        size_t slot = indexOf(tag.id);
+        uint32_t id = tag.id;
+        if (slot == NONE) {
+            slot = pickSlot();
+            id = record.nextId++;
+            if (record.nextId == 0) record.nextId = 1;
+        }
+
+        current.store(NONE, std::memory_order_release);
+        JobEntry& e = record.entries[slot];
+        e.state = (uint32_t)JobState::FREE;  // Torn until the last store
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        e.id = id;
+        e.hash = tag.hash;
+        e.length = tag.length;
+        e.from = tag.from;
+        e.kind = (uint32_t)tag.kind;
+        e.check = entryCrc(e);
+        e.emitted = 0;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        e.state = (uint32_t)JobState::ACTIVE;
+        current.store(slot, std::memory_order_release);
+        return id;
+    }
+
+    /**
+     * @brief Count characters written to the host (pump, per report)
+     */
+    void progress(size_t chars) {
+        size_t slot = current.load(std::memory_order_acquire);
+        if (slot == NONE) return;
+        JobEntry& e = retained().entries[slot];
+        e.emitted = e.emitted + (uint32_t)chars;
+    }
+
+    /**
+     * @brief Record how the running job ended (loop task)
+     */
+    void finish(bool completed) {
+        size_t slot = current.load(std::memory_order_relaxed);
+        if (slot == NONE) return;
+        current.store(NONE, std::memory_order_release);
+        retained().entries[slot].state =
+            (uint32_t)(completed ? JobState::COMPLETED : JobState::FAILED);
+    }
+
+    /**
+     * @brief Entry of the running job, or nullptr when idle
+     */
+    const JobEntry* getCurrent() const {
+        size_t slot = current.load(std::memory_order_acquire);
+        return slot == NONE ? nullptr : &retained().entries[slot];
+    }
+
+    /**
+     * @brief Entry for id, or nullptr if it has been dropped
+     */
+    const JobEntry* find(uint32_t id) const {
+        size_t slot = indexOf(id);
+        return slot == NONE ? nullptr : &retained().entries[slot];
+    }
+
+    /**
+     * @brief Newest stopped job that was typing this text
+     * @return nullptr if none
+     */
+    const JobEntry* findStopped(JobKind kind, uint32_t hash, size_t length) const {
+        const JobJournalRecord& record = retained();
+        const JobEntry* newest = nullptr;
+        for (size_t i = 0; i < Config::Jobs::JOURNAL_ENTRIES; i++) {
+            const JobEntry& e = record.entries[i];
+            if (e.isStopped() && e.kind == (uint32_t)kind && e.hash == hash &&
+                e.length == length && (newest == nullptr || e.id > newest->id)) {
+                newest = &e;
+            }
+        }
+        return newest;
+    }
+
+    /**
+     * @brief Where to continue job id, given its text again
+     * @param from Set to the offset typing stopped at
+     * @return NOT_FOUND if the job is not in the journal, INVALID_PARAMETER
+     *         if the text differs or the job has not stopped short
+     */
+    ErrorCode resumePoint(uint32_t id, JobKind kind, uint32_t hash, size_t length,
+                          size_t& from) const {
+        from = 0;
+        const JobEntry* e = find(id);
+        if (e == nullptr) return ErrorCode::NOT_FOUND;
+        if (e->kind != (uint32_t)kind || e->hash != hash || e->length != length ||
+            !e->isStopped()) {
+            return ErrorCode::INVALID_PARAMETER;
+        }
+        from = e->position();
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Jobs found running by begin()
+     */
+    size_t getInterruptedAtBoot() const {
+        return interruptedAtBoot;
+    }
+
+    /**
+     * @brief Format the journal as JSON, newest job first
+     * @return Bytes written (0 if it didn't fit)
+     */
+    size_t toJson(char* buffer, size_t bufferSize) const {
+        const JobJournalRecord& record = retained();
+        int pos = snprintf(buffer, bufferSize, "{\"interruptedAtBoot\":%u,\"jobs\":[",
+                           (unsigned)interruptedAtBoot);
+
+        // Selection by descending ID; there are only a handful of entries
+        uint32_t below = 0xFFFFFFFFu;
+        bool first = true;
+        for (size_t n = 0; n < Config::Jobs::JOURNAL_ENTRIES && pos > 0 && (size_t)pos < bufferSize; n++) {
+            const JobEntry* next = nullptr;
+            for (size_t i = 0; i < Config::Jobs::JOURNAL_ENTRIES; i++) {
+                const JobEntry& e = record.entries[i];
+                if (e.state != (uint32_t)JobState::FREE && e.id < below &&
+                    (next == nullptr || e.id > next->id)) {
+                    next = &e;
+                }
+            }
+            if (next == nullptr) break;
+            below = next->id;
+
+            pos += snprintf(buffer + pos, bufferSize - pos,
+                            "%s{\"id\":%lu,\"kind\":\"%s\",\"state\":\"%s\",\"hash\":\"%08lx\","
+                            "\"length\":%lu,\"from\":%lu,\"typed\":%lu}",
+                            first ? "" : ",", (unsigned long)next->id, kindName(next->kind),
+                            stateName(next->state), (unsigned long)next->hash,
+                            (unsigned long)next->length, (unsigned long)next->from,
+                            (unsigned long)next->position());
+            first = false;
+        }
+
+        if (pos > 0 && (size_t)pos < bufferSize) {
+            pos += snprintf(buffer + pos, bufferSize - pos, "]}");
+        }
+        if (pos < 0 || (size_t)pos >= bufferSize) {
+            if (bufferSize > 0) buffer[0] = '\0';
+            return 0;
+        }
+        return (size_t)pos;
+    }
+};
+
+namespace Jobs {
+    /**
+     * @brief Get the process-wide job journal
+     */
+    inline JobJournal& journal() {
+        static JobJournal instance;
+        return instance;
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include "config.h"
+#include "time_utils.h"
 
 /**
  * @file logger.h
@@ -27,8 +28,9 @@ private:
      * @param bufferSize Size of buffer
      */
     static void formatTimestamp(char* buffer, size_t bufferSize) {
-        unsigned long ms = millis();
-        unsigned long seconds = ms / 1000;
+        // 64-bit clock: timestamps stay correct past the 49-day millis() wrap
+        uint64_t ms = TimeUtils::nowMs64();
+        unsigned long seconds = (unsigned long)(ms / 1000);
         unsigned long minutes = seconds / 60;
         unsigned long hours = minutes / 60;
 
@@ -36,10 +38,48 @@ private:
                  hours % 24,
                  minutes % 60,
                  seconds % 60,
-                 ms % 1000);
+                 (unsigned long)(ms % 1000));
+    }
+
+    /**
+     * @brief Format "[timestamp] [LEVEL] message" into buffer (truncates)
+     */
+    static size_t vformatLine(char* buffer, size_t bufferSize, const char* level,
+                              const char* format, va_list args) {
+        char timestamp[20];
+        formatTimestamp(timestamp, sizeof(timestamp));
+
+        int prefix = snprintf(buffer, bufferSize, "%s %s ", timestamp, level);
+        if (prefix < 0 || (size_t)prefix >= bufferSize) {
+            return prefix < 0 ? 0 : bufferSize - 1;
+        }
+
+        int body = vsnprintf(buffer + prefix, bufferSize - prefix, format, args);
+        if (body < 0) return (size_t)prefix;
+        size_t total = (size_t)prefix + (size_t)body;
+        return total < bufferSize ? total : bufferSize - 1;
     }
 
 public:
+    static constexpr size_t LINE_SIZE = 288;  // Timestamp, level and a 256-byte message
+
+    /**
+     * @brief Format a log line without printing it
+     * @param buffer Output buffer
+     * @param bufferSize Size of buffer
+     * @param level Level tag, e.g. "[INFO] "
+     * @param format Printf-style format string
+     * @return Length written (truncated to fit)
+     */
+    static size_t formatLine(char* buffer, size_t bufferSize, const char* level,
+                             const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        size_t len = vformatLine(buffer, bufferSize, level, format, args);
+        va_end(args);
+        return len;
+    }
+
     /**
      * @brief Log debug message
      * @param message Message to log
@@ -59,18 +99,13 @@ public:
      */
     static void debugF(const char* format, ...) {
         if (Config::Logging::LOG_LEVEL >= Config::Logging::DEBUG) {
-            char timestamp[20];
-            formatTimestamp(timestamp, sizeof(timestamp));
-
-            Serial.printf("%s [DEBUG] ", timestamp);
-
+            char line[LINE_SIZE];
             va_list args;
             va_start(args, format);
-            char buffer[256];
-            vsnprintf(buffer, sizeof(buffer), format, args);
+            vformatLine(line, sizeof(line), "[DEBUG]", format, args);
             va_end(args);
 
-            Serial.println(buffer);
+            Serial.println(line);
         }
     }
 
@@ -93,18 +128,13 @@ public:
      */
     static void infoF(const char* format, ...) {
         if (Config::Logging::LOG_LEVEL >= Config::Logging::INFO) {
-            char timestamp[20];
-            formatTimestamp(timestamp, sizeof(timestamp));
-
-            Serial.printf("%s [INFO]  ", timestamp);
-
+            char line[LINE_SIZE];
             va_list args;
             va_start(args, format);
-            char buffer[256];
-            vsnprintf(buffer, sizeof(buffer), format, args);
+            vformatLine(line, sizeof(line), "[INFO] ", format, args);
             va_end(args);
 
-            Serial.println(buffer);
+            Serial.println(line);
         }
     }
 
@@ -127,18 +157,13 @@ public:
      */
     static void errorF(const char* format, ...) {
         if (Config::Logging::LOG_LEVEL >= Config::Logging::ERROR) {
-            char timestamp[20];
-            formatTimestamp(timestamp, sizeof(timestamp));
-
-            Serial.printf("%s [ERROR] ", timestamp);
-
+            char line[LINE_SIZE];
             va_list args;
             va_start(args, format);
-            char buffer[256];
-            vsnprintf(buffer, sizeof(buffer), format, args);
+            vformatLine(line, sizeof(line), "[ERROR]", format, args);
             va_end(args);
 
-            Serial.println(buffer);
+            Serial.println(line);
         }
     }
 
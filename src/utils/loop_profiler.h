@@ -0,0 +1,320 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "histogram.h"
+#include "metrics.h"
+#include "logger.h"
+#include "rtc_retained.h"
+#include "time_utils.h"
+#include "timing_wheel.h"
+
+#ifdef ESP_PLATFORM
+#include <xtensa/hal.h>
+#endif
+
+/**
+ * @file loop_profiler.h
+ * @brief Per-section time attribution for loop()
+ *
+ * loop() calls beginIteration(), then mark(section) after each manager
+ * call; the time since the previous mark is charged to that section.
+ * Timing uses the CPU cycle counter (CCOUNT), so a mark costs a single
+ * register read. Times are wall-clock: preemption by higher-priority
+ * tasks is charged to whichever section was running.
+ *
+ * An iteration longer than Config::Profiler::LOOP_BUDGET_US is counted
+ * as an overrun and logged (rate-limited) with the section that took
+ * the most time. A summary is written to RTC memory periodically and
+ * printed at the next boot, so a reset still leaves a profile behind.
+ *
+ * Usage:
+ *   void loop() {
+ *     LoopProfiler& profiler = Profiling::mainLoop();
+ *     profiler.beginIteration();
+ *     SystemTimers::wheel().advance(SystemTimers::nowTick());
+ *     profiler.mark(LoopProfiler::TIMERS);
+ *     bleManager.update();
+ *     profiler.mark(LoopProfiler::BLE);
+ *     ...
+ *     profiler.endIteration();  // Remainder is charged to HOUSEKEEPING
+ *   }
+ */
+
+/**
+ * @brief Loop profile persisted across resets
+ */
+struct LoopProfileSummary {
+    static constexpr uint32_t MAGIC = 0x4C50524Fu;  // "LPRO"
+    static constexpr uint8_t SLOTS = 5;             // Sections + whole loop
+
+    uint32_t magic;
+    uint32_t uptimeSeconds;
+    uint32_t iterations;
+    uint32_t overruns;
+    uint32_t meanUs[SLOTS];
+    uint32_t p99Us[SLOTS];
+    uint32_t maxUs[SLOTS];
+};
+
+class LoopProfiler {
+public:
+    enum Section : uint8_t {
+        TIMERS,        // SystemTimers::wheel().advance() and its callbacks
+        BLE,           // bleManager.update()
+        HTTP,          // webServer.handleClient()
+        HOUSEKEEPING,  // Everything else in loop()
+        SECTION_COUNT
+    };
+
+    static constexpr uint8_t TOTAL = SECTION_COUNT;  // Whole-iteration slot
+
+private:
+    LogLinearHistogram histograms[SECTION_COUNT + 1];  // Microseconds
+    uint32_t iterationUs[SECTION_COUNT];  // Current iteration
+    uint32_t iterationStart;
+    uint32_t lastMark;
+    uint32_t cyclesPerUs;
+    uint32_t budgetUs;
+    bool inIteration;
+
+    Counter overruns;
+    uint64_t lastOverrunLogUs;
+    uint32_t suppressedOverruns;
+
+    LoopProfileSummary previous;
+    bool hasPrevious;
+    Timer summaryTimer;
+
+    static uint32_t cycles() {
+#ifdef ESP_PLATFORM
+        return xthal_get_ccount();
+#else
+        return (uint32_t)TimeUtils::nowUs();  // One "cycle" per microsecond
+#endif
+    }
+
+    uint32_t toUs(uint32_t cycleDelta) const {
+        return cycleDelta / cyclesPerUs;
+    }
+
+    static LoopProfileSummary& retained() {
+        static RTC_RETAINED LoopProfileSummary record;
+        return record;
+    }
+
+    static void onSummaryTimer(void* context) {
+        LoopProfiler* self = static_cast<LoopProfiler*>(context);
+        self->summarize(retained());
+    }
+
+    void reportOverrun(uint32_t totalUs) {
+        overruns.inc();
+
+        if (!TimeUtils::hasElapsedUs(lastOverrunLogUs,
+                                     Config::Profiler::OVERRUN_LOG_INTERVAL_MS * 1000ULL)) {
+            suppressedOverruns++;
+            return;
+        }
+
+        uint8_t worst = 0;
+        for (uint8_t s = 1; s < SECTION_COUNT; s++) {
+            if (iterationUs[s] > iterationUs[worst]) worst = s;
+        }
+
+        LOG_ERROR_F("Loop overrun: %lu us (budget %lu us), %s took %lu us (+%lu suppressed)",
+                    (unsigned long)totalUs, (unsigned long)budgetUs,
+                    sectionName(worst), (unsigned long)iterationUs[worst],
+                    (unsigned long)suppressedOverruns);
+        lastOverrunLogUs = TimeUtils::nowUs();
+        suppressedOverruns = 0;
+    }
+
+public:
+    /**
+     * @brief Construct profiler
+     * @param budget Iteration budget in microseconds
+     */
+    explicit LoopProfiler(uint32_t budget = Config::Profiler::LOOP_BUDGET_US)
+        : iterationStart(0), lastMark(0), cyclesPerUs(1), budgetUs(budget),
+          inIteration(false), lastOverrunLogUs(0), suppressedOverruns(0),
+          hasPrevious(false) {
+        memset(iterationUs, 0, sizeof(iterationUs));
+        memset(&previous, 0, sizeof(previous));
+        summaryTimer.setCallback(&LoopProfiler::onSummaryTimer, this);
+    }
+
+    static const char* sectionName(uint8_t section) {
+        static const char* const names[SECTION_COUNT + 1] = {
+            "timers", "ble", "http", "housekeeping", "loop"
+        };
+        return section <= SECTION_COUNT ? names[section] : "unknown";
+    }
+
+    /**
+     * @brief Load and log the previous boot's summary, start summarizing
+     *
+     * Call this in setup(), after Serial is up.
+     */
+    void begin() {
+#ifdef ESP_PLATFORM
+        cyclesPerUs = getCpuFrequencyMhz();
+        if (cyclesPerUs == 0) cyclesPerUs = 1;
+#endif
+
+        LoopProfileSummary& record = retained();
+        hasPrevious = (record.magic == LoopProfileSummary::MAGIC);
+        if (hasPrevious) {
+            previous = record;
+            logSummary(previous);
+        }
+        record.magic = 0;
+
+        MetricsRegistry& registry = Metrics::registry();
+        for (uint8_t s = 0; s <= SECTION_COUNT; s++) {
+            registry.addHistogram("loop_section_duration_seconds",
+                                  "Time per loop() iteration spent in each section",
+                                  histograms[s], 1e-6, "section", sectionName(s));
+        }
+        registry.addCounter("loop_overruns_total", "loop() iterations over budget", overruns);
+
+        SystemTimers::wheel().armPeriodic(summaryTimer, Config::Profiler::SUMMARY_INTERVAL_MS);
+    }
+
+    /**
+     * @brief Start timing one loop() iteration
+     */
+    void beginIteration() {
+        iterationStart = cycles();
+        lastMark = iterationStart;
+        memset(iterationUs, 0, sizeof(iterationUs));
+        inIteration = true;
+    }
+
+    /**
+     * @brief Charge time since the previous mark to a section
+     */
+    void mark(Section section) {
+        if (!inIteration) return;
+        uint32_t now = cycles();
+        uint32_t us = toUs(now - lastMark);
+        lastMark = now;
+
+        iterationUs[section] += us;
+        histograms[section].record(us);
+    }
+
+    /**
+     * @brief Finish the iteration; the remainder goes to HOUSEKEEPING
+     */
+    void endIteration() {
+        if (!inIteration) return;
+        mark(HOUSEKEEPING);
+        inIteration = false;
+
+        uint32_t totalUs = toUs(lastMark - iterationStart);
+        histograms[TOTAL].record(totalUs);
+
+        if (totalUs > budgetUs) {
+            reportOverrun(totalUs);
+        }
+    }
+
+    /**
+     * @brief Copy current statistics into a summary record
+     */
+    void summarize(LoopProfileSummary& out) const {
+        out.magic = LoopProfileSummary::MAGIC;
+        out.uptimeSeconds = (uint32_t)(TimeUtils::nowUs() / 1000000ULL);
+        out.iterations = histograms[TOTAL].count();
+        out.overruns = overruns.get();
+        for (uint8_t s = 0; s <= SECTION_COUNT; s++) {
+            out.meanUs[s] = histograms[s].mean();
+            out.p99Us[s] = histograms[s].percentile(99.0f);
+            out.maxUs[s] = histograms[s].max();
+        }
+    }
+
+    /**
+     * @brief Print a summary (used for the previous boot at startup)
+     */
+    static void logSummary(const LoopProfileSummary& summary) {
+        LOG_INFO_F("Previous boot loop profile: %lu iterations, %lu overruns, up %lu s",
+                   (unsigned long)summary.iterations, (unsigned long)summary.overruns,
+                   (unsigned long)summary.uptimeSeconds);
+        for (uint8_t s = 0; s <= SECTION_COUNT; s++) {
+            LOG_INFO_F("  %-12s mean %6lu us  p99 %6lu us  max %6lu us", sectionName(s),
+                       (unsigned long)summary.meanUs[s], (unsigned long)summary.p99Us[s],
+                       (unsigned long)summary.maxUs[s]);
+        }
+    }
+
+    /**
+     * @brief Write current and previous-boot profile as JSON
+     * @return Characters written (0 if the buffer is too small)
+     */
+    size_t toJson(char* buffer, size_t bufferSize) const {
+        int pos = snprintf(buffer, bufferSize,
+                           "{\"budgetUs\":%lu,\"iterations\":%lu,\"overruns\":%lu,\"sections\":{",
+                           (unsigned long)budgetUs, (unsigned long)histograms[TOTAL].count(),
+                           (unsigned long)overruns.get());
+
+        for (uint8_t s = 0; s <= SECTION_COUNT && pos > 0 && (size_t)pos < bufferSize; s++) {
+            const LogLinearHistogram& h = histograms[s];
+            pos += snprintf(buffer + pos, bufferSize - pos,
+                            "%s\"%s\":{\"meanUs\":%lu,\"p50Us\":%lu,\"p99Us\":%lu,\"maxUs\":%lu}",
+                            s ? "," : "", sectionName(s), (unsigned long)h.mean(),
+                            (unsigned long)h.percentile(50.0f), (unsigned long)h.percentile(99.0f),
+                            (unsigned long)h.max());
+        }
+
+        if (pos > 0 && (size_t)pos < bufferSize) {
+            if (hasPrevious) {
+                pos += snprintf(buffer + pos, bufferSize - pos,
+                                "},\"previousBoot\":{\"uptime\":%lu,\"iterations\":%lu,"
+                                "\"overruns\":%lu,\"maxUs\":%lu}}",
+                                (unsigned long)previous.uptimeSeconds,
+                                (unsigned long)previous.iterations,
+                                (unsigned long)previous.overruns,
+                                (unsigned long)previous.maxUs[TOTAL]);
+            } else {
+                pos += snprintf(buffer + pos, bufferSize - pos, "},\"previousBoot\":null}");
+            }
+        }
+
+        if (pos < 0 || (size_t)pos >= bufferSize) {
+            if (bufferSize > 0) buffer[0] = '\0';
+            return 0;
+        }
+        return (size_t)pos;
+    }
+
+    const LogLinearHistogram& getHistogram(uint8_t section) const {
+        return histograms[section];
+    }
+
+    uint32_t getOverruns() const {
+        return overruns.get();
+    }
+
+    uint32_t getBudgetUs() const {
+        return budgetUs;
+    }
+
+    bool hasPreviousBoot() const {
+        return hasPrevious;
+    }
+
+    const LoopProfileSummary& getPreviousBoot() const {
+        return previous;
+    }
+};
+
+namespace Profiling {
+    /**
+     * @brief Get the profiler for the Arduino loop()
+     */
+    inline LoopProfiler& mainLoop() {
+        static LoopProfiler instance;
+        return instance;
+    }
+}
@@ -0,0 +1,244 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @file lzss.h
+ * @brief LZSS compression with a streaming, fixed-memory decoder
+ *
+ * The heatshrink family of formats, byte-aligned for a simpler decoder:
+ * a flag byte precedes every group of up to eight items, one bit per
+ * item (LSB first). A set bit is a literal byte; a clear bit is a
+ * two-byte back-reference of 3..66 bytes from up to 1 KB back:
+ *
+ *   byte 0: distance - 1, low 8 bits
+ *   byte 1: (distance - 1) >> 8 in the top 2 bits, length - 3 below
+ *
+ * The stream has no terminator; the decoder is told the output length.
+ *
+ * compress() hands each finished group to a sink, so the output can go
+ * straight to flash. The Decoder pulls compressed bytes from a source a
+ * few at a time and keeps only the 1 KB window, so text of any length
+ * can be expanded on the fly.
+ *
+ * Usage:
+ *   Lzss::compress(text, length, &writeToFlash, &store);
+ *   Lzss::Decoder decoder;
+ *   decoder.begin(&readFromFlash, &cursor, length);
+ *   uint8_t byte;
+ *   while (decoder.next(byte)) { ... }
+ */
+
+namespace Lzss {
+    constexpr unsigned WINDOW_BITS = 10;
+    constexpr size_t WINDOW_SIZE = (size_t)1 << WINDOW_BITS;
+    constexpr size_t MIN_MATCH = 3;
+    constexpr size_t MAX_MATCH = MIN_MATCH + ((size_t)1 << (16 - WINDOW_BITS)) - 1;
+
+    /**
+     * @brief Receives compressed output; return false to stop
+     */
+    typedef bool (*Sink)(const uint8_t* data, size_t length, void* context);
+
+    /**
+     * @brief Supplies compressed input
+     * @return Bytes written to out (0 = no more input)
+     */
+    typedef size_t (*Source)(uint8_t* out, size_t max, void* context);
+
+    /**
+     * @brief Largest possible output for length bytes of input
+     */
+    constexpr size_t maxCompressedSize(size_t length) {
+        return length + (length + 7) / 8;
+    }
+
+    /**
+     * @brief Longest earlier match for in[position..]
+     * @param distance Set to how far back the match starts
+     */
+    inline size_t longestMatch(const uint8_t* in, size_t length, size_t position, size_t& distance) {
+        size_t limit = length - position;
+        if (limit > MAX_MATCH) limit = MAX_MATCH;
+        if (limit < MIN_MATCH) return 0;
+
+        size_t best = 0;
+        size_t start = position > WINDOW_SIZE ? position - WINDOW_SIZE : 0;
+        for (size_t candidate = position; candidate-- > start;) {
+            if (in[candidate] != in[position]) continue;
+            size_t n = 1;
+            while (n < limit && in[candidate + n] == in[position + n]) n++;
+            if (n > best) {
+                best = n;
+                distance = position - candidate;
+                if (best == limit) break;
+            }
+        }
+        return best >= MIN_MATCH ? best : 0;
+    }
+
+    /**
+     * @brief Compress length bytes of in, group by group, into sink
+     * @return false if the sink refused output
+     *
+     * Greedy longest-match search, scanning the whole window for every
+     * position: meant for one-off compression at upload, not the
+     * request path.
+     */
+    inline bool compress(const uint8_t* in, size_t length, Sink sink, void* context) {
+        uint8_t group[1 + 8 * 2];
+        size_t groupLength = 1;
+        unsigned items = 0;
+        group[0] = 0;
+
+        size_t position = 0;
+        while (position < length) {
+            size_t distance = 0;
+            size_t match = longestMatch(in, length, position, distance);
+            if (match > 0) {
+                size_t code = distance - 1;
+                group[groupLength++] = (uint8_t)(code & 0xFF);
+                group[groupLength++] = (uint8_t)(((code >> 8) << (16 - WINDOW_BITS)) |
+                                                 (match - MIN_MATCH));
+                position += match;
+            } else {
+                group[0] |= (uint8_t)(1u << items);
+                group[groupLength++] = in[position++];
+            }
+
+            if (++items == 8) {
+                if (!sink(group, groupLength, context)) return false;
+                group[0] = 0;
+                groupLength = 1;
+                items = 0;
+            }
+        }
+        if (items > 0 && !sink(group, groupLength, context)) return false;
+        return true;
+    }
+
+    /**
+     * @brief Streaming decoder (1 KB window, 32-byte input buffer)
+     */
+    class Decoder {
+    public:
+        static constexpr size_t INPUT_BYTES = 32;
+
+    private:
+        Source source;
+        void* sourceContext;
+        uint8_t input[INPUT_BYTES];
+        size_t inputPos;
+        size_t inputLength;
+
+        uint8_t window[WINDOW_SIZE];
+        size_t produced;    // Output bytes so far
+        size_t total;       // Output bytes expected
+        uint8_t flags;
+        unsigned flagsLeft;
+        size_t matchDistance;
+        size_t matchLeft;
+        bool failed;        // Input ended early
+
+        bool nextInput(uint8_t& byte) {
+            if (inputPos == inputLength) {
+                inputLength = source(input, sizeof(input), sourceContext);
+                inputPos = 0;
+                if (inputLength == 0) {
+                    failed = true;
+                    return false;
+                }
+            }
+            byte = input[inputPos++];
+            return true;
+        }
+
+        void emit(uint8_t byte) {
+            window[produced % WINDOW_SIZE] = byte;
+            produced++;
+        }
+
+    public:
+        Decoder() : source(nullptr), sourceContext(nullptr), inputPos(0), inputLength(0),
+                    produced(0), total(0), flags(0), flagsLeft(0),
+                    matchDistance(0), matchLeft(0), failed(false) {}
+
+        /**
+         * @brief Start decoding a stream that expands to length bytes
+         */
+        void begin(Source src, void* context, size_t length) {
+            source = src;
+            sourceContext = context;
+            inputPos = 0;
+            inputLength = 0;
+            produced = 0;
+            total = length;
+            flags = 0;
+            flagsLeft = 0;
+            matchDistance = 0;
+            matchLeft = 0;
+            failed = false;
+        }
+
+        /**
+         * @brief Next output byte
+         * @return false at the end of the output (or if the input ran out)
+         */
+        bool next(uint8_t& byte) {
+            if (produced >= total || failed) return false;
+
+            if (matchLeft == 0) {
+                if (flagsLeft == 0) {
+                    if (!nextInput(flags)) return false;
+                    flagsLeft = 8;
+                }
+                bool literal = flags & 1;
+                flags >>= 1;
+                flagsLeft--;
+
+                if (literal) {
+                    if (!nextInput(byte)) return false;
+                    emit(byte);
+                    return true;
+                }
+
+                uint8_t low;
+                uint8_t high;
+                if (!nextInput(low) || !nextInput(high)) return false;
+                matchDistance = (((size_t)(high >> (16 - WINDOW_BITS)) << 8) | low) + 1;
+                matchLeft = (high & ((1u << (16 - WINDOW_BITS)) - 1)) + MIN_MATCH;
+                if (matchDistance > produced) {
+                    failed = true;  // Corrupt stream
+                    return false;
+                }
+            }
+
+            byte = window[(produced - matchDistance) % WINDOW_SIZE];
+            matchLeft--;
+            emit(byte);
+            return true;
+        }
+
+        /**
+         * @brief Decode up to max bytes
+         * @return Bytes written (less than max only at the end)
+         */
+        size_t read(uint8_t* out, size_t max) {
+            size_t n = 0;
+            while (n < max && next(out[n])) n++;
+            return n;
+        }
+
+        size_t getProduced() const {
+            return produced;
+        }
+
+        /**
+         * @brief Whether the input ended or was corrupt before the output did
+         */
+        bool hasFailed() const {
+            return failed;
+        }
+    };
+}
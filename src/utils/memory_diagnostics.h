@@ -0,0 +1,150 @@
+#pragma once
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+#include "chunked_writer.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+/**
+ * @file memory_diagnostics.h
+ * @brief Heap, per-task stack headroom and static RAM per manager, as JSON
+ *
+ * Static footprints are a constant table built with sizeof() where the
+ * managers are defined (main.cpp), so the numbers cost nothing at run
+ * time and change only when the classes do.
+ *
+ * Task stacks come from uxTaskGetSystemState() when FreeRTOS is built
+ * with the trace facility (the Arduino default); otherwise only tasks
+ * registered with addTask() are listed. High-water marks are the least
+ * free stack ever seen, in bytes (ESP-IDF counts stack in bytes).
+ *
+ * Usage:
+ *   static const MemoryFootprint footprint[] = {
+ *     MEMORY_FOOTPRINT("bleManager", BLEKeyboardManager),
+ *   };
+ *   Diagnostics::memory().setFootprint(footprint, 1);
+ *
+ *   Diagnostics::memory().writeJson(out);
+ */
+
+struct MemoryFootprint {
+    const char* name;
+    size_t bytes;
+};
+
+#define MEMORY_FOOTPRINT(name, type) { name, sizeof(type) }
+
+class MemoryDiagnostics {
+private:
+    const MemoryFootprint* footprint;
+    size_t footprintCount;
+
+#ifdef ESP_PLATFORM
+    TaskHandle_t tasks[Config::Memory::MAX_TASKS];
+    size_t taskCount;
+
+    void writeTask(ChunkedWriter& out, bool first, const char* name, uint32_t stackFree,
+                   int core, uint32_t priority) const {
+        out.printf("%s{\"name\":\"%s\",\"stackFreeMin\":%lu,\"core\":%d,\"priority\":%lu}",
+                   first ? "" : ",", name, (unsigned long)stackFree, core,
+                   (unsigned long)priority);
+    }
+#endif
+
+public:
+    MemoryDiagnostics() : footprint(nullptr), footprintCount(0) {
+#ifdef ESP_PLATFORM
+        taskCount = 0;
+#endif
+    }
+
+    /**
+     * @brief Set the static footprint table (caller keeps it alive)
+     */
+    void setFootprint(const MemoryFootprint* table, size_t count) {
+        footprint = table;
+        footprintCount = count;
+    }
+
+    /**
+     * @brief Total bytes in the footprint table
+     */
+    size_t staticTotal() const {
+        size_t total = 0;
+        for (size_t i = 0; i < footprintCount; i++) {
+            total += footprint[i].bytes;
+        }
+        return total;
+    }
+
+#ifdef ESP_PLATFORM
+    /**
+     * @brief List a task even without the FreeRTOS trace facility
+     */
+    void addTask(TaskHandle_t task) {
+        if (task && taskCount < Config::Memory::MAX_TASKS) {
+            tasks[taskCount++] = task;
+        }
+    }
+#endif
+
+    /**
+     * @brief Stream the report as one JSON object. Call out.flush() after.
+     */
+    void writeJson(ChunkedWriter& out) const {
+#ifdef ESP_PLATFORM
+        out.printf("{\"heap\":{\"free\":%lu,\"minFree\":%lu,\"largestBlock\":%lu,\"total\":%lu},",
+                   (unsigned long)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+                   (unsigned long)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT),
+                   (unsigned long)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+                   (unsigned long)heap_caps_get_total_size(MALLOC_CAP_8BIT));
+
+        out.printf("\"tasks\":[");
+#if configUSE_TRACE_FACILITY == 1
+        TaskStatus_t status[Config::Memory::MAX_TASKS];
+        UBaseType_t count = uxTaskGetNumberOfTasks();
+        if (count <= Config::Memory::MAX_TASKS) {
+            count = uxTaskGetSystemState(status, Config::Memory::MAX_TASKS, nullptr);
+        } else {
+            count = 0;  // Array too small; FreeRTOS would return nothing anyway
+        }
+        for (UBaseType_t i = 0; i < count; i++) {
+            int core = status[i].xCoreID == tskNO_AFFINITY ? -1 : (int)status[i].xCoreID;
+            writeTask(out, i == 0, status[i].pcTaskName, status[i].usStackHighWaterMark, core,
+                      status[i].uxCurrentPriority);
+        }
+#else
+        for (size_t i = 0; i < taskCount; i++) {
+            writeTask(out, i == 0, pcTaskGetName(tasks[i]), uxTaskGetStackHighWaterMark(tasks[i]),
+                      -1, uxTaskPriorityGet(tasks[i]));
+        }
+#endif
+        out.printf("],");
+#else
+        out.printf("{\"heap\":null,\"tasks\":[],");
+#endif
+
+        out.printf("\"static\":{\"total\":%lu,\"objects\":{", (unsigned long)staticTotal());
+        for (size_t i = 0; i < footprintCount; i++) {
+            out.printf("%s\"%s\":%lu", i == 0 ? "" : ",", footprint[i].name,
+                       (unsigned long)footprint[i].bytes);
+        }
+        out.printf("}}}\n");
+    }
+};
+
+namespace Diagnostics {
+    /**
+     * @brief Get the process-wide memory diagnostics
+     */
+    inline MemoryDiagnostics& memory() {
+        static MemoryDiagnostics instance;
+        return instance;
+    }
+}
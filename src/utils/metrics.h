@@ -0,0 +1,280 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "config.h"
+#include "histogram.h"
+#include "chunked_writer.h"
+
+/**
+ * @file metrics.h
+ * @brief Fixed-allocation metrics registry with Prometheus text export
+ *
+ * Counters, gauges and log-linear histograms are owned by the code that
+ * updates them (usually as manager members); the registry only holds a
+ * fixed table of pointers plus names, so registering and updating never
+ * allocate. Counters and gauges are atomic and may be updated from any
+ * task; histograms should be recorded from a single task.
+ *
+ * Export walks the table and streams Prometheus text exposition format
+ * (version 0.0.4) through a small ChunkedWriter buffer, so the whole
+ * page never has to fit in RAM.
+ *
+ * Usage:
+ *   Counter requests;
+ *   Metrics::registry().addCounter("http_requests_total", "Requests served", requests);
+ *   requests.inc();
+ *
+ *   char buffer[256];
+ *   ChunkedWriter out(buffer, sizeof(buffer), &sendChunk, &server);
+ *   Metrics::registry().render(out);
+ *   out.flush();
+ */
+
+/**
+ * @class Counter
+ * @brief Monotonically increasing count (wraps at 2^32; scrapers treat that as a reset)
+ */
+class Counter {
+private:
+    std::atomic<uint32_t> value;
+
+public:
+    Counter() : value(0) {}
+
+    void inc(uint32_t n = 1) {
+        value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint32_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @class Gauge
+ * @brief Value that can go up and down
+ */
+class Gauge {
+private:
+    std::atomic<int32_t> value;
+
+public:
+    Gauge() : value(0) {}
+
+    void set(int32_t v) {
+        value.store(v, std::memory_order_relaxed);
+    }
+
+    void add(int32_t delta) {
+        value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    int32_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @class MetricsRegistry
+ * @brief Fixed table of named metrics
+ *
+ * Several entries may share a name with different label values (e.g.
+ * one latency histogram per route); they are exported as one family.
+ */
+class MetricsRegistry {
+public:
+    enum class Type : uint8_t {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM
+    };
+
+private:
+    struct Entry {
+        const char* name;
+        const char* help;
+        const char* labelName;   // nullptr = unlabelled
+        const char* labelValue;
+        const void* metric;
+        double scale;            // Histogram unit conversion on export
+        Type type;
+    };
+
+    Entry entries[Config::Metrics::MAX_METRICS];
+    size_t count;
+
+    bool add(Type type, const char* name, const char* help, const void* metric,
+             const char* labelName, const char* labelValue, double scale) {
+        // Re-registering the same object (e.g. begin() called twice) is a no-op
+        for (size_t i = 0; i < count; i++) {
+            if (entries[i].metric == metric) return true;
+        }
+        if (count >= Config::Metrics::MAX_METRICS) {
+            return false;
+        }
+
+        Entry& e = entries[count++];
+        e.name = name;
+        e.help = help;
+        e.labelName = labelName;
+        e.labelValue = labelValue;
+        e.metric = metric;
+        e.scale = scale;
+        e.type = type;
+        return true;
+    }
+
+    static const char* typeName(Type type) {
+        switch (type) {
+            case Type::COUNTER: return "counter";
+            case Type::GAUGE: return "gauge";
+            default: return "histogram";
+        }
+    }
+
+    /**
+     * @brief Write `{label="value"` (open) for a sample; caller closes it
+     * @return true if a label set was opened
+     */
+    static bool openLabels(ChunkedWriter& out, const Entry& e) {
+        if (e.labelName == nullptr) return false;
+        out.printf("{%s=\"%s\"", e.labelName, e.labelValue);
+        return true;
+    }
+
+    static void renderHistogram(ChunkedWriter& out, const Entry& e) {
+        const LogLinearHistogram& h = *static_cast<const LogLinearHistogram*>(e.metric);
+        const size_t group = LogLinearHistogram::SUB_BUCKETS;
+
+        // One `le` per power of two, up to the one holding the maximum
+        size_t lastIndex = h.count() ? LogLinearHistogram::bucketIndex(h.max()) : 0;
+        uint32_t cumulative = 0;
+
+        for (size_t i = 0; i < LogLinearHistogram::BUCKET_COUNT; i++) {
+            cumulative += h.bucketValue(i);
+            if ((i + 1) % group != 0) continue;
+
+            out.printf("%s_bucket", e.name);
+            out.printf("%s", openLabels(out, e) ? "," : "{");
+            out.printf("le=\"%.9g\"} %lu\n",
+                       LogLinearHistogram::bucketUpperBound(i) * e.scale,
+                       (unsigned long)cumulative);
+
+            if (i >= lastIndex) break;
+        }
+
+        out.printf("%s_bucket", e.name);
+        out.printf("%s", openLabels(out, e) ? "," : "{");
+        out.printf("le=\"+Inf\"} %lu\n", (unsigned long)h.count());
+
+        out.printf("%s_sum", e.name);
+        if (openLabels(out, e)) out.printf("}");
+        out.printf(" %.9g\n", (double)h.getSum() * e.scale);
+
+        out.printf("%s_count", e.name);
+        if (openLabels(out, e)) out.printf("}");
+        out.printf(" %lu\n", (unsigned long)h.count());
+    }
+
+    static void renderSample(ChunkedWriter& out, const Entry& e) {
+        if (e.type == Type::HISTOGRAM) {
+            renderHistogram(out, e);
+            return;
+        }
+
+        out.printf("%s", e.name);
+        if (openLabels(out, e)) out.printf("}");
+
+        if (e.type == Type::COUNTER) {
+            out.printf(" %lu\n", (unsigned long)static_cast<const Counter*>(e.metric)->get());
+        } else {
+            out.printf(" %ld\n", (long)static_cast<const Gauge*>(e.metric)->get());
+        }
+    }
+
+public:
+    MetricsRegistry() : count(0) {}
+
+    /**
+     * @brief Register a counter
+     * @param name Metric name (by convention ending in _total)
+     * @param help One-line description
+     * @param counter Counter owned by the caller; must outlive the registry
+     * @param labelName Optional label name (string literal)
+     * @param labelValue Label value (string literal)
+     * @return false if the registry is full
+     */
+    bool addCounter(const char* name, const char* help, const Counter& counter,
+                    const char* labelName = nullptr, const char* labelValue = nullptr) {
+        return add(Type::COUNTER, name, help, &counter, labelName, labelValue, 1.0);
+    }
+
+    /**
+     * @brief Register a gauge (see addCounter for parameters)
+     */
+    bool addGauge(const char* name, const char* help, const Gauge& gauge,
+                  const char* labelName = nullptr, const char* labelValue = nullptr) {
+        return add(Type::GAUGE, name, help, &gauge, labelName, labelValue, 1.0);
+    }
+
+    /**
+     * @brief Register a histogram
+     * @param scale Multiplier from recorded units to exported units
+     *              (1e-6 exports microsecond samples as seconds)
+     */
+    bool addHistogram(const char* name, const char* help, const LogLinearHistogram& histogram,
+                      double scale = 1.0,
+                      const char* labelName = nullptr, const char* labelValue = nullptr) {
+        return add(Type::HISTOGRAM, name, help, &histogram, labelName, labelValue, scale);
+    }
+
+    /**
+     * @brief Stream every metric in Prometheus text format
+     *
+     * Each family gets one HELP/TYPE header followed by all of its
+     * samples, regardless of registration order. Call out.flush() after.
+     */
+    void render(ChunkedWriter& out) const {
+        for (size_t i = 0; i < count; i++) {
+            // Skip families already written with an earlier entry
+            bool seen = false;
+            for (size_t j = 0; j < i && !seen; j++) {
+                seen = strcmp(entries[j].name, entries[i].name) == 0;
+            }
+            if (seen) continue;
+
+            out.printf("# HELP %s %s\n", entries[i].name, entries[i].help);
+            out.printf("# TYPE %s %s\n", entries[i].name, typeName(entries[i].type));
+
+            for (size_t j = i; j < count; j++) {
+                if (strcmp(entries[j].name, entries[i].name) == 0) {
+                    renderSample(out, entries[j]);
+                }
+            }
+        }
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    /**
+     * @brief Drop all registrations (tests only)
+     */
+    void clear() {
+        count = 0;
+    }
+};
+
+namespace Metrics {
+    /**
+     * @brief Get the process-wide metrics registry
+     */
+    inline MetricsRegistry& registry() {
+        static MetricsRegistry instance;
+        return instance;
+    }
+}
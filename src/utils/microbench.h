@@ -0,0 +1,141 @@
+#pragma once
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+#include "chunked_writer.h"
+#include "time_utils.h"
+
+#ifdef ESP_PLATFORM
+#include <xtensa/hal.h>
+#endif
+
+/**
+ * @file microbench.h
+ * @brief Cycle-counted microbenchmarks that yield between batches
+ *
+ * Each case runs Config::Bench::BATCHES batches of a fixed number of
+ * iterations. Time is read from CCOUNT on device (so results include
+ * flash cache misses and IRAM placement of the real build) and from the
+ * microsecond clock on native. The best batch is reported alongside the
+ * mean: the best is the steady-state cost, the gap to the mean is cache
+ * and preemption noise.
+ *
+ * Between batches the runner calls a yield function, so a long suite
+ * can feed the watchdog and let the BLE tasks run.
+ *
+ * Usage:
+ *   MicroBench bench(&yieldToSystem, nullptr);
+ *   bench.run("validate", &benchValidate, &input, 100);
+ *   bench.writeJson(out);
+ */
+
+struct BenchResult {
+    const char* name;
+    uint32_t iterations;   // Per batch
+    uint32_t bestTicks;    // Best batch, per iteration
+    uint32_t meanTicks;    // All batches, per iteration
+};
+
+class MicroBench {
+public:
+    typedef void (*BenchFn)(void* context, uint32_t iteration);
+    typedef void (*YieldFn)(void* context);
+
+private:
+    BenchResult results[Config::Bench::MAX_CASES];
+    size_t count;
+    YieldFn yieldFn;
+    void* yieldContext;
+
+public:
+    /**
+     * @brief Clock ticks: CPU cycles on device, microseconds on native
+     */
+    static uint32_t ticks() {
+#ifdef ESP_PLATFORM
+        return xthal_get_ccount();
+#else
+        return (uint32_t)TimeUtils::nowUs();
+#endif
+    }
+
+    /**
+     * @brief Tick rate in ticks per microsecond
+     */
+    static uint32_t ticksPerUs() {
+#ifdef ESP_PLATFORM
+        return getCpuFrequencyMhz();
+#else
+        return 1;
+#endif
+    }
+
+    explicit MicroBench(YieldFn fn = nullptr, void* context = nullptr)
+        : count(0), yieldFn(fn), yieldContext(context) {}
+
+    /**
+     * @brief Run one case
+     * @param name Case name (string literal)
+     * @param fn Called iterations times per batch with the iteration index
+     * @param context Passed through to fn
+     * @param iterations Iterations per batch (keep a batch well under a millisecond)
+     * @return false if all result slots are used
+     */
+    bool run(const char* name, BenchFn fn, void* context, uint32_t iterations) {
+        if (count >= Config::Bench::MAX_CASES || iterations == 0) return false;
+
+        uint32_t best = UINT32_MAX;
+        uint64_t total = 0;
+        for (uint32_t batch = 0; batch < Config::Bench::BATCHES; batch++) {
+            if (yieldFn) yieldFn(yieldContext);
+
+            uint32_t start = ticks();
+            for (uint32_t i = 0; i < iterations; i++) {
+                fn(context, i);
+            }
+            uint32_t elapsed = ticks() - start;
+
+            if (elapsed < best) best = elapsed;
+            total += elapsed;
+        }
+
+        BenchResult& r = results[count++];
+        r.name = name;
+        r.iterations = iterations;
+        r.bestTicks = best / iterations;
+        r.meanTicks = (uint32_t)(total / ((uint64_t)iterations * Config::Bench::BATCHES));
+        return true;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    const BenchResult& get(size_t index) const {
+        return results[index];
+    }
+
+    /**
+     * @brief Stream results as one JSON object. Call out.flush() after.
+     */
+    void writeJson(ChunkedWriter& out) const {
+        uint32_t perUs = ticksPerUs();
+        out.printf("{\"unit\":\"%s\",\"ticksPerUs\":%lu,\"batches\":%u,\"results\":{",
+#ifdef ESP_PLATFORM
+                   "cycles",
+#else
+                   "us",
+#endif
+                   (unsigned long)perUs, (unsigned)Config::Bench::BATCHES);
+
+        for (size_t i = 0; i < count; i++) {
+            const BenchResult& r = results[i];
+            out.printf("%s\"%s\":{\"iterations\":%lu,\"best\":%lu,\"mean\":%lu,\"bestNs\":%lu}",
+                       i ? "," : "", r.name, (unsigned long)r.iterations,
+                       (unsigned long)r.bestTicks, (unsigned long)r.meanTicks,
+                       (unsigned long)((uint64_t)r.bestTicks * 1000 / perUs));
+        }
+        out.printf("}}\n");
+    }
+};
@@ -0,0 +1,168 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @file object_pool.h
+ * @brief Fixed-capacity typed pool: allocation without the heap
+ *
+ * Storage for N objects of type T is part of the pool itself (static
+ * RAM when the owner is a global), so create()/destroy() never touch
+ * the heap and can't fragment it. Free slots form an intrusive list:
+ * both operations are O(1). A slot's index is stable for the life of
+ * its object, so owners can refer to objects by a small integer.
+ *
+ * create() returns nullptr when every slot is taken; what to do then
+ * (refuse, evict) is the owner's policy.
+ *
+ * Usage:
+ *   ObjectPool<ClientInfo, 64> pool;
+ *   ClientInfo* info = pool.create(ip, now);
+ *   ...
+ *   pool.destroy(info);
+ */
+
+template <typename T, size_t N>
+class ObjectPool {
+    static_assert(N > 0, "ObjectPool needs at least one slot");
+
+private:
+    union Slot {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type object;
+        Slot* next;  // While free
+    };
+
+    Slot slots[N];
+    Slot* freeList;
+    uint32_t live[(N + 31) / 32];  // Bit per slot: holds an object
+    size_t count;
+    size_t highWater;
+    uint32_t exhausted;  // create() calls refused
+
+    void markLive(size_t index, bool on) {
+        uint32_t bit = (uint32_t)1 << (index % 32);
+        if (on) {
+            live[index / 32] |= bit;
+        } else {
+            live[index / 32] &= ~bit;
+        }
+    }
+
+    void rebuildFreeList() {
+        freeList = nullptr;
+        for (size_t i = N; i-- > 0;) {
+            slots[i].next = freeList;
+            freeList = &slots[i];
+        }
+    }
+
+    ObjectPool(const ObjectPool&);
+    ObjectPool& operator=(const ObjectPool&);
+
+public:
+    ObjectPool() : count(0), highWater(0), exhausted(0) {
+        for (size_t i = 0; i < sizeof(live) / sizeof(live[0]); i++) live[i] = 0;
+        rebuildFreeList();
+    }
+
+    ~ObjectPool() {
+        clear();
+    }
+
+    /**
+     * @brief Construct an object in a free slot
+     * @return nullptr if the pool is full
+     */
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (freeList == nullptr) {
+            exhausted++;
+            return nullptr;
+        }
+        Slot* slot = freeList;
+        freeList = slot->next;
+
+        T* object = new (&slot->object) T(std::forward<Args>(args)...);
+        markLive((size_t)(slot - slots), true);
+        if (++count > highWater) highWater = count;
+        return object;
+    }
+
+    /**
+     * @brief Destroy an object and return its slot (nullptr is ignored)
+     */
+    void destroy(T* object) {
+        if (object == nullptr) return;
+        size_t index = indexOf(object);
+        object->~T();
+        markLive(index, false);
+
+        Slot* slot = &slots[index];
+        slot->next = freeList;
+        freeList = slot;
+        count--;
+    }
+
+    /**
+     * @brief Destroy every object
+     */
+    void clear() {
+        for (size_t i = 0; i < N; i++) {
+            if (isLive(i)) at(i)->~T();
+        }
+        for (size_t i = 0; i < sizeof(live) / sizeof(live[0]); i++) live[i] = 0;
+        count = 0;
+        rebuildFreeList();
+    }
+
+    /**
+     * @brief Slot index of an object from this pool
+     */
+    size_t indexOf(const T* object) const {
+        return (size_t)(reinterpret_cast<const Slot*>(object) - slots);
+    }
+
+    bool isLive(size_t index) const {
+        return index < N && (live[index / 32] >> (index % 32)) & 1;
+    }
+
+    /**
+     * @brief Object in a slot, or nullptr if the slot is free
+     */
+    T* at(size_t index) {
+        return isLive(index) ? reinterpret_cast<T*>(&slots[index].object) : nullptr;
+    }
+
+    const T* at(size_t index) const {
+        return isLive(index) ? reinterpret_cast<const T*>(&slots[index].object) : nullptr;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+    size_t available() const {
+        return N - count;
+    }
+
+    /**
+     * @brief Most objects held at once
+     */
+    size_t getHighWater() const {
+        return highWater;
+    }
+
+    /**
+     * @brief create() calls refused because the pool was full
+     */
+    uint32_t getExhausted() const {
+        return exhausted;
+    }
+};
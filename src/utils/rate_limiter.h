@@ -1,8 +1,9 @@
 #pragma once
-#include <map>
+#include <stdint.h>
 #include <IPAddress.h>
 #include "config.h"
 #include "time_utils.h"
+#include "object_pool.h"
 
 /**
  * @file rate_limiter.h
@@ -10,6 +11,15 @@
  *
  * Prevents abuse by limiting requests per IP address.
  *
+ * Client entries live in a fixed pool of Config::RateLimit::MAX_CLIENTS,
+ * found through an open-addressing index, so checking a request never
+ * allocates. When the pool is full a new client takes the entry of the
+ * client seen least recently; that entry's window has almost always
+ * expired already, so this only matters when more than MAX_CLIENTS
+ * clients are active inside one window. The last client checked is
+ * kept aside and tried before the index, so a single client (the usual
+ * case) skips hashing and probing.
+ *
  * Usage:
  *   RateLimiter limiter;
  *   if (!limiter.checkLimit(server.client().remoteIP())) {
@@ -21,22 +31,107 @@
 class RateLimiter {
 private:
     struct ClientInfo {
+        uint32_t ip;
         unsigned long lastRequestTime;
         uint8_t requestCount;
+
+        ClientInfo(uint32_t address, unsigned long now)
+            : ip(address), lastRequestTime(now), requestCount(1) {}
     };
 
-    std::map<uint32_t, ClientInfo> clients;
+    static constexpr size_t CAPACITY = Config::RateLimit::MAX_CLIENTS;
+    static constexpr size_t INDEX_SIZE = CAPACITY * 2;  // Load factor <= 0.5
+    static constexpr uint16_t EMPTY = 0xFFFF;
+
+    static constexpr unsigned log2(size_t n) {
+        return n <= 1 ? 0 : 1 + log2(n / 2);
+    }
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "MAX_CLIENTS must be a power of two");
+    static_assert(CAPACITY < EMPTY, "MAX_CLIENTS too large for 16-bit slot indexes");
+
+    ObjectPool<ClientInfo, CAPACITY> clients;
+    uint16_t index[INDEX_SIZE];  // Pool slot per bucket, or EMPTY
+    ClientInfo* last;            // Last client checked, nullptr once it is removed
     uint32_t windowMs;
     uint8_t maxRequests;
-    unsigned long lastCleanup;
+    uint32_t evictions;
 
     /**
-     * @brief Convert IPAddress to uint32_t for map key
+     * @brief Convert IPAddress to uint32_t for the index key
      */
     static uint32_t ipToUint32(IPAddress ip) {
         return (uint32_t)ip;
     }
 
+    static size_t bucketOf(uint32_t ip) {
+        // Fibonacci hashing: the top bits mix every octet of the address
+        return (size_t)((uint32_t)(ip * 2654435761u) >> (32 - log2(INDEX_SIZE)));
+    }
+
+    /**
+     * @brief Bucket holding ip, or the empty bucket where it would go
+     */
+    size_t findBucket(uint32_t ip) const {
+        size_t bucket = bucketOf(ip);
+        while (index[bucket] != EMPTY && clients.at(index[bucket])->ip != ip) {
+            bucket = (bucket + 1) % INDEX_SIZE;
+        }
+        return bucket;
+    }
+
+    /**
+     * @brief Drop a client from the index and the pool
+     *
+     * Backward-shift deletion: later entries of the probe run move up,
+     * so lookups never need tombstones.
+     */
+    void remove(uint32_t ip) {
+        size_t hole = findBucket(ip);
+        if (index[hole] == EMPTY) return;
+        ClientInfo* info = clients.at(index[hole]);
+        if (info == last) last = nullptr;
+        clients.destroy(info);
+
+        size_t next = (hole + 1) % INDEX_SIZE;
+        while (index[next] != EMPTY) {
+            size_t home = bucketOf(clients.at(index[next])->ip);
+            // Move up unless its home lies cyclically in (hole, next]
+            bool stays = (hole < next) ? (home > hole && home <= next)
+                                       : (home > hole || home <= next);
+            if (!stays) {
+                index[hole] = index[next];
+                hole = next;
+            }
+            next = (next + 1) % INDEX_SIZE;
+        }
+        index[hole] = EMPTY;
+    }
+
+    /**
+     * @brief Free the entry of the client seen least recently
+     */
+    void evictStalest(unsigned long now) {
+        const ClientInfo* stalest = nullptr;
+        uint32_t stalestAge = 0;
+        for (size_t i = 0; i < CAPACITY; i++) {
+            const ClientInfo* info = clients.at(i);
+            if (info == nullptr) continue;
+            uint32_t age = TimeUtils::timeDiff(info->lastRequestTime, now);
+            if (stalest == nullptr || age > stalestAge) {
+                stalest = info;
+                stalestAge = age;
+            }
+        }
+        if (stalest != nullptr) {
+            remove(stalest->ip);
+            evictions++;
+        }
+    }
+
+    void clearIndex() {
+        for (size_t i = 0; i < INDEX_SIZE; i++) index[i] = EMPTY;
+    }
+
 public:
     /**
      * @brief Construct rate limiter
@@ -46,7 +141,9 @@ public:
     RateLimiter(
         uint32_t window = Config::RateLimit::WINDOW_MS,
         uint8_t max = Config::RateLimit::MAX_REQUESTS
-    ) : windowMs(window), maxRequests(max), lastCleanup(millis()) {}
+    ) : last(nullptr), windowMs(window), maxRequests(max), evictions(0) {
+        clearIndex();
+    }
 
     /**
      * @brief Check if request is within rate limit
@@ -57,16 +154,25 @@ public:
         uint32_t ipInt = ipToUint32(ip);
         unsigned long now = millis();
 
-        // Find or create client entry
-        auto it = clients.find(ipInt);
-
-        if (it == clients.end()) {
-            // New client
-            clients[ipInt] = {now, 1};
-            return true;
+        // Same client as last time?
+        if (last == nullptr || last->ip != ipInt) {
+            // Find or create client entry
+            size_t bucket = findBucket(ipInt);
+
+            if (index[bucket] == EMPTY) {
+                // New client
+                if (clients.available() == 0) {
+                    evictStalest(now);
+                    bucket = findBucket(ipInt);  // The index may have shifted
+                }
+                last = clients.create(ipInt, now);
+                index[bucket] = (uint16_t)clients.indexOf(last);
+                return true;
+            }
+            last = clients.at(index[bucket]);
         }
 
-        ClientInfo& info = it->second;
+        ClientInfo& info = *last;
 
         // Check if we're outside the rate limit window
         if (TimeUtils::timeDiff(info.lastRequestTime, now) >= windowMs) {
@@ -89,25 +195,18 @@ public:
     /**
      * @brief Cleanup old entries (call periodically)
      *
-     * Removes entries for IPs that haven't made requests recently
-     * to prevent unbounded memory growth.
+     * Removes entries for IPs that haven't made requests recently so
+     * the pool has room for new clients. Scheduling is the caller's
+     * job (see Config::RateLimit::CLEANUP_INTERVAL_MS).
      */
     void cleanup() {
         unsigned long now = millis();
 
-        // Only cleanup every 10 windows
-        if (!TimeUtils::hasElapsed(lastCleanup, windowMs * 10)) {
-            return;
-        }
-
-        lastCleanup = now;
-
         // Remove entries older than 10 windows
-        for (auto it = clients.begin(); it != clients.end();) {
-            if (TimeUtils::timeDiff(it->second.lastRequestTime, now) > windowMs * 10) {
-                it = clients.erase(it);
-            } else {
-                ++it;
+        for (size_t i = 0; i < CAPACITY; i++) {
+            const ClientInfo* info = clients.at(i);
+            if (info != nullptr && TimeUtils::timeDiff(info->lastRequestTime, now) > windowMs * 10) {
+                remove(info->ip);
             }
         }
     }
@@ -120,10 +219,19 @@ public:
         return clients.size();
     }
 
+    /**
+     * @brief Clients dropped to make room for a new one since boot
+     */
+    uint32_t getEvictions() const {
+        return evictions;
+    }
+
     /**
      * @brief Clear all rate limit data
      */
     void reset() {
         clients.clear();
+        clearIndex();
+        last = nullptr;
     }
 };
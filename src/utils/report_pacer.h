@@ -0,0 +1,308 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+#include "spsc_ring.h"
+#include "histogram.h"
+#include "time_utils.h"
+#include "metrics.h"
+
+/**
+ * @file report_pacer.h
+ * @brief Fixed-cadence HID report emission from a pre-planned queue
+ *
+ * The main loop plans text into HidReports and pushes them; a periodic
+ * timer calls tick() which emits at most one report per period. Loop
+ * latency therefore only matters if the queue runs dry (an underrun),
+ * not on every chunk.
+ *
+ * Consumer-side telemetry (all fixed-size):
+ * - jitter: deviation of each inter-report interval from the period
+ * - interval: the inter-report interval itself
+ * - pacing wait: how long each report sat queued before its tick
+ * - loop blocked: how long the pacer sat starved (underruns) before
+ *   the loop refilled the queue
+ * Pacing wait is healthy latency; loop-blocked time means the loop is
+ * too slow to keep up.
+ *
+ * Usage:
+ *   ReportPacer pacer;
+ *   pacer.setSink(&emit, context);
+ *
+ *   // Producer (loop):
+ *   pacer.startJob();
+ *   pacer.enqueue(report);
+ *
+ *   // Consumer (timer):
+ *   pacer.tick(nowUs);
+ */
+
+struct HidReport {
+    char text[Config::BLE::TEXT_CHUNK_SIZE + 1];
+    uint8_t length;
+    bool last;  // Final report of the job
+    uint64_t queuedUs;  // Set by enqueue()
+};
+
+class ReportPacer {
+public:
+    typedef bool (*EmitFn)(const HidReport& report, void* context);
+
+    enum class TickResult {
+        IDLE,       // No job active
+        UNDERRUN,   // Job active but the loop hasn't refilled the queue
+        EMITTED,
+        COMPLETED,  // Emitted the final report
+        FAILED      // Sink reported failure; queue drained
+    };
+
+    enum class JobOutcome : uint8_t {
+        NONE,       // No job has finished yet
+        COMPLETED,
+        FAILED,     // Sink reported failure
+        ABORTED     // abort() requested by the producer
+    };
+
+private:
+    SpscRing<HidReport, Config::BLE::REPORT_QUEUE_DEPTH> queue;
+    EmitFn sink;
+    void* sinkContext;
+    uint32_t periodUs;
+
+    std::atomic<bool> jobActive;
+    std::atomic<bool> abortRequested;
+    std::atomic<uint32_t> emittedChars;
+    std::atomic<JobOutcome> lastOutcome;
+
+    // Consumer-side timing state
+    uint64_t lastEmitUs;
+    bool haveLastEmit;
+    uint64_t starvedSinceUs;
+    bool starved;
+    Counter underruns;
+    Counter reports;
+    LogLinearHistogram jitter;
+    LogLinearHistogram interval;
+    LogLinearHistogram pacingWait;
+    LogLinearHistogram loopBlocked;
+
+    void finishJob(JobOutcome outcome) {
+        queue.drain();
+        haveLastEmit = false;
+        starved = false;
+        lastOutcome.store(outcome, std::memory_order_relaxed);
+        jobActive.store(false, std::memory_order_release);
+    }
+
+public:
+    /**
+     * @brief Construct pacer
+     * @param period Nominal interval between reports in microseconds
+     */
+    explicit ReportPacer(uint32_t period = Config::BLE::CHUNK_DELAY_MS * 1000UL)
+        : sink(nullptr), sinkContext(nullptr), periodUs(period),
+          jobActive(false), abortRequested(false), emittedChars(0),
+          lastOutcome(JobOutcome::NONE), lastEmitUs(0), haveLastEmit(false),
+          starvedSinceUs(0), starved(false) {}
+
+    /**
+     * @brief Set report output
+     * @param fn Called from tick() context for each report
+     * @param context Passed through to fn
+     */
+    void setSink(EmitFn fn, void* context) {
+        sink = fn;
+        sinkContext = context;
+    }
+
+    /**
+     * @brief Begin a new job (producer only; previous job must be finished)
+     *
+     * Reports pushed after the consumer finished the last job (the loop
+     * can plan between its isJobActive() check and the drain) are
+     * dropped here, while tick() is idle and won't pop.
+     */
+    void startJob() {
+        queue.discard();
+        emittedChars.store(0, std::memory_order_relaxed);
+        abortRequested.store(false, std::memory_order_relaxed);
+        jobActive.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Queue a planned report (producer only)
+     * @param report Report to send
+     * @param nowUs Current monotonic time, stamped for pacing-wait telemetry
+     * @return false if the queue is full
+     */
+    bool enqueue(HidReport report, uint64_t nowUs = TimeUtils::nowUs()) {
+        report.queuedUs = nowUs;
+        return queue.push(report);
+    }
+
+    /**
+     * @brief Split text into reports and queue as many as fit (producer only)
+     * @param text Job text
+     * @param length Length of text
+     * @param position First unplanned character
+     * @param final false if text is a window onto a longer job: only whole
+     *              chunks are planned and none is marked last
+     * @return New first unplanned character (length once fully planned)
+     */
+    size_t plan(const char* text, size_t length, size_t position, bool final = true) {
+        uint64_t nowUs = TimeUtils::nowUs();
+        while (position < length && freeSlots() > 0) {
+            size_t remaining = length - position;
+            if (!final && remaining < Config::BLE::TEXT_CHUNK_SIZE) {
+                break;  // Wait for the rest of the chunk
+            }
+            size_t chunkLen = (remaining < Config::BLE::TEXT_CHUNK_SIZE)
+                ? remaining
+                : Config::BLE::TEXT_CHUNK_SIZE;
+
+            HidReport report;
+            memcpy(report.text, text + position, chunkLen);
+            report.text[chunkLen] = '\0';
+            report.length = chunkLen;
+            report.last = final && (chunkLen == remaining);
+
+            if (!enqueue(report, nowUs)) {
+                break;
+            }
+            position += chunkLen;
+        }
+        return position;
+    }
+
+    /**
+     * @brief Ask the consumer to drop the current job at its next tick
+     */
+    void abort() {
+        abortRequested.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Emit the next report if one is queued (consumer only)
+     * @param nowUs Current monotonic time in microseconds
+     */
+    TickResult tick(uint64_t nowUs) {
+        if (!jobActive.load(std::memory_order_acquire)) {
+            return TickResult::IDLE;
+        }
+
+        if (abortRequested.load(std::memory_order_acquire)) {
+            finishJob(JobOutcome::ABORTED);
+            return TickResult::FAILED;
+        }
+
+        HidReport report;
+        if (!queue.pop(report)) {
+            underruns.inc();
+            if (!starved) {
+                starved = true;
+                starvedSinceUs = nowUs;
+            }
+            return TickResult::UNDERRUN;
+        }
+
+        if (sink == nullptr || !sink(report, sinkContext)) {
+            finishJob(JobOutcome::FAILED);
+            return TickResult::FAILED;
+        }
+
+        if (haveLastEmit) {
+            uint64_t elapsed = nowUs - lastEmitUs;
+            uint64_t deviation = elapsed > periodUs ? elapsed - periodUs : periodUs - elapsed;
+            jitter.record(TimeUtils::saturateUs(deviation));
+            interval.record(TimeUtils::saturateUs(elapsed));
+        }
+        lastEmitUs = nowUs;
+        haveLastEmit = true;
+
+        if (starved) {
+            loopBlocked.record(TimeUtils::saturateUs(nowUs - starvedSinceUs));
+            starved = false;
+        }
+        pacingWait.record(TimeUtils::saturateUs(nowUs >= report.queuedUs ? nowUs - report.queuedUs : 0));
+        reports.inc();
+
+        emittedChars.fetch_add(report.length, std::memory_order_release);
+
+        if (report.last) {
+            finishJob(JobOutcome::COMPLETED);
+            return TickResult::COMPLETED;
+        }
+        return TickResult::EMITTED;
+    }
+
+    bool isJobActive() const {
+        return jobActive.load(std::memory_order_acquire);
+    }
+
+    uint32_t getEmittedChars() const {
+        return emittedChars.load(std::memory_order_acquire);
+    }
+
+    size_t freeSlots() const {
+        return queue.freeSlots();
+    }
+
+    size_t queuedReports() const {
+        return queue.size();
+    }
+
+    uint32_t getPeriodUs() const {
+        return periodUs;
+    }
+
+    uint32_t getUnderruns() const {
+        return underruns.get();
+    }
+
+    const Counter& getUnderrunCounter() const {
+        return underruns;
+    }
+
+    /**
+     * @brief Reports sent since boot
+     */
+    const Counter& getReportCounter() const {
+        return reports;
+    }
+
+    /**
+     * @brief How the most recent job ended
+     */
+    JobOutcome getLastOutcome() const {
+        return lastOutcome.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Deviation of inter-report intervals from the nominal period (us)
+     */
+    const LogLinearHistogram& getJitterHistogram() const {
+        return jitter;
+    }
+
+    /**
+     * @brief Actual inter-report intervals (us)
+     */
+    const LogLinearHistogram& getIntervalHistogram() const {
+        return interval;
+    }
+
+    /**
+     * @brief Time each report waited in the queue for its tick (us)
+     */
+    const LogLinearHistogram& getPacingWaitHistogram() const {
+        return pacingWait;
+    }
+
+    /**
+     * @brief Length of each starvation episode, underrun to refill (us)
+     */
+    const LogLinearHistogram& getLoopBlockedHistogram() const {
+        return loopBlocked;
+    }
+};
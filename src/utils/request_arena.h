@@ -0,0 +1,133 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "config.h"
+
+/**
+ * @file request_arena.h
+ * @brief Bump allocator for the request being handled
+ *
+ * Argument copies, validation scratch and response bodies are carved
+ * from one fixed buffer and all released together by reset() when the
+ * request ends, so handling a request neither fragments the heap nor
+ * puts kilobyte arrays on the loop task's stack. The server handles
+ * one connection at a time, so one arena serves every request.
+ *
+ * Allocation never falls back to the heap: when the arena is full the
+ * call returns nullptr and the handler rejects the request.
+ *
+ * Usage:
+ *   RequestArena arena;
+ *   char* json = arena.allocChars(1024);
+ *   const char* reply = arena.format("LED is now %s", "ON");
+ *   ...
+ *   arena.reset();  // Request done
+ */
+
+class RequestArena {
+public:
+    static constexpr size_t ALIGN = 8;
+
+private:
+    alignas(ALIGN) uint8_t storage[Config::HTTP::ARENA_BYTES];
+    size_t used;
+    size_t highWater;  // Most used by one request
+    uint32_t failures; // Allocations refused since boot
+
+    static size_t alignUp(size_t offset, size_t align) {
+        return (offset + align - 1) & ~(align - 1);
+    }
+
+public:
+    RequestArena() : used(0), highWater(0), failures(0) {}
+
+    /**
+     * @brief Allocate size bytes aligned to align (a power of two <= ALIGN)
+     * @return nullptr if the arena can't hold it
+     */
+    void* allocate(size_t size, size_t align = ALIGN) {
+        size_t start = alignUp(used, align);
+        if (start > sizeof(storage) || size > sizeof(storage) - start) {
+            failures++;
+            return nullptr;
+        }
+        used = start + size;
+        if (used > highWater) highWater = used;
+        return storage + start;
+    }
+
+    char* allocChars(size_t count) {
+        return static_cast<char*>(allocate(count, 1));
+    }
+
+    /**
+     * @brief NUL-terminated copy of length bytes of text
+     */
+    char* copy(const char* text, size_t length) {
+        char* out = allocChars(length + 1);
+        if (out == nullptr) return nullptr;
+        memcpy(out, text, length);
+        out[length] = '\0';
+        return out;
+    }
+
+    /**
+     * @brief Format into the arena, taking only the bytes written
+     * @return nullptr if the text doesn't fit
+     */
+    char* format(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        char* out = reinterpret_cast<char*>(storage + used);
+        size_t space = sizeof(storage) - used;
+
+        va_list args;
+        va_start(args, fmt);
+        int length = vsnprintf(out, space, fmt, args);
+        va_end(args);
+
+        if (length < 0 || (size_t)length >= space) {
+            failures++;
+            return nullptr;
+        }
+        return allocChars((size_t)length + 1);  // Claims what vsnprintf wrote
+    }
+
+    /**
+     * @brief Current position, for rewind()
+     */
+    size_t mark() const {
+        return used;
+    }
+
+    /**
+     * @brief Release everything allocated since mark
+     */
+    void rewind(size_t mark) {
+        if (mark < used) used = mark;
+    }
+
+    /**
+     * @brief Release everything (O(1); nothing is destroyed)
+     */
+    void reset() {
+        used = 0;
+    }
+
+    size_t getUsed() const {
+        return used;
+    }
+
+    size_t getCapacity() const {
+        return sizeof(storage);
+    }
+
+    size_t getHighWater() const {
+        return highWater;
+    }
+
+    uint32_t getFailures() const {
+        return failures;
+    }
+};
@@ -0,0 +1,158 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+#include "error_codes.h"
+#include "chunked_writer.h"
+
+/**
+ * @file request_capture.h
+ * @brief Ring buffer of recent HTTP requests for offline replay
+ *
+ * While enabled, each handled request is recorded with its arrival time,
+ * handler time, client, outcome, the BLE state it saw and a prefix of
+ * its "msg" argument (with the full length, so replay can type a message
+ * of the same size). The ring overwrites the oldest record when full.
+ *
+ * The API key is never stored; a capture holds typed text, so export it
+ * only over an authenticated route. writeJson() emits one record per
+ * line, which tools/replay reads without a JSON library; the writer's
+ * buffer must hold a record's fields (~300 bytes, CHUNK_SIZE is plenty).
+ *
+ * Usage:
+ *   RequestCapture capture;
+ *   capture.setEnabled(true);
+ *   CapturedRequest r = ...;
+ *   capture.add(r);
+ *   capture.writeJson(out);
+ */
+
+struct CapturedRequest {
+    uint64_t atUs;          // Handler start on the microsecond clock
+    uint32_t durationUs;    // Handler time, including the response write
+    uint32_t clientIp;      // IPv4, most significant octet first
+    const char* path;       // Static route path
+    const char* method;     // "GET", "POST", ...
+    ErrorCode result;       // SUCCESS or the error that was sent
+    bool bleConnected;      // BLE state at arrival
+    bool bleBusy;
+    uint16_t bodyLength;    // Full length of "msg"
+    uint8_t bodyStored;     // Bytes of it kept in body
+    char body[Config::Capture::BODY_BYTES];
+};
+
+class RequestCapture {
+private:
+    CapturedRequest records[Config::Capture::RECORDS];
+    size_t next;      // Slot the next record goes into
+    size_t count;     // Valid records (<= RECORDS)
+    uint32_t total;   // Recorded since the last clear()
+    bool enabled;
+
+    /**
+     * @brief Write bytes as the body of a JSON string
+     */
+    static void writeEscaped(ChunkedWriter& out, const char* text, size_t length) {
+        char escaped[6 * 16 + 1];
+        size_t used = 0;
+        for (size_t i = 0; i < length; i++) {
+            unsigned char c = (unsigned char)text[i];
+            if (c == '"' || c == '\\') {
+                escaped[used++] = '\\';
+                escaped[used++] = (char)c;
+            } else if (c < 0x20 || c >= 0x7f) {
+                used += snprintf(escaped + used, sizeof(escaped) - used, "\\u%04x", c);
+            } else {
+                escaped[used++] = (char)c;
+            }
+            if (used > sizeof(escaped) - 7 || i + 1 == length) {
+                escaped[used] = '\0';
+                out.printf("%s", escaped);
+                used = 0;
+            }
+        }
+    }
+
+public:
+    RequestCapture() : next(0), count(0), total(0), enabled(Config::Capture::ENABLED_AT_BOOT) {}
+
+    void setEnabled(bool on) {
+        enabled = on;
+    }
+
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    void clear() {
+        next = 0;
+        count = 0;
+        total = 0;
+    }
+
+    /**
+     * @brief Record a request (no-op while disabled)
+     */
+    void add(const CapturedRequest& request) {
+        if (!enabled) return;
+        records[next] = request;
+        next = (next + 1) % Config::Capture::RECORDS;
+        if (count < Config::Capture::RECORDS) count++;
+        total++;
+    }
+
+    /**
+     * @brief Keep a prefix of a body in a record
+     */
+    static void setBody(CapturedRequest& request, const char* text, size_t length) {
+        size_t stored = length < sizeof(request.body) ? length : sizeof(request.body);
+        memcpy(request.body, text, stored);
+        request.bodyStored = (uint8_t)stored;
+        request.bodyLength = (uint16_t)(length > 0xFFFF ? 0xFFFF : length);
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    /**
+     * @brief Record by age, 0 = oldest still held
+     */
+    const CapturedRequest& get(size_t index) const {
+        size_t oldest = (next + Config::Capture::RECORDS - count) % Config::Capture::RECORDS;
+        return records[(oldest + index) % Config::Capture::RECORDS];
+    }
+
+    /**
+     * @brief Requests overwritten before they could be exported
+     */
+    uint32_t getDropped() const {
+        return total - (uint32_t)count;
+    }
+
+    /**
+     * @brief Stream the held records, oldest first, one per line
+     */
+    void writeJson(ChunkedWriter& out) const {
+        out.printf("{\"version\":1,\"enabled\":%s,\"recorded\":%lu,\"dropped\":%lu,"
+                   "\"records\":[\n",
+                   enabled ? "true" : "false", (unsigned long)total,
+                   (unsigned long)getDropped());
+
+        for (size_t i = 0; i < count; i++) {
+            const CapturedRequest& r = get(i);
+            out.printf("{\"atUs\":%llu,\"durUs\":%lu,\"ip\":\"%u.%u.%u.%u\","
+                       "\"method\":\"%s\",\"path\":\"%s\",\"result\":\"%s\","
+                       "\"bleConnected\":%s,\"bleBusy\":%s,\"bodyLength\":%u,\"body\":\"",
+                       (unsigned long long)r.atUs, (unsigned long)r.durationUs,
+                       (unsigned)(r.clientIp >> 24), (unsigned)((r.clientIp >> 16) & 0xFF),
+                       (unsigned)((r.clientIp >> 8) & 0xFF), (unsigned)(r.clientIp & 0xFF),
+                       r.method, r.path, errorCodeName(r.result),
+                       r.bleConnected ? "true" : "false", r.bleBusy ? "true" : "false",
+                       (unsigned)r.bodyLength);
+            writeEscaped(out, r.body, r.bodyStored);
+            out.printf("\"}%s\n", i + 1 < count ? "," : "");
+        }
+        out.printf("]}\n");
+    }
+};
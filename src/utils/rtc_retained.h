@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include <esp_attr.h>
+#endif
+
+/**
+ * @file rtc_retained.h
+ * @brief Storage that survives a software reset (panic, watchdog, restart)
+ *
+ * RTC_RETAINED places a variable in RTC slow memory without zeroing it
+ * at boot, so the next boot can read what the previous one left behind.
+ * Contents are garbage after power-on; guard every record with a magic
+ * value (and clear it once consumed).
+ *
+ * On native builds it is an ordinary static.
+ *
+ * Usage:
+ *   static RTC_RETAINED MyRecord record;
+ *   if (record.magic == MY_MAGIC) { ... previous boot's data ... }
+ */
+
+#ifdef ESP_PLATFORM
+#define RTC_RETAINED RTC_NOINIT_ATTR
+#else
+#define RTC_RETAINED
+#endif
@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#endif
+
+/**
+ * @file seqlock.h
+ * @brief Sequence lock for publishing small structs across tasks
+ *
+ * Writers bump an odd/even sequence counter around each update; readers
+ * copy the value and retry if the sequence changed underneath them.
+ * Readers never block writers and never see a half-written value.
+ *
+ * Writers are serialized with a critical section on ESP32 (so a writer
+ * on the BLE core and one on the loop core cannot interleave) and with
+ * a spin flag on native builds.
+ *
+ * T must be trivially copyable.
+ *
+ * Usage:
+ *   SeqLock<Status> status;
+ *
+ *   // Writer (any task/core):
+ *   status.update([](Status& s) { s.busy = true; });
+ *
+ *   // Reader (any task/core):
+ *   Status copy = status.read();
+ */
+
+template <typename T>
+class SeqLock {
+private:
+    std::atomic<uint32_t> sequence;
+    T value;
+
+#ifdef ESP_PLATFORM
+    portMUX_TYPE writerMux;
+
+    void lockWriter() { portENTER_CRITICAL(&writerMux); }
+    void unlockWriter() { portEXIT_CRITICAL(&writerMux); }
+#else
+    std::atomic_flag writerFlag;
+
+    void lockWriter() {
+        while (writerFlag.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+    void unlockWriter() { writerFlag.clear(std::memory_order_release); }
+#endif
+
+public:
+    SeqLock() : sequence(0) {
+        memset(&value, 0, sizeof(value));
+#ifdef ESP_PLATFORM
+        writerMux = portMUX_INITIALIZER_UNLOCKED;
+#else
+        writerFlag.clear();
+#endif
+    }
+
+    /**
+     * @brief Modify the protected value in place
+     * @param fn Callable taking T& - keep it short, it runs with writers locked
+     */
+    template <typename Fn>
+    void update(Fn fn) {
+        lockWriter();
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        fn(value);
+
+        sequence.store(seq + 2, std::memory_order_release);
+        unlockWriter();
+    }
+
+    /**
+     * @brief Replace the protected value
+     * @param newValue Value to publish
+     */
+    void write(const T& newValue) {
+        update([&newValue](T& v) { memcpy(&v, &newValue, sizeof(T)); });
+    }
+
+    /**
+     * @brief Attempt a single consistent read
+     * @param out Receives the value if the read was consistent
+     * @return false if a writer was active; retry
+     */
+    bool tryRead(T& out) const {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+
+        memcpy(&out, const_cast<const T*>(&value), sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    /**
+     * @brief Read a consistent copy, retrying while writers are active
+     * @return Snapshot of the protected value
+     */
+    T read() const {
+        T out;
+        while (!tryRead(out)) {
+        }
+        return out;
+    }
+
+    /**
+     * @brief Get current sequence number
+     * @return Even when idle; increases by 2 per update
+     */
+    uint32_t getSequence() const {
+        return sequence.load(std::memory_order_acquire);
+    }
+};
@@ -0,0 +1,565 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "config.h"
+#include "error_codes.h"
+#include "validation.h"
+#include "flash_region.h"
+#include "lzss.h"
+#include "crc32.h"
+#include "chunked_writer.h"
+
+/**
+ * @file snippet_store.h
+ * @brief Named text templates, compressed in a flash partition
+ *
+ * Texts that clients type again and again (boilerplate, sign-offs,
+ * login sequences) are uploaded once. Upload validates the text,
+ * compiles each {name} placeholder into a two-byte marker, compresses
+ * the result (LZSS) and writes it to its own 4 KB sector of the
+ * "snippets" partition. Typing one later only reads flash: a
+ * SnippetReader decompresses a few bytes at a time and splices in the
+ * variable values, so neither the template nor the expanded text is
+ * ever held in RAM whole.
+ *
+ * Template syntax: {name} is replaced by the value of variable name
+ * (letters, digits, '_'); {{ and }} stand for literal braces.
+ *
+ * A sector is written body first and header last, and the header's
+ * CRC covers both, so a write cut short by a reset leaves the slot
+ * empty rather than corrupt. Replacing a snippet writes the new copy
+ * to a free slot before erasing the old one; one slot is kept free for
+ * that, so the store holds at most SLOTS - 1 snippets.
+ *
+ * A reader streams its snippet out of flash for as long as the job
+ * typing it runs, so the snippet last opened can't be replaced or
+ * removed until close().
+ *
+ * Usage:
+ *   SnippetStore store;
+ *   store.begin();
+ *   if (store.compile(text, length) == ErrorCode::SUCCESS) store.save("sig");
+ *
+ *   SnippetReader reader;
+ *   store.open("sig", reader);
+ *   reader.setValue(0, "Ana", 3);
+ *   reader.start();
+ *   size_t n = reader.read(buffer, sizeof(buffer));
+ *   store.close();  // When the job typing it has ended
+ */
+
+/**
+ * @brief Slot header as stored in flash
+ */
+struct SnippetHeader {
+    static constexpr uint32_t MAGIC = 0x31504E53;  // "SNP1"
+
+    uint32_t magic;
+    uint32_t crc;            // Of the body, then the header after this field
+    char name[Config::Snippets::MAX_NAME_LENGTH + 1];
+    uint16_t textLength;     // Literal characters (placeholders not counted)
+    uint16_t compiledLength; // Decompressed stream length
+    uint16_t storedLength;   // Compressed body length
+    uint8_t variableCount;
+    uint8_t reserved;
+    char variables[Config::Snippets::MAX_VARIABLES][Config::Snippets::MAX_VARIABLE_NAME + 1];
+    uint16_t uses[Config::Snippets::MAX_VARIABLES];  // Placeholders per variable
+};
+
+/**
+ * @brief Streams one snippet's expanded text out of flash
+ */
+class SnippetReader {
+public:
+    static constexpr uint8_t MARKER = 0x01;  // Followed by a variable index
+
+private:
+    const FlashRegion* flash;
+    size_t bodyOffset;
+    size_t bodyRead;
+    SnippetHeader header;
+    Lzss::Decoder decoder;
+
+    char values[Config::Snippets::VALUE_BYTES];
+    uint16_t valueStart[Config::Snippets::MAX_VARIABLES];
+    uint16_t valueLength[Config::Snippets::MAX_VARIABLES];
+    size_t valuesUsed;
+
+    const char* pending;     // Rest of the value being spliced in
+    size_t pendingLength;
+
+    static size_t readBody(uint8_t* out, size_t max, void* context) {
+        SnippetReader* self = static_cast<SnippetReader*>(context);
+        size_t left = self->header.storedLength - self->bodyRead;
+        size_t n = max < left ? max : left;
+        if (n == 0 || !self->flash->read(self->bodyOffset + self->bodyRead, out, n)) return 0;
+        self->bodyRead += n;
+        return n;
+    }
+
+    friend class SnippetStore;
+
+    void load(const FlashRegion* region, size_t slotOffset, const SnippetHeader& h) {
+        flash = region;
+        bodyOffset = slotOffset + sizeof(SnippetHeader);
+        header = h;
+        valuesUsed = 0;
+        for (size_t i = 0; i < Config::Snippets::MAX_VARIABLES; i++) {
+            valueStart[i] = 0;
+            valueLength[i] = 0;
+        }
+    }
+
+public:
+    SnippetReader() : flash(nullptr), bodyOffset(0), bodyRead(0), valuesUsed(0),
+                      pending(nullptr), pendingLength(0) {
+        memset(&header, 0, sizeof(header));
+    }
+
+    const SnippetHeader& getHeader() const {
+        return header;
+    }
+
+    /**
+     * @brief Set the value of variable index (copied)
+     * @return false if the values of this job don't fit VALUE_BYTES
+     */
+    bool setValue(size_t index, const char* text, size_t length) {
+        if (index >= header.variableCount) return false;
+        if (length > sizeof(values) - valuesUsed) return false;
+        memcpy(values + valuesUsed, text, length);
+        valueStart[index] = (uint16_t)valuesUsed;
+        valueLength[index] = (uint16_t)length;
+        valuesUsed += length;
+        return true;
+    }
+
+    /**
+     * @brief Length of the text with the current values
+     */
+    size_t length() const {
+        size_t total = header.textLength;
+        for (size_t i = 0; i < header.variableCount; i++) {
+            total += (size_t)header.uses[i] * valueLength[i];
+        }
+        return total;
+    }
+
+    /**
+     * @brief Rewind to the start of the text (after the values are set)
+     */
+    void start() {
+        bodyRead = 0;
+        pending = nullptr;
+        pendingLength = 0;
+        decoder.begin(&SnippetReader::readBody, this, header.compiledLength);
+    }
+
+    /**
+     * @brief Next bytes of the expanded text
+     * @return Bytes written (0 at the end, or if flash can't be read)
+     */
+    size_t read(char* out, size_t max) {
+        size_t n = 0;
+        while (n < max) {
+            if (pendingLength > 0) {
+                size_t take = pendingLength < max - n ? pendingLength : max - n;
+                memcpy(out + n, pending, take);
+                pending += take;
+                pendingLength -= take;
+                n += take;
+                continue;
+            }
+
+            uint8_t byte;
+            if (!decoder.next(byte)) break;
+            if (byte == MARKER) {
+                uint8_t index;
+                if (!decoder.next(index) || index >= header.variableCount) break;
+                pending = values + valueStart[index];
+                pendingLength = valueLength[index];
+                continue;
+            }
+            out[n++] = (char)byte;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Read and drop the next count bytes (to resume part-way)
+     * @return Bytes dropped (fewer at the end of the text)
+     */
+    size_t skip(size_t count) {
+        char scratch[64];
+        size_t done = 0;
+        while (done < count) {
+            size_t want = count - done < sizeof(scratch) ? count - done : sizeof(scratch);
+            size_t n = read(scratch, want);
+            if (n == 0) break;
+            done += n;
+        }
+        return done;
+    }
+
+    /**
+     * @brief CRC-32 of the whole expanded text (reads it through; start() again after)
+     */
+    uint32_t textCrc() {
+        char scratch[64];
+        uint32_t crc = 0;
+        start();
+        for (size_t n; (n = read(scratch, sizeof(scratch))) > 0;) {
+            crc = Crc32::update(crc, scratch, n);
+        }
+        return crc;
+    }
+
+    /**
+     * @brief read() with a void* context, for BLEKeyboardManager::queueStream()
+     */
+    static size_t readText(char* out, size_t max, void* context) {
+        return static_cast<SnippetReader*>(context)->read(out, max);
+    }
+};
+
+class SnippetStore {
+public:
+    static constexpr size_t SLOT_BYTES = FlashRegion::SECTOR_SIZE;
+    static constexpr size_t BODY_BYTES = SLOT_BYTES - sizeof(SnippetHeader);
+
+private:
+    FlashRegion flash;
+    bool slotUsed[Config::Snippets::SLOTS];
+    char slotName[Config::Snippets::SLOTS][Config::Snippets::MAX_NAME_LENGTH + 1];
+    uint32_t corrupt;  // Slots dropped at boot (bad CRC)
+    int openSlot;      // Slot a reader is streaming, -1 if none
+
+    // Upload scratch: compile() fills it, save() writes it
+    SnippetHeader pendingHeader;
+    uint8_t compiled[Config::Snippets::MAX_TEXT_LENGTH];
+    bool compiledReady;
+
+    struct WriteCursor {
+        FlashRegion* flash;
+        size_t offset;
+        size_t written;
+        uint32_t crc;
+        bool overflow;  // Didn't compress into one sector
+    };
+
+    static bool writeBody(const uint8_t* data, size_t length, void* context) {
+        WriteCursor* cursor = static_cast<WriteCursor*>(context);
+        if (length > BODY_BYTES - cursor->written) {
+            cursor->overflow = true;
+            return false;
+        }
+        if (!cursor->flash->write(cursor->offset + cursor->written, data, length)) return false;
+        cursor->written += length;
+        cursor->crc = Crc32::update(cursor->crc, data, length);
+        return true;
+    }
+
+    static size_t slotOffset(size_t slot) {
+        return slot * SLOT_BYTES;
+    }
+
+    static uint32_t headerCrc(uint32_t bodyCrc, const SnippetHeader& header) {
+        const uint8_t* start = reinterpret_cast<const uint8_t*>(&header.name);
+        const uint8_t* end = reinterpret_cast<const uint8_t*>(&header) + sizeof(header);
+        return Crc32::update(bodyCrc, start, (size_t)(end - start));
+    }
+
+    /**
+     * @brief Check a slot's header and body against the CRC
+     */
+    bool verifySlot(size_t slot, SnippetHeader& header) const {
+        if (!flash.read(slotOffset(slot), &header, sizeof(header))) return false;
+        if (header.magic != SnippetHeader::MAGIC) return false;
+        if (header.storedLength > BODY_BYTES ||
+            header.variableCount > Config::Snippets::MAX_VARIABLES) {
+            return false;
+        }
+
+        uint8_t chunk[64];
+        uint32_t crc = 0;
+        size_t offset = slotOffset(slot) + sizeof(header);
+        for (size_t done = 0; done < header.storedLength;) {
+            size_t n = header.storedLength - done;
+            if (n > sizeof(chunk)) n = sizeof(chunk);
+            if (!flash.read(offset + done, chunk, n)) return false;
+            crc = Crc32::update(crc, chunk, n);
+            done += n;
+        }
+        return headerCrc(crc, header) == header.crc;
+    }
+
+    int findSlot(const char* name) const {
+        for (size_t i = 0; i < Config::Snippets::SLOTS; i++) {
+            if (slotUsed[i] && strcmp(slotName[i], name) == 0) return (int)i;
+        }
+        return -1;
+    }
+
+    int findFreeSlot() const {
+        for (size_t i = 0; i < Config::Snippets::SLOTS; i++) {
+            if (!slotUsed[i]) return (int)i;
+        }
+        return -1;
+    }
+
+    static bool isNameChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               (c >= '0' && c <= '9') || c == '_';
+    }
+
+    /**
+     * @brief Index of a variable, added on first use
+     * @return -1 if there are already MAX_VARIABLES
+     */
+    int variableIndex(SnippetHeader& header, const char* name, size_t length) {
+        for (size_t i = 0; i < header.variableCount; i++) {
+            if (strlen(header.variables[i]) == length &&
+                memcmp(header.variables[i], name, length) == 0) {
+                return (int)i;
+            }
+        }
+        if (header.variableCount == Config::Snippets::MAX_VARIABLES) return -1;
+        memcpy(header.variables[header.variableCount], name, length);
+        header.variables[header.variableCount][length] = '\0';
+        return header.variableCount++;
+    }
+
+public:
+    SnippetStore() : corrupt(0), openSlot(-1), compiledReady(false) {
+        for (size_t i = 0; i < Config::Snippets::SLOTS; i++) {
+            slotUsed[i] = false;
+            slotName[i][0] = '\0';
+        }
+        memset(&pendingHeader, 0, sizeof(pendingHeader));
+    }
+
+    /**
+     * @brief Open the partition and index the stored snippets (call in setup())
+     * @return false if the partition table has no "snippets" partition
+     */
+    bool begin() {
+        if (!flash.begin(Config::Snippets::PARTITION, Config::Snippets::SLOTS * SLOT_BYTES)) {
+            return false;
+        }
+        size_t slots = flash.size() / SLOT_BYTES;
+        for (size_t i = 0; i < Config::Snippets::SLOTS; i++) {
+            SnippetHeader header;
+            header.magic = 0xFFFFFFFF;
+            slotUsed[i] = i < slots && verifySlot(i, header);
+            if (slotUsed[i]) {
+                memcpy(slotName[i], header.name, sizeof(slotName[i]));
+                slotName[i][Config::Snippets::MAX_NAME_LENGTH] = '\0';
+            } else if (i < slots && header.magic != 0xFFFFFFFF) {
+                corrupt++;  // Torn write or bit rot; the slot is reused
+            }
+        }
+        return true;
+    }
+
+    bool isOpen() const {
+        return flash.isOpen();
+    }
+
+    /**
+     * @brief Whether name is a valid snippet name
+     */
+    static bool isValidName(const char* name) {
+        size_t length = strlen(name);
+        if (length == 0 || length > Config::Snippets::MAX_NAME_LENGTH) return false;
+        for (size_t i = 0; i < length; i++) {
+            if (!isNameChar(name[i])) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Validate a template and compile it into the upload scratch
+     * @return INVALID_PARAMETER for a malformed placeholder, or the
+     *         message validation error
+     */
+    ErrorCode compile(const char* text, size_t length) {
+        compiledReady = false;
+        Validation::ValidationResult valid =
+            Validation::validateText(text, length, Config::Snippets::MAX_TEXT_LENGTH);
+        if (!valid.valid) return valid.errorCode;
+
+        SnippetHeader& header = pendingHeader;
+        memset(&header, 0, sizeof(header));
+        size_t out = 0;
+        size_t literal = 0;
+
+        for (size_t i = 0; i < length;) {
+            char c = text[i];
+            bool doubled = i + 1 < length && text[i + 1] == c;
+            if ((c == '{' || c == '}') && doubled) {
+                compiled[out++] = (uint8_t)c;  // Escaped brace
+                literal++;
+                i += 2;
+            } else if (c == '{') {
+                size_t nameStart = i + 1;
+                size_t nameEnd = nameStart;
+                while (nameEnd < length && isNameChar(text[nameEnd])) nameEnd++;
+                size_t nameLength = nameEnd - nameStart;
+                if (nameEnd == length || text[nameEnd] != '}' || nameLength == 0 ||
+                    nameLength > Config::Snippets::MAX_VARIABLE_NAME) {
+                    return ErrorCode::INVALID_PARAMETER;
+                }
+                int index = variableIndex(header, text + nameStart, nameLength);
+                if (index < 0) return ErrorCode::INVALID_PARAMETER;
+                header.uses[index]++;
+                compiled[out++] = SnippetReader::MARKER;
+                compiled[out++] = (uint8_t)index;
+                i = nameEnd + 1;
+            } else {
+                compiled[out++] = (uint8_t)c;
+                literal++;
+                i++;
+            }
+        }
+
+        header.textLength = (uint16_t)literal;
+        header.compiledLength = (uint16_t)out;
+        compiledReady = true;
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Compress and write the compiled template under name
+     * @return MESSAGE_TOO_LONG if it doesn't compress into one sector,
+     *         STORAGE_FULL if a new name would take the spare slot, BUSY
+     *         if the snippet is open for reading
+     */
+    ErrorCode save(const char* name) {
+        if (!compiledReady || !isValidName(name)) return ErrorCode::INVALID_PARAMETER;
+        if (!isOpen()) return ErrorCode::INTERNAL_ERROR;
+
+        int previous = findSlot(name);
+        if (previous >= 0 && previous == openSlot) return ErrorCode::BUSY;
+        if (previous < 0 && size() >= getCapacity()) return ErrorCode::STORAGE_FULL;
+        int slot = findFreeSlot();
+        if (slot < 0) return ErrorCode::STORAGE_FULL;  // Filled before the spare was kept
+
+        size_t offset = slotOffset((size_t)slot);
+        if (!flash.erase(offset, SLOT_BYTES)) return ErrorCode::INTERNAL_ERROR;
+
+        WriteCursor cursor = { &flash, offset + sizeof(SnippetHeader), 0, 0, false };
+        if (!Lzss::compress(compiled, pendingHeader.compiledLength, &SnippetStore::writeBody, &cursor)) {
+            flash.erase(offset, SLOT_BYTES);
+            return cursor.overflow ? ErrorCode::MESSAGE_TOO_LONG : ErrorCode::INTERNAL_ERROR;
+        }
+
+        SnippetHeader& header = pendingHeader;
+        header.magic = SnippetHeader::MAGIC;
+        strncpy(header.name, name, sizeof(header.name) - 1);
+        header.storedLength = (uint16_t)cursor.written;
+        header.crc = headerCrc(cursor.crc, header);
+        if (!flash.write(offset, &header, sizeof(header))) {
+            flash.erase(offset, SLOT_BYTES);
+            return ErrorCode::INTERNAL_ERROR;
+        }
+
+        if (previous >= 0) {
+            flash.erase(slotOffset((size_t)previous), SLOT_BYTES);
+            slotUsed[previous] = false;
+        }
+        slotUsed[slot] = true;
+        memcpy(slotName[slot], header.name, sizeof(slotName[slot]));
+        compiledReady = false;
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Header of the template last compiled (valid after compile())
+     */
+    const SnippetHeader& getCompiled() const {
+        return pendingHeader;
+    }
+
+    /**
+     * @brief Delete a snippet
+     * @return NOT_FOUND, or BUSY if it is open for reading
+     */
+    ErrorCode remove(const char* name) {
+        int slot = findSlot(name);
+        if (slot < 0) return ErrorCode::NOT_FOUND;
+        if (slot == openSlot) return ErrorCode::BUSY;
+        if (!flash.erase(slotOffset((size_t)slot), SLOT_BYTES)) return ErrorCode::INTERNAL_ERROR;
+        slotUsed[slot] = false;
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Point reader at a snippet; set its values, then start() it
+     *
+     * The snippet stays open (save() and remove() refuse it) until
+     * close() or the next open().
+     */
+    ErrorCode open(const char* name, SnippetReader& reader) {
+        int slot = findSlot(name);
+        if (slot < 0) return ErrorCode::NOT_FOUND;
+        SnippetHeader header;
+        if (!flash.read(slotOffset((size_t)slot), &header, sizeof(header))) {
+            return ErrorCode::INTERNAL_ERROR;
+        }
+        reader.load(&flash, slotOffset((size_t)slot), header);
+        openSlot = slot;
+        return ErrorCode::SUCCESS;
+    }
+
+    /**
+     * @brief Release the snippet last opened (its reader is done with it)
+     */
+    void close() {
+        openSlot = -1;
+    }
+
+    size_t size() const {
+        size_t count = 0;
+        for (size_t i = 0; i < Config::Snippets::SLOTS; i++) {
+            if (slotUsed[i]) count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Most snippets the store holds (one slot is the spare)
+     */
+    static constexpr size_t getCapacity() {
+        return Config::Snippets::SLOTS - 1;
+    }
+
+    uint32_t getCorrupt() const {
+        return corrupt;
+    }
+
+    /**
+     * @brief List the stored snippets as JSON
+     */
+    void writeJson(ChunkedWriter& out) const {
+        size_t used = size();
+        out.printf("{\"free\":%u,\"snippets\":[",
+                   (unsigned)(used < getCapacity() ? getCapacity() - used : 0));
+        bool first = true;
+        for (size_t i = 0; i < Config::Snippets::SLOTS; i++) {
+            SnippetHeader header;
+            if (!slotUsed[i] || !flash.read(slotOffset(i), &header, sizeof(header))) continue;
+
+            out.printf("%s{\"name\":\"%s\",\"length\":%u,\"stored\":%u,\"variables\":[",
+                       first ? "" : ",", slotName[i], (unsigned)header.textLength,
+                       (unsigned)header.storedLength);
+            for (size_t v = 0; v < header.variableCount && v < Config::Snippets::MAX_VARIABLES; v++) {
+                header.variables[v][Config::Snippets::MAX_VARIABLE_NAME] = '\0';
+                out.printf("%s\"%s\"", v ? "," : "", header.variables[v]);
+            }
+            out.printf("]}");
+            first = false;
+        }
+        out.printf("]}\n");
+    }
+};
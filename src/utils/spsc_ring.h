@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file spsc_ring.h
+ * @brief Lock-free single-producer / single-consumer ring buffer
+ *
+ * One task pushes, one other task (or timer context) pops. No locks,
+ * no allocation; capacity must be a power of two.
+ *
+ * Usage:
+ *   SpscRing<Report, 16> queue;
+ *   queue.push(report);          // producer
+ *   Report r;
+ *   if (queue.pop(r)) { ... }    // consumer
+ */
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+private:
+    T slots[N];
+    std::atomic<uint32_t> head;  // Next slot to write (producer owned)
+    std::atomic<uint32_t> tail;  // Next slot to read (consumer owned)
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    /**
+     * @brief Push an item (producer only)
+     * @return false if the ring is full
+     */
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            return false;
+        }
+        slots[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pop an item (consumer only)
+     * @return false if the ring is empty
+     */
+    bool pop(T& out) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = slots[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Discard all queued items (consumer only)
+     */
+    void drain() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /**
+     * @brief Discard all queued items (producer only)
+     *
+     * Only while the consumer is known not to pop, e.g. between jobs:
+     * it moves head back to tail, under the consumer's feet otherwise.
+     */
+    void discard() {
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    size_t freeSlots() const {
+        return N - size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <stdint.h>
+#include "seqlock.h"
+
+/**
+ * @file system_snapshot.h
+ * @brief Consistent, lock-free view of manager state
+ *
+ * Each manager publishes its own section after a state change; readers
+ * (status endpoint, metrics) take one consistent copy of everything
+ * instead of querying managers field by field.
+ *
+ * Usage:
+ *   // Writer (inside a manager):
+ *   SystemStatus::publish([](SystemSnapshot& s) { s.led.flashing = true; });
+ *
+ *   // Reader:
+ *   SystemSnapshot snap = SystemStatus::read();
+ */
+
+struct SystemSnapshot {
+    struct Ble {
+        bool connected;
+        bool busy;
+        uint8_t progress;  // 0-100
+    } ble;
+
+    struct Led {
+        bool manualState;
+        bool flashing;
+        bool lit;
+    } led;
+
+    struct WiFi {
+        bool connected;
+        bool hasBeenConnected;
+        uint32_t disconnectTime;  // millis() at disconnect, 0 if connected
+    } wifi;
+};
+
+namespace SystemStatus {
+    /**
+     * @brief Get the process-wide snapshot board
+     */
+    inline SeqLock<SystemSnapshot>& board() {
+        static SeqLock<SystemSnapshot> instance;
+        return instance;
+    }
+
+    /**
+     * @brief Publish a change to the snapshot
+     * @param fn Callable taking SystemSnapshot& - modify only your own section
+     */
+    template <typename Fn>
+    inline void publish(Fn fn) {
+        board().update(fn);
+    }
+
+    /**
+     * @brief Read a consistent copy of the snapshot
+     */
+    inline SystemSnapshot read() {
+        return board().read();
+    }
+}
@@ -1,13 +1,20 @@
 #pragma once
 #include <Arduino.h>
+#include <esp_timer.h>
 
 /**
  * @file time_utils.h
  * @brief Overflow-safe timing utilities
  *
- * These utilities handle millis() overflow correctly.
- * The millis() function overflows after approximately 49 days,
- * wrapping from ~4,294,967,295 back to 0.
+ * Two clocks:
+ * - 32-bit millis() helpers (hasElapsed, timeDiff, withinWindow). These
+ *   handle the wrap after ~49.7 days using unsigned arithmetic.
+ * - A 64-bit monotonic microsecond clock (nowUs) backed by
+ *   esp_timer_get_time(). It never wraps in practice and resolves
+ *   sub-millisecond intervals; use it for pacing and instrumentation.
+ *
+ * On native builds esp_timer_get_time() comes from the mocks and reads
+ * the virtual clock.
  */
 
 namespace TimeUtils {
@@ -28,25 +35,33 @@ namespace TimeUtils {
      *     // At least 1 second has passed
      *   }
      */
-    inline bool hasElapsed(unsigned long start, unsigned long interval) {
-        return (unsigned long)(millis() - start) >= interval;
+    inline bool hasElapsed(uint32_t start, uint32_t interval) {
+        return (uint32_t)((uint32_t)millis() - start) >= interval;
     }
 
     /**
      * @brief Calculate time difference (overflow-safe)
      * @param start Start time
-     * @param end End time (defaults to current time)
+     * @param end End time
      * @return Time difference in milliseconds
      *
      * Example:
      *   unsigned long start = millis();
      *   delay(100);
-     *   unsigned long elapsed = TimeUtils::timeDiff(start);
+     *   unsigned long elapsed = TimeUtils::timeDiff(start, millis());
      *   // elapsed will be approximately 100
      */
-    inline unsigned long timeDiff(unsigned long start, unsigned long end = 0) {
-        if (end == 0) end = millis();
-        return (unsigned long)(end - start);
+    inline uint32_t timeDiff(uint32_t start, uint32_t end) {
+        return (uint32_t)(end - start);
+    }
+
+    /**
+     * @brief Calculate time elapsed since start (overflow-safe)
+     * @param start Start time from millis()
+     * @return Milliseconds since start
+     */
+    inline uint32_t timeDiff(uint32_t start) {
+        return timeDiff(start, (uint32_t)millis());
     }
 
     /**
@@ -55,7 +70,91 @@ namespace TimeUtils {
      * @param windowMs Window size in milliseconds
      * @return true if current time is within windowMs of timestamp
      */
-    inline bool withinWindow(unsigned long timestamp, unsigned long windowMs) {
+    inline bool withinWindow(uint32_t timestamp, uint32_t windowMs) {
         return timeDiff(timestamp) < windowMs;
     }
+
+    // ===== 64-bit microsecond clock =====
+
+    /**
+     * @brief Monotonic time since boot in microseconds
+     */
+    inline uint64_t nowUs() {
+        return (uint64_t)esp_timer_get_time();
+    }
+
+    /**
+     * @brief Monotonic time since boot in milliseconds (64-bit, no wrap)
+     */
+    inline uint64_t nowMs64() {
+        return nowUs() / 1000ULL;
+    }
+
+    /**
+     * @brief Microseconds elapsed since startUs
+     * @param startUs Earlier value of nowUs()
+     */
+    inline uint64_t elapsedUs(uint64_t startUs) {
+        return nowUs() - startUs;
+    }
+
+    /**
+     * @brief Check if intervalUs has elapsed since startUs
+     */
+    inline bool hasElapsedUs(uint64_t startUs, uint64_t intervalUs) {
+        return elapsedUs(startUs) >= intervalUs;
+    }
+
+    /**
+     * @brief Clamp a microsecond duration into 32 bits (~71 minutes)
+     *
+     * For histograms and counters that store uint32_t durations.
+     */
+    inline uint32_t saturateUs(uint64_t us) {
+        return us > 0xFFFFFFFFULL ? 0xFFFFFFFFu : (uint32_t)us;
+    }
+
+    /**
+     * @brief Point in time on the microsecond clock
+     *
+     * Example:
+     *   TimeUtils::Deadline deadline = TimeUtils::Deadline::afterMs(250);
+     *   while (!deadline.expired()) { ... }
+     */
+    struct Deadline {
+        uint64_t atUs;
+
+        static Deadline atTime(uint64_t us) {
+            Deadline d;
+            d.atUs = us;
+            return d;
+        }
+
+        static Deadline afterUs(uint64_t us) {
+            return atTime(nowUs() + us);
+        }
+
+        static Deadline afterMs(uint32_t ms) {
+            return afterUs((uint64_t)ms * 1000ULL);
+        }
+
+        bool expired() const {
+            return nowUs() >= atUs;
+        }
+
+        /**
+         * @brief Microseconds left, 0 once expired
+         */
+        uint64_t remainingUs() const {
+            uint64_t now = nowUs();
+            return now >= atUs ? 0 : atUs - now;
+        }
+
+        /**
+         * @brief Move the deadline forward by one period (drift-free)
+         */
+        void advance(uint64_t periodUs) {
+            atUs += periodUs;
+        }
+    };
 }
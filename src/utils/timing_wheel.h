@@ -0,0 +1,314 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "time_utils.h"
+
+/**
+ * @file timing_wheel.h
+ * @brief Hierarchical timing wheel for periodic and delayed work
+ *
+ * Four levels of 64 slots at 1 ms resolution cover delays up to ~4.6
+ * hours directly; longer delays are parked in the top level and
+ * re-filed as they come closer. Arming, re-arming and cancelling are
+ * O(1) (intrusive doubly linked lists, no allocation). advance() only
+ * touches slots whose time has come and skips whole empty rotations,
+ * so idle loop iterations cost a few comparisons.
+ *
+ * Ticks are 32-bit milliseconds (the low bits of TimeUtils::nowMs64())
+ * and compared wrap-safely.
+ *
+ * Usage:
+ *   Timer flashTimer;
+ *   flashTimer.setCallback(&onFlash, this);
+ *   SystemTimers::wheel().armPeriodic(flashTimer, 5000);
+ *
+ *   // In loop:
+ *   SystemTimers::wheel().advance(SystemTimers::nowTick());
+ */
+
+class TimingWheel;
+
+/**
+ * @class Timer
+ * @brief Intrusive timer node; owned by the caller, never copied
+ */
+class Timer {
+    friend class TimingWheel;
+
+public:
+    typedef void (*Callback)(void* context);
+
+private:
+    Timer* next;
+    Timer* prev;
+    uint32_t expiry;    // Absolute tick
+    uint32_t period;    // 0 = one-shot
+    Callback callback;
+    void* context;
+    uint8_t level;
+    uint8_t slot;
+    bool armed;
+
+    Timer(const Timer&);
+    Timer& operator=(const Timer&);
+
+public:
+    Timer()
+        : next(nullptr), prev(nullptr), expiry(0), period(0),
+          callback(nullptr), context(nullptr), level(0), slot(0), armed(false) {}
+
+    /**
+     * @brief Set function called on expiry (from TimingWheel::advance())
+     */
+    void setCallback(Callback fn, void* ctx) {
+        callback = fn;
+        context = ctx;
+    }
+
+    bool isArmed() const {
+        return armed;
+    }
+
+    uint32_t getExpiry() const {
+        return expiry;
+    }
+};
+
+class TimingWheel {
+public:
+    static constexpr uint8_t LEVELS = 4;
+    static constexpr uint8_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+    static constexpr uint32_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint32_t MAX_DELAY = (1u << (SLOT_BITS * LEVELS)) - 1;
+
+private:
+    Timer* slots[LEVELS][SLOTS];
+    uint64_t occupied[LEVELS];  // Bit per non-empty slot
+    uint32_t currentTick;
+    size_t armedCount;
+
+    static bool tickBefore(uint32_t a, uint32_t b) {
+        return (int32_t)(a - b) < 0;
+    }
+
+    void link(Timer& t) {
+        uint32_t delta = t.expiry - currentTick;
+        uint32_t placeAt = t.expiry;
+        if (delta > MAX_DELAY) {
+            // Too far out: park at the horizon and re-file on cascade
+            placeAt = currentTick + MAX_DELAY;
+            delta = MAX_DELAY;
+        }
+
+        uint8_t level = 0;
+        while (level < LEVELS - 1 && delta >= (1u << (SLOT_BITS * (level + 1)))) {
+            level++;
+        }
+        uint8_t slot = (placeAt >> (SLOT_BITS * level)) & SLOT_MASK;
+
+        t.level = level;
+        t.slot = slot;
+        t.prev = nullptr;
+        t.next = slots[level][slot];
+        if (t.next) t.next->prev = &t;
+        slots[level][slot] = &t;
+        occupied[level] |= (1ULL << slot);
+    }
+
+    void unlink(Timer& t) {
+        if (t.prev) {
+            t.prev->next = t.next;
+        } else {
+            slots[t.level][t.slot] = t.next;
+            if (t.next == nullptr) {
+                occupied[t.level] &= ~(1ULL << t.slot);
+            }
+        }
+        if (t.next) t.next->prev = t.prev;
+        t.next = nullptr;
+        t.prev = nullptr;
+    }
+
+    /**
+     * @brief Move every timer in a higher-level slot down toward level 0
+     */
+    void cascade(uint8_t level, uint8_t slot) {
+        Timer* t = slots[level][slot];
+        slots[level][slot] = nullptr;
+        occupied[level] &= ~(1ULL << slot);
+
+        while (t) {
+            Timer* nextTimer = t->next;
+            link(*t);
+            t = nextTimer;
+        }
+    }
+
+    /**
+     * @brief Fire everything in the current level-0 slot
+     */
+    size_t expireCurrent() {
+        size_t fired = 0;
+        uint8_t slot = currentTick & SLOT_MASK;
+
+        while (Timer* t = slots[0][slot]) {
+            unlink(*t);
+
+            if (t->expiry != currentTick) {
+                // Parked long timer that isn't due yet
+                link(*t);
+                continue;
+            }
+
+            if (t->period > 0) {
+                t->expiry += t->period;  // Drift-free: from schedule, not now
+                link(*t);
+            } else {
+                t->armed = false;
+                armedCount--;
+            }
+
+            fired++;
+            if (t->callback) t->callback(t->context);
+        }
+        return fired;
+    }
+
+public:
+    /**
+     * @brief Construct timing wheel
+     * @param nowTick Current time in milliseconds
+     */
+    explicit TimingWheel(uint32_t nowTick = 0) : currentTick(nowTick), armedCount(0) {
+        for (uint8_t l = 0; l < LEVELS; l++) {
+            for (uint32_t s = 0; s < SLOTS; s++) {
+                slots[l][s] = nullptr;
+            }
+            occupied[l] = 0;
+        }
+    }
+
+    /**
+     * @brief Arm (or re-arm) a one-shot timer
+     * @param t Timer to arm
+     * @param delayMs Delay from the wheel's current tick (0 fires on the next tick)
+     */
+    void arm(Timer& t, uint32_t delayMs) {
+        cancel(t);
+        t.period = 0;
+        t.expiry = currentTick + (delayMs == 0 ? 1 : delayMs);
+        t.armed = true;
+        armedCount++;
+        link(t);
+    }
+
+    /**
+     * @brief Arm (or re-arm) a periodic timer
+     * @param t Timer to arm
+     * @param periodMs Interval between firings (first firing after one period)
+     */
+    void armPeriodic(Timer& t, uint32_t periodMs) {
+        arm(t, periodMs);
+        t.period = periodMs == 0 ? 1 : periodMs;
+    }
+
+    /**
+     * @brief Disarm a timer (no-op if not armed)
+     */
+    void cancel(Timer& t) {
+        if (!t.armed) return;
+        unlink(t);
+        t.armed = false;
+        armedCount--;
+    }
+
+    /**
+     * @brief Run all timers due at or before nowTick
+     * @param nowTick Current time in milliseconds
+     * @return Number of callbacks fired
+     */
+    size_t advance(uint32_t nowTick) {
+        size_t fired = 0;
+
+        while (tickBefore(currentTick, nowTick)) {
+            // Skip rotations of levels that are entirely empty
+            uint32_t skipMask = 0;
+            for (uint8_t l = 0; l < LEVELS && occupied[l] == 0; l++) {
+                skipMask = (skipMask << SLOT_BITS) | SLOT_MASK;
+            }
+            if (skipMask != 0) {
+                uint32_t target = currentTick | skipMask;
+                if (target != currentTick) {
+                    currentTick = tickBefore(target, nowTick) ? target : nowTick;
+                    continue;
+                }
+            }
+
+            currentTick++;
+
+            // Level-0 wrapped: pull the next slot down from each higher level
+            for (uint8_t l = 1; l < LEVELS; l++) {
+                if ((currentTick & ((1u << (SLOT_BITS * l)) - 1)) != 0) break;
+                cascade(l, (currentTick >> (SLOT_BITS * l)) & SLOT_MASK);
+            }
+
+            fired += expireCurrent();
+        }
+        return fired;
+    }
+
+    /**
+     * @brief Ticks until the next tick that has work to do
+     * @return 1..MAX_DELAY + 1, or MAX_DELAY if nothing is armed
+     *
+     * Either a level-0 slot is due or an occupied higher-level slot
+     * cascades at that tick; boundaries that would pull down an empty
+     * slot are skipped. Lets simulations jump the clock straight to the
+     * next event instead of stepping one rotation at a time.
+     */
+    uint32_t ticksUntilNext() const {
+        if (armedCount == 0) return MAX_DELAY;
+
+        uint32_t best = 0;
+        for (uint8_t l = 0; l < LEVELS; l++) {
+            if (occupied[l] == 0) continue;
+
+            uint8_t shift = SLOT_BITS * l;
+            for (uint32_t i = 1; i <= SLOTS; i++) {
+                uint32_t tick = ((currentTick >> shift) + i) << shift;
+                if (occupied[l] & (1ULL << ((tick >> shift) & SLOT_MASK))) {
+                    uint32_t delta = tick - currentTick;
+                    if (best == 0 || delta < best) best = delta;
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+    uint32_t getCurrentTick() const {
+        return currentTick;
+    }
+
+    size_t getArmedCount() const {
+        return armedCount;
+    }
+};
+
+namespace SystemTimers {
+    /**
+     * @brief Current wheel tick from the 64-bit clock
+     */
+    inline uint32_t nowTick() {
+        return (uint32_t)TimeUtils::nowMs64();
+    }
+
+    /**
+     * @brief Get the process-wide timing wheel advanced by loop()
+     */
+    inline TimingWheel& wheel() {
+        static TimingWheel instance(nowTick());
+        return instance;
+    }
+}
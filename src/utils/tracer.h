@@ -0,0 +1,258 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+#include "time_utils.h"
+#include "chunked_writer.h"
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#endif
+
+/**
+ * @file tracer.h
+ * @brief Per-request span events in a ring buffer, exported as Chrome trace JSON
+ *
+ * Each HTTP request gets a span ID. Code handling that request records
+ * completed stages (start and end on the microsecond clock) against the
+ * span, including stages that finish later on the HID pump task.
+ * Events go into a fixed ring that overwrites the oldest entries.
+ *
+ * writeChromeJson() emits the Trace Event Format understood by
+ * chrome://tracing and Perfetto: HTTP stages on a "loop" track, report
+ * emission on a "hid_pump" track, and one async slice per request
+ * spanning accept to last report.
+ *
+ * Usage:
+ *   TraceContext trace = Tracing::tracer().startSpan();
+ *   uint64_t t = TimeUtils::nowUs();
+ *   ... authenticate ...
+ *   Tracing::tracer().record(trace, TraceStage::AUTH, t);
+ */
+
+enum class TraceStage : uint8_t {
+    REQUEST,      // Route handler, accept to response sent
+    PARSE,        // Argument extraction
+    AUTH,         // API key check
+    RATE_LIMIT,   // Rate limiter check
+    VALIDATE,     // Message validation
+    ENQUEUE,      // Hand-off to the BLE manager
+    QUEUE_WAIT,   // Queued until the first report is sent
+    TYPING,       // First report until last report
+    END_TO_END,   // Accept until last report
+    STAGE_COUNT
+};
+
+/**
+ * @brief Span identity carried alongside a request
+ */
+struct TraceContext {
+    uint32_t spanId;    // 0 = not traced
+    uint64_t startUs;   // Accept time
+
+    TraceContext() : spanId(0), startUs(0) {}
+    TraceContext(uint32_t id, uint64_t start) : spanId(id), startUs(start) {}
+
+    bool isActive() const {
+        return spanId != 0;
+    }
+};
+
+struct TraceEvent {
+    uint64_t startUs;
+    uint32_t durationUs;
+    uint32_t spanId;
+    TraceStage stage;
+};
+
+class Tracer {
+public:
+    static constexpr size_t CAPACITY = Config::Trace::RING_SIZE;
+
+private:
+    TraceEvent ring[CAPACITY];
+    uint32_t head;   // Total events ever recorded; next slot is head % CAPACITY
+    std::atomic<uint32_t> nextSpanId;
+    bool enabled;
+
+#ifdef ESP_PLATFORM
+    mutable portMUX_TYPE mux;
+
+    void lock() const { portENTER_CRITICAL(&mux); }
+    void unlock() const { portEXIT_CRITICAL(&mux); }
+#else
+    mutable std::atomic_flag flag;
+
+    void lock() const {
+        while (flag.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+    void unlock() const { flag.clear(std::memory_order_release); }
+#endif
+
+    // Pump-task stages are drawn on their own track
+    static uint8_t trackOf(TraceStage stage) {
+        return (stage == TraceStage::QUEUE_WAIT || stage == TraceStage::TYPING) ? 2 : 1;
+    }
+
+public:
+    Tracer() : head(0), nextSpanId(1), enabled(true) {
+        memset(ring, 0, sizeof(ring));
+#ifdef ESP_PLATFORM
+        mux = portMUX_INITIALIZER_UNLOCKED;
+#else
+        flag.clear();
+#endif
+    }
+
+    static const char* stageName(TraceStage stage) {
+        static const char* const names[] = {
+            "request", "parse", "auth", "rate_limit", "validate",
+            "enqueue", "queue_wait", "typing", "end_to_end"
+        };
+        uint8_t index = static_cast<uint8_t>(stage);
+        return index < static_cast<uint8_t>(TraceStage::STAGE_COUNT) ? names[index] : "unknown";
+    }
+
+    /**
+     * @brief Allocate a span starting now
+     * @return Inactive context if tracing is disabled
+     */
+    TraceContext startSpan() {
+        if (!enabled) return TraceContext();
+
+        uint32_t id = nextSpanId.fetch_add(1, std::memory_order_relaxed);
+        if (id == 0) id = nextSpanId.fetch_add(1, std::memory_order_relaxed);
+        return TraceContext(id, TimeUtils::nowUs());
+    }
+
+    /**
+     * @brief Record a completed stage (any task)
+     * @param trace Span the stage belongs to (ignored if inactive)
+     * @param stage Stage that finished
+     * @param startUs When the stage started
+     * @param endUs When it finished
+     */
+    void record(const TraceContext& trace, TraceStage stage, uint64_t startUs, uint64_t endUs) {
+        if (!trace.isActive() || !enabled) return;
+
+        TraceEvent event;
+        event.startUs = startUs;
+        event.durationUs = TimeUtils::saturateUs(endUs >= startUs ? endUs - startUs : 0);
+        event.spanId = trace.spanId;
+        event.stage = stage;
+
+        lock();
+        ring[head % CAPACITY] = event;
+        head++;
+        unlock();
+    }
+
+    /**
+     * @brief Record a stage that ends now
+     */
+    void record(const TraceContext& trace, TraceStage stage, uint64_t startUs) {
+        record(trace, stage, startUs, TimeUtils::nowUs());
+    }
+
+    /**
+     * @brief Copy one event by sequence number
+     * @return false if it has been overwritten or not yet written
+     */
+    bool readEvent(uint32_t sequence, TraceEvent& out) const {
+        lock();
+        bool valid = (uint32_t)(head - sequence - 1) < CAPACITY;
+        if (valid) out = ring[sequence % CAPACITY];
+        unlock();
+        return valid;
+    }
+
+    /**
+     * @brief Sequence number of the oldest retained event
+     */
+    uint32_t oldestSequence() const {
+        lock();
+        uint32_t oldest = head > CAPACITY ? head - CAPACITY : 0;
+        unlock();
+        return oldest;
+    }
+
+    /**
+     * @brief Total events recorded since boot (including overwritten ones)
+     */
+    uint32_t getRecordedCount() const {
+        lock();
+        uint32_t count = head;
+        unlock();
+        return count;
+    }
+
+    /**
+     * @brief Drop all retained events
+     */
+    void clear() {
+        lock();
+        head = 0;
+        unlock();
+    }
+
+    void setEnabled(bool on) {
+        enabled = on;
+    }
+
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    /**
+     * @brief Stream retained events as Chrome Trace Event JSON
+     *
+     * The ring is read one event at a time, so recording continues
+     * while a large trace is being sent. Call out.flush() after.
+     */
+    void writeChromeJson(ChunkedWriter& out) const {
+        out.printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        out.printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+                   "\"args\":{\"name\":\"loop\"}},");
+        out.printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,"
+                   "\"args\":{\"name\":\"hid_pump\"}}");
+
+        uint32_t end = getRecordedCount();
+        for (uint32_t seq = oldestSequence(); seq != end; seq++) {
+            TraceEvent e;
+            if (!readEvent(seq, e)) continue;
+
+            if (e.stage == TraceStage::END_TO_END) {
+                // Async slice: its own row per request in Perfetto
+                out.printf(",\n{\"name\":\"request %lu\",\"cat\":\"request\",\"ph\":\"b\","
+                           "\"id\":%lu,\"ts\":%llu,\"pid\":1,\"tid\":1}",
+                           (unsigned long)e.spanId, (unsigned long)e.spanId,
+                           (unsigned long long)e.startUs);
+                out.printf(",\n{\"name\":\"request %lu\",\"cat\":\"request\",\"ph\":\"e\","
+                           "\"id\":%lu,\"ts\":%llu,\"pid\":1,\"tid\":1}",
+                           (unsigned long)e.spanId, (unsigned long)e.spanId,
+                           (unsigned long long)(e.startUs + e.durationUs));
+                continue;
+            }
+
+            out.printf(",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%llu,"
+                       "\"dur\":%lu,\"pid\":1,\"tid\":%u,\"args\":{\"span\":%lu}}",
+                       stageName(e.stage), trackOf(e.stage) == 2 ? "ble" : "http",
+                       (unsigned long long)e.startUs, (unsigned long)e.durationUs,
+                       (unsigned)trackOf(e.stage), (unsigned long)e.spanId);
+        }
+
+        out.printf("\n]}\n");
+    }
+};
+
+namespace Tracing {
+    /**
+     * @brief Get the process-wide request tracer
+     */
+    inline Tracer& tracer() {
+        static Tracer instance;
+        return instance;
+    }
+}
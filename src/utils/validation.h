@@ -21,30 +21,35 @@ namespace Validation {
     };
 
     /**
-     * @brief Validate message for BLE keyboard transmission
-     * @param msg Message to validate
+     * @brief Validate text for BLE keyboard transmission
+     * @param msg Text (need not be NUL-terminated)
+     * @param length Length of the text
+     * @param maxLength Longest text accepted
      * @return ValidationResult with validity and error code
      *
      * Checks:
-     * - Message is not empty
-     * - Message doesn't exceed maximum length
-     * - Message doesn't contain invalid control characters
+     * - Text is not empty
+     * - Text doesn't exceed maxLength
+     * - Text doesn't contain invalid control characters
+     *
+     * Length is checked before any text is read, so a caller may pass
+     * only the first maxLength bytes of a longer text.
      */
-    inline ValidationResult validateMessage(const String& msg) {
+    inline ValidationResult validateText(const char* msg, size_t length, size_t maxLength) {
         // Check for empty message
-        if (msg.length() == 0) {
+        if (length == 0) {
             return ValidationResult(false, ErrorCode::MESSAGE_EMPTY);
         }
 
         // Check maximum length
-        if (msg.length() > Config::BLE::MAX_MESSAGE_LENGTH) {
+        if (length > maxLength) {
             return ValidationResult(false, ErrorCode::MESSAGE_TOO_LONG);
         }
 
         // Check for invalid characters (optional - restrict to printable + whitespace)
         // Note: This is a basic check. Adjust based on your security requirements.
-        for (size_t i = 0; i < msg.length(); i++) {
-            char c = msg.charAt(i);
+        for (size_t i = 0; i < length; i++) {
+            char c = msg[i];
             // Allow printable ASCII (32-126), newline, carriage return, tab
             if (c < 32 && c != '\n' && c != '\r' && c != '\t') {
                 return ValidationResult(false, ErrorCode::INVALID_CHARACTERS);
@@ -58,6 +63,71 @@ namespace Validation {
         return ValidationResult(true, ErrorCode::SUCCESS);
     }
 
+    /**
+     * @brief Validate a /type message (validateText() up to MAX_MESSAGE_LENGTH)
+     */
+    inline ValidationResult validateMessage(const char* msg, size_t length) {
+        return validateText(msg, length, Config::BLE::MAX_MESSAGE_LENGTH);
+    }
+
+    inline ValidationResult validateMessage(const String& msg) {
+        return validateMessage(msg.c_str(), msg.length());
+    }
+
+    /**
+     * @brief Log-safe form of one character
+     * @return Replacement text ("\\n", ".", ...), or nullptr to keep c
+     */
+    inline const char* logEscape(char c) {
+        if (c >= 32 && c <= 126) return nullptr;
+        if (c == '\n') return "\\n";
+        if (c == '\r') return "\\r";
+        if (c == '\t') return "\\t";
+        return ".";
+    }
+
+    /**
+     * @brief Sanitize message for safe logging into a caller's buffer
+     * @param msg Message text
+     * @param length Length of the message
+     * @param out Output buffer; sanitizedBytes(maxLength) always fits
+     * @param outSize Size of out
+     * @param maxLength Maximum length to log (default 50)
+     * @return out, NUL-terminated
+     */
+    inline char* sanitizeForLog(const char* msg, size_t length, char* out, size_t outSize,
+                                size_t maxLength = 50) {
+        if (outSize == 0) return out;
+        size_t used = 0;
+        size_t len = min(length, maxLength);
+
+        for (size_t i = 0; i < len; i++) {
+            const char* escaped = logEscape(msg[i]);
+            size_t add = escaped ? strlen(escaped) : 1;
+            if (used + add >= outSize) break;
+            if (escaped) {
+                memcpy(out + used, escaped, add);
+            } else {
+                out[used] = msg[i];
+            }
+            used += add;
+        }
+
+        if (length > maxLength && used + 3 < outSize) {
+            memcpy(out + used, "...", 3);
+            used += 3;
+        }
+        out[used] = '\0';
+        return out;
+    }
+
+    /**
+     * @brief Buffer size for sanitizeForLog() (every character escaped, "...", NUL)
+     */
+    constexpr size_t sanitizedBytes(size_t maxLength) {
+        return maxLength * 2 + 4;
+    }
+
     /**
      * @brief Sanitize message for safe logging
      * @param msg Message to sanitize
@@ -70,16 +140,11 @@ namespace Validation {
 
         for (size_t i = 0; i < len; i++) {
             char c = msg.charAt(i);
-            if (c >= 32 && c <= 126) {
-                sanitized += c;
-            } else if (c == '\n') {
-                sanitized += "\\n";
-            } else if (c == '\r') {
-                sanitized += "\\r";
-            } else if (c == '\t') {
-                sanitized += "\\t";
+            const char* escaped = logEscape(c);
+            if (escaped) {
+                sanitized += escaped;
             } else {
-                sanitized += '.';
+                sanitized += c;
             }
         }
 
@@ -24,11 +24,29 @@
 
 // Mock global state
 extern unsigned long mock_millis_value;
+extern uint64_t mock_micros_value;  // Virtual clock behind esp_timer_get_time()
 extern uint8_t mock_pin_states[50];
+extern void (*mock_delay_hook)(unsigned long ms);  // Set by VirtualClock
 
 // Arduino functions
-inline unsigned long millis() { return mock_millis_value; }
-inline void delay(unsigned long ms) { mock_millis_value += ms; }
+// millis()/micros() wrap at 32 bits like the ESP32, even on 64-bit hosts
+inline unsigned long millis() { return (uint32_t)mock_millis_value; }
+inline unsigned long micros() { return (uint32_t)mock_micros_value; }
+inline void delay(unsigned long ms) {
+    if (mock_delay_hook) {
+        mock_delay_hook(ms);
+        return;
+    }
+    mock_millis_value += ms;
+    mock_micros_value += (uint64_t)ms * 1000;
+}
+inline void delayMicroseconds(unsigned int us) { mock_micros_value += us; }
+
+// The ESP32 core provides min/max for mixed argument types
+template <typename T, typename U>
+inline T min(T a, U b) { return (b < a) ? (T)b : a; }
+template <typename T, typename U>
+inline T max(T a, U b) { return (a < b) ? (T)b : a; }
 inline void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
 inline void digitalWrite(uint8_t pin, uint8_t value) {
     if (pin < 50) mock_pin_states[pin] = value;
@@ -116,6 +134,24 @@ public:
         return strcmp(buffer, str) == 0;
     }
 
+    String& operator+=(const char* str) {
+        size_t add = strlen(str);
+        char* grown = new char[len + add + 1];
+        memcpy(grown, c_str(), len);
+        memcpy(grown + len, str, add + 1);
+        delete[] buffer;
+        buffer = grown;
+        len += add;
+        return *this;
+    }
+
+    String& operator+=(const String& other) { return *this += other.c_str(); }
+
+    String& operator+=(char c) {
+        char str[2] = { c, '\0' };
+        return *this += str;
+    }
+
     const char* c_str() const { return buffer ? buffer : ""; }
 };
 
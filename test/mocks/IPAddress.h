@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file IPAddress.h
+ * @brief Mock Arduino IPAddress for native testing
+ *
+ * Converts to the same host-order uint32_t the rate limiter keys on.
+ */
+
+#define IPAddress_h
+
+class IPAddress {
+private:
+    uint32_t addr;
+
+public:
+    IPAddress() : addr(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+        addr = ((uint32_t)a << 24) | ((uint32_t)b << 16) | ((uint32_t)c << 8) | d;
+    }
+    explicit IPAddress(uint32_t address) : addr(address) {}
+
+    operator uint32_t() const { return addr; }
+
+    // Octet by position, as on the ESP32 (0 = first in dotted form)
+    uint8_t operator[](int index) const { return (uint8_t)(addr >> (8 * (3 - index))); }
+};
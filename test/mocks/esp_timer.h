@@ -0,0 +1,14 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file esp_timer.h
+ * @brief Mock ESP-IDF high-resolution timer for native testing
+ *
+ * esp_timer_get_time() reads the virtual microsecond clock, so code
+ * using TimeUtils::nowUs() runs deterministically in tests.
+ */
+
+extern uint64_t mock_micros_value;
+
+inline int64_t esp_timer_get_time() { return (int64_t)mock_micros_value; }
@@ -2,5 +2,7 @@
 
 // Global mock state
 unsigned long mock_millis_value = 0;
+uint64_t mock_micros_value = 0;
 uint8_t mock_pin_states[50] = {0};
+void (*mock_delay_hook)(unsigned long ms) = nullptr;
 MockSerial Serial;
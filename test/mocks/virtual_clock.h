@@ -0,0 +1,293 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "Arduino.h"
+#include "utils/timing_wheel.h"
+
+/**
+ * @file virtual_clock.h
+ * @brief Discrete-event scheduler behind the mocked millis()/micros()
+ *
+ * Events are queued at absolute virtual times and run in time order;
+ * the clock jumps straight from one event to the next, so hours of
+ * device time (or the 49-day millis() wrap) simulate in milliseconds.
+ * Events at the same time run in the order they were scheduled.
+ *
+ * The clock owns mock_micros_value/mock_millis_value while attached:
+ * they always move together and never go backwards. delay() inside
+ * code under test runs the events that fall within the delay, the way
+ * other tasks would keep running on the device.
+ *
+ * A TimingWheel can be attached too. It is advanced whenever the clock
+ * reaches a tick where ticksUntilNext() says it has work, so managers
+ * that arm SystemTimers::wheel() timers run without a loop() poll.
+ *
+ * Usage:
+ *   VirtualClock& clock = Sim::clock();
+ *   clock.reset(0);
+ *   clock.attachWheel(SystemTimers::wheel());
+ *   clock.scheduleIn(30 * 1000000ULL, &onLinkDown, &wifi);
+ *   clock.runFor(3600 * 1000000ULL);  // One simulated hour
+ */
+
+class VirtualClock {
+public:
+    typedef void (*EventFn)(void* context);
+
+    static constexpr size_t MAX_EVENTS = 64;
+
+private:
+    struct Event {
+        uint64_t atUs;
+        uint32_t seq;   // FIFO order among events at the same time
+        uint32_t id;
+        EventFn fn;     // nullptr once cancelled
+        void* context;
+    };
+
+    Event heap[MAX_EVENTS];
+    size_t count;
+    uint32_t nextSeq;
+    uint32_t nextId;
+    uint64_t eventsRun;
+    TimingWheel* wheel;
+
+    static bool earlier(const Event& a, const Event& b) {
+        if (a.atUs != b.atUs) return a.atUs < b.atUs;
+        return (int32_t)(a.seq - b.seq) < 0;
+    }
+
+    void siftUp(size_t i) {
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (!earlier(heap[i], heap[parent])) break;
+            Event tmp = heap[i];
+            heap[i] = heap[parent];
+            heap[parent] = tmp;
+            i = parent;
+        }
+    }
+
+    void siftDown(size_t i) {
+        for (;;) {
+            size_t first = i;
+            size_t left = 2 * i + 1;
+            size_t right = left + 1;
+            if (left < count && earlier(heap[left], heap[first])) first = left;
+            if (right < count && earlier(heap[right], heap[first])) first = right;
+            if (first == i) break;
+            Event tmp = heap[i];
+            heap[i] = heap[first];
+            heap[first] = tmp;
+            i = first;
+        }
+    }
+
+    Event pop() {
+        Event top = heap[0];
+        heap[0] = heap[--count];
+        siftDown(0);
+        return top;
+    }
+
+    void dropCancelled() {
+        while (count > 0 && heap[0].fn == nullptr) pop();
+    }
+
+    /**
+     * @brief Absolute time of the wheel's next due tick, or UINT64_MAX
+     */
+    uint64_t wheelDueUs() const {
+        if (wheel == nullptr || wheel->getArmedCount() == 0) return UINT64_MAX;
+
+        // Ticks are the low 32 bits of the millisecond clock
+        int64_t nowMs = (int64_t)(mock_micros_value / 1000);
+        int32_t lag = (int32_t)((uint32_t)nowMs - wheel->getCurrentTick());
+        int64_t dueMs = nowMs - lag + wheel->ticksUntilNext();
+        return dueMs <= nowMs ? mock_micros_value : (uint64_t)dueMs * 1000;
+    }
+
+    void moveTo(uint64_t us) {
+        if (us < mock_micros_value) return;  // Late events run at "now"
+        mock_micros_value = us;
+        mock_millis_value = (unsigned long)(us / 1000);
+    }
+
+    static void delayHook(unsigned long ms);
+
+public:
+    VirtualClock() : count(0), nextSeq(0), nextId(0), eventsRun(0), wheel(nullptr) {}
+
+    /**
+     * @brief Drop all events and the wheel, and set the clock
+     * @param startUs New virtual time in microseconds
+     *
+     * Also routes delay() through runFor() from here on.
+     */
+    void reset(uint64_t startUs) {
+        count = 0;
+        eventsRun = 0;
+        wheel = nullptr;
+        mock_micros_value = startUs;
+        mock_millis_value = (unsigned long)(startUs / 1000);
+        mock_delay_hook = &VirtualClock::delayHook;
+    }
+
+    /**
+     * @brief Hand delay() back to the plain counter mock
+     */
+    void detach() {
+        mock_delay_hook = nullptr;
+    }
+
+    /**
+     * @brief Advance this wheel as the clock reaches its due ticks
+     * @param timers Wheel to drive (nullptr to stop); its current tick
+     *               should not be ahead of millis()
+     */
+    void attachWheel(TimingWheel* timers) {
+        wheel = timers;
+    }
+
+    void attachWheel(TimingWheel& timers) {
+        wheel = &timers;
+    }
+
+    /**
+     * @brief Queue an event at an absolute virtual time
+     * @return Event id for cancel(), or 0 if the queue is full
+     *
+     * Times in the past run at the current time on the next step.
+     */
+    uint32_t scheduleAt(uint64_t atUs, EventFn fn, void* context) {
+        if (fn == nullptr) return 0;
+        dropCancelled();
+        if (count >= MAX_EVENTS) return 0;
+
+        if (++nextId == 0) nextId = 1;
+        Event& e = heap[count];
+        e.atUs = atUs;
+        e.seq = nextSeq++;
+        e.id = nextId;
+        e.fn = fn;
+        e.context = context;
+        siftUp(count++);
+        return nextId;
+    }
+
+    uint32_t scheduleIn(uint64_t delayUs, EventFn fn, void* context) {
+        return scheduleAt(mock_micros_value + delayUs, fn, context);
+    }
+
+    /**
+     * @brief Cancel a pending event
+     * @return true if the event was still pending
+     */
+    bool cancel(uint32_t id) {
+        if (id == 0) return false;
+        for (size_t i = 0; i < count; i++) {
+            if (heap[i].id == id && heap[i].fn != nullptr) {
+                heap[i].fn = nullptr;  // Discarded when it reaches the top
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Time of the next event or wheel tick, or UINT64_MAX if idle
+     */
+    uint64_t nextEventUs() {
+        dropCancelled();
+        uint64_t next = count > 0 ? heap[0].atUs : UINT64_MAX;
+        uint64_t timers = wheelDueUs();
+        if (timers < next) next = timers;
+        return next < mock_micros_value ? mock_micros_value : next;
+    }
+
+    /**
+     * @brief Jump to the next event (or wheel tick) and run it
+     * @param limitUs Don't step past this time
+     * @return false if nothing is due by limitUs
+     */
+    bool step(uint64_t limitUs = UINT64_MAX) {
+        uint64_t next = nextEventUs();
+        if (next == UINT64_MAX || next > limitUs) return false;
+
+        moveTo(next);
+        // Wheel timers due at this tick run before a queued event, like
+        // loop() servicing timers before the next request arrives
+        if (wheelDueUs() <= mock_micros_value) {
+            eventsRun += wheel->advance((uint32_t)(mock_micros_value / 1000));
+        }
+        if (count > 0 && heap[0].atUs <= mock_micros_value) {
+            Event e = pop();
+            e.fn(e.context);
+            eventsRun++;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Run everything due up to atUs, then set the clock to atUs
+     * @return Steps taken
+     */
+    size_t runUntil(uint64_t atUs) {
+        size_t steps = 0;
+        while (step(atUs)) steps++;
+        moveTo(atUs);
+        return steps;
+    }
+
+    size_t runFor(uint64_t durationUs) {
+        return runUntil(mock_micros_value + durationUs);
+    }
+
+    /**
+     * @brief Run until the queue is empty (wheel timers excluded)
+     * @param limitUs Give up at this time (periodic events never drain)
+     */
+    size_t runAll(uint64_t limitUs = UINT64_MAX) {
+        size_t steps = 0;
+        for (;;) {
+            dropCancelled();
+            if (count == 0 || !step(limitUs)) break;
+            steps++;
+        }
+        return steps;
+    }
+
+    uint64_t nowUs() const {
+        return mock_micros_value;
+    }
+
+    size_t pending() {
+        dropCancelled();
+        size_t live = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (heap[i].fn != nullptr) live++;
+        }
+        return live;
+    }
+
+    /**
+     * @brief Events and wheel callbacks run since reset()
+     */
+    uint64_t getEventsRun() const {
+        return eventsRun;
+    }
+};
+
+namespace Sim {
+    /**
+     * @brief Get the shared virtual clock
+     */
+    inline VirtualClock& clock() {
+        static VirtualClock instance;
+        return instance;
+    }
+}
+
+inline void VirtualClock::delayHook(unsigned long ms) {
+    Sim::clock().runFor((uint64_t)ms * 1000);
+}
@@ -0,0 +1,189 @@
+#include <unity.h>
+#include <string.h>
+#include "mocks/Arduino.h"
+#include "utils/alloc_hooks.h"
+#include "utils/report_pacer.h"
+#include "utils/tracer.h"
+#include "utils/heartbeat.h"
+#include "utils/rate_limiter.h"
+
+/**
+ * @file test_alloc_tracker.cpp
+ * @brief Unit tests for allocation counting, plus zero-allocation checks
+ *
+ * alloc_hooks.h replaces operator new/delete for this binary, so every
+ * C++ allocation is counted exactly. The hot-path tests pin down code
+ * that runs per report or per request and must never touch the heap.
+ */
+
+static bool discardSink(const HidReport& report, void* context) {
+    (void)report;
+    (void)context;
+    return true;
+}
+
+static void discardWrite(const char* data, size_t length, void* context) {
+    (void)data;
+    (void)length;
+    (void)context;
+}
+
+static void noopTimer(void* context) {
+    (void)context;
+}
+
+static HidReport makeReport(const char* text, bool last) {
+    HidReport report;
+    strncpy(report.text, text, Config::BLE::TEXT_CHUNK_SIZE);
+    report.text[Config::BLE::TEXT_CHUNK_SIZE] = '\0';
+    report.length = strlen(report.text);
+    report.last = last;
+    return report;
+}
+
+void setUp(void) {
+    mock_millis_value = 0;
+    mock_micros_value = 0;
+}
+
+void tearDown(void) {
+}
+
+// Test: The interposed allocator counts calls, bytes and frees
+void test_counts_allocations() {
+    AllocTracker& tracker = Allocations::tracker();
+    uint32_t frees = tracker.getFrees();
+
+    AllocScope scope;
+    int* value = new int(7);
+    char* block = new char[100];
+    TEST_ASSERT_EQUAL(2, scope.calls());
+    TEST_ASSERT_EQUAL(sizeof(int) + 100, scope.bytes());
+
+    delete value;
+    delete[] block;
+    TEST_ASSERT_EQUAL(2, tracker.getFrees() - frees);
+    TEST_ASSERT_TRUE(AllocTracker::isExact());
+}
+
+// Test: String copies allocate (the fragmentation suspect)
+void test_string_allocates() {
+    String source("hello");
+
+    AllocScope scope;
+    String copy(source);
+    TEST_ASSERT_EQUAL(1, scope.calls());
+    TEST_ASSERT_EQUAL(6, scope.bytes());
+}
+
+// Test: Nested scopes both see inner allocations; stats are charged on exit
+void test_nested_scopes() {
+    AllocStats manager;
+    AllocStats request;
+
+    {
+        AllocScope outer(&manager);
+        delete new int(1);
+        {
+            AllocScope inner(&request);
+            delete new int(2);
+            delete new int(3);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(3, manager.calls.get());
+    TEST_ASSERT_EQUAL(2, request.calls.get());
+    TEST_ASSERT_EQUAL(2 * sizeof(int), request.bytes.get());
+}
+
+// Test: CRITICAL - Report planning and emission never allocate
+void test_pacer_zero_alloc() {
+    ReportPacer pacer(1000);
+    pacer.setSink(&discardSink, nullptr);
+
+    AllocScope scope;
+    pacer.startJob();
+    pacer.enqueue(makeReport("abcd", false));
+    pacer.enqueue(makeReport("efgh", true));
+    pacer.tick(0);
+    pacer.tick(1000);
+    pacer.tick(2000);
+    TEST_ASSERT_EQUAL(0, scope.calls());
+}
+
+// Test: CRITICAL - Tracing, histograms, heartbeats and timers never allocate
+void test_instrumentation_zero_alloc() {
+    Tracer tracer;
+    LogLinearHistogram histogram;
+    HeartbeatSupervisor supervisor;
+    Heartbeat* hb = supervisor.add("http", 100);
+    TimingWheel wheel;
+    Timer timer;
+    timer.setCallback(&noopTimer, nullptr);
+
+    AllocScope scope;
+    TraceContext trace = tracer.startSpan();
+    tracer.record(trace, TraceStage::AUTH, 0, 10);
+    histogram.record(1234);
+    hb->arm("handleClient");
+    hb->beat("/type");
+    hb->disarm();
+    supervisor.check(50);
+    wheel.armPeriodic(timer, 10);
+    wheel.advance(100);
+    wheel.cancel(timer);
+    TEST_ASSERT_EQUAL(0, scope.calls());
+}
+
+// Test: CRITICAL - /metrics export streams without allocating
+void test_metrics_render_zero_alloc() {
+    MetricsRegistry registry;
+    Counter counter;
+    LogLinearHistogram histogram;
+    registry.addCounter("requests_total", "Requests", counter, "route", "/type");
+    registry.addHistogram("latency_seconds", "Latency", histogram, 1e-6);
+    histogram.record(2500);
+
+    char buffer[64];
+    ChunkedWriter out(buffer, sizeof(buffer), &discardWrite, nullptr);
+
+    AllocScope scope;
+    counter.inc();
+    registry.render(out);
+    out.flush();
+    TEST_ASSERT_EQUAL(0, scope.calls());
+}
+
+// Test: CRITICAL - Rate limiting new, known and evicted clients never allocates
+void test_rate_limiter_zero_alloc() {
+    RateLimiter limiter(1000, 5);
+
+    AllocScope scope;
+    for (uint32_t i = 0; i < Config::RateLimit::MAX_CLIENTS + 10; i++) {
+        mock_millis_value = i;
+        limiter.checkLimit(IPAddress(10, 0, (uint8_t)(i >> 8), (uint8_t)i));
+        limiter.checkLimit(IPAddress(10, 0, (uint8_t)(i >> 8), (uint8_t)i));
+    }
+    mock_millis_value = 60000;
+    limiter.cleanup();
+    TEST_ASSERT_EQUAL(0, scope.calls());
+    TEST_ASSERT_EQUAL(10, limiter.getEvictions());
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_counts_allocations);
+    RUN_TEST(test_string_allocates);
+    RUN_TEST(test_nested_scopes);
+    RUN_TEST(test_pacer_zero_alloc);
+    RUN_TEST(test_instrumentation_zero_alloc);
+    RUN_TEST(test_metrics_render_zero_alloc);
+    RUN_TEST(test_rate_limiter_zero_alloc);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
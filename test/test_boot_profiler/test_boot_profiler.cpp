@@ -0,0 +1,96 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/boot_profiler.h"
+
+/**
+ * @file test_boot_profiler.cpp
+ * @brief Unit tests for setup() phase timing and boot milestones
+ */
+
+void setUp(void) {
+    mock_millis_value = 0;
+    mock_micros_value = 0;
+}
+
+void tearDown(void) {
+}
+
+// Test: Each phase runs from the previous mark to its own
+void test_phases_chain() {
+    BootProfiler boot;
+    mock_micros_value = 300000;  // Bootloader
+    boot.begin();
+
+    mock_micros_value += 100000;
+    boot.phaseDone(BootPhase::CONSOLE);
+    mock_micros_value += 5000;
+    boot.phaseDone(BootPhase::LED);
+    mock_micros_value += 650000;
+    boot.phaseDone(BootPhase::BLE);
+    boot.setupDone();
+
+    TEST_ASSERT_EQUAL(100000, boot.phaseUs(BootPhase::CONSOLE));
+    TEST_ASSERT_EQUAL(5000, boot.phaseUs(BootPhase::LED));
+    TEST_ASSERT_EQUAL(650000, boot.phaseUs(BootPhase::BLE));
+    TEST_ASSERT_EQUAL(0, boot.phaseUs(BootPhase::HTTP));
+    TEST_ASSERT_EQUAL(755000, boot.setupUs());
+    TEST_ASSERT_EQUAL_UINT64(300000ULL, boot.getSetupStartUs());
+}
+
+// Test: CRITICAL - Milestones keep only their first occurrence
+void test_milestone_first_only() {
+    BootProfiler boot;
+    boot.begin();
+
+    TEST_ASSERT_EQUAL_UINT64(0ULL, boot.milestoneAtUs(BootMilestone::FIRST_REQUEST));
+
+    mock_micros_value = 2500000;
+    TEST_ASSERT_TRUE(boot.reach(BootMilestone::FIRST_REQUEST));
+    mock_micros_value = 9000000;
+    TEST_ASSERT_FALSE(boot.reach(BootMilestone::FIRST_REQUEST));
+
+    TEST_ASSERT_EQUAL_UINT64(2500000ULL, boot.milestoneAtUs(BootMilestone::FIRST_REQUEST));
+    TEST_ASSERT_EQUAL_UINT64(0ULL, boot.milestoneAtUs(BootMilestone::WIFI_CONNECTED));
+}
+
+// Test: JSON lists completed phases in order and null for pending milestones
+void test_json() {
+    BootProfiler boot;
+    mock_micros_value = 1000;
+    boot.begin();
+    mock_micros_value = 3000;
+    boot.phaseDone(BootPhase::WIFI_START);
+    mock_micros_value = 4000;
+    boot.phaseDone(BootPhase::BLE);
+    boot.setupDone();
+    mock_micros_value = 7000;
+    boot.reach(BootMilestone::WIFI_CONNECTED);
+
+    char json[1024];
+    size_t len = boot.toJson(json, sizeof(json));
+
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_NOT_NULL(strstr(json, "{\"preSetupUs\":1000,\"setupUs\":3000,\"phases\":["
+                                      "{\"name\":\"wifi_start\",\"startUs\":1000,\"durationUs\":2000},"
+                                      "{\"name\":\"ble\",\"startUs\":3000,\"durationUs\":1000}]"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"milestonesUs\":{\"wifi_connected\":7000,"
+                                      "\"ble_connected\":null,\"first_request\":null}}"));
+
+    // Too small a buffer yields an empty string, never partial JSON
+    TEST_ASSERT_EQUAL(0, boot.toJson(json, 40));
+    TEST_ASSERT_EQUAL_STRING("", json);
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_phases_chain);
+    RUN_TEST(test_milestone_first_only);
+    RUN_TEST(test_json);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,158 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/coroutine.h"
+
+/**
+ * @file test_coroutine.cpp
+ * @brief Unit tests for stackless coroutines
+ *
+ * Drives small sequences the same way managers do from update(),
+ * advancing mock time between resumes.
+ */
+
+/**
+ * @brief "press; wait 100 ms; release" sequence with an observable log
+ */
+struct PressRelease {
+    Coroutine co;
+    int pressed;
+    int released;
+
+    PressRelease() : pressed(0), released(0) {}
+
+    bool run() {
+        CO_BEGIN(co);
+        pressed++;
+        CO_DELAY(co, 100);
+        released++;
+        CO_END(co);
+    }
+};
+
+/**
+ * @brief Sequence with a loop, a yield and an early exit
+ */
+struct Counter {
+    Coroutine co;
+    int count;
+    int limit;
+
+    Counter() : count(0), limit(3) {}
+
+    bool run() {
+        CO_BEGIN(co);
+        while (count < 10) {
+            count++;
+            if (count == limit) CO_EXIT(co);
+            CO_YIELD(co);
+        }
+        CO_END(co);
+    }
+};
+
+void setUp(void) {
+    mock_millis_value = 1000;
+}
+
+void tearDown(void) {
+}
+
+// Test: A new coroutine is not running until reset
+void test_not_running_until_reset() {
+    Coroutine co;
+    TEST_ASSERT_FALSE(co.isRunning());
+    co.reset();
+    TEST_ASSERT_TRUE(co.isRunning());
+}
+
+// Test: Delay suspends until the interval elapses
+void test_delay_suspends() {
+    PressRelease seq;
+    seq.co.reset();
+
+    TEST_ASSERT_TRUE(seq.run());
+    TEST_ASSERT_EQUAL(1, seq.pressed);
+    TEST_ASSERT_EQUAL(0, seq.released);
+
+    mock_millis_value += 99;
+    TEST_ASSERT_TRUE(seq.run());
+    TEST_ASSERT_EQUAL(0, seq.released);
+
+    mock_millis_value += 1;
+    TEST_ASSERT_FALSE(seq.run());
+    TEST_ASSERT_EQUAL(1, seq.pressed);
+    TEST_ASSERT_EQUAL(1, seq.released);
+    TEST_ASSERT_FALSE(seq.co.isRunning());
+}
+
+// Test: Resuming a finished coroutine does nothing
+void test_finished_stays_finished() {
+    PressRelease seq;
+    seq.co.reset();
+    seq.run();
+    mock_millis_value += 100;
+    seq.run();
+
+    TEST_ASSERT_FALSE(seq.run());
+    TEST_ASSERT_EQUAL(1, seq.pressed);
+}
+
+// Test: Yield inside a loop and early exit
+void test_yield_and_exit() {
+    Counter c;
+    c.co.reset();
+
+    TEST_ASSERT_TRUE(c.run());
+    TEST_ASSERT_EQUAL(1, c.count);
+    TEST_ASSERT_TRUE(c.run());
+    TEST_ASSERT_EQUAL(2, c.count);
+    TEST_ASSERT_FALSE(c.run());
+    TEST_ASSERT_EQUAL(3, c.count);
+    TEST_ASSERT_FALSE(c.co.isRunning());
+}
+
+// Test: Cancel stops a suspended coroutine
+void test_cancel() {
+    PressRelease seq;
+    seq.co.reset();
+    seq.run();
+    seq.co.cancel();
+
+    mock_millis_value += 500;
+    TEST_ASSERT_FALSE(seq.run());
+    TEST_ASSERT_EQUAL(0, seq.released);
+}
+
+// Test: Reset restarts from the beginning
+void test_reset_restarts() {
+    PressRelease seq;
+    seq.co.reset();
+    seq.run();
+    seq.co.reset();
+    seq.run();
+
+    TEST_ASSERT_EQUAL(2, seq.pressed);
+}
+
+// Test: Coroutine state stays small
+void test_state_is_small() {
+    TEST_ASSERT_TRUE(sizeof(Coroutine) <= 12);
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_not_running_until_reset);
+    RUN_TEST(test_delay_suspends);
+    RUN_TEST(test_finished_stays_finished);
+    RUN_TEST(test_yield_and_exit);
+    RUN_TEST(test_cancel);
+    RUN_TEST(test_reset_restarts);
+    RUN_TEST(test_state_is_small);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
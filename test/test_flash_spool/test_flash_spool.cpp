@@ -0,0 +1,202 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/flash_spool.h"
+
+/**
+ * @file test_flash_spool.cpp
+ * @brief Unit tests for the flash text spool and its progress journal
+ *
+ * The native partition lives in RAM for the life of the FlashSpool, and
+ * begin() can be called again on it to stand in for a reboot.
+ */
+
+static FlashSpool* spool;
+static char document[20000];
+
+static ErrorCode upload(const char* text, size_t length, size_t piece) {
+    ErrorCode result = spool->beginUpload(length);
+    for (size_t done = 0; result == ErrorCode::SUCCESS && done < length; done += piece) {
+        size_t n = length - done < piece ? length - done : piece;
+        result = spool->append(reinterpret_cast<const uint8_t*>(text + done), n);
+    }
+    return result == ErrorCode::SUCCESS ? spool->commit() : result;
+}
+
+void setUp(void) {
+    for (size_t i = 0; i < sizeof(document); i++) {
+        document[i] = (char)('a' + (i * 7 + i / 26) % 26);
+    }
+    spool = new FlashSpool();
+    spool->begin();
+}
+
+void tearDown(void) {
+    delete spool;
+    spool = nullptr;
+}
+
+// Test: CRITICAL - Text uploaded in pieces reads back in place, and survives a reboot
+void test_upload_and_map() {
+    TEST_ASSERT_NULL(spool->text());
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)upload(document, sizeof(document), 1436));
+    TEST_ASSERT_EQUAL(sizeof(document), spool->getLength());
+    TEST_ASSERT_NOT_NULL(spool->text());
+    TEST_ASSERT_TRUE(memcmp(spool->text(), document, sizeof(document)) == 0);
+
+    TEST_ASSERT_TRUE(spool->begin());
+    TEST_ASSERT_FALSE(spool->isDamaged());
+    TEST_ASSERT_EQUAL(sizeof(document), spool->getLength());
+    TEST_ASSERT_EQUAL(0, spool->getTyped());
+    TEST_ASSERT_TRUE(memcmp(spool->text(), document, sizeof(document)) == 0);
+}
+
+// Test: CRITICAL - An upload that stops short, or is cut off, leaves no document
+void test_incomplete_upload() {
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)spool->beginUpload(sizeof(document)));
+    spool->append(reinterpret_cast<const uint8_t*>(document), 5000);
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_PARAMETER, (int)spool->commit());
+    TEST_ASSERT_NULL(spool->text());
+
+    spool->beginUpload(sizeof(document));
+    spool->append(reinterpret_cast<const uint8_t*>(document), 5000);
+    spool->cancelUpload();
+    spool->begin();  // Reset mid-upload
+    TEST_ASSERT_EQUAL(0, spool->getLength());
+    TEST_ASSERT_FALSE(spool->isDamaged());
+}
+
+// Test: Length and characters are checked before and while writing
+void test_upload_rejects() {
+    TEST_ASSERT_EQUAL((int)ErrorCode::MESSAGE_EMPTY, (int)spool->beginUpload(0));
+    TEST_ASSERT_EQUAL((int)ErrorCode::MESSAGE_TOO_LONG,
+                      (int)spool->beginUpload(spool->getCapacity() + 1));
+
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)spool->beginUpload(10));
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_CHARACTERS,
+                      (int)spool->append(reinterpret_cast<const uint8_t*>("ok\x01"), 3));
+    TEST_ASSERT_FALSE(spool->isUploading());
+
+    spool->beginUpload(4);
+    TEST_ASSERT_EQUAL((int)ErrorCode::MESSAGE_TOO_LONG,
+                      (int)spool->append(reinterpret_cast<const uint8_t*>("12345"), 5));
+}
+
+// Test: CRITICAL - A rejected, short or abandoned upload keeps the old document
+void test_rejected_upload_keeps_document() {
+    upload(document, sizeof(document), 4096);
+    spool->checkpoint(300);
+    TEST_ASSERT_EQUAL((int)ErrorCode::MESSAGE_TOO_LONG,
+                      (int)spool->beginUpload(spool->getCapacity() + 1));
+
+    // Bad characters part-way through
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)spool->beginUpload(9000));
+    spool->append(reinterpret_cast<const uint8_t*>("new text"), 8);
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_CHARACTERS,
+                      (int)spool->append(reinterpret_cast<const uint8_t*>("ok\x01"), 3));
+
+    // Fewer bytes than announced
+    spool->beginUpload(9000);
+    spool->append(reinterpret_cast<const uint8_t*>(document), 5000);
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_PARAMETER, (int)spool->commit());
+    TEST_ASSERT_EQUAL(sizeof(document), spool->getLength());
+    TEST_ASSERT_TRUE(memcmp(spool->text(), document, sizeof(document)) == 0);
+
+    // Reset mid-upload
+    spool->beginUpload(9000);
+    spool->append(reinterpret_cast<const uint8_t*>("new text"), 8);
+    spool->begin();
+    TEST_ASSERT_FALSE(spool->isDamaged());
+    TEST_ASSERT_EQUAL(sizeof(document), spool->getLength());
+    TEST_ASSERT_EQUAL(300, spool->getTyped());
+    TEST_ASSERT_TRUE(memcmp(spool->text(), document, sizeof(document)) == 0);
+}
+
+// Test: Each upload replaces the last one, alternating text areas, across reboots
+void test_replace_document() {
+    upload(document, sizeof(document), 4096);
+    spool->checkpoint(500);
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)upload("second document", 15, 15));
+    TEST_ASSERT_EQUAL(15, spool->getLength());
+    TEST_ASSERT_EQUAL(0, spool->getTyped());
+    TEST_ASSERT_TRUE(memcmp(spool->text(), "second document", 15) == 0);
+
+    spool->begin();
+    TEST_ASSERT_FALSE(spool->isDamaged());
+    TEST_ASSERT_EQUAL(15, spool->getLength());
+    TEST_ASSERT_EQUAL(0, spool->getTyped());
+
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)upload(document, sizeof(document), 1000));
+    spool->begin();
+    TEST_ASSERT_EQUAL(sizeof(document), spool->getLength());
+    TEST_ASSERT_TRUE(memcmp(spool->text(), document, sizeof(document)) == 0);
+}
+
+// Test: CRITICAL - Checkpoints survive a reboot; stale or backward positions are ignored
+void test_checkpoint_resume() {
+    upload(document, sizeof(document), 4096);
+    TEST_ASSERT_TRUE(spool->checkpoint(100));
+    TEST_ASSERT_TRUE(spool->checkpoint(2500));
+    TEST_ASSERT_FALSE(spool->checkpoint(2500));
+    TEST_ASSERT_FALSE(spool->checkpoint(1000));
+    TEST_ASSERT_EQUAL(2, spool->getCheckpoints());
+
+    spool->begin();
+    TEST_ASSERT_EQUAL(2500, spool->getTyped());
+
+    // Past the end is clamped to the end
+    TEST_ASSERT_TRUE(spool->checkpoint(sizeof(document) + 50));
+    spool->begin();
+    TEST_ASSERT_EQUAL(sizeof(document), spool->getTyped());
+}
+
+// Test: A full journal moves to the other header sector without losing the document
+void test_journal_wraps() {
+    upload(document, sizeof(document), 4096);
+    size_t last = 0;
+    for (size_t i = 1; i <= FlashSpool::JOURNAL_SLOTS * 2 + 5; i++) {
+        last = i * 5;
+        TEST_ASSERT_TRUE(spool->checkpoint(last));
+    }
+    TEST_ASSERT_TRUE(spool->getCheckpoints() < FlashSpool::JOURNAL_SLOTS);
+
+    spool->begin();
+    TEST_ASSERT_FALSE(spool->isDamaged());
+    TEST_ASSERT_EQUAL(sizeof(document), spool->getLength());
+    TEST_ASSERT_EQUAL(last, spool->getTyped());
+}
+
+// Test: rewind() restarts from zero across a reboot; discard() deletes
+void test_rewind_and_discard() {
+    upload(document, sizeof(document), 4096);
+    spool->checkpoint(777);
+    TEST_ASSERT_TRUE(spool->rewind());
+    TEST_ASSERT_EQUAL(0, spool->getTyped());
+    spool->begin();
+    TEST_ASSERT_EQUAL(0, spool->getTyped());
+    TEST_ASSERT_EQUAL(sizeof(document), spool->getLength());
+
+    TEST_ASSERT_TRUE(spool->discard());
+    TEST_ASSERT_NULL(spool->text());
+    TEST_ASSERT_FALSE(spool->checkpoint(10));
+    spool->begin();
+    TEST_ASSERT_EQUAL(0, spool->getLength());
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_upload_and_map);
+    RUN_TEST(test_incomplete_upload);
+    RUN_TEST(test_upload_rejects);
+    RUN_TEST(test_rejected_upload_keeps_document);
+    RUN_TEST(test_replace_document);
+    RUN_TEST(test_checkpoint_resume);
+    RUN_TEST(test_journal_wraps);
+    RUN_TEST(test_rewind_and_discard);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,99 @@
+#define HEAP_TRAP_AFTER_BOOT 1
+
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/alloc_hooks.h"
+#include "utils/heap_trap.h"
+
+/**
+ * @file test_heap_trap.cpp
+ * @brief Unit tests for the zero-heap-after-boot trap
+ *
+ * Built with the trap enabled and a counting handler in place of
+ * abort(), so the tests can see which allocations would have trapped.
+ */
+
+static uint32_t handled = 0;
+static size_t lastSize = 0;
+
+static void countTrap(size_t size, void* context) {
+    (void)context;
+    handled++;
+    lastSize = size;
+}
+
+static void allocateOne(size_t size) {
+    char* block = new char[size];
+    delete[] block;
+}
+
+void setUp(void) {
+    handled = 0;
+    lastSize = 0;
+    HeapTrap::setHandler(&countTrap, nullptr);
+}
+
+void tearDown(void) {
+    HeapTrap::disarm();
+    HeapTrap::setHandler(nullptr, nullptr);
+}
+
+// Test: Nothing traps until arm() (boot allocations are fine)
+void test_not_armed_during_boot() {
+    allocateOne(16);
+    TEST_ASSERT_EQUAL(0, handled);
+}
+
+// Test: CRITICAL - Once armed, an allocation reaches the handler
+void test_armed_traps_allocation() {
+    HeapTrap::arm();
+    TEST_ASSERT_TRUE(HeapTrap::isArmed());
+
+    uint32_t before = HeapTrap::getTrapped();
+    allocateOne(48);
+    TEST_ASSERT_EQUAL(1, handled);
+    TEST_ASSERT_EQUAL(48, lastSize);
+    TEST_ASSERT_EQUAL(before + 1, HeapTrap::getTrapped());
+}
+
+// Test: Allow exempts a library call; Forbid re-arms inside it
+void test_allow_and_forbid() {
+    HeapTrap::arm();
+    {
+        HeapTrap::Allow library;
+        allocateOne(8);
+        TEST_ASSERT_EQUAL(0, handled);
+        {
+            HeapTrap::Forbid strict;
+            allocateOne(8);
+            TEST_ASSERT_EQUAL(1, handled);
+        }
+        allocateOne(8);  // Allow is back in force
+        TEST_ASSERT_EQUAL(1, handled);
+    }
+    allocateOne(8);
+    TEST_ASSERT_EQUAL(2, handled);
+}
+
+// Test: Freeing never traps (boot-time objects may be released later)
+void test_free_does_not_trap() {
+    char* block = new char[32];
+    HeapTrap::arm();
+    delete[] block;
+    TEST_ASSERT_EQUAL(0, handled);
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_not_armed_during_boot);
+    RUN_TEST(test_armed_traps_allocation);
+    RUN_TEST(test_allow_and_forbid);
+    RUN_TEST(test_free_does_not_trap);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
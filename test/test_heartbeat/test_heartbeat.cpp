@@ -0,0 +1,185 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/heartbeat.h"
+
+/**
+ * @file test_heartbeat.cpp
+ * @brief Unit tests for per-manager heartbeats and stall attribution
+ *
+ * check() is called directly with the mock clock; on device it runs
+ * from an esp_timer.
+ */
+
+void setUp(void) {
+    mock_micros_value = 0;
+}
+
+void tearDown(void) {
+}
+
+// Test: Disarmed heartbeats never stall
+void test_disarmed_never_stalls() {
+    HeartbeatSupervisor supervisor;
+    Heartbeat* hb = supervisor.add("ble", 100);
+
+    mock_micros_value = 10000 * 1000ULL;
+    TEST_ASSERT_EQUAL(0, supervisor.check(10000));
+    TEST_ASSERT_FALSE(hb->isStalled());
+}
+
+// Test: Beats within budget keep an armed heartbeat healthy
+void test_beats_within_budget() {
+    HeartbeatSupervisor supervisor;
+    Heartbeat* hb = supervisor.add("hid_pump", 100);
+
+    hb->arm("startPacing");
+    for (uint32_t t = 50; t <= 1000; t += 50) {
+        mock_micros_value = t * 1000ULL;
+        hb->beat("pacer.tick");
+        TEST_ASSERT_EQUAL(0, supervisor.check(t + 40));
+    }
+    TEST_ASSERT_EQUAL(0, hb->getStallCount());
+}
+
+// Test: CRITICAL - Overrun is counted once per episode and names the location
+void test_stall_detected_once() {
+    HeartbeatSupervisor supervisor;
+    Heartbeat* hb = supervisor.add("http", 3000);
+
+    mock_micros_value = 1000 * 1000ULL;
+    hb->arm("handleClient");
+    hb->beat("/type");
+
+    TEST_ASSERT_EQUAL(0, supervisor.check(4000));
+    TEST_ASSERT_EQUAL(1, supervisor.check(4001));
+    TEST_ASSERT_EQUAL(1, supervisor.check(9000));
+    TEST_ASSERT_TRUE(hb->isStalled());
+    TEST_ASSERT_EQUAL(1, hb->getStallCount());
+
+    const StallRecord* record = supervisor.getCurrentStall();
+    TEST_ASSERT_NOT_NULL(record);
+    TEST_ASSERT_EQUAL_STRING("http", record->manager);
+    TEST_ASSERT_EQUAL_STRING("/type", record->where);
+    TEST_ASSERT_EQUAL(8000, record->stalledMs);
+    TEST_ASSERT_EQUAL(3000, record->budgetMs);
+
+    // Recovery clears the flag; the next overrun is a new episode
+    mock_micros_value = 9500 * 1000ULL;
+    hb->beat("handleClient");
+    TEST_ASSERT_FALSE(hb->isStalled());
+    TEST_ASSERT_EQUAL(1, supervisor.check(13000));
+    TEST_ASSERT_EQUAL(2, hb->getStallCount());
+}
+
+// Test: CRITICAL - A beat stamped after the supervisor read the clock is not a stall
+void test_beat_ahead_of_check() {
+    HeartbeatSupervisor supervisor;
+    Heartbeat* hb = supervisor.add("loop", 5000);
+
+    mock_micros_value = 20000 * 1000ULL;
+    hb->arm("loop");  // Other core, just after check() sampled 19999 ms
+
+    TEST_ASSERT_EQUAL(0, supervisor.check(19999));
+    TEST_ASSERT_FALSE(hb->isStalled());
+    TEST_ASSERT_EQUAL(0, hb->getStallCount());
+    TEST_ASSERT_NULL(supervisor.getCurrentStall());
+}
+
+// Test: CRITICAL - A stall that recovered is not left for the next boot to report
+void test_recovered_stall_cleared() {
+    HeartbeatSupervisor supervisor;
+    Heartbeat* hb = supervisor.add("ble", 500);
+
+    mock_micros_value = 1000 * 1000ULL;
+    hb->arm("processSendQueue");
+    TEST_ASSERT_EQUAL(1, supervisor.check(2000));
+    TEST_ASSERT_NOT_NULL(supervisor.getCurrentStall());
+
+    mock_micros_value = 2100 * 1000ULL;
+    hb->beat("processSendQueue");
+    TEST_ASSERT_EQUAL(0, supervisor.check(2200));
+    TEST_ASSERT_NULL(supervisor.getCurrentStall());
+
+    // Stalled then disarmed (the section returned) also counts as recovered
+    TEST_ASSERT_EQUAL(1, supervisor.check(3000));
+    hb->disarm();
+    TEST_ASSERT_EQUAL(0, supervisor.check(3250));
+    TEST_ASSERT_NULL(supervisor.getCurrentStall());
+
+    HeartbeatSupervisor after;
+    after.begin();
+    TEST_ASSERT_FALSE(after.hasPreviousStall());
+}
+
+// Test: The section furthest past its budget is blamed
+void test_blames_worst_overrun() {
+    HeartbeatSupervisor supervisor;
+    Heartbeat* loop = supervisor.add("loop", 5000);
+    Heartbeat* ble = supervisor.add("ble", 500);
+
+    loop->arm("loop");
+    {
+        HeartbeatScope watch(ble, "processSendQueue");
+        TEST_ASSERT_TRUE(ble->isArmed());
+
+        // loop() is stuck inside the BLE section
+        TEST_ASSERT_EQUAL(2, supervisor.check(6000));
+        TEST_ASSERT_EQUAL_STRING("ble", supervisor.getCurrentStall()->manager);
+        TEST_ASSERT_EQUAL_STRING("processSendQueue", supervisor.getCurrentStall()->where);
+    }
+    TEST_ASSERT_FALSE(ble->isArmed());
+}
+
+// Test: A stall recorded before a reset is reported by the next begin()
+void test_previous_stall_survives_reset() {
+    {
+        HeartbeatSupervisor before;
+        Heartbeat* hb = before.add("timers", 500);
+        hb->arm("wheel.advance");
+        before.check(2000);
+    }
+
+    HeartbeatSupervisor after;
+    after.begin();
+
+    TEST_ASSERT_TRUE(after.hasPreviousStall());
+    TEST_ASSERT_EQUAL_STRING("timers", after.getPreviousStall().manager);
+    TEST_ASSERT_EQUAL_STRING("wheel.advance", after.getPreviousStall().where);
+    TEST_ASSERT_EQUAL(2000, after.getPreviousStall().stalledMs);
+
+    // Consumed: this boot starts clean
+    TEST_ASSERT_NULL(after.getCurrentStall());
+}
+
+// Test: Registration is idempotent and bounded
+void test_add_limits() {
+    HeartbeatSupervisor supervisor;
+    Heartbeat* a = supervisor.add("ble", 100);
+    TEST_ASSERT_TRUE(a == supervisor.add("ble", 100));
+
+    static const char* const names[] = { "m1", "m2", "m3", "m4", "m5", "m6", "m7" };
+    for (size_t i = 0; i + 1 < Config::Watchdog::MAX_HEARTBEATS; i++) {
+        TEST_ASSERT_NOT_NULL(supervisor.add(names[i], 100));
+    }
+    TEST_ASSERT_EQUAL(Config::Watchdog::MAX_HEARTBEATS, supervisor.size());
+    TEST_ASSERT_NULL(supervisor.add("extra", 100));
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_disarmed_never_stalls);
+    RUN_TEST(test_beats_within_budget);
+    RUN_TEST(test_stall_detected_once);
+    RUN_TEST(test_beat_ahead_of_check);
+    RUN_TEST(test_recovered_stall_cleared);
+    RUN_TEST(test_blames_worst_overrun);
+    RUN_TEST(test_previous_stall_survives_reset);
+    RUN_TEST(test_add_limits);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,110 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/histogram.h"
+
+/**
+ * @file test_histogram.cpp
+ * @brief Unit tests for the log-linear histogram
+ */
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Test: Small values map to exact buckets
+void test_small_values_exact() {
+    for (uint32_t v = 0; v < LogLinearHistogram::SUB_BUCKETS; v++) {
+        size_t index = LogLinearHistogram::bucketIndex(v);
+        TEST_ASSERT_EQUAL(v, LogLinearHistogram::bucketLowerBound(index));
+        TEST_ASSERT_EQUAL(v, LogLinearHistogram::bucketUpperBound(index));
+    }
+}
+
+// Test: Every value falls within its bucket's bounds
+void test_bucket_bounds_contain_value() {
+    const uint32_t samples[] = {4, 5, 7, 8, 100, 1000, 65535, 65536, 123456789, 0xFFFFFFFFu};
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        size_t index = LogLinearHistogram::bucketIndex(samples[i]);
+        TEST_ASSERT_TRUE(index < LogLinearHistogram::BUCKET_COUNT);
+        TEST_ASSERT_TRUE(LogLinearHistogram::bucketLowerBound(index) <= samples[i]);
+        TEST_ASSERT_TRUE(LogLinearHistogram::bucketUpperBound(index) >= samples[i]);
+    }
+}
+
+// Test: Relative bucket width stays within 1/SUB_BUCKETS
+void test_relative_error_bounded() {
+    for (size_t i = LogLinearHistogram::SUB_BUCKETS; i < LogLinearHistogram::BUCKET_COUNT - 1; i++) {
+        uint32_t lower = LogLinearHistogram::bucketLowerBound(i);
+        uint32_t width = LogLinearHistogram::bucketUpperBound(i) - lower + 1;
+        TEST_ASSERT_TRUE((uint64_t)width * LogLinearHistogram::SUB_BUCKETS <= lower);
+    }
+}
+
+// Test: Percentiles, min, max and mean
+void test_percentiles() {
+    LogLinearHistogram h;
+    for (uint32_t v = 1; v <= 100; v++) {
+        h.record(v);
+    }
+
+    TEST_ASSERT_EQUAL(100, h.count());
+    TEST_ASSERT_EQUAL(1, h.min());
+    TEST_ASSERT_EQUAL(100, h.max());
+    TEST_ASSERT_EQUAL(50, h.mean());
+
+    uint32_t p50 = h.percentile(50.0f);
+    TEST_ASSERT_TRUE(p50 >= 50 && p50 <= 63);
+    TEST_ASSERT_EQUAL(100, h.percentile(100.0f));
+}
+
+// Test: Empty histogram reports zeros
+void test_empty() {
+    LogLinearHistogram h;
+    TEST_ASSERT_EQUAL(0, h.count());
+    TEST_ASSERT_EQUAL(0, h.min());
+    TEST_ASSERT_EQUAL(0, h.percentile(99.0f));
+}
+
+// Test: Merge combines counts and extremes
+void test_merge() {
+    LogLinearHistogram a;
+    LogLinearHistogram b;
+    a.record(10);
+    b.record(1000);
+
+    a.merge(b);
+    TEST_ASSERT_EQUAL(2, a.count());
+    TEST_ASSERT_EQUAL(10, a.min());
+    TEST_ASSERT_EQUAL(1000, a.max());
+}
+
+// Test: JSON output lists non-empty buckets
+void test_to_json() {
+    LogLinearHistogram h;
+    h.record(2);
+    h.record(2);
+
+    char json[64];
+    h.toJson(json, sizeof(json));
+    TEST_ASSERT_EQUAL_STRING("[[2,2,2]]", json);
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_small_values_exact);
+    RUN_TEST(test_bucket_bounds_contain_value);
+    RUN_TEST(test_relative_error_bounded);
+    RUN_TEST(test_percentiles);
+    RUN_TEST(test_empty);
+    RUN_TEST(test_merge);
+    RUN_TEST(test_to_json);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,217 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/job_journal.h"
+
+/**
+ * @file test_job_journal.cpp
+ * @brief Unit tests for the RTC job journal
+ *
+ * On native builds the RTC record is an ordinary static shared by every
+ * JobJournal, so a second journal's begin() stands in for the next boot.
+ */
+
+static const char* TEXT = "The quick brown fox jumps over the lazy dog";
+
+static JobTag textTag(const char* text, size_t from = 0, uint32_t id = 0) {
+    size_t length = strlen(text);
+    return JobTag(JobKind::TEXT, Crc32::compute(text, length), length, from, id);
+}
+
+void setUp(void) {
+    JobJournal journal;
+    journal.clear();
+}
+
+void tearDown(void) {
+}
+
+// Test: Jobs get increasing IDs; progress counts each report; finish records the outcome
+void test_job_lifecycle() {
+    JobJournal journal;
+    journal.begin();
+
+    uint32_t first = journal.start(textTag(TEXT));
+    journal.progress(4);
+    journal.progress(4);
+    TEST_ASSERT_EQUAL(8, journal.getCurrent()->position());
+    journal.finish(true);
+    TEST_ASSERT_NULL(journal.getCurrent());
+
+    uint32_t second = journal.start(textTag("hello"));
+    journal.progress(2);
+    journal.finish(false);
+    TEST_ASSERT_TRUE(second > first);
+
+    TEST_ASSERT_EQUAL((uint32_t)JobState::COMPLETED, journal.find(first)->state);
+    TEST_ASSERT_EQUAL((uint32_t)JobState::FAILED, journal.find(second)->state);
+    TEST_ASSERT_TRUE(journal.find(second)->isStopped());
+
+    // No job running: progress is ignored
+    journal.progress(10);
+    TEST_ASSERT_EQUAL(2, journal.find(second)->position());
+}
+
+// Test: CRITICAL - A job running at reset is reported interrupted at the exact position
+void test_interrupted_by_reset() {
+    uint32_t id;
+    {
+        JobJournal before;
+        before.begin();
+        id = before.start(textTag(TEXT));
+        before.progress(4);
+        before.progress(3);
+    }
+
+    JobJournal after;
+    after.begin();
+    TEST_ASSERT_EQUAL(1, after.getInterruptedAtBoot());
+    const JobEntry* job = after.find(id);
+    TEST_ASSERT_NOT_NULL(job);
+    TEST_ASSERT_EQUAL((uint32_t)JobState::INTERRUPTED, job->state);
+    TEST_ASSERT_EQUAL(7, job->position());
+    TEST_ASSERT_EQUAL(strlen(TEXT), job->length);
+
+    // New jobs don't reuse the ID
+    TEST_ASSERT_TRUE(after.start(textTag("next")) > id);
+}
+
+// Test: CRITICAL - An entry torn by a reset is dropped, not misread
+void test_torn_entry_dropped() {
+    uint32_t id;
+    {
+        JobJournal before;
+        before.begin();
+        id = before.start(textTag(TEXT));
+        before.progress(4);
+        const_cast<JobEntry*>(before.find(id))->length = 9999;  // check no longer matches
+    }
+
+    JobJournal after;
+    after.begin();
+    TEST_ASSERT_EQUAL(0, after.getInterruptedAtBoot());
+    TEST_ASSERT_NULL(after.find(id));
+}
+
+// Test: CRITICAL - Resuming needs the same text; the job keeps its ID and carries on
+void test_resume_point() {
+    uint32_t id;
+    {
+        JobJournal before;
+        before.begin();
+        id = before.start(textTag(TEXT));
+        before.progress(12);
+    }
+    JobJournal journal;
+    journal.begin();
+
+    size_t from = 99;
+    size_t length = strlen(TEXT);
+    uint32_t hash = Crc32::compute(TEXT, length);
+    TEST_ASSERT_EQUAL((int)ErrorCode::NOT_FOUND,
+                      (int)journal.resumePoint(id + 5, JobKind::TEXT, hash, length, from));
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_PARAMETER,
+                      (int)journal.resumePoint(id, JobKind::TEXT, hash ^ 1, length, from));
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_PARAMETER,
+                      (int)journal.resumePoint(id, JobKind::SNIPPET, hash, length, from));
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS,
+                      (int)journal.resumePoint(id, JobKind::TEXT, hash, length, from));
+    TEST_ASSERT_EQUAL(12, from);
+
+    // Interrupted again part-way through the resumed run
+    TEST_ASSERT_EQUAL(id, journal.start(textTag(TEXT, from, id)));
+    journal.progress(8);
+    JobJournal again;
+    again.begin();
+    TEST_ASSERT_EQUAL(20, again.find(id)->position());
+
+    // Resumed to the end: nothing left to resume
+    again.start(textTag(TEXT, 20, id));
+    again.progress(length - 20);
+    again.finish(true);
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_PARAMETER,
+                      (int)again.resumePoint(id, JobKind::TEXT, hash, length, from));
+}
+
+// Test: A full journal drops ended jobs before interrupted ones
+void test_slot_reuse() {
+    uint32_t interrupted;
+    {
+        JobJournal before;
+        before.begin();
+        interrupted = before.start(textTag(TEXT));
+        before.progress(4);
+    }
+    JobJournal journal;
+    journal.begin();
+
+    uint32_t last = 0;
+    for (size_t i = 0; i < Config::Jobs::JOURNAL_ENTRIES * 2; i++) {
+        last = journal.start(textTag("filler"));
+        journal.finish(true);
+    }
+    TEST_ASSERT_NOT_NULL(journal.find(interrupted));
+    TEST_ASSERT_NOT_NULL(journal.find(last));
+    TEST_ASSERT_NULL(journal.find(last - (uint32_t)Config::Jobs::JOURNAL_ENTRIES + 1));
+}
+
+// Test: findStopped() picks the newest stopped job with the same text
+void test_find_stopped() {
+    JobJournal journal;
+    journal.begin();
+    uint32_t hash = 0x1234ABCD;
+
+    journal.start(JobTag(JobKind::SPOOL, hash, 5000));
+    journal.progress(100);
+    journal.finish(false);
+    uint32_t newer = journal.start(JobTag(JobKind::SPOOL, hash, 5000, 100));
+    journal.progress(50);
+    journal.finish(false);
+    journal.start(JobTag(JobKind::SPOOL, hash ^ 1, 5000));  // Other document
+    journal.finish(false);
+
+    const JobEntry* stopped = journal.findStopped(JobKind::SPOOL, hash, 5000);
+    TEST_ASSERT_NOT_NULL(stopped);
+    TEST_ASSERT_EQUAL(newer, stopped->id);
+    TEST_ASSERT_EQUAL(150, stopped->position());
+    TEST_ASSERT_NULL(journal.findStopped(JobKind::TEXT, hash, 5000));
+}
+
+// Test: JSON lists jobs newest first
+void test_json() {
+    JobJournal journal;
+    journal.begin();
+    journal.start(JobTag(JobKind::TEXT, 0xDEADBEEF, 10));
+    journal.progress(4);
+    journal.finish(false);
+    journal.start(JobTag(JobKind::SNIPPET, 0x1, 20));
+
+    char json[512];
+    TEST_ASSERT_TRUE(journal.toJson(json, sizeof(json)) > 0);
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"interruptedAtBoot\":0"));
+    const char* snippet = strstr(json, "\"kind\":\"snippet\",\"state\":\"active\"");
+    const char* text = strstr(json, "\"hash\":\"deadbeef\",\"length\":10,\"from\":0,\"typed\":4");
+    TEST_ASSERT_NOT_NULL(snippet);
+    TEST_ASSERT_NOT_NULL(text);
+    TEST_ASSERT_TRUE(snippet < text);
+
+    // Too small a buffer gives nothing rather than half a document
+    TEST_ASSERT_EQUAL(0, journal.toJson(json, 40));
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_job_lifecycle);
+    RUN_TEST(test_interrupted_by_reset);
+    RUN_TEST(test_torn_entry_dropped);
+    RUN_TEST(test_resume_point);
+    RUN_TEST(test_slot_reuse);
+    RUN_TEST(test_find_stopped);
+    RUN_TEST(test_json);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,156 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/loop_profiler.h"
+
+/**
+ * @file test_loop_profiler.cpp
+ * @brief Unit tests for loop() time attribution
+ *
+ * On native the profiler's cycle counter is the virtual microsecond
+ * clock, so each section's cost is set by advancing mock_micros_value.
+ */
+
+static void spend(uint32_t us) {
+    mock_micros_value += us;
+}
+
+void setUp(void) {
+    mock_millis_value = 0;
+    mock_micros_value = 0;
+}
+
+void tearDown(void) {
+}
+
+// Test: Time between marks is charged to the marked section
+void test_attributes_sections() {
+    LoopProfiler profiler(100000);
+
+    profiler.beginIteration();
+    spend(100);
+    profiler.mark(LoopProfiler::TIMERS);
+    spend(2000);
+    profiler.mark(LoopProfiler::BLE);
+    spend(300);
+    profiler.mark(LoopProfiler::HTTP);
+    spend(40);
+    profiler.endIteration();
+
+    TEST_ASSERT_EQUAL(100, profiler.getHistogram(LoopProfiler::TIMERS).max());
+    TEST_ASSERT_EQUAL(2000, profiler.getHistogram(LoopProfiler::BLE).max());
+    TEST_ASSERT_EQUAL(300, profiler.getHistogram(LoopProfiler::HTTP).max());
+    TEST_ASSERT_EQUAL(40, profiler.getHistogram(LoopProfiler::HOUSEKEEPING).max());
+    TEST_ASSERT_EQUAL(2440, profiler.getHistogram(LoopProfiler::TOTAL).max());
+    TEST_ASSERT_EQUAL(0, profiler.getOverruns());
+}
+
+// Test: Mean and count accumulate over iterations
+void test_accumulates_iterations() {
+    LoopProfiler profiler(100000);
+
+    for (int i = 0; i < 10; i++) {
+        profiler.beginIteration();
+        spend(i % 2 ? 300 : 100);
+        profiler.mark(LoopProfiler::HTTP);
+        profiler.endIteration();
+    }
+
+    const LogLinearHistogram& http = profiler.getHistogram(LoopProfiler::HTTP);
+    TEST_ASSERT_EQUAL(10, http.count());
+    TEST_ASSERT_EQUAL(200, http.mean());
+    TEST_ASSERT_EQUAL(300, http.max());
+    TEST_ASSERT_EQUAL(10, profiler.getHistogram(LoopProfiler::TOTAL).count());
+}
+
+// Test: CRITICAL - Iterations over budget are counted as overruns
+void test_overrun_detection() {
+    LoopProfiler profiler(5000);
+
+    profiler.beginIteration();
+    spend(4999);
+    profiler.mark(LoopProfiler::BLE);
+    profiler.endIteration();
+    TEST_ASSERT_EQUAL(0, profiler.getOverruns());
+
+    profiler.beginIteration();
+    spend(200);
+    profiler.mark(LoopProfiler::TIMERS);
+    spend(8000);  // Slow HTTP client
+    profiler.mark(LoopProfiler::HTTP);
+    profiler.endIteration();
+    TEST_ASSERT_EQUAL(1, profiler.getOverruns());
+}
+
+// Test: Marks outside an iteration are ignored
+void test_mark_outside_iteration() {
+    LoopProfiler profiler;
+
+    spend(1000);
+    profiler.mark(LoopProfiler::BLE);
+    profiler.endIteration();
+
+    TEST_ASSERT_EQUAL(0, profiler.getHistogram(LoopProfiler::BLE).count());
+    TEST_ASSERT_EQUAL(0, profiler.getHistogram(LoopProfiler::TOTAL).count());
+}
+
+// Test: Summary captures per-section statistics for the next boot
+void test_summary() {
+    LoopProfiler profiler(1000);
+
+    profiler.beginIteration();
+    spend(1500);
+    profiler.mark(LoopProfiler::BLE);
+    profiler.endIteration();
+
+    mock_micros_value = 42ULL * 1000000ULL;
+    LoopProfileSummary summary;
+    profiler.summarize(summary);
+
+    TEST_ASSERT_EQUAL_HEX32(LoopProfileSummary::MAGIC, summary.magic);
+    TEST_ASSERT_EQUAL(42, summary.uptimeSeconds);
+    TEST_ASSERT_EQUAL(1, summary.iterations);
+    TEST_ASSERT_EQUAL(1, summary.overruns);
+    TEST_ASSERT_EQUAL(1500, summary.maxUs[LoopProfiler::BLE]);
+    TEST_ASSERT_EQUAL(1500, summary.maxUs[LoopProfiler::TOTAL]);
+}
+
+// Test: JSON output names every section
+void test_json() {
+    LoopProfiler profiler(20000);
+
+    profiler.beginIteration();
+    spend(250);
+    profiler.mark(LoopProfiler::HTTP);
+    profiler.endIteration();
+
+    char json[1024];
+    size_t len = profiler.toJson(json, sizeof(json));
+
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"budgetUs\":20000"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"http\":{\"meanUs\":250"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"timers\":"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"loop\":"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"previousBoot\":null}"));
+
+    // Too small a buffer yields an empty string, never partial JSON
+    TEST_ASSERT_EQUAL(0, profiler.toJson(json, 32));
+    TEST_ASSERT_EQUAL_STRING("", json);
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_attributes_sections);
+    RUN_TEST(test_accumulates_iterations);
+    RUN_TEST(test_overrun_detection);
+    RUN_TEST(test_mark_outside_iteration);
+    RUN_TEST(test_summary);
+    RUN_TEST(test_json);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,172 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/lzss.h"
+#include "utils/crc32.h"
+
+/**
+ * @file test_lzss.cpp
+ * @brief Unit tests for LZSS compression and the CRC-32 used beside it
+ */
+
+static uint8_t packed[8192];
+static size_t packedLength;
+static size_t sinkLimit;
+
+static bool collect(const uint8_t* data, size_t length, void* context) {
+    (void)context;
+    if (packedLength + length > sinkLimit) return false;
+    memcpy(packed + packedLength, data, length);
+    packedLength += length;
+    return true;
+}
+
+// Hands out the compressed bytes a few at a time
+struct Cursor {
+    size_t position;
+    size_t step;
+};
+
+static size_t feed(uint8_t* out, size_t max, void* context) {
+    Cursor* cursor = static_cast<Cursor*>(context);
+    size_t n = packedLength - cursor->position;
+    if (n > max) n = max;
+    if (n > cursor->step) n = cursor->step;
+    memcpy(out, packed + cursor->position, n);
+    cursor->position += n;
+    return n;
+}
+
+// Compress, then expand through a source that returns step bytes per call
+static bool roundTrip(const uint8_t* in, size_t length, size_t step) {
+    packedLength = 0;
+    sinkLimit = sizeof(packed);
+    if (!Lzss::compress(in, length, &collect, nullptr)) return false;
+    if (packedLength > Lzss::maxCompressedSize(length)) return false;
+
+    static uint8_t out[4096];
+    Cursor cursor = { 0, step };
+    Lzss::Decoder decoder;
+    decoder.begin(&feed, &cursor, length);
+    size_t produced = decoder.read(out, sizeof(out));
+    return produced == length && !decoder.hasFailed() && memcmp(in, out, length) == 0;
+}
+
+void setUp(void) {
+    packedLength = 0;
+    sinkLimit = sizeof(packed);
+}
+
+void tearDown(void) {
+}
+
+// Test: CRITICAL - Text round-trips and repetitive text shrinks
+void test_round_trip_text() {
+    char text[2048];
+    size_t length = 0;
+    while (length + 40 < sizeof(text)) {
+        length += (size_t)snprintf(text + length, sizeof(text) - length,
+                                   "Best regards,\nThe MiniKeyboard team %u\n",
+                                   (unsigned)(length % 7));
+    }
+    TEST_ASSERT_TRUE(roundTrip((const uint8_t*)text, length, Lzss::Decoder::INPUT_BYTES));
+    TEST_ASSERT_TRUE(packedLength < length / 4);
+}
+
+// Test: Overlapping matches (a run longer than its distance) and runs past MAX_MATCH
+void test_round_trip_runs() {
+    uint8_t runs[1500];
+    memset(runs, 'a', 700);
+    for (size_t i = 700; i < sizeof(runs); i++) {
+        runs[i] = (uint8_t)("xyz"[i % 3]);
+    }
+    TEST_ASSERT_TRUE(roundTrip(runs, sizeof(runs), 1));
+}
+
+// Test: Incompressible input stays within maxCompressedSize()
+void test_round_trip_random() {
+    uint8_t noise[3000];
+    uint32_t state = 12345;
+    for (size_t i = 0; i < sizeof(noise); i++) {
+        state = state * 1664525u + 1013904223u;
+        noise[i] = (uint8_t)(state >> 24);
+    }
+    TEST_ASSERT_TRUE(roundTrip(noise, sizeof(noise), 7));
+    TEST_ASSERT_TRUE(roundTrip(noise, 1, 7));
+}
+
+// Test: Matches reach back the whole window but not past it
+void test_window_distance() {
+    uint8_t text[Lzss::WINDOW_SIZE + 64];
+    uint32_t state = 99;
+    for (size_t i = 0; i < Lzss::WINDOW_SIZE; i++) {
+        state = state * 1664525u + 1013904223u;
+        text[i] = (uint8_t)(state >> 24);
+    }
+    memcpy(text + Lzss::WINDOW_SIZE, text, 64);
+    TEST_ASSERT_TRUE(roundTrip(text, sizeof(text), 5));
+
+    size_t distance = 0;
+    TEST_ASSERT_EQUAL(Lzss::MAX_MATCH > 64 ? 64 : Lzss::MAX_MATCH,
+                      Lzss::longestMatch(text, sizeof(text), Lzss::WINDOW_SIZE, distance));
+    TEST_ASSERT_EQUAL(Lzss::WINDOW_SIZE, distance);
+}
+
+// Test: A refusing sink stops compress()
+void test_sink_refusal() {
+    uint8_t text[200];
+    memset(text, 'q', sizeof(text));
+    sinkLimit = 1;
+    TEST_ASSERT_FALSE(Lzss::compress(text, sizeof(text), &collect, nullptr));
+}
+
+// Test: CRITICAL - Truncated or corrupt input fails instead of inventing output
+void test_decoder_failures() {
+    const char* text = "abcabcabcabcabcabc hello hello hello";
+    size_t length = strlen(text);
+    TEST_ASSERT_TRUE(Lzss::compress((const uint8_t*)text, length, &collect, nullptr));
+
+    uint8_t out[64];
+    Lzss::Decoder decoder;
+    Cursor cursor = { 0, 64 };
+    packedLength -= 2;
+    decoder.begin(&feed, &cursor, length);
+    TEST_ASSERT_TRUE(decoder.read(out, sizeof(out)) < length);
+    TEST_ASSERT_TRUE(decoder.hasFailed());
+
+    // A back-reference before the start of the output
+    packed[0] = 0x00;
+    packed[1] = 0x05;
+    packed[2] = 0x00;
+    packedLength = 3;
+    cursor.position = 0;
+    decoder.begin(&feed, &cursor, 10);
+    TEST_ASSERT_EQUAL(0, decoder.read(out, sizeof(out)));
+    TEST_ASSERT_TRUE(decoder.hasFailed());
+}
+
+// Test: CRC-32 matches the standard check value, in one pass or several
+void test_crc32() {
+    const char* check = "123456789";
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, Crc32::compute(check, 9));
+    uint32_t crc = Crc32::update(0, check, 4);
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, Crc32::update(crc, check + 4, 5));
+    TEST_ASSERT_EQUAL_HEX32(0, Crc32::compute(check, 0));
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_round_trip_text);
+    RUN_TEST(test_round_trip_runs);
+    RUN_TEST(test_round_trip_random);
+    RUN_TEST(test_window_distance);
+    RUN_TEST(test_sink_refusal);
+    RUN_TEST(test_decoder_failures);
+    RUN_TEST(test_crc32);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,92 @@
+#include <unity.h>
+#include <string>
+#include "mocks/Arduino.h"
+#include "utils/memory_diagnostics.h"
+#include "utils/tracer.h"
+
+/**
+ * @file test_memory_diagnostics.cpp
+ * @brief Unit tests for the /diag/memory report
+ *
+ * Heap and task sections are device-only; native covers the static
+ * footprint table and the JSON shape.
+ */
+
+static std::string output;
+
+static void captureWrite(const char* data, size_t length, void* context) {
+    (void)context;
+    output.append(data, length);
+}
+
+static std::string exportJson(const MemoryDiagnostics& memory) {
+    output.clear();
+    char buffer[64];
+    ChunkedWriter out(buffer, sizeof(buffer), &captureWrite, nullptr);
+    memory.writeJson(out);
+    out.flush();
+    return output;
+}
+
+struct Small {
+    char data[10];
+};
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Test: Footprint entries are sizeof() at compile time and sum to the total
+void test_footprint_total() {
+    static const MemoryFootprint table[] = {
+        MEMORY_FOOTPRINT("small", Small),
+        MEMORY_FOOTPRINT("tracer", Tracer),
+    };
+    MemoryDiagnostics memory;
+    memory.setFootprint(table, 2);
+
+    TEST_ASSERT_EQUAL(10, table[0].bytes);
+    TEST_ASSERT_EQUAL(sizeof(Small) + sizeof(Tracer), memory.staticTotal());
+}
+
+// Test: Report lists every static object and is one JSON object
+void test_json() {
+    static const MemoryFootprint table[] = {
+        MEMORY_FOOTPRINT("a", Small),
+        MEMORY_FOOTPRINT("b", Small),
+    };
+    MemoryDiagnostics memory;
+    memory.setFootprint(table, 2);
+
+    std::string json = exportJson(memory);
+
+    TEST_ASSERT_EQUAL(0, json.find("{\"heap\":"));
+    TEST_ASSERT_TRUE(json.find("\"tasks\":[]") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("\"static\":{\"total\":20,\"objects\":{\"a\":10,\"b\":10}}")
+                     != std::string::npos);
+    TEST_ASSERT_EQUAL(json.size() - 4, json.rfind("}}}\n"));
+}
+
+// Test: No table still produces a valid report
+void test_json_empty() {
+    MemoryDiagnostics memory;
+    std::string json = exportJson(memory);
+
+    TEST_ASSERT_TRUE(json.find("\"static\":{\"total\":0,\"objects\":{}}") != std::string::npos);
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_footprint_total);
+    RUN_TEST(test_json);
+    RUN_TEST(test_json_empty);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,190 @@
+#include <unity.h>
+#include <string>
+#include "mocks/Arduino.h"
+#include "utils/metrics.h"
+
+/**
+ * @file test_metrics.cpp
+ * @brief Unit tests for the metrics registry and Prometheus text export
+ */
+
+static std::string output;
+static size_t writes;
+
+static void captureWrite(const char* data, size_t length, void* context) {
+    (void)context;
+    output.append(data, length);
+    writes++;
+}
+
+static std::string renderAll(MetricsRegistry& registry, size_t bufferSize = 512) {
+    char buffer[512];
+    ChunkedWriter out(buffer, bufferSize, &captureWrite, nullptr);
+    registry.render(out);
+    out.flush();
+    return output;
+}
+
+static bool contains(const std::string& haystack, const char* needle) {
+    return haystack.find(needle) != std::string::npos;
+}
+
+void setUp(void) {
+    output.clear();
+    writes = 0;
+}
+
+void tearDown(void) {
+}
+
+// Test: Counter and gauge samples with HELP/TYPE headers
+void test_counter_and_gauge() {
+    MetricsRegistry registry;
+    Counter requests;
+    Gauge depth;
+
+    registry.addCounter("requests_total", "Requests served", requests);
+    registry.addGauge("queue_depth", "Items queued", depth);
+
+    requests.inc();
+    requests.inc(4);
+    depth.set(7);
+    depth.add(-2);
+
+    std::string text = renderAll(registry);
+
+    TEST_ASSERT_TRUE(contains(text, "# HELP requests_total Requests served\n"));
+    TEST_ASSERT_TRUE(contains(text, "# TYPE requests_total counter\n"));
+    TEST_ASSERT_TRUE(contains(text, "requests_total 5\n"));
+    TEST_ASSERT_TRUE(contains(text, "# TYPE queue_depth gauge\n"));
+    TEST_ASSERT_TRUE(contains(text, "queue_depth 5\n"));
+}
+
+// Test: Labelled series share one header even when registered apart
+void test_labelled_family_grouped() {
+    MetricsRegistry registry;
+    Counter a, b, other;
+
+    registry.addCounter("rejections_total", "Rejections", a, "code", "BUSY");
+    registry.addCounter("other_total", "Other", other);
+    registry.addCounter("rejections_total", "Rejections", b, "code", "UNAUTHORIZED");
+    b.inc(3);
+
+    std::string text = renderAll(registry);
+
+    size_t header = text.find("# TYPE rejections_total counter");
+    size_t first = text.find("rejections_total{code=\"BUSY\"} 0\n");
+    size_t second = text.find("rejections_total{code=\"UNAUTHORIZED\"} 3\n");
+    size_t otherHeader = text.find("# TYPE other_total");
+
+    TEST_ASSERT_TRUE(header != std::string::npos);
+    TEST_ASSERT_TRUE(first > header && second > first);
+    TEST_ASSERT_TRUE(otherHeader > second);
+    TEST_ASSERT_EQUAL(text.rfind("# TYPE rejections_total"), header);
+}
+
+// Test: Histogram buckets are cumulative and end with +Inf, _sum, _count
+void test_histogram_export() {
+    MetricsRegistry registry;
+    LogLinearHistogram latency;
+
+    registry.addHistogram("latency_us", "Latency", latency, 1.0f, "route", "/type");
+    latency.record(2);
+    latency.record(5);
+    latency.record(100);
+
+    std::string text = renderAll(registry);
+
+    TEST_ASSERT_TRUE(contains(text, "# TYPE latency_us histogram\n"));
+    TEST_ASSERT_TRUE(contains(text, "latency_us_bucket{route=\"/type\",le=\"3\"} 1\n"));
+    TEST_ASSERT_TRUE(contains(text, "latency_us_bucket{route=\"/type\",le=\"7\"} 2\n"));
+    TEST_ASSERT_TRUE(contains(text, "latency_us_bucket{route=\"/type\",le=\"127\"} 3\n"));
+    TEST_ASSERT_TRUE(contains(text, "latency_us_bucket{route=\"/type\",le=\"+Inf\"} 3\n"));
+    TEST_ASSERT_TRUE(contains(text, "latency_us_sum{route=\"/type\"} 107\n"));
+    TEST_ASSERT_TRUE(contains(text, "latency_us_count{route=\"/type\"} 3\n"));
+
+    // Nothing above the bucket holding the maximum
+    TEST_ASSERT_FALSE(contains(text, "le=\"255\""));
+}
+
+// Test: Histogram scale converts microseconds to seconds
+void test_histogram_scale() {
+    MetricsRegistry registry;
+    LogLinearHistogram latency;
+
+    registry.addHistogram("duration_seconds", "Duration", latency, 1e-6);
+    latency.record(1500);
+
+    std::string text = renderAll(registry);
+
+    TEST_ASSERT_TRUE(contains(text, "duration_seconds_bucket{le=\"0.002047"));
+    TEST_ASSERT_TRUE(contains(text, "duration_seconds_sum 0.0015"));
+    TEST_ASSERT_TRUE(contains(text, "duration_seconds_count 1\n"));
+}
+
+// Test: Registry is fixed size and ignores duplicate registrations
+void test_registry_capacity_and_duplicates() {
+    MetricsRegistry registry;
+    static Counter counters[Config::Metrics::MAX_METRICS + 1];
+
+    TEST_ASSERT_TRUE(registry.addCounter("a_total", "A", counters[0]));
+    TEST_ASSERT_TRUE(registry.addCounter("a_total", "A", counters[0]));
+    TEST_ASSERT_EQUAL(1, registry.size());
+
+    for (size_t i = 1; i < Config::Metrics::MAX_METRICS; i++) {
+        TEST_ASSERT_TRUE(registry.addCounter("a_total", "A", counters[i]));
+    }
+    TEST_ASSERT_FALSE(registry.addCounter("a_total", "A", counters[Config::Metrics::MAX_METRICS]));
+    TEST_ASSERT_EQUAL(Config::Metrics::MAX_METRICS, registry.size());
+}
+
+// Test: CRITICAL - Output larger than the buffer is streamed in chunks without loss
+void test_streams_in_chunks() {
+    MetricsRegistry registry;
+    LogLinearHistogram big;
+    big.record(0xFFFFFFFFu);  // Every power-of-two bucket line is emitted
+    registry.addHistogram("big", "Big histogram", big);
+
+    std::string whole = renderAll(registry, 512);
+    size_t wholeWrites = writes;
+
+    output.clear();
+    writes = 0;
+    std::string chunked = renderAll(registry, 64);
+
+    TEST_ASSERT_EQUAL(1, wholeWrites > 0 ? 1 : 0);
+    TEST_ASSERT_TRUE(writes > wholeWrites);
+    TEST_ASSERT_EQUAL_STRING(whole.c_str(), chunked.c_str());
+    TEST_ASSERT_TRUE(contains(chunked, "big_bucket{le=\"+Inf\"} 1\n"));
+}
+
+// Test: Lines longer than the whole buffer are dropped, not split
+void test_writer_drops_oversized_line() {
+    char buffer[16];
+    ChunkedWriter out(buffer, sizeof(buffer), &captureWrite, nullptr);
+
+    TEST_ASSERT_TRUE(out.printf("short\n"));
+    TEST_ASSERT_FALSE(out.printf("%s\n", "this line is far too long"));
+    out.flush();
+
+    TEST_ASSERT_EQUAL_STRING("short\n", output.c_str());
+    TEST_ASSERT_EQUAL(1, out.getDroppedCount());
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_counter_and_gauge);
+    RUN_TEST(test_labelled_family_grouped);
+    RUN_TEST(test_histogram_export);
+    RUN_TEST(test_histogram_scale);
+    RUN_TEST(test_registry_capacity_and_duplicates);
+    RUN_TEST(test_streams_in_chunks);
+    RUN_TEST(test_writer_drops_oversized_line);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,120 @@
+#include <unity.h>
+#include <string>
+#include "mocks/Arduino.h"
+#include "utils/microbench.h"
+
+/**
+ * @file test_microbench.cpp
+ * @brief Unit tests for the /bench runner
+ *
+ * Native ticks are microseconds, so each case advances mock_micros_value
+ * to make the measured cost exact.
+ */
+
+static std::string output;
+static int yields = 0;
+
+static void captureWrite(const char* data, size_t length, void* context) {
+    (void)context;
+    output.append(data, length);
+}
+
+static void countYield(void* context) {
+    (void)context;
+    yields++;
+}
+
+// Costs 3 us per iteration, plus 10 us on the first iteration of the second batch
+static void unevenWork(void* context, uint32_t iteration) {
+    int* calls = static_cast<int*>(context);
+    mock_micros_value += 3;
+    if (iteration == 0 && ++(*calls) == 2) {
+        mock_micros_value += 10;
+    }
+}
+
+static void noWork(void* context, uint32_t iteration) {
+    (void)context;
+    (void)iteration;
+}
+
+void setUp(void) {
+    mock_micros_value = 0;
+    yields = 0;
+}
+
+void tearDown(void) {
+}
+
+// Test: Best and mean are per iteration; the slow batch only moves the mean
+void test_best_and_mean() {
+    MicroBench bench;
+    int calls = 0;
+
+    TEST_ASSERT_TRUE(bench.run("uneven", &unevenWork, &calls, 5));
+
+    TEST_ASSERT_EQUAL(1, bench.size());
+    const BenchResult& r = bench.get(0);
+    TEST_ASSERT_EQUAL_STRING("uneven", r.name);
+    TEST_ASSERT_EQUAL(5, r.iterations);
+    TEST_ASSERT_EQUAL(3, r.bestTicks);
+    // (5 batches * 15 us + 10 us) / 25 iterations
+    TEST_ASSERT_EQUAL(85 / 25, r.meanTicks);
+    TEST_ASSERT_EQUAL(Config::Bench::BATCHES, calls);
+}
+
+// Test: CRITICAL - Runner yields before every batch
+void test_yields_between_batches() {
+    MicroBench bench(&countYield, nullptr);
+
+    bench.run("a", &noWork, nullptr, 10);
+    bench.run("b", &noWork, nullptr, 10);
+
+    TEST_ASSERT_EQUAL(2 * Config::Bench::BATCHES, yields);
+}
+
+// Test: Cases beyond the result table (or with no iterations) are refused
+void test_slot_limit() {
+    MicroBench bench;
+
+    TEST_ASSERT_FALSE(bench.run("empty", &noWork, nullptr, 0));
+    for (size_t i = 0; i < Config::Bench::MAX_CASES; i++) {
+        TEST_ASSERT_TRUE(bench.run("case", &noWork, nullptr, 1));
+    }
+    TEST_ASSERT_FALSE(bench.run("overflow", &noWork, nullptr, 1));
+    TEST_ASSERT_EQUAL(Config::Bench::MAX_CASES, bench.size());
+}
+
+// Test: Results stream as one JSON object keyed by case name
+void test_json() {
+    MicroBench bench;
+    int calls = 0;
+    bench.run("uneven", &unevenWork, &calls, 5);
+    bench.run("noop", &noWork, nullptr, 1);
+
+    output.clear();
+    char buffer[64];
+    ChunkedWriter out(buffer, sizeof(buffer), &captureWrite, nullptr);
+    bench.writeJson(out);
+    out.flush();
+
+    TEST_ASSERT_EQUAL(0, output.find("{\"unit\":\"us\",\"ticksPerUs\":1,\"batches\":"));
+    TEST_ASSERT_TRUE(output.find("\"results\":{\"uneven\":{\"iterations\":5,\"best\":3,"
+                                 "\"mean\":3,\"bestNs\":3000},\"noop\":{") != std::string::npos);
+    TEST_ASSERT_EQUAL(output.size() - 4, output.rfind("}}}\n"));
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_best_and_mean);
+    RUN_TEST(test_yields_between_batches);
+    RUN_TEST(test_slot_limit);
+    RUN_TEST(test_json);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,120 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/object_pool.h"
+
+/**
+ * @file test_object_pool.cpp
+ * @brief Unit tests for the fixed-capacity typed pool
+ *
+ * Objects must be constructed and destroyed in place, slots reused,
+ * and a full pool must refuse rather than grow.
+ */
+
+struct Tracked {
+    static int liveCount;
+    int value;
+
+    explicit Tracked(int v) : value(v) {
+        liveCount++;
+    }
+    ~Tracked() {
+        liveCount--;
+    }
+};
+
+int Tracked::liveCount = 0;
+
+void setUp(void) {
+    Tracked::liveCount = 0;
+}
+
+void tearDown(void) {
+}
+
+// Test: create() constructs in place and destroy() runs the destructor
+void test_create_and_destroy() {
+    ObjectPool<Tracked, 4> pool;
+
+    Tracked* a = pool.create(7);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL(7, a->value);
+    TEST_ASSERT_EQUAL(1, Tracked::liveCount);
+    TEST_ASSERT_EQUAL(1, pool.size());
+
+    pool.destroy(a);
+    TEST_ASSERT_EQUAL(0, Tracked::liveCount);
+    TEST_ASSERT_EQUAL(0, pool.size());
+    pool.destroy(nullptr);
+}
+
+// Test: CRITICAL - A full pool returns nullptr and counts the refusal
+void test_exhaustion_returns_null() {
+    ObjectPool<Tracked, 3> pool;
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_NOT_NULL(pool.create(i));
+    }
+    TEST_ASSERT_NULL(pool.create(99));
+    TEST_ASSERT_EQUAL(1, pool.getExhausted());
+    TEST_ASSERT_EQUAL(0, pool.available());
+    TEST_ASSERT_EQUAL(3, Tracked::liveCount);
+}
+
+// Test: Slots are reused and indexes stay stable
+void test_slot_reuse_and_index() {
+    ObjectPool<Tracked, 4> pool;
+    Tracked* a = pool.create(1);
+    Tracked* b = pool.create(2);
+    size_t bIndex = pool.indexOf(b);
+
+    pool.destroy(a);
+    TEST_ASSERT_FALSE(pool.isLive(pool.indexOf(a)));
+    TEST_ASSERT_NULL(pool.at(pool.indexOf(a)));
+
+    Tracked* c = pool.create(3);
+    TEST_ASSERT_EQUAL_PTR(a, c);  // Most recently freed slot first
+    TEST_ASSERT_EQUAL_PTR(b, pool.at(bIndex));
+    TEST_ASSERT_EQUAL(2, pool.at(bIndex)->value);
+    TEST_ASSERT_EQUAL(2, pool.getHighWater());
+}
+
+// Test: clear() destroys every object and frees every slot
+void test_clear() {
+    ObjectPool<Tracked, 40> pool;
+    for (int i = 0; i < 40; i++) {
+        pool.create(i);
+    }
+    pool.clear();
+
+    TEST_ASSERT_EQUAL(0, Tracked::liveCount);
+    TEST_ASSERT_EQUAL(40, pool.available());
+    for (size_t i = 0; i < pool.capacity(); i++) {
+        TEST_ASSERT_FALSE(pool.isLive(i));
+    }
+    TEST_ASSERT_NOT_NULL(pool.create(1));
+}
+
+// Test: Objects are aligned for their type
+void test_alignment() {
+    ObjectPool<uint64_t, 3> pool;
+    for (int i = 0; i < 3; i++) {
+        uint64_t* value = pool.create((uint64_t)i);
+        TEST_ASSERT_EQUAL(0, (uintptr_t)value % alignof(uint64_t));
+    }
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_create_and_destroy);
+    RUN_TEST(test_exhaustion_returns_null);
+    RUN_TEST(test_slot_reuse_and_index);
+    RUN_TEST(test_clear);
+    RUN_TEST(test_alignment);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
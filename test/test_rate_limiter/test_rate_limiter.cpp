@@ -153,13 +153,96 @@ void test_overflow_safe_timing() {
     }
     TEST_ASSERT_FALSE(limiter.checkLimit(ip));
 
-    // Overflow millis
+    // Overflow millis: 796 ms later, still inside the window
     mock_millis_value = 500;
+    TEST_ASSERT_FALSE(limiter.checkLimit(ip));
 
-    // Should reset (new window after overflow)
+    // 1096 ms after the window opened: should reset across the wrap
+    mock_millis_value = 800;
     TEST_ASSERT_TRUE(limiter.checkLimit(ip));
 }
 
+// Test: Thousands of clients are each counted under their own address
+void test_many_clients_tracked_separately() {
+    RateLimiter limiter(1000, 2);
+
+    for (int round = 0; round < 2; round++) {
+        for (uint32_t i = 0; i < Config::RateLimit::MAX_CLIENTS; i++) {
+            TEST_ASSERT_TRUE(limiter.checkLimit(IPAddress(172, 16, (uint8_t)(i >> 8), (uint8_t)i)));
+        }
+    }
+    for (uint32_t i = 0; i < Config::RateLimit::MAX_CLIENTS; i++) {
+        TEST_ASSERT_FALSE(limiter.checkLimit(IPAddress(172, 16, (uint8_t)(i >> 8), (uint8_t)i)));
+    }
+    TEST_ASSERT_EQUAL(Config::RateLimit::MAX_CLIENTS, limiter.getTrackedClientCount());
+    TEST_ASSERT_EQUAL(0, limiter.getEvictions());
+}
+
+// Test: CRITICAL - A full table evicts the client seen least recently
+void test_full_table_evicts_stalest() {
+    RateLimiter limiter(1000, 1);
+    IPAddress oldest(192, 168, 1, 1);
+
+    mock_millis_value = 0;
+    limiter.checkLimit(oldest);
+    for (uint32_t i = 1; i < Config::RateLimit::MAX_CLIENTS; i++) {
+        mock_millis_value = i;
+        limiter.checkLimit(IPAddress(10, 1, (uint8_t)(i >> 8), (uint8_t)i));
+    }
+    TEST_ASSERT_EQUAL(Config::RateLimit::MAX_CLIENTS, limiter.getTrackedClientCount());
+
+    // A new client takes the oldest entry; the others keep their counts
+    IPAddress newcomer(192, 168, 1, 2);
+    TEST_ASSERT_TRUE(limiter.checkLimit(newcomer));
+    TEST_ASSERT_EQUAL(1, limiter.getEvictions());
+    TEST_ASSERT_EQUAL(Config::RateLimit::MAX_CLIENTS, limiter.getTrackedClientCount());
+    TEST_ASSERT_FALSE(limiter.checkLimit(newcomer));
+    TEST_ASSERT_FALSE(limiter.checkLimit(IPAddress(10, 1, 0, 1)));
+
+    // The evicted client starts over
+    TEST_ASSERT_TRUE(limiter.checkLimit(oldest));
+}
+
+// Test: A client removed while it was the last one checked starts afresh
+void test_removed_last_client_not_reused() {
+    RateLimiter limiter(1000, 1);
+    IPAddress ip1(192, 168, 1, 100);
+    IPAddress ip2(192, 168, 1, 101);
+
+    mock_millis_value = 0;
+    TEST_ASSERT_TRUE(limiter.checkLimit(ip1));
+    mock_millis_value = 20000;
+    limiter.cleanup();
+    TEST_ASSERT_EQUAL(0, limiter.getTrackedClientCount());
+
+    // ip2 takes the freed entry; ip1 must not be counted against it
+    TEST_ASSERT_TRUE(limiter.checkLimit(ip2));
+    TEST_ASSERT_TRUE(limiter.checkLimit(ip1));
+    TEST_ASSERT_FALSE(limiter.checkLimit(ip1));
+    TEST_ASSERT_FALSE(limiter.checkLimit(ip2));
+    TEST_ASSERT_EQUAL(2, limiter.getTrackedClientCount());
+}
+
+// Test: Removing entries keeps the rest findable
+void test_cleanup_keeps_recent_entries() {
+    RateLimiter limiter(1000, 1);
+
+    mock_millis_value = 0;
+    for (uint32_t i = 0; i < 100; i++) {
+        limiter.checkLimit(IPAddress(10, 2, 0, (uint8_t)(2 * i)));
+    }
+    mock_millis_value = 20000;
+    for (uint32_t i = 0; i < 100; i++) {
+        limiter.checkLimit(IPAddress(10, 2, 0, (uint8_t)(2 * i + 1)));
+    }
+
+    limiter.cleanup();
+    TEST_ASSERT_EQUAL(100, limiter.getTrackedClientCount());
+    for (uint32_t i = 0; i < 100; i++) {
+        TEST_ASSERT_FALSE(limiter.checkLimit(IPAddress(10, 2, 0, (uint8_t)(2 * i + 1))));
+    }
+}
+
 void setup() {
     UNITY_BEGIN();
 
@@ -171,6 +254,10 @@ void setup() {
     RUN_TEST(test_cleanup_removes_old_entries);
     RUN_TEST(test_reset_clears_all);
     RUN_TEST(test_overflow_safe_timing);
+    RUN_TEST(test_many_clients_tracked_separately);
+    RUN_TEST(test_full_table_evicts_stalest);
+    RUN_TEST(test_cleanup_keeps_recent_entries);
+    RUN_TEST(test_removed_last_client_not_reused);
 
     UNITY_END();
 }
@@ -0,0 +1,352 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/report_pacer.h"
+
+/**
+ * @file test_report_pacer.cpp
+ * @brief Unit tests and cadence simulation for the HID report pacer
+ *
+ * The simulation compares timer-driven emission (the pacer) against the
+ * old loop-driven emission when loop() iterations are occasionally slow,
+ * and prints both jitter histograms.
+ */
+
+static char emitted[256];
+static size_t emittedLen;
+static bool sinkResult;
+
+static bool recordSink(const HidReport& report, void* context) {
+    (void)context;
+    if (!sinkResult) return false;
+    memcpy(emitted + emittedLen, report.text, report.length);
+    emittedLen += report.length;
+    emitted[emittedLen] = '\0';
+    return true;
+}
+
+static HidReport makeReport(const char* text, bool last) {
+    HidReport report;
+    strncpy(report.text, text, Config::BLE::TEXT_CHUNK_SIZE);
+    report.text[Config::BLE::TEXT_CHUNK_SIZE] = '\0';
+    report.length = strlen(report.text);
+    report.last = last;
+    return report;
+}
+
+// Deterministic pseudo-random source for the simulation
+static uint32_t rngState;
+static uint32_t nextRandom() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+void setUp(void) {
+    emitted[0] = '\0';
+    emittedLen = 0;
+    sinkResult = true;
+    rngState = 12345;
+}
+
+void tearDown(void) {
+}
+
+// Test: Idle pacer does nothing
+void test_idle_tick() {
+    ReportPacer pacer;
+    pacer.setSink(&recordSink, nullptr);
+
+    TEST_ASSERT_TRUE(pacer.tick(0) == ReportPacer::TickResult::IDLE);
+}
+
+// Test: One report per tick, in order, completing on the last report
+void test_emits_in_order() {
+    ReportPacer pacer(1000);
+    pacer.setSink(&recordSink, nullptr);
+    pacer.startJob();
+    pacer.enqueue(makeReport("Hell", false));
+    pacer.enqueue(makeReport("o", true));
+
+    TEST_ASSERT_TRUE(pacer.tick(0) == ReportPacer::TickResult::EMITTED);
+    TEST_ASSERT_EQUAL(4, pacer.getEmittedChars());
+    TEST_ASSERT_TRUE(pacer.tick(1000) == ReportPacer::TickResult::COMPLETED);
+
+    TEST_ASSERT_EQUAL_STRING("Hello", emitted);
+    TEST_ASSERT_FALSE(pacer.isJobActive());
+    TEST_ASSERT_EQUAL(1, pacer.getJitterHistogram().count());
+    TEST_ASSERT_EQUAL(0, pacer.getJitterHistogram().max());
+}
+
+// Test: Empty queue during a job counts as an underrun
+void test_underrun_counted() {
+    ReportPacer pacer;
+    pacer.setSink(&recordSink, nullptr);
+    pacer.startJob();
+
+    TEST_ASSERT_TRUE(pacer.tick(0) == ReportPacer::TickResult::UNDERRUN);
+    TEST_ASSERT_EQUAL(1, pacer.getUnderruns());
+    TEST_ASSERT_TRUE(pacer.isJobActive());
+}
+
+// Test: Sink failure ends the job and drains the queue
+void test_sink_failure_drains() {
+    ReportPacer pacer;
+    pacer.setSink(&recordSink, nullptr);
+    pacer.startJob();
+    pacer.enqueue(makeReport("abcd", false));
+    pacer.enqueue(makeReport("efgh", true));
+
+    sinkResult = false;
+    TEST_ASSERT_TRUE(pacer.tick(0) == ReportPacer::TickResult::FAILED);
+    TEST_ASSERT_FALSE(pacer.isJobActive());
+    TEST_ASSERT_EQUAL(0, pacer.queuedReports());
+}
+
+// Test: CRITICAL - Reports planned after a job failed are not typed by the next job
+void test_stale_reports_dropped() {
+    ReportPacer pacer;
+    pacer.setSink(&recordSink, nullptr);
+    pacer.startJob();
+    pacer.enqueue(makeReport("abcd", false));
+
+    sinkResult = false;
+    TEST_ASSERT_TRUE(pacer.tick(0) == ReportPacer::TickResult::FAILED);
+    pacer.enqueue(makeReport("old!", false));  // Loop planned before it saw the failure
+
+    sinkResult = true;
+    pacer.startJob();
+    pacer.enqueue(makeReport("new", true));
+    TEST_ASSERT_TRUE(pacer.tick(1000) == ReportPacer::TickResult::COMPLETED);
+    TEST_ASSERT_EQUAL_STRING("new", emitted);
+}
+
+// Test: Abort is honoured at the next tick
+void test_abort() {
+    ReportPacer pacer;
+    pacer.setSink(&recordSink, nullptr);
+    pacer.startJob();
+    pacer.enqueue(makeReport("abcd", true));
+
+    pacer.abort();
+    TEST_ASSERT_TRUE(pacer.tick(0) == ReportPacer::TickResult::FAILED);
+    TEST_ASSERT_EQUAL(0, emittedLen);
+}
+
+// Test: Queue accepts exactly REPORT_QUEUE_DEPTH reports
+void test_queue_capacity() {
+    ReportPacer pacer;
+    pacer.startJob();
+    for (size_t i = 0; i < Config::BLE::REPORT_QUEUE_DEPTH; i++) {
+        TEST_ASSERT_TRUE(pacer.enqueue(makeReport("x", false)));
+    }
+    TEST_ASSERT_FALSE(pacer.enqueue(makeReport("x", false)));
+    TEST_ASSERT_EQUAL(0, pacer.freeSlots());
+}
+
+// Test: plan() splits text into chunks, flags the last one and stops when full
+void test_plan_text() {
+    ReportPacer pacer;
+    pacer.setSink(&recordSink, nullptr);
+    pacer.startJob();
+
+    const char* text = "Hello world";
+    TEST_ASSERT_EQUAL(11, pacer.plan(text, 11, 0));
+    TEST_ASSERT_EQUAL(3, pacer.queuedReports());
+
+    while (pacer.tick(0) == ReportPacer::TickResult::EMITTED) {
+    }
+    TEST_ASSERT_EQUAL_STRING("Hello world", emitted);
+    TEST_ASSERT_FALSE(pacer.isJobActive());
+
+    // Longer than the queue: planning resumes where it stopped
+    char longText[Config::BLE::TEXT_CHUNK_SIZE * (Config::BLE::REPORT_QUEUE_DEPTH + 2)];
+    memset(longText, 'x', sizeof(longText));
+    pacer.startJob();
+    size_t position = pacer.plan(longText, sizeof(longText), 0);
+    TEST_ASSERT_EQUAL(Config::BLE::TEXT_CHUNK_SIZE * Config::BLE::REPORT_QUEUE_DEPTH, position);
+    TEST_ASSERT_EQUAL(position, pacer.plan(longText, sizeof(longText), position));
+}
+
+// Test: A non-final window plans whole chunks only and never flags the last report
+void test_plan_window() {
+    ReportPacer pacer;
+    pacer.setSink(&recordSink, nullptr);
+    pacer.startJob();
+
+    // Five characters short of two chunks: the tail waits for the next window
+    const size_t chunk = Config::BLE::TEXT_CHUNK_SIZE;
+    char window[chunk * 2 - 1];
+    memset(window, 'w', sizeof(window));
+    TEST_ASSERT_EQUAL(chunk, pacer.plan(window, sizeof(window), 0, false));
+    TEST_ASSERT_EQUAL(1, pacer.queuedReports());
+
+    pacer.tick(0);
+    TEST_ASSERT_TRUE(pacer.isJobActive());
+
+    // The final window flushes the remainder and ends the job
+    TEST_ASSERT_EQUAL(sizeof(window), pacer.plan(window, sizeof(window), chunk, true));
+    while (pacer.tick(0) == ReportPacer::TickResult::EMITTED) {
+    }
+    TEST_ASSERT_FALSE(pacer.isJobActive());
+    TEST_ASSERT_EQUAL(sizeof(window), emittedLen);
+}
+
+// Test: Pacing wait is measured from enqueue to emission
+void test_pacing_wait_telemetry() {
+    ReportPacer pacer(1000);
+    pacer.setSink(&recordSink, nullptr);
+    pacer.startJob();
+    pacer.enqueue(makeReport("ab", false), 100);
+    pacer.enqueue(makeReport("cd", true), 100);
+
+    pacer.tick(600);
+    pacer.tick(1600);
+
+    const LogLinearHistogram& wait = pacer.getPacingWaitHistogram();
+    TEST_ASSERT_EQUAL(2, wait.count());
+    TEST_ASSERT_EQUAL(500, wait.min());
+    TEST_ASSERT_EQUAL(1500, wait.max());
+    TEST_ASSERT_EQUAL(2, pacer.getReportCounter().get());
+    TEST_ASSERT_EQUAL(1, pacer.getIntervalHistogram().count());
+    TEST_ASSERT_EQUAL(1000, pacer.getIntervalHistogram().max());
+}
+
+// Test: CRITICAL - Starvation time is charged to the loop, once per episode
+void test_loop_blocked_telemetry() {
+    ReportPacer pacer(1000);
+    pacer.setSink(&recordSink, nullptr);
+    pacer.startJob();
+
+    // Queue empty for three ticks: the loop is late
+    pacer.tick(1000);
+    pacer.tick(2000);
+    pacer.tick(3000);
+    pacer.enqueue(makeReport("ab", true), 3500);
+    pacer.tick(4000);
+
+    const LogLinearHistogram& blocked = pacer.getLoopBlockedHistogram();
+    TEST_ASSERT_EQUAL(3, pacer.getUnderruns());
+    TEST_ASSERT_EQUAL(1, blocked.count());
+    TEST_ASSERT_EQUAL(3000, blocked.max());
+    TEST_ASSERT_EQUAL(500, pacer.getPacingWaitHistogram().max());
+}
+
+// Test: Job outcome distinguishes completion, sink failure and abort
+void test_job_outcome() {
+    ReportPacer pacer;
+    pacer.setSink(&recordSink, nullptr);
+    TEST_ASSERT_TRUE(pacer.getLastOutcome() == ReportPacer::JobOutcome::NONE);
+
+    pacer.startJob();
+    pacer.enqueue(makeReport("a", true));
+    pacer.tick(0);
+    TEST_ASSERT_TRUE(pacer.getLastOutcome() == ReportPacer::JobOutcome::COMPLETED);
+
+    pacer.startJob();
+    pacer.enqueue(makeReport("a", true));
+    sinkResult = false;
+    pacer.tick(0);
+    TEST_ASSERT_TRUE(pacer.getLastOutcome() == ReportPacer::JobOutcome::FAILED);
+
+    pacer.startJob();
+    pacer.abort();
+    pacer.tick(0);
+    TEST_ASSERT_TRUE(pacer.getLastOutcome() == ReportPacer::JobOutcome::ABORTED);
+}
+
+/**
+ * Loop model: most iterations take 1-2 ms, 3% stall for 20-300 ms
+ * (a slow HTTP client or a blocking combo).
+ */
+static uint32_t loopIterationUs() {
+    if (nextRandom() % 100 < 3) {
+        return 20000 + nextRandom() % 280000;
+    }
+    return 1000 + nextRandom() % 1000;
+}
+
+// Test: SIMULATION - timer cadence is unaffected by loop stalls
+void test_simulated_cadence_timer_vs_loop() {
+    const uint32_t period = Config::BLE::CHUNK_DELAY_MS * 1000UL;
+    const int reports = 2000;
+
+    // Timer-driven: loop refills, timer (with small wake latency) emits
+    ReportPacer pacer(period);
+    pacer.setSink(&recordSink, nullptr);
+    pacer.startJob();
+
+    int planned = 0;
+    uint64_t loopAt = 0;
+    uint64_t tickAt = period;
+    while (pacer.isJobActive()) {
+        if (loopAt <= tickAt) {
+            while (planned < reports && pacer.freeSlots() > 0) {
+                pacer.enqueue(makeReport("", planned == reports - 1));
+                planned++;
+            }
+            loopAt += loopIterationUs();
+        } else {
+            pacer.tick(tickAt + nextRandom() % 200);
+            tickAt += period;
+        }
+    }
+
+    // Loop-driven: emit on the first iteration after the period elapsed
+    LogLinearHistogram loopJitter;
+    uint64_t now = 0;
+    uint64_t lastSend = 0;
+    for (int sent = 0; sent < reports;) {
+        now += loopIterationUs();
+        if (now - lastSend >= period) {
+            if (sent > 0) loopJitter.record((uint32_t)(now - lastSend - period));
+            lastSend = now;
+            sent++;
+        }
+    }
+
+    const LogLinearHistogram& timerJitter = pacer.getJitterHistogram();
+
+    char line[160];
+    snprintf(line, sizeof(line), "timer jitter us: p50=%lu p99=%lu max=%lu underruns=%lu",
+             (unsigned long)timerJitter.percentile(50), (unsigned long)timerJitter.percentile(99),
+             (unsigned long)timerJitter.max(), (unsigned long)pacer.getUnderruns());
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "loop  jitter us: p50=%lu p99=%lu max=%lu",
+             (unsigned long)loopJitter.percentile(50), (unsigned long)loopJitter.percentile(99),
+             (unsigned long)loopJitter.max());
+    TEST_MESSAGE(line);
+
+    char histogram[1024];
+    timerJitter.toJson(histogram, sizeof(histogram));
+    TEST_MESSAGE(histogram);
+    loopJitter.toJson(histogram, sizeof(histogram));
+    TEST_MESSAGE(histogram);
+
+    TEST_ASSERT_EQUAL(reports - 1, timerJitter.count());
+    TEST_ASSERT_EQUAL(0, pacer.getUnderruns());
+    TEST_ASSERT_TRUE(timerJitter.max() < 200);
+    TEST_ASSERT_TRUE(loopJitter.percentile(99) > 10 * timerJitter.max());
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_idle_tick);
+    RUN_TEST(test_emits_in_order);
+    RUN_TEST(test_underrun_counted);
+    RUN_TEST(test_sink_failure_drains);
+    RUN_TEST(test_stale_reports_dropped);
+    RUN_TEST(test_abort);
+    RUN_TEST(test_queue_capacity);
+    RUN_TEST(test_plan_text);
+    RUN_TEST(test_plan_window);
+    RUN_TEST(test_pacing_wait_telemetry);
+    RUN_TEST(test_loop_blocked_telemetry);
+    RUN_TEST(test_job_outcome);
+    RUN_TEST(test_simulated_cadence_timer_vs_loop);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
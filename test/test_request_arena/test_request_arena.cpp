@@ -0,0 +1,112 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/request_arena.h"
+#include "utils/validation.h"
+
+/**
+ * @file test_request_arena.cpp
+ * @brief Unit tests for the per-request bump allocator
+ *
+ * Allocations must be aligned, refused (not truncated) when they don't
+ * fit, and all released by reset().
+ */
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Test: Allocations are aligned and laid out back to back
+void test_alignment() {
+    RequestArena arena;
+
+    char* text = arena.allocChars(3);
+    uint64_t* wide = static_cast<uint64_t*>(arena.allocate(sizeof(uint64_t)));
+
+    TEST_ASSERT_NOT_NULL(text);
+    TEST_ASSERT_NOT_NULL(wide);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)wide % RequestArena::ALIGN);
+    TEST_ASSERT_EQUAL(RequestArena::ALIGN + sizeof(uint64_t), arena.getUsed());
+}
+
+// Test: CRITICAL - A full arena refuses instead of overrunning
+void test_exhaustion_returns_null() {
+    RequestArena arena;
+    size_t capacity = arena.getCapacity();
+
+    TEST_ASSERT_NOT_NULL(arena.allocChars(capacity - 4));
+    TEST_ASSERT_NULL(arena.allocChars(5));
+    TEST_ASSERT_NOT_NULL(arena.allocChars(4));
+    TEST_ASSERT_NULL(arena.allocChars(1));
+    TEST_ASSERT_EQUAL(2, arena.getFailures());
+
+    TEST_ASSERT_NULL(arena.allocate((size_t)-1));  // No wraparound
+}
+
+// Test: reset() releases everything and keeps the high-water mark
+void test_reset() {
+    RequestArena arena;
+    arena.allocChars(300);
+    arena.reset();
+
+    TEST_ASSERT_EQUAL(0, arena.getUsed());
+    TEST_ASSERT_EQUAL(300, arena.getHighWater());
+    TEST_ASSERT_NOT_NULL(arena.allocChars(arena.getCapacity()));
+}
+
+// Test: format() takes only the bytes it wrote, and refuses text that doesn't fit
+void test_format() {
+    RequestArena arena;
+
+    const char* msg = arena.format("LED is now %s", "ON");
+    TEST_ASSERT_EQUAL_STRING("LED is now ON", msg);
+    TEST_ASSERT_EQUAL(strlen("LED is now ON") + 1, arena.getUsed());
+
+    arena.allocChars(arena.getCapacity() - arena.getUsed() - 4);
+    size_t before = arena.getUsed();
+    TEST_ASSERT_NULL(arena.format("%s", "too long"));
+    TEST_ASSERT_EQUAL(before, arena.getUsed());
+}
+
+// Test: copy() NUL-terminates; rewind() releases back to a mark
+void test_copy_and_rewind() {
+    RequestArena arena;
+
+    const char* copy = arena.copy("hello world", 5);
+    TEST_ASSERT_EQUAL_STRING("hello", copy);
+
+    size_t mark = arena.mark();
+    arena.allocChars(100);
+    arena.rewind(mark);
+    TEST_ASSERT_EQUAL(mark, arena.getUsed());
+}
+
+// Test: Sanitized log text built in arena memory matches the String version
+void test_sanitize_into_arena() {
+    RequestArena arena;
+    const char* msg = "Hi\tthere\n";
+    size_t bytes = Validation::sanitizedBytes(50);
+    char* out = arena.allocChars(bytes);
+
+    Validation::sanitizeForLog(msg, strlen(msg), out, bytes);
+    TEST_ASSERT_EQUAL_STRING(Validation::sanitizeForLog(String(msg)).c_str(), out);
+    TEST_ASSERT_EQUAL_STRING("Hi\\tthere\\n", out);
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_alignment);
+    RUN_TEST(test_exhaustion_returns_null);
+    RUN_TEST(test_reset);
+    RUN_TEST(test_format);
+    RUN_TEST(test_copy_and_rewind);
+    RUN_TEST(test_sanitize_into_arena);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,128 @@
+#include <unity.h>
+#include <string>
+#include "mocks/Arduino.h"
+#include "utils/request_capture.h"
+
+/**
+ * @file test_request_capture.cpp
+ * @brief Unit tests for the request capture ring
+ *
+ * The export is what tools/replay parses, so the line format and the
+ * body escaping are checked byte for byte.
+ */
+
+static std::string output;
+
+static void captureWrite(const char* data, size_t length, void* context) {
+    (void)context;
+    output.append(data, length);
+}
+
+static CapturedRequest makeRequest(uint64_t atUs, const char* path, const char* body) {
+    CapturedRequest r;
+    r.atUs = atUs;
+    r.durationUs = 40;
+    r.clientIp = (192u << 24) | (168u << 16) | (1u << 8) | 20u;
+    r.path = path;
+    r.method = "POST";
+    r.result = ErrorCode::SUCCESS;
+    r.bleConnected = true;
+    r.bleBusy = false;
+    RequestCapture::setBody(r, body, strlen(body));
+    return r;
+}
+
+static std::string exportJson(const RequestCapture& capture) {
+    output.clear();
+    char buffer[Config::Metrics::CHUNK_SIZE];
+    ChunkedWriter out(buffer, sizeof(buffer), &captureWrite, nullptr);
+    capture.writeJson(out);
+    out.flush();
+    return output;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Test: Nothing is recorded until capture is enabled
+void test_disabled_records_nothing() {
+    RequestCapture capture;
+    capture.add(makeRequest(1, "/status", ""));
+    TEST_ASSERT_EQUAL(0, capture.size());
+
+    capture.setEnabled(true);
+    capture.add(makeRequest(2, "/status", ""));
+    TEST_ASSERT_EQUAL(1, capture.size());
+}
+
+// Test: CRITICAL - A full ring keeps the newest records, oldest first
+void test_ring_overwrites_oldest() {
+    RequestCapture capture;
+    capture.setEnabled(true);
+
+    const size_t extra = 5;
+    for (size_t i = 0; i < Config::Capture::RECORDS + extra; i++) {
+        capture.add(makeRequest(i, "/status", ""));
+    }
+
+    TEST_ASSERT_EQUAL(Config::Capture::RECORDS, capture.size());
+    TEST_ASSERT_EQUAL(extra, capture.getDropped());
+    TEST_ASSERT_EQUAL(extra, (uint32_t)capture.get(0).atUs);
+    TEST_ASSERT_EQUAL(Config::Capture::RECORDS + extra - 1,
+                      (uint32_t)capture.get(Config::Capture::RECORDS - 1).atUs);
+
+    capture.clear();
+    TEST_ASSERT_EQUAL(0, capture.size());
+    TEST_ASSERT_EQUAL(0, capture.getDropped());
+}
+
+// Test: Long bodies keep a prefix and their full length
+void test_body_prefix() {
+    char text[Config::Capture::BODY_BYTES * 3];
+    memset(text, 'k', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+
+    CapturedRequest r = makeRequest(0, "/type", text);
+    TEST_ASSERT_EQUAL(Config::Capture::BODY_BYTES, r.bodyStored);
+    TEST_ASSERT_EQUAL(sizeof(text) - 1, r.bodyLength);
+}
+
+// Test: Export is one record per line with escaped bodies
+void test_json_lines() {
+    RequestCapture capture;
+    capture.setEnabled(true);
+    capture.add(makeRequest(1500, "/type", "say \"hi\"\n\\"));
+    CapturedRequest busy = makeRequest(2500, "/type", "x");
+    busy.result = ErrorCode::BUSY;
+    capture.add(busy);
+
+    std::string json = exportJson(capture);
+
+    TEST_ASSERT_EQUAL(0, json.find("{\"version\":1,\"enabled\":true,\"recorded\":2,\"dropped\":0,"
+                                   "\"records\":[\n"));
+    TEST_ASSERT_TRUE(json.find("{\"atUs\":1500,\"durUs\":40,\"ip\":\"192.168.1.20\","
+                               "\"method\":\"POST\",\"path\":\"/type\",\"result\":\"SUCCESS\","
+                               "\"bleConnected\":true,\"bleBusy\":false,\"bodyLength\":10,"
+                               "\"body\":\"say \\\"hi\\\"\\u000a\\\\\"},\n") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("\"atUs\":2500,") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("\"result\":\"BUSY\"") != std::string::npos);
+    TEST_ASSERT_EQUAL(json.size() - 3, json.rfind("]}\n"));
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_disabled_records_nothing);
+    RUN_TEST(test_ring_overwrites_oldest);
+    RUN_TEST(test_body_prefix);
+    RUN_TEST(test_json_lines);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
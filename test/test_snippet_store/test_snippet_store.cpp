@@ -0,0 +1,255 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/snippet_store.h"
+
+/**
+ * @file test_snippet_store.cpp
+ * @brief Unit tests for the flash snippet store and its template reader
+ *
+ * Native builds keep the partition in RAM with NOR rules, so these
+ * tests also catch writes into sectors that were not erased first.
+ */
+
+static SnippetStore* store;
+static SnippetReader reader;
+
+static ErrorCode upload(const char* name, const char* text) {
+    ErrorCode code = store->compile(text, strlen(text));
+    return code == ErrorCode::SUCCESS ? store->save(name) : code;
+}
+
+// Expand the open snippet, step bytes per read()
+static size_t expand(char* out, size_t max, size_t step) {
+    reader.start();
+    size_t total = 0;
+    while (total < max) {
+        size_t want = max - total < step ? max - total : step;
+        size_t n = reader.read(out + total, want);
+        if (n == 0) break;
+        total += n;
+    }
+    out[total] = '\0';
+    return total;
+}
+
+void setUp(void) {
+    store = new SnippetStore();
+    store->begin();
+}
+
+void tearDown(void) {
+    delete store;
+    store = nullptr;
+}
+
+// Test: Placeholders, repeated variables and escaped braces compile as expected
+void test_compile_template() {
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS,
+                      (int)store->compile("Hi {name}, {{ok}} {name} {team}", 31));
+    const SnippetHeader& header = store->getCompiled();
+    TEST_ASSERT_EQUAL(2, header.variableCount);
+    TEST_ASSERT_EQUAL_STRING("name", header.variables[0]);
+    TEST_ASSERT_EQUAL_STRING("team", header.variables[1]);
+    TEST_ASSERT_EQUAL(2, header.uses[0]);
+    TEST_ASSERT_EQUAL(1, header.uses[1]);
+    TEST_ASSERT_EQUAL(strlen("Hi , {ok}  "), header.textLength);
+}
+
+// Test: CRITICAL - Malformed templates and bad text are rejected
+void test_compile_rejects() {
+    const char* bad[] = { "Hi {name", "Hi {}", "Hi {na me}", "} {x", "{a-b}" };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_PARAMETER,
+                          (int)store->compile(bad[i], strlen(bad[i])));
+    }
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_PARAMETER,
+                      (int)store->compile("{v0123456789abcdef}", 19));
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_PARAMETER,
+                      (int)store->compile("{a}{b}{c}{d}{e}{f}{g}{h}{i}", 27));
+    TEST_ASSERT_EQUAL((int)ErrorCode::MESSAGE_EMPTY, (int)store->compile("", 0));
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_CHARACTERS, (int)store->compile("a\x01{b}", 5));
+
+    // Nothing compiled, so nothing to save
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_PARAMETER, (int)store->save("x"));
+}
+
+// Test: CRITICAL - Save, open and expand with values spliced in
+void test_round_trip_with_values() {
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS,
+                      (int)upload("greet", "Dear {who},\nthanks from {team}. {{Bye}}, {who}"));
+    TEST_ASSERT_EQUAL(1, store->size());
+
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)store->open("greet", reader));
+    TEST_ASSERT_TRUE(reader.setValue(0, "Ana", 3));
+    TEST_ASSERT_TRUE(reader.setValue(1, "QA", 2));
+    TEST_ASSERT_FALSE(reader.setValue(2, "x", 1));
+
+    const char* expected = "Dear Ana,\nthanks from QA. {Bye}, Ana";
+    TEST_ASSERT_EQUAL(strlen(expected), reader.length());
+
+    char out[128];
+    TEST_ASSERT_EQUAL(strlen(expected), expand(out, sizeof(out) - 1, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING(expected, out);
+
+    // One byte per read(): values split across calls come out whole
+    TEST_ASSERT_EQUAL(strlen(expected), expand(out, sizeof(out) - 1, 1));
+    TEST_ASSERT_EQUAL_STRING(expected, out);
+
+    // An unset value expands to nothing
+    store->open("greet", reader);
+    expand(out, sizeof(out) - 1, 16);
+    TEST_ASSERT_EQUAL_STRING("Dear ,\nthanks from . {Bye}, ", out);
+}
+
+// Test: A long template compresses and streams back exactly
+void test_long_template() {
+    static char text[Config::Snippets::MAX_TEXT_LENGTH + 1];
+    size_t length = 0;
+    while (length + 60 < Config::Snippets::MAX_TEXT_LENGTH) {
+        length += (size_t)snprintf(text + length, sizeof(text) - length,
+                                   "Line %03u for {user}: all systems nominal.\n",
+                                   (unsigned)(length / 50));
+    }
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)upload("report", text));
+
+    store->open("report", reader);
+    TEST_ASSERT_TRUE(reader.getHeader().storedLength < length / 2);
+    reader.setValue(0, "{user}", 6);  // Value that looks like the placeholder
+
+    static char out[Config::Snippets::MAX_TEXT_LENGTH + 1];
+    TEST_ASSERT_EQUAL(length, expand(out, sizeof(out) - 1, 100));
+    TEST_ASSERT_EQUAL_STRING(text, out);
+}
+
+// Test: Replacing keeps one copy; remove() frees it
+void test_replace_and_remove() {
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)upload("sig", "first"));
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)upload("sig", "second"));
+    TEST_ASSERT_EQUAL(1, store->size());
+
+    char out[32];
+    store->open("sig", reader);
+    expand(out, sizeof(out) - 1, 32);
+    TEST_ASSERT_EQUAL_STRING("second", out);
+    store->close();
+
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)store->remove("sig"));
+    TEST_ASSERT_EQUAL(0, store->size());
+    TEST_ASSERT_EQUAL((int)ErrorCode::NOT_FOUND, (int)store->remove("sig"));
+    TEST_ASSERT_EQUAL((int)ErrorCode::NOT_FOUND, (int)store->open("sig", reader));
+}
+
+// Test: CRITICAL - A snippet being read can't be removed or replaced until close()
+void test_open_snippet_locked() {
+    upload("sig", "Regards, {who}");
+    upload("other", "text");
+    store->open("sig", reader);
+    reader.setValue(0, "Ana", 3);
+
+    TEST_ASSERT_EQUAL((int)ErrorCode::BUSY, (int)store->remove("sig"));
+    TEST_ASSERT_EQUAL((int)ErrorCode::BUSY, (int)upload("sig", "replaced"));
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)upload("other", "changed"));
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)store->remove("other"));
+
+    char out[32];
+    expand(out, sizeof(out) - 1, 4);
+    TEST_ASSERT_EQUAL_STRING("Regards, Ana", out);
+
+    store->close();
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)store->remove("sig"));
+}
+
+// Test: Names are checked before anything is written
+void test_names() {
+    TEST_ASSERT_TRUE(SnippetStore::isValidName("sig_2"));
+    TEST_ASSERT_FALSE(SnippetStore::isValidName(""));
+    TEST_ASSERT_FALSE(SnippetStore::isValidName("a b"));
+    TEST_ASSERT_FALSE(SnippetStore::isValidName("../x"));
+    TEST_ASSERT_FALSE(SnippetStore::isValidName("abcdefghijklmnopqrstuvwxyz"));
+
+    store->compile("text", 4);
+    TEST_ASSERT_EQUAL((int)ErrorCode::INVALID_PARAMETER, (int)store->save("a b"));
+    TEST_ASSERT_EQUAL(0, store->size());
+}
+
+// Test: CRITICAL - A full store refuses new names but still replaces existing ones
+void test_storage_full() {
+    char name[8];
+    for (size_t i = 0; i < SnippetStore::getCapacity(); i++) {
+        snprintf(name, sizeof(name), "s%u", (unsigned)i);
+        TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)upload(name, "body"));
+    }
+    TEST_ASSERT_EQUAL((int)ErrorCode::STORAGE_FULL, (int)upload("extra", "body"));
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)upload("s3", "new body"));
+    TEST_ASSERT_EQUAL(SnippetStore::getCapacity(), store->size());
+
+    // The replacement went to the spare slot, so a reboot finds one copy of each
+    store->begin();
+    TEST_ASSERT_EQUAL(SnippetStore::getCapacity(), store->size());
+
+    char out[32];
+    store->open("s3", reader);
+    expand(out, sizeof(out) - 1, 32);
+    TEST_ASSERT_EQUAL_STRING("new body", out);
+}
+
+// Test: Text that won't compress into one sector is refused and leaves no slot behind
+void test_incompressible_text() {
+    static char text[Config::Snippets::MAX_TEXT_LENGTH + 1];
+    uint32_t state = 7;
+    for (size_t i = 0; i < Config::Snippets::MAX_TEXT_LENGTH; i++) {
+        state = state * 1664525u + 1013904223u;
+        char c = (char)(' ' + (state >> 24) % 95);
+        text[i] = (c == '{' || c == '}') ? 'x' : c;
+    }
+    text[Config::Snippets::MAX_TEXT_LENGTH] = '\0';
+
+    TEST_ASSERT_EQUAL((int)ErrorCode::MESSAGE_TOO_LONG, (int)upload("noise", text));
+    TEST_ASSERT_EQUAL(0, store->size());
+    TEST_ASSERT_EQUAL((int)ErrorCode::SUCCESS, (int)upload("noise", "fits"));
+}
+
+// Test: textCrc() covers the expansion; skip() lands mid-value for resuming
+void test_crc_and_skip() {
+    upload("greet", "Dear {who}, bye");
+    store->open("greet", reader);
+    reader.setValue(0, "Ana", 3);
+    TEST_ASSERT_EQUAL_HEX32(Crc32::compute("Dear Ana, bye", 13), reader.textCrc());
+
+    char out[32];
+    reader.start();
+    TEST_ASSERT_EQUAL(6, reader.skip(6));
+    size_t n = reader.read(out, sizeof(out) - 1);
+    out[n] = '\0';
+    TEST_ASSERT_EQUAL_STRING("na, bye", out);
+    TEST_ASSERT_EQUAL(0, reader.skip(5));
+}
+
+// Test: A fresh partition opens empty with no corrupt slots
+void test_fresh_store() {
+    TEST_ASSERT_TRUE(store->isOpen());
+    TEST_ASSERT_EQUAL(0, store->size());
+    TEST_ASSERT_EQUAL(0, store->getCorrupt());
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_compile_template);
+    RUN_TEST(test_compile_rejects);
+    RUN_TEST(test_round_trip_with_values);
+    RUN_TEST(test_long_template);
+    RUN_TEST(test_replace_and_remove);
+    RUN_TEST(test_open_snippet_locked);
+    RUN_TEST(test_names);
+    RUN_TEST(test_storage_full);
+    RUN_TEST(test_incompressible_text);
+    RUN_TEST(test_crc_and_skip);
+    RUN_TEST(test_fresh_store);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -15,6 +15,7 @@
 void setUp(void) {
     // Reset mock time before each test
     mock_millis_value = 0;
+    mock_micros_value = 0;
 }
 
 void tearDown(void) {
@@ -108,10 +109,10 @@ void test_timeDiff_overflow() {
     unsigned long start = 4294967000UL;
     mock_millis_value = 1000;
 
-    // Time diff: (4,294,967,295 - 4,294,967,000) + 1,000 = 1,295ms
+    // Time diff: (4,294,967,296 - 4,294,967,000) + 1,000 = 1,296ms
     unsigned long diff = TimeUtils::timeDiff(start);
 
-    TEST_ASSERT_EQUAL(1295, diff);
+    TEST_ASSERT_EQUAL(1296, diff);
 }
 
 // Test: Time difference with specified end time
@@ -122,6 +123,15 @@ void test_timeDiff_with_end_time() {
     TEST_ASSERT_EQUAL(1500, TimeUtils::timeDiff(start, end));
 }
 
+// Test: CRITICAL - An explicit end of 0 is a real timestamp, not "now"
+void test_timeDiff_explicit_zero_end() {
+    unsigned long start = 4294967000UL;
+    mock_millis_value = 5000;  // Must be ignored
+
+    // Wrapped from start to exactly 0: 296ms
+    TEST_ASSERT_EQUAL(296, TimeUtils::timeDiff(start, 0));
+}
+
 // ===== withinWindow() Tests =====
 
 // Test: Within time window
@@ -152,12 +162,12 @@ void test_withinWindow_boundary() {
 // Test: CRITICAL - Window check with overflow
 void test_withinWindow_overflow() {
     unsigned long timestamp = 4294967000UL;
-    mock_millis_value = 500;
+    mock_millis_value = 1000;
 
-    // 1,295ms has elapsed, window is 2000ms
+    // 1,296ms has elapsed, window is 2000ms
     TEST_ASSERT_TRUE(TimeUtils::withinWindow(timestamp, 2000));
 
-    // 1,295ms has elapsed, window is 1000ms
+    // 1,296ms has elapsed, window is 1000ms
     TEST_ASSERT_FALSE(TimeUtils::withinWindow(timestamp, 1000));
 }
 
@@ -180,6 +190,81 @@ void test_both_at_max() {
     TEST_ASSERT_EQUAL(0, TimeUtils::timeDiff(start));
 }
 
+// ===== 64-bit Microsecond Clock Tests =====
+
+// Test: nowUs() reads the virtual clock with sub-millisecond resolution
+void test_nowUs_resolution() {
+    mock_micros_value = 1234567;
+    TEST_ASSERT_EQUAL_UINT64(1234567ULL, TimeUtils::nowUs());
+    TEST_ASSERT_EQUAL_UINT64(1234ULL, TimeUtils::nowMs64());
+}
+
+// Test: CRITICAL - The microsecond clock does not wrap at 49.7 days
+void test_nowUs_past_millis_wrap() {
+    uint64_t fiftyDaysUs = 50ULL * 24 * 3600 * 1000000ULL;
+    mock_micros_value = fiftyDaysUs;
+
+    uint64_t start = TimeUtils::nowUs();
+    mock_micros_value += 250;
+
+    TEST_ASSERT_EQUAL_UINT64(250ULL, TimeUtils::elapsedUs(start));
+    TEST_ASSERT_EQUAL_UINT64(fiftyDaysUs / 1000ULL, TimeUtils::nowMs64());
+    TEST_ASSERT_TRUE(TimeUtils::nowMs64() > 0xFFFFFFFFULL);
+}
+
+// Test: hasElapsedUs() at the boundary
+void test_hasElapsedUs() {
+    mock_micros_value = 1000;
+    uint64_t start = TimeUtils::nowUs();
+
+    mock_micros_value += 499;
+    TEST_ASSERT_FALSE(TimeUtils::hasElapsedUs(start, 500));
+    mock_micros_value += 1;
+    TEST_ASSERT_TRUE(TimeUtils::hasElapsedUs(start, 500));
+}
+
+// Test: Deadline expiry and remaining time
+void test_deadline() {
+    mock_micros_value = 10000;
+    TimeUtils::Deadline deadline = TimeUtils::Deadline::afterMs(2);
+
+    TEST_ASSERT_FALSE(deadline.expired());
+    TEST_ASSERT_EQUAL_UINT64(2000ULL, deadline.remainingUs());
+
+    mock_micros_value += 1500;
+    TEST_ASSERT_EQUAL_UINT64(500ULL, deadline.remainingUs());
+
+    mock_micros_value += 600;
+    TEST_ASSERT_TRUE(deadline.expired());
+    TEST_ASSERT_EQUAL_UINT64(0ULL, deadline.remainingUs());
+}
+
+// Test: Deadline advance keeps a drift-free schedule
+void test_deadline_advance() {
+    mock_micros_value = 0;
+    TimeUtils::Deadline deadline = TimeUtils::Deadline::afterUs(100);
+
+    mock_micros_value = 130;  // Serviced late
+    TEST_ASSERT_TRUE(deadline.expired());
+    deadline.advance(100);
+
+    TEST_ASSERT_EQUAL_UINT64(200ULL, deadline.atUs);
+    TEST_ASSERT_EQUAL_UINT64(70ULL, deadline.remainingUs());
+}
+
+// Test: delay() advances both clocks
+void test_delay_advances_both_clocks() {
+    delay(5);
+    TEST_ASSERT_EQUAL(5, millis());
+    TEST_ASSERT_EQUAL_UINT64(5000ULL, TimeUtils::nowUs());
+}
+
+// Test: saturateUs() clamps to 32 bits
+void test_saturateUs() {
+    TEST_ASSERT_EQUAL_UINT32(42u, TimeUtils::saturateUs(42));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, TimeUtils::saturateUs(0x100000000ULL));
+}
+
 void setup() {
     UNITY_BEGIN();
 
@@ -196,6 +281,7 @@ void setup() {
     RUN_TEST(test_timeDiff_zero);
     RUN_TEST(test_timeDiff_overflow);
     RUN_TEST(test_timeDiff_with_end_time);
+    RUN_TEST(test_timeDiff_explicit_zero_end);
 
     // withinWindow tests
     RUN_TEST(test_withinWindow_inside);
@@ -207,6 +293,15 @@ void setup() {
     RUN_TEST(test_max_time_value);
     RUN_TEST(test_both_at_max);
 
+    // 64-bit microsecond clock
+    RUN_TEST(test_nowUs_resolution);
+    RUN_TEST(test_nowUs_past_millis_wrap);
+    RUN_TEST(test_hasElapsedUs);
+    RUN_TEST(test_deadline);
+    RUN_TEST(test_deadline_advance);
+    RUN_TEST(test_delay_advances_both_clocks);
+    RUN_TEST(test_saturateUs);
+
     UNITY_END();
 }
 
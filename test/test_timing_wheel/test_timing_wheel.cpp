@@ -0,0 +1,257 @@
+#include <unity.h>
+#include "mocks/Arduino.h"
+#include "utils/timing_wheel.h"
+
+/**
+ * @file test_timing_wheel.cpp
+ * @brief Unit tests for the hierarchical timing wheel
+ *
+ * Checks that every timer fires exactly at its expiry tick - across
+ * level cascades, past the wheel horizon and across the 32-bit wrap.
+ */
+
+struct Probe {
+    Timer timer;
+    uint32_t firedAt;
+    int fireCount;
+    TimingWheel* wheel;
+
+    Probe() : firedAt(0), fireCount(0), wheel(nullptr) {
+        timer.setCallback(&Probe::onFire, this);
+    }
+
+    static void onFire(void* context) {
+        Probe* self = static_cast<Probe*>(context);
+        self->firedAt = self->wheel->getCurrentTick();
+        self->fireCount++;
+    }
+};
+
+// Deterministic pseudo-random source
+static uint32_t rngState;
+static uint32_t nextRandom() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState;
+}
+
+void setUp(void) {
+    rngState = 42;
+}
+
+void tearDown(void) {
+}
+
+// Test: One-shot timer fires exactly once at its expiry
+void test_one_shot_fires_on_time() {
+    TimingWheel wheel(1000);
+    Probe p;
+    p.wheel = &wheel;
+
+    wheel.arm(p.timer, 50);
+    TEST_ASSERT_EQUAL(0, wheel.advance(1049));
+    TEST_ASSERT_EQUAL(1, wheel.advance(1050));
+    TEST_ASSERT_EQUAL(1050, p.firedAt);
+    TEST_ASSERT_FALSE(p.timer.isArmed());
+
+    wheel.advance(5000);
+    TEST_ASSERT_EQUAL(1, p.fireCount);
+}
+
+// Test: Zero delay fires on the next tick
+void test_zero_delay_next_tick() {
+    TimingWheel wheel(0);
+    Probe p;
+    p.wheel = &wheel;
+
+    wheel.arm(p.timer, 0);
+    wheel.advance(1);
+    TEST_ASSERT_EQUAL(1, p.fireCount);
+}
+
+// Test: Cancel prevents firing
+void test_cancel() {
+    TimingWheel wheel(0);
+    Probe p;
+    p.wheel = &wheel;
+
+    wheel.arm(p.timer, 100);
+    wheel.cancel(p.timer);
+    wheel.advance(1000);
+    TEST_ASSERT_EQUAL(0, p.fireCount);
+    TEST_ASSERT_EQUAL(0, wheel.getArmedCount());
+}
+
+// Test: Re-arming replaces the previous expiry
+void test_rearm_replaces() {
+    TimingWheel wheel(0);
+    Probe p;
+    p.wheel = &wheel;
+
+    wheel.arm(p.timer, 100);
+    wheel.arm(p.timer, 300);
+    wheel.advance(200);
+    TEST_ASSERT_EQUAL(0, p.fireCount);
+    wheel.advance(300);
+    TEST_ASSERT_EQUAL(1, p.fireCount);
+    TEST_ASSERT_EQUAL(0, wheel.getArmedCount());
+}
+
+// Test: Periodic timer keeps its schedule even when advance() is late
+void test_periodic_drift_free() {
+    TimingWheel wheel(0);
+    Probe p;
+    p.wheel = &wheel;
+
+    wheel.armPeriodic(p.timer, 1000);
+    wheel.advance(2500);  // Late loop: both 1000 and 2000 are due
+    TEST_ASSERT_EQUAL(2, p.fireCount);
+    TEST_ASSERT_EQUAL(2000, p.firedAt);
+
+    wheel.advance(3000);
+    TEST_ASSERT_EQUAL(3, p.fireCount);
+    TEST_ASSERT_EQUAL(3000, p.firedAt);
+}
+
+// Test: CRITICAL - Random delays across all levels fire exactly on time
+void test_random_delays_exact() {
+    const int count = 200;
+    static Probe probes[count];
+    static uint32_t expected[count];
+    TimingWheel wheel(123456);
+
+    for (int i = 0; i < count; i++) {
+        probes[i].wheel = &wheel;
+        uint32_t delay = 1 + nextRandom() % (1u << (6 * (1 + i % 4)));
+        wheel.arm(probes[i].timer, delay);
+        expected[i] = 123456 + delay;
+    }
+
+    // Advance in irregular steps
+    uint32_t now = 123456;
+    while (wheel.getArmedCount() > 0) {
+        now += 1 + nextRandom() % 5000;
+        wheel.advance(now);
+    }
+
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL(1, probes[i].fireCount);
+        TEST_ASSERT_EQUAL_UINT32(expected[i], probes[i].firedAt);
+    }
+}
+
+// Test: Delay beyond the wheel horizon still fires on time
+void test_beyond_horizon() {
+    TimingWheel wheel(0);
+    Probe p;
+    p.wheel = &wheel;
+
+    uint32_t delay = TimingWheel::MAX_DELAY * 3 + 12345;  // ~14 hours
+    wheel.arm(p.timer, delay);
+
+    wheel.advance(delay - 1);
+    TEST_ASSERT_EQUAL(0, p.fireCount);
+    wheel.advance(delay);
+    TEST_ASSERT_EQUAL(1, p.fireCount);
+    TEST_ASSERT_EQUAL_UINT32(delay, p.firedAt);
+}
+
+// Test: CRITICAL - Timers spanning the 32-bit tick wrap fire on time
+void test_tick_wrap() {
+    uint32_t start = 0xFFFFFFFFu - 500;
+    TimingWheel wheel(start);
+    Probe p;
+    p.wheel = &wheel;
+
+    wheel.armPeriodic(p.timer, 300);
+    wheel.advance(start + 300);
+    TEST_ASSERT_EQUAL(1, p.fireCount);
+    wheel.advance(start + 600);  // Wrapped to 99
+    TEST_ASSERT_EQUAL(2, p.fireCount);
+    TEST_ASSERT_EQUAL_UINT32(start + 600, p.firedAt);
+}
+
+// Test: Callback may cancel another timer due in the same tick
+static Probe* victim;
+static TimingWheel* victimWheel;
+static void cancelVictim(void* context) {
+    (void)context;
+    victimWheel->cancel(victim->timer);
+}
+
+void test_callback_cancels_sibling() {
+    TimingWheel wheel(0);
+    Probe p;
+    p.wheel = &wheel;
+    Timer killer;
+    killer.setCallback(&cancelVictim, nullptr);
+    victim = &p;
+    victimWheel = &wheel;
+
+    wheel.arm(p.timer, 10);
+    wheel.arm(killer, 10);  // Linked at the head, so it runs first
+    wheel.advance(10);
+
+    TEST_ASSERT_EQUAL(0, p.fireCount);
+}
+
+// Test: ticksUntilNext points at the next due slot
+void test_ticks_until_next() {
+    TimingWheel wheel(0);
+    Probe p;
+    p.wheel = &wheel;
+
+    TEST_ASSERT_EQUAL(TimingWheel::MAX_DELAY, wheel.ticksUntilNext());
+    wheel.arm(p.timer, 20);
+    TEST_ASSERT_EQUAL(20, wheel.ticksUntilNext());
+}
+
+// Test: ticksUntilNext jumps over rotations with nothing to cascade
+void test_ticks_until_next_skips_empty() {
+    TimingWheel wheel(0);
+    Probe p;
+    p.wheel = &wheel;
+
+    wheel.arm(p.timer, 5000);
+    int jumps = 0;
+    while (p.fireCount == 0 && jumps < 10) {
+        wheel.advance(wheel.getCurrentTick() + wheel.ticksUntilNext());
+        jumps++;
+    }
+
+    TEST_ASSERT_EQUAL(1, p.fireCount);
+    TEST_ASSERT_EQUAL(5000, p.firedAt);
+    TEST_ASSERT_EQUAL(3, jumps);  // Level-2 cascade, level-1 cascade, expiry
+}
+
+// Test: Idle wheel skips large gaps cheaply
+void test_idle_skip_large_gap() {
+    TimingWheel wheel(0);
+    Probe p;
+    p.wheel = &wheel;
+
+    wheel.arm(p.timer, 2000000000u);  // ~23 days
+    TEST_ASSERT_EQUAL(1, wheel.advance(2000000000u));
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_one_shot_fires_on_time);
+    RUN_TEST(test_zero_delay_next_tick);
+    RUN_TEST(test_cancel);
+    RUN_TEST(test_rearm_replaces);
+    RUN_TEST(test_periodic_drift_free);
+    RUN_TEST(test_random_delays_exact);
+    RUN_TEST(test_beyond_horizon);
+    RUN_TEST(test_tick_wrap);
+    RUN_TEST(test_callback_cancels_sibling);
+    RUN_TEST(test_ticks_until_next);
+    RUN_TEST(test_ticks_until_next_skips_empty);
+    RUN_TEST(test_idle_skip_large_gap);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
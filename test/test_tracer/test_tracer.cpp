@@ -0,0 +1,159 @@
+#include <unity.h>
+#include <string>
+#include "mocks/Arduino.h"
+#include "utils/tracer.h"
+
+/**
+ * @file test_tracer.cpp
+ * @brief Unit tests for request span tracing and Chrome trace export
+ */
+
+static std::string output;
+
+static void captureWrite(const char* data, size_t length, void* context) {
+    (void)context;
+    output.append(data, length);
+}
+
+static std::string exportJson(const Tracer& tracer) {
+    output.clear();
+    char buffer[256];
+    ChunkedWriter out(buffer, sizeof(buffer), &captureWrite, nullptr);
+    tracer.writeChromeJson(out);
+    out.flush();
+    return output;
+}
+
+static size_t countOf(const std::string& haystack, const char* needle) {
+    size_t count = 0;
+    for (size_t pos = haystack.find(needle); pos != std::string::npos;
+         pos = haystack.find(needle, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+void setUp(void) {
+    mock_millis_value = 0;
+    mock_micros_value = 0;
+}
+
+void tearDown(void) {
+}
+
+// Test: Spans get distinct non-zero IDs and the accept time
+void test_start_span() {
+    Tracer tracer;
+    mock_micros_value = 500;
+
+    TraceContext a = tracer.startSpan();
+    TraceContext b = tracer.startSpan();
+
+    TEST_ASSERT_TRUE(a.isActive());
+    TEST_ASSERT_TRUE(a.spanId != b.spanId);
+    TEST_ASSERT_EQUAL_UINT64(500ULL, a.startUs);
+}
+
+// Test: Inactive contexts and a disabled tracer record nothing
+void test_inactive_not_recorded() {
+    Tracer tracer;
+
+    tracer.record(TraceContext(), TraceStage::AUTH, 0, 10);
+    TEST_ASSERT_EQUAL(0, tracer.getRecordedCount());
+
+    tracer.setEnabled(false);
+    TraceContext trace = tracer.startSpan();
+    TEST_ASSERT_FALSE(trace.isActive());
+    tracer.record(TraceContext(7, 0), TraceStage::AUTH, 0, 10);
+    TEST_ASSERT_EQUAL(0, tracer.getRecordedCount());
+}
+
+// Test: Recorded stage keeps start, duration and span
+void test_record_event() {
+    Tracer tracer;
+    TraceContext trace = tracer.startSpan();
+
+    mock_micros_value = 1000;
+    uint64_t start = TimeUtils::nowUs();
+    mock_micros_value = 1250;
+    tracer.record(trace, TraceStage::VALIDATE, start);
+
+    TraceEvent e;
+    TEST_ASSERT_TRUE(tracer.readEvent(0, e));
+    TEST_ASSERT_EQUAL_UINT64(1000ULL, e.startUs);
+    TEST_ASSERT_EQUAL(250, e.durationUs);
+    TEST_ASSERT_EQUAL(trace.spanId, e.spanId);
+    TEST_ASSERT_TRUE(e.stage == TraceStage::VALIDATE);
+    TEST_ASSERT_FALSE(tracer.readEvent(1, e));
+}
+
+// Test: CRITICAL - Ring keeps only the newest CAPACITY events
+void test_ring_overwrites_oldest() {
+    Tracer tracer;
+    TraceContext trace(1, 0);
+
+    for (uint32_t i = 0; i < Tracer::CAPACITY + 10; i++) {
+        tracer.record(trace, TraceStage::AUTH, i, i + 1);
+    }
+
+    TraceEvent e;
+    TEST_ASSERT_EQUAL(10, tracer.oldestSequence());
+    TEST_ASSERT_FALSE(tracer.readEvent(9, e));
+    TEST_ASSERT_TRUE(tracer.readEvent(10, e));
+    TEST_ASSERT_EQUAL_UINT64(10ULL, e.startUs);
+    TEST_ASSERT_TRUE(tracer.readEvent(Tracer::CAPACITY + 9, e));
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)Tracer::CAPACITY + 9, e.startUs);
+}
+
+// Test: Chrome export - complete events on the right tracks, async end-to-end slice
+void test_chrome_export() {
+    Tracer tracer;
+    TraceContext trace(42, 100);
+
+    tracer.record(trace, TraceStage::AUTH, 110, 130);
+    tracer.record(trace, TraceStage::QUEUE_WAIT, 200, 300);
+    tracer.record(trace, TraceStage::END_TO_END, 100, 900);
+
+    std::string json = exportJson(tracer);
+
+    TEST_ASSERT_EQUAL(0, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    TEST_ASSERT_EQUAL(2, countOf(json, "\"ph\":\"M\""));
+    TEST_ASSERT_EQUAL(1, countOf(json,
+        "{\"name\":\"auth\",\"cat\":\"http\",\"ph\":\"X\",\"ts\":110,\"dur\":20,"
+        "\"pid\":1,\"tid\":1,\"args\":{\"span\":42}}"));
+    TEST_ASSERT_EQUAL(1, countOf(json, "\"name\":\"queue_wait\",\"cat\":\"ble\""));
+    TEST_ASSERT_EQUAL(1, countOf(json, "\"tid\":2,\"args\":{\"span\":42}"));
+    TEST_ASSERT_EQUAL(1, countOf(json, "\"ph\":\"b\",\"id\":42,\"ts\":100"));
+    TEST_ASSERT_EQUAL(1, countOf(json, "\"ph\":\"e\",\"id\":42,\"ts\":900"));
+    TEST_ASSERT_EQUAL(json.size() - 4, json.rfind("\n]}\n"));
+
+    // Balanced braces: the export is one JSON object
+    TEST_ASSERT_EQUAL(countOf(json, "{"), countOf(json, "}"));
+}
+
+// Test: Empty ring still exports valid JSON
+void test_chrome_export_empty() {
+    Tracer tracer;
+    std::string json = exportJson(tracer);
+
+    TEST_ASSERT_EQUAL(0, countOf(json, "\"ph\":\"X\""));
+    TEST_ASSERT_EQUAL(countOf(json, "{"), countOf(json, "}"));
+    TEST_ASSERT_EQUAL(countOf(json, "["), countOf(json, "]"));
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_start_span);
+    RUN_TEST(test_inactive_not_recorded);
+    RUN_TEST(test_record_event);
+    RUN_TEST(test_ring_overwrites_oldest);
+    RUN_TEST(test_chrome_export);
+    RUN_TEST(test_chrome_export_empty);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,259 @@
+#include <unity.h>
+#include <time.h>
+#include "mocks/Arduino.h"
+#include "mocks/virtual_clock.h"
+#include "utils/time_utils.h"
+
+/**
+ * @file test_virtual_clock.cpp
+ * @brief Unit tests for the discrete-event virtual clock
+ *
+ * Events and wheel timers must run in time order with the clock set to
+ * their exact time, and long simulations (including the 49-day millis()
+ * wrap) must cost per event, not per millisecond.
+ */
+
+static const uint64_t US_PER_MS = 1000ULL;
+static const uint64_t US_PER_HOUR = 3600ULL * 1000000ULL;
+
+// Records the millis()/micros() seen by each event in firing order
+struct Trace {
+    uint32_t millisAt[16];
+    uint64_t microsAt[16];
+    int tags[16];
+    int count;
+
+    Trace() : count(0) {}
+
+    void record(int tag) {
+        if (count < 16) {
+            millisAt[count] = millis();
+            microsAt[count] = TimeUtils::nowUs();
+            tags[count] = tag;
+            count++;
+        }
+    }
+};
+
+static Trace trace;
+
+struct Tagged {
+    int tag;
+};
+
+static void recordEvent(void* context) {
+    trace.record(static_cast<Tagged*>(context)->tag);
+}
+
+// Re-schedules itself every 10 seconds until stopped
+struct Ticker {
+    uint32_t fired;
+    bool stop;
+};
+
+static void onTick(void* context) {
+    Ticker* t = static_cast<Ticker*>(context);
+    t->fired++;
+    if (!t->stop) Sim::clock().scheduleIn(10000000ULL, &onTick, t);
+}
+
+// Calls delay() from inside an event, like a handler that blocks
+static void delayingEvent(void* context) {
+    (void)context;
+    trace.record(100);
+    delay(50);
+    trace.record(101);
+}
+
+struct WheelProbe {
+    Timer timer;
+    uint32_t fired;
+    uint32_t lastMillis;
+
+    WheelProbe() : fired(0), lastMillis(0) {
+        timer.setCallback(&onWheelTimer, this);
+    }
+
+    static void onWheelTimer(void* context) {
+        WheelProbe* p = static_cast<WheelProbe*>(context);
+        p->fired++;
+        p->lastMillis = millis();
+    }
+};
+
+void setUp(void) {
+    trace = Trace();
+    Sim::clock().reset(0);
+}
+
+void tearDown(void) {
+    Sim::clock().detach();
+}
+
+// Test: Events run in time order with the clock at their exact time
+void test_events_in_time_order() {
+    VirtualClock& sim = Sim::clock();
+    Tagged a = { 1 }, b = { 2 }, c = { 3 };
+
+    sim.scheduleAt(5000, &recordEvent, &b);
+    sim.scheduleAt(250, &recordEvent, &a);
+    sim.scheduleAt(2000000, &recordEvent, &c);
+
+    TEST_ASSERT_EQUAL(3, sim.runAll());
+    TEST_ASSERT_EQUAL(3, trace.count);
+    TEST_ASSERT_EQUAL(1, trace.tags[0]);
+    TEST_ASSERT_EQUAL(250, (uint32_t)trace.microsAt[0]);
+    TEST_ASSERT_EQUAL(0, trace.millisAt[0]);
+    TEST_ASSERT_EQUAL(2, trace.tags[1]);
+    TEST_ASSERT_EQUAL(5, trace.millisAt[1]);
+    TEST_ASSERT_EQUAL(3, trace.tags[2]);
+    TEST_ASSERT_EQUAL(2000, trace.millisAt[2]);
+}
+
+// Test: Events at the same instant run in scheduling order
+void test_same_time_fifo() {
+    VirtualClock& sim = Sim::clock();
+    Tagged tags[5] = { { 10 }, { 11 }, { 12 }, { 13 }, { 14 } };
+
+    for (int i = 0; i < 5; i++) {
+        sim.scheduleAt(1000, &recordEvent, &tags[i]);
+    }
+    sim.runAll();
+
+    TEST_ASSERT_EQUAL(5, trace.count);
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL(10 + i, trace.tags[i]);
+    }
+}
+
+// Test: runUntil stops at the limit and leaves later events queued
+void test_run_until_limit() {
+    VirtualClock& sim = Sim::clock();
+    Tagged early = { 1 }, late = { 2 };
+
+    sim.scheduleAt(10 * US_PER_MS, &recordEvent, &early);
+    sim.scheduleAt(30 * US_PER_MS, &recordEvent, &late);
+
+    sim.runUntil(20 * US_PER_MS);
+    TEST_ASSERT_EQUAL(1, trace.count);
+    TEST_ASSERT_EQUAL(20, millis());
+    TEST_ASSERT_EQUAL(1, sim.pending());
+
+    sim.runFor(10 * US_PER_MS);
+    TEST_ASSERT_EQUAL(2, trace.count);
+    TEST_ASSERT_EQUAL(30, trace.millisAt[1]);
+}
+
+// Test: Cancelled events never run
+void test_cancel() {
+    VirtualClock& sim = Sim::clock();
+    Tagged keep = { 1 }, drop = { 2 };
+
+    sim.scheduleIn(100, &recordEvent, &keep);
+    uint32_t id = sim.scheduleIn(50, &recordEvent, &drop);
+
+    TEST_ASSERT_TRUE(sim.cancel(id));
+    TEST_ASSERT_FALSE(sim.cancel(id));
+    TEST_ASSERT_EQUAL(1, sim.pending());
+    sim.runAll();
+
+    TEST_ASSERT_EQUAL(1, trace.count);
+    TEST_ASSERT_EQUAL(1, trace.tags[0]);
+}
+
+// Test: A full queue refuses new events instead of dropping old ones
+void test_queue_full() {
+    VirtualClock& sim = Sim::clock();
+    Tagged t = { 1 };
+
+    for (size_t i = 0; i < VirtualClock::MAX_EVENTS; i++) {
+        TEST_ASSERT_NOT_EQUAL(0, sim.scheduleIn(i + 1, &recordEvent, &t));
+    }
+    TEST_ASSERT_EQUAL(0, sim.scheduleIn(1, &recordEvent, &t));
+    TEST_ASSERT_EQUAL(VirtualClock::MAX_EVENTS, sim.runAll());
+}
+
+// Test: CRITICAL - delay() inside an event runs the events it overlaps
+void test_delay_runs_due_events() {
+    VirtualClock& sim = Sim::clock();
+    Tagged during = { 7 }, after = { 8 };
+
+    sim.scheduleAt(10 * US_PER_MS, &delayingEvent, nullptr);
+    sim.scheduleAt(40 * US_PER_MS, &recordEvent, &during);
+    sim.scheduleAt(90 * US_PER_MS, &recordEvent, &after);
+    sim.runAll();
+
+    TEST_ASSERT_EQUAL(4, trace.count);
+    TEST_ASSERT_EQUAL(100, trace.tags[0]);
+    TEST_ASSERT_EQUAL(7, trace.tags[1]);
+    TEST_ASSERT_EQUAL(40, trace.millisAt[1]);
+    TEST_ASSERT_EQUAL(101, trace.tags[2]);
+    TEST_ASSERT_EQUAL(60, trace.millisAt[2]);
+    TEST_ASSERT_EQUAL(8, trace.tags[3]);
+}
+
+// Test: Wheel timers fire at their exact tick without a loop() poll
+void test_drives_timing_wheel() {
+    VirtualClock& sim = Sim::clock();
+    TimingWheel wheel(0);
+    WheelProbe oneShot, periodic;
+
+    sim.attachWheel(wheel);
+    wheel.arm(oneShot.timer, 12345);
+    wheel.armPeriodic(periodic.timer, 5000);
+
+    sim.runFor(US_PER_HOUR);
+
+    TEST_ASSERT_EQUAL(1, oneShot.fired);
+    TEST_ASSERT_EQUAL(12345, oneShot.lastMillis);
+    TEST_ASSERT_EQUAL(720, periodic.fired);
+    TEST_ASSERT_EQUAL(3600000, periodic.lastMillis);
+    TEST_ASSERT_EQUAL(3600000, wheel.getCurrentTick());
+
+    wheel.cancel(periodic.timer);
+}
+
+// Test: CRITICAL - Days of simulated time cost per event, across the millis() wrap
+void test_long_run_across_millis_wrap() {
+    VirtualClock& sim = Sim::clock();
+    TimingWheel wheel(0);
+    WheelProbe hourly;
+    Ticker ticker = { 0, false };
+
+    sim.attachWheel(wheel);
+    wheel.armPeriodic(hourly.timer, 3600000);
+    sim.scheduleIn(10000000ULL, &onTick, &ticker);
+
+    clock_t start = clock();
+    sim.runFor(50ULL * 24 * US_PER_HOUR);  // Past 2^32 ms (~49.7 days)
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    TEST_ASSERT_EQUAL(50 * 24 * 360, ticker.fired);
+    TEST_ASSERT_EQUAL(50 * 24, hourly.fired);
+    // millis() wrapped; the 64-bit clock didn't
+    TEST_ASSERT_EQUAL((uint32_t)(50ULL * 24 * 3600000), millis());
+    TEST_ASSERT_TRUE(TimeUtils::nowMs64() == 50ULL * 24 * 3600000);
+    TEST_ASSERT_TRUE(seconds < 2.0);
+
+    ticker.stop = true;
+    wheel.cancel(hourly.timer);
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_events_in_time_order);
+    RUN_TEST(test_same_time_fifo);
+    RUN_TEST(test_run_until_limit);
+    RUN_TEST(test_cancel);
+    RUN_TEST(test_queue_full);
+    RUN_TEST(test_delay_runs_due_events);
+    RUN_TEST(test_drives_timing_wheel);
+    RUN_TEST(test_long_run_across_millis_wrap);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Not used in native testing
+}
@@ -0,0 +1,579 @@
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netdb.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @file loadgen.cpp
+ * @brief HTTP load generator for the keyboard API (device or host build)
+ *
+ *   pio run -e loadgen
+ *   .pio/build/loadgen/program --target 192.168.1.50 --key KEY \
+ *       --route status:8 --route type:1 --route led:1 \
+ *       --concurrency 4 --rate 20 --duration 30
+ *
+ * Options:
+ *   --target HOST[:PORT]  Device or host emulator (default 127.0.0.1:8080)
+ *   --key KEY             Sent as X-API-Key
+ *   --route NAME[:W]      status | type | ctrlaltdel | led | sleep | metrics,
+ *                         or METHOD:/path. W is a relative weight (default 1).
+ *                         Repeatable; default is status.
+ *   --msg TEXT            Text for type requests (default "hello")
+ *   --concurrency N       Connections in flight at most (default 1)
+ *   --rate R              Open loop: R requests/s, independent of responses.
+ *                         0 = closed loop: each connection sends its next
+ *                         request as soon as the last completes (default 0)
+ *   --poisson             Exponential inter-arrival times instead of fixed
+ *   --duration S          Seconds to generate load (default 10)
+ *   --timeout-ms N        Per-request timeout (default 5000)
+ *   --json PATH           Also write results as JSON
+ *
+ * Open-loop latency is measured from each request's scheduled time, not
+ * from when a connection became free. When the server falls behind, the
+ * wait shows up in the percentiles instead of being hidden by the
+ * generator slowing down (coordinated omission). "late" counts requests
+ * that couldn't start on schedule because all connections were busy.
+ *
+ * Status 0 rows are transport failures: connect errors, resets and
+ * timeouts. Every request uses a fresh connection with
+ * Connection: close, as the device's WebServer serves one request per
+ * connection.
+ */
+
+static const char* const PRESETS[][3] = {
+    // name, method, path
+    { "status", "GET", "/status" },
+    { "type", "POST", nullptr },  // Path built from --msg
+    { "ctrlaltdel", "POST", "/ctrlaltdel" },
+    { "led", "POST", "/led/toggle" },
+    { "sleep", "POST", "/sleep" },
+    { "metrics", "GET", "/metrics" },
+};
+
+struct Route {
+    std::string name;
+    std::string method;
+    std::string path;
+    unsigned weight;
+};
+
+struct RouteStats {
+    std::map<int, std::vector<uint32_t>> byStatus;  // Status -> latencies (us)
+};
+
+struct Connection {
+    int fd;
+    size_t route;
+    uint64_t scheduledNs;  // Latency is measured from here
+    uint64_t deadlineNs;
+    std::string request;
+    size_t written;
+    std::string response;
+    bool connected;
+};
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void onInterrupt(int) {
+    interrupted = 1;
+}
+
+static uint64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static std::string urlEncode(const std::string& text) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            out += (char)c;
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        }
+    }
+    return out;
+}
+
+static bool parseRoute(const char* spec, const std::string& message, Route& route) {
+    std::string text(spec);
+    route.weight = 1;
+
+    // METHOD:/path[:W]
+    size_t slash = text.find(":/");
+    if (slash != std::string::npos) {
+        route.method = text.substr(0, slash);
+        std::string rest = text.substr(slash + 1);
+        size_t colon = rest.rfind(':');
+        if (colon != std::string::npos && colon > 0) {
+            route.weight = (unsigned)atoi(rest.c_str() + colon + 1);
+            rest = rest.substr(0, colon);
+        }
+        route.path = rest;
+        route.name = rest;
+        return route.weight > 0;
+    }
+
+    // NAME[:W]
+    size_t colon = text.find(':');
+    std::string name = text.substr(0, colon);
+    if (colon != std::string::npos) {
+        route.weight = (unsigned)atoi(text.c_str() + colon + 1);
+    }
+    for (size_t i = 0; i < sizeof(PRESETS) / sizeof(PRESETS[0]); i++) {
+        if (name == PRESETS[i][0]) {
+            route.name = name;
+            route.method = PRESETS[i][1];
+            route.path = PRESETS[i][2] ? PRESETS[i][2] : "/type?msg=" + urlEncode(message);
+            return route.weight > 0;
+        }
+    }
+    return false;
+}
+
+static bool resolve(const std::string& target, sockaddr_in& addr, std::string& hostHeader) {
+    std::string host = target;
+    std::string port = "8080";
+    size_t colon = target.rfind(':');
+    if (colon != std::string::npos) {
+        host = target.substr(0, colon);
+        port = target.substr(colon + 1);
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0 || result == nullptr) {
+        return false;
+    }
+    memcpy(&addr, result->ai_addr, sizeof(addr));
+    freeaddrinfo(result);
+    hostHeader = host + ":" + port;
+    return true;
+}
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+    if (rank == 0) rank = 1;
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+/**
+ * @brief Parse the status code once the status line has arrived
+ * @return -1 if not there yet
+ */
+static int statusCode(const std::string& response) {
+    size_t lineEnd = response.find("\r\n");
+    if (lineEnd == std::string::npos) return -1;
+    int code = 0;
+    if (sscanf(response.c_str(), "HTTP/%*d.%*d %d", &code) != 1) return 0;
+    return code;
+}
+
+/**
+ * @brief Whether a full response is in (for servers that don't close)
+ */
+static bool responseComplete(const std::string& response) {
+    size_t headerEnd = response.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) return false;
+
+    std::string headers = response.substr(0, headerEnd);
+    for (size_t i = 0; i < headers.size(); i++) headers[i] = (char)tolower(headers[i]);
+
+    size_t field = headers.find("content-length:");
+    if (field != std::string::npos) {
+        size_t length = (size_t)strtoul(headers.c_str() + field + 15, nullptr, 10);
+        return response.size() >= headerEnd + 4 + length;
+    }
+    if (headers.find("transfer-encoding: chunked") != std::string::npos) {
+        return response.size() >= headerEnd + 4 + 5 &&
+               response.compare(response.size() - 5, 5, "0\r\n\r\n") == 0;
+    }
+    return false;  // Delimited by close
+}
+
+class LoadGenerator {
+private:
+    sockaddr_in addr;
+    std::string hostHeader;
+    std::string apiKey;
+    std::vector<Route> routes;
+    std::vector<size_t> schedule;  // Weighted round-robin over routes
+    size_t nextRoute;
+
+    int epollFd;
+    std::vector<Connection*> active;
+    std::deque<uint64_t> backlog;  // Scheduled times waiting for a connection
+    uint32_t concurrency;
+    uint64_t timeoutNs;
+
+public:
+    std::vector<RouteStats> stats;
+    uint64_t late;
+    size_t maxBacklog;
+
+    LoadGenerator(const sockaddr_in& address, const std::string& host, const std::string& key,
+                  const std::vector<Route>& routeList, uint32_t maxInFlight, uint32_t timeoutMs)
+        : addr(address), hostHeader(host), apiKey(key), routes(routeList), nextRoute(0),
+          concurrency(maxInFlight), timeoutNs((uint64_t)timeoutMs * 1000000ULL),
+          stats(routeList.size()), late(0), maxBacklog(0) {
+        for (size_t r = 0; r < routes.size(); r++) {
+            for (unsigned w = 0; w < routes[r].weight; w++) schedule.push_back(r);
+        }
+        // Interleave weights instead of running each route in a burst
+        std::mt19937 rng(1);
+        std::shuffle(schedule.begin(), schedule.end(), rng);
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+    }
+
+    ~LoadGenerator() {
+        for (size_t i = 0; i < active.size(); i++) {
+            close(active[i]->fd);
+            delete active[i];
+        }
+        close(epollFd);
+    }
+
+    size_t inFlight() const {
+        return active.size();
+    }
+
+    bool hasCapacity() const {
+        return active.size() < concurrency;
+    }
+
+    /**
+     * @brief Start (or queue) a request scheduled for scheduledNs
+     */
+    void submit(uint64_t scheduledNs) {
+        if (hasCapacity() && backlog.empty()) {
+            start(scheduledNs);
+        } else {
+            backlog.push_back(scheduledNs);
+            maxBacklog = std::max(maxBacklog, backlog.size());
+            late++;
+        }
+    }
+
+    /**
+     * @return false if the connection failed immediately (recorded as status 0)
+     */
+    bool start(uint64_t scheduledNs) {
+        Connection* c = new Connection();
+        c->route = schedule[nextRoute++ % schedule.size()];
+        c->scheduledNs = scheduledNs;
+        c->deadlineNs = nowNs() + timeoutNs;
+        c->written = 0;
+        c->connected = false;
+
+        const Route& route = routes[c->route];
+        c->request = route.method + " " + route.path + " HTTP/1.1\r\n" +
+                     "Host: " + hostHeader + "\r\n" +
+                     "Connection: close\r\n" +
+                     "Content-Length: 0\r\n";
+        if (!apiKey.empty()) c->request += "X-API-Key: " + apiKey + "\r\n";
+        c->request += "\r\n";
+
+        c->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (c->fd < 0 || (connect(c->fd, (sockaddr*)&addr, sizeof(addr)) < 0 &&
+                          errno != EINPROGRESS)) {
+            finish(c, 0, false);
+            return false;
+        }
+
+        epoll_event ev = {};
+        ev.events = EPOLLOUT | EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = c;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, c->fd, &ev);
+        active.push_back(c);
+        return true;
+    }
+
+    /**
+     * @param registered false if the request never got a connection slot
+     */
+    void finish(Connection* c, int status, bool registered) {
+        uint64_t latencyUs = (nowNs() - c->scheduledNs) / 1000;
+        stats[c->route].byStatus[status].push_back(
+            (uint32_t)std::min<uint64_t>(latencyUs, UINT32_MAX));
+
+        if (c->fd >= 0) {
+            if (registered) epoll_ctl(epollFd, EPOLL_CTL_DEL, c->fd, nullptr);
+            close(c->fd);
+        }
+        if (registered) {
+            active.erase(std::find(active.begin(), active.end(), c));
+        }
+        delete c;
+        if (!registered) return;
+
+        // A slot freed up: start the oldest queued request
+        while (hasCapacity() && !backlog.empty()) {
+            uint64_t scheduled = backlog.front();
+            backlog.pop_front();
+            start(scheduled);
+        }
+    }
+
+    void onEvent(Connection* c, uint32_t events) {
+        if (!c->connected && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &error, &length);
+            if (error != 0) {
+                finish(c, 0, true);
+                return;
+            }
+            c->connected = true;
+        }
+
+        if (c->connected && c->written < c->request.size() && (events & EPOLLOUT)) {
+            ssize_t n = send(c->fd, c->request.data() + c->written,
+                             c->request.size() - c->written, MSG_NOSIGNAL);
+            if (n < 0 && errno != EAGAIN) {
+                finish(c, 0, true);
+                return;
+            }
+            if (n > 0) c->written += (size_t)n;
+            if (c->written == c->request.size()) {
+                epoll_event ev = {};
+                ev.events = EPOLLIN | EPOLLRDHUP;
+                ev.data.ptr = c;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, c->fd, &ev);
+            }
+        }
+
+        if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+            char buffer[4096];
+            for (;;) {
+                ssize_t n = recv(c->fd, buffer, sizeof(buffer), 0);
+                if (n > 0) {
+                    c->response.append(buffer, (size_t)n);
+                    if (responseComplete(c->response)) {
+                        finish(c, statusCode(c->response), true);
+                        return;
+                    }
+                    continue;
+                }
+                if (n == 0) {
+                    int status = statusCode(c->response);
+                    finish(c, status < 0 ? 0 : status, true);
+                    return;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+                finish(c, 0, true);  // Reset
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Wait for socket events until untilNs, then expire timeouts
+     */
+    void poll(uint64_t untilNs) {
+        uint64_t now = nowNs();
+        int timeoutMs = untilNs > now ? (int)((untilNs - now + 999999) / 1000000) : 0;
+
+        epoll_event events[64];
+        int n = epoll_wait(epollFd, events, 64, timeoutMs);
+        for (int i = 0; i < n; i++) {
+            onEvent(static_cast<Connection*>(events[i].data.ptr), events[i].events);
+        }
+
+        now = nowNs();
+        for (size_t i = 0; i < active.size();) {
+            if (now >= active[i]->deadlineNs) {
+                finish(active[i], 0, true);  // Timeout
+            } else {
+                i++;
+            }
+        }
+    }
+};
+
+static void report(const std::vector<Route>& routes, const LoadGenerator& gen, double seconds,
+                   const char* jsonPath) {
+    printf("\n%-14s %6s %8s %9s %9s %9s %9s %9s\n",
+           "route", "status", "count", "req/s", "p50 ms", "p99 ms", "p999 ms", "max ms");
+
+    FILE* json = jsonPath ? fopen(jsonPath, "w") : nullptr;
+    if (jsonPath && !json) fprintf(stderr, "Can't write %s\n", jsonPath);
+    if (json) fprintf(json, "{\"durationS\":%.3f,\"late\":%llu,\"routes\":[", seconds,
+                      (unsigned long long)gen.late);
+
+    std::vector<uint32_t> all;
+    for (size_t r = 0; r < routes.size(); r++) {
+        if (json) fprintf(json, "%s{\"name\":\"%s\",\"statuses\":[", r ? "," : "",
+                          routes[r].name.c_str());
+        bool first = true;
+        for (std::map<int, std::vector<uint32_t>>::const_iterator it = gen.stats[r].byStatus.begin();
+             it != gen.stats[r].byStatus.end(); ++it) {
+            std::vector<uint32_t> sorted = it->second;
+            std::sort(sorted.begin(), sorted.end());
+            all.insert(all.end(), sorted.begin(), sorted.end());
+
+            double rps = sorted.size() / seconds;
+            printf("%-14s %6d %8zu %9.1f %9.2f %9.2f %9.2f %9.2f\n", routes[r].name.c_str(),
+                   it->first, sorted.size(), rps, percentile(sorted, 50) / 1000.0,
+                   percentile(sorted, 99) / 1000.0, percentile(sorted, 99.9) / 1000.0,
+                   sorted.back() / 1000.0);
+            if (json) {
+                fprintf(json, "%s{\"status\":%d,\"count\":%zu,\"rps\":%.2f,\"p50Us\":%u,"
+                              "\"p99Us\":%u,\"p999Us\":%u,\"maxUs\":%u}",
+                        first ? "" : ",", it->first, sorted.size(), rps,
+                        percentile(sorted, 50), percentile(sorted, 99),
+                        percentile(sorted, 99.9), sorted.back());
+            }
+            first = false;
+        }
+        if (json) fprintf(json, "]}");
+    }
+
+    std::sort(all.begin(), all.end());
+    printf("%-14s %6s %8zu %9.1f %9.2f %9.2f %9.2f %9.2f\n", "total", "", all.size(),
+           all.size() / seconds, percentile(all, 50) / 1000.0, percentile(all, 99) / 1000.0,
+           percentile(all, 99.9) / 1000.0, all.empty() ? 0.0 : all.back() / 1000.0);
+    printf("late starts: %llu (max backlog %zu)\n", (unsigned long long)gen.late, gen.maxBacklog);
+
+    if (json) {
+        fprintf(json, "],\"total\":{\"count\":%zu,\"rps\":%.2f,\"p50Us\":%u,\"p99Us\":%u,"
+                      "\"p999Us\":%u}}\n",
+                all.size(), all.size() / seconds, percentile(all, 50), percentile(all, 99),
+                percentile(all, 99.9));
+        fclose(json);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string target = "127.0.0.1:8080";
+    std::string key;
+    std::string message = "hello";
+    std::vector<const char*> routeSpecs;
+    uint32_t concurrency = 1;
+    double rate = 0;
+    bool poisson = false;
+    double duration = 10;
+    uint32_t timeoutMs = 5000;
+    const char* jsonPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--target") == 0 && hasValue) {
+            target = argv[++i];
+        } else if (strcmp(argv[i], "--key") == 0 && hasValue) {
+            key = argv[++i];
+        } else if (strcmp(argv[i], "--route") == 0 && hasValue) {
+            routeSpecs.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--msg") == 0 && hasValue) {
+            message = argv[++i];
+        } else if (strcmp(argv[i], "--concurrency") == 0 && hasValue) {
+            concurrency = (uint32_t)std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--rate") == 0 && hasValue) {
+            rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--poisson") == 0) {
+            poisson = true;
+        } else if (strcmp(argv[i], "--duration") == 0 && hasValue) {
+            duration = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--timeout-ms") == 0 && hasValue) {
+            timeoutMs = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown option: %s (see tools/loadgen/loadgen.cpp)\n", argv[i]);
+            return 2;
+        }
+    }
+    if (target.find(':') == std::string::npos) target += ":80";
+    if (routeSpecs.empty()) routeSpecs.push_back("status");
+
+    std::vector<Route> routes;
+    for (size_t i = 0; i < routeSpecs.size(); i++) {
+        Route route;
+        if (!parseRoute(routeSpecs[i], message, route)) {
+            fprintf(stderr, "Bad --route: %s\n", routeSpecs[i]);
+            return 2;
+        }
+        routes.push_back(route);
+    }
+
+    sockaddr_in addr;
+    std::string hostHeader;
+    if (!resolve(target, addr, hostHeader)) {
+        fprintf(stderr, "Can't resolve %s\n", target.c_str());
+        return 2;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, onInterrupt);
+
+    printf("%s loop against %s: %u connection(s)", rate > 0 ? "Open" : "Closed",
+           hostHeader.c_str(), concurrency);
+    if (rate > 0) printf(", %.1f req/s%s", rate, poisson ? " (Poisson)" : "");
+    printf(", %.0f s\n", duration);
+
+    LoadGenerator gen(addr, hostHeader, key, routes, concurrency, timeoutMs);
+    std::mt19937_64 rng(42);
+    std::exponential_distribution<double> gap(rate > 0 ? rate : 1);
+
+    uint64_t startNs = nowNs();
+    uint64_t endNs = startNs + (uint64_t)(duration * 1e9);
+    uint64_t nextArrivalNs = startNs;
+    uint64_t arrivals = 0;
+
+    while (!interrupted && nowNs() < endNs) {
+        if (rate > 0) {
+            uint64_t now = nowNs();
+            while (nextArrivalNs <= now && nextArrivalNs < endNs) {
+                gen.submit(nextArrivalNs);
+                arrivals++;
+                double gapS = poisson ? gap(rng) : 1.0 / rate;
+                nextArrivalNs += (uint64_t)(gapS * 1e9);
+            }
+            gen.poll(std::min(nextArrivalNs, endNs));
+        } else {
+            bool failed = false;
+            while (gen.hasCapacity() && !failed) {
+                failed = !gen.start(nowNs());
+            }
+            // Back off briefly after an immediate failure instead of spinning
+            gen.poll(failed ? std::min<uint64_t>(nowNs() + 10000000ULL, endNs) : endNs);
+        }
+    }
+
+    // Let in-flight requests finish (bounded by their timeouts)
+    while (gen.inFlight() > 0) {
+        gen.poll(nowNs() + 100000000ULL);
+    }
+
+    double seconds = (nowNs() - startNs) / 1e9;
+    report(routes, gen, seconds, jsonPath);
+    return 0;
+}
@@ -0,0 +1,547 @@
+#include <Arduino.h>
+#include <BleKeyboard.h>
+#include <WebServer.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "host_options.h"
+#include "host_clock.h"
+#include "host_sim.h"
+#include "hid_sink.h"
+#include "error_codes.h"
+
+// The key the firmware was built with (src/secrets.h wins, as for main.cpp)
+#if __has_include("../../src/secrets.h")
+#include "../../src/secrets.h"
+#else
+#include "secrets.h"
+#endif
+
+/**
+ * @file replay_main.cpp
+ * @brief Replays a GET /capture export through the host build on virtual time
+ *
+ *   curl -H "X-API-Key: KEY" http://DEVICE/capture > capture.json
+ *   pio run -e replay
+ *   .pio/build/replay/program --capture capture.json --out before.json
+ *   (change the firmware, rebuild)
+ *   .pio/build/replay/program --capture capture.json --baseline before.json
+ *
+ * Options:
+ *   --capture PATH     Export from GET /capture (required)
+ *   --out PATH         Results file (default replay-results.json)
+ *   --baseline PATH    Compare against an earlier --out; exit 1 on change
+ *   --threshold PCT    Allowed growth of time metrics (default 25)
+ *   --settle-ms N      Virtual time between setup() and the first request
+ *                      (default 2000: WiFi associated, timers running)
+ *   --log PATH         Firmware log output (default: discarded)
+ *
+ * The firmware runs setup()/loop() on a virtual clock. Requests are
+ * injected into the WebServer at their captured arrival times (relative
+ * to the first), from the captured client IP, with the valid API key
+ * unless the original was rejected as unauthorised. The BLE host is
+ * connected or disconnected to match what each request saw. Between
+ * requests the clock jumps to the next timer (at most MAX_STEP_MS), so
+ * report pacing, rate-limit windows and BLE busy periods play out the
+ * same way every run.
+ *
+ * Results:
+ *   - Responses per route and status (exact: any change fails the gate)
+ *   - Requests whose status differs from the capture (exact)
+ *   - Typing jobs: virtual time from acceptance to the last character
+ *     (p50/p99/max; fails if it grows past the threshold)
+ *   - Host wall time of the loop() pass that served each route
+ *     (informational: varies with the machine and its load)
+ */
+
+static const uint32_t MAX_STEP_MS = 10;
+static const uint64_t DRAIN_LIMIT_US = 600ULL * 1000000ULL;  // Typing left after the last request
+
+struct ReplayRequest {
+    uint64_t atUs;
+    std::string method;
+    std::string path;
+    std::string ip;
+    std::string result;
+    bool bleConnected;
+    uint32_t bodyLength;
+    std::string body;   // Stored prefix
+};
+
+struct TypingJob {
+    uint64_t acceptedUs;
+    uint64_t charsThrough;  // Typed total once this job is done
+};
+
+/**
+ * @brief Sink that keeps a running count of typed characters
+ */
+class CountingHidSink : public HidSink {
+private:
+    uint64_t typed;
+    std::vector<std::pair<uint64_t, uint64_t> > progress;  // (us, typed so far)
+
+public:
+    CountingHidSink() : typed(0) {}
+
+    void onText(uint64_t us, const char* text, size_t length) override {
+        (void)text;
+        typed += length;
+        progress.push_back(std::make_pair(us, typed));
+    }
+    void onPress(uint64_t, uint8_t) override {}
+    void onReleaseAll(uint64_t) override {}
+
+    uint64_t getTyped() const { return typed; }
+
+    /**
+     * @brief Time the running total first reached chars, or 0
+     */
+    uint64_t reachedAt(uint64_t chars) const {
+        for (size_t i = 0; i < progress.size(); i++) {
+            if (progress[i].second >= chars) return progress[i].first;
+        }
+        return 0;
+    }
+};
+
+struct Metric {
+    std::string name;
+    double value;
+    const char* kind;  // "exact", "time" or "info"
+};
+
+// ===== Capture parsing =====
+
+static bool readFile(const char* path, std::string& contents) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) return false;
+
+    char chunk[4096];
+    size_t n;
+    contents.clear();
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        contents.append(chunk, n);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool findRaw(const std::string& line, const char* key, size_t& valueAt) {
+    std::string quoted = std::string("\"") + key + "\":";
+    size_t at = line.find(quoted);
+    if (at == std::string::npos) return false;
+    valueAt = at + quoted.size();
+    return true;
+}
+
+static bool findNumber(const std::string& line, const char* key, double& value) {
+    size_t at;
+    if (!findRaw(line, key, at)) return false;
+    value = strtod(line.c_str() + at, nullptr);
+    return true;
+}
+
+static bool findBool(const std::string& line, const char* key, bool& value) {
+    size_t at;
+    if (!findRaw(line, key, at)) return false;
+    value = line.compare(at, 4, "true") == 0;
+    return true;
+}
+
+/**
+ * @brief Read a JSON string value, undoing the escapes writeJson() uses
+ */
+static bool findString(const std::string& line, const char* key, std::string& value) {
+    size_t at;
+    if (!findRaw(line, key, at) || at >= line.size() || line[at] != '"') return false;
+
+    value.clear();
+    for (size_t i = at + 1; i < line.size(); i++) {
+        char c = line[i];
+        if (c == '"') return true;
+        if (c != '\\' || i + 1 >= line.size()) {
+            value += c;
+            continue;
+        }
+        char e = line[++i];
+        switch (e) {
+            case 'n': value += '\n'; break;
+            case 'r': value += '\r'; break;
+            case 't': value += '\t'; break;
+            case 'u':
+                if (i + 4 < line.size()) {
+                    value += (char)strtoul(line.substr(i + 1, 4).c_str(), nullptr, 16);
+                    i += 4;
+                }
+                break;
+            default: value += e; break;
+        }
+    }
+    return false;  // Unterminated
+}
+
+static bool loadCapture(const char* path, std::vector<ReplayRequest>& requests) {
+    std::string contents;
+    if (!readFile(path, contents)) return false;
+
+    size_t start = 0;
+    while (start < contents.size()) {
+        size_t end = contents.find('\n', start);
+        if (end == std::string::npos) end = contents.size();
+        std::string line = contents.substr(start, end - start);
+        start = end + 1;
+
+        double atUs, bodyLength;
+        ReplayRequest r;
+        if (!findNumber(line, "atUs", atUs) || !findString(line, "path", r.path)) continue;
+        findString(line, "method", r.method);
+        findString(line, "ip", r.ip);
+        findString(line, "result", r.result);
+        findString(line, "body", r.body);
+        r.bleConnected = true;
+        findBool(line, "bleConnected", r.bleConnected);
+        r.bodyLength = findNumber(line, "bodyLength", bodyLength) ? (uint32_t)bodyLength : 0;
+        r.atUs = (uint64_t)atUs;
+        requests.push_back(r);
+    }
+    return true;
+}
+
+// ===== Request building =====
+
+static HTTPMethod parseMethod(const std::string& name) {
+    if (name == "GET") return HTTP_GET;
+    if (name == "POST") return HTTP_POST;
+    if (name == "PUT") return HTTP_PUT;
+    if (name == "DELETE") return HTTP_DELETE;
+    return HTTP_ANY;
+}
+
+static IPAddress parseIp(const std::string& text) {
+    unsigned a = 0, b = 0, c = 0, d = 0;
+    sscanf(text.c_str(), "%u.%u.%u.%u", &a, &b, &c, &d);
+    return IPAddress((uint8_t)a, (uint8_t)b, (uint8_t)c, (uint8_t)d);
+}
+
+static std::string urlEncode(const std::string& text) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            out += (char)c;
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 0xF];
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief The captured message at its full length (the prefix repeated)
+ */
+static std::string expandBody(const ReplayRequest& r) {
+    if (r.bodyLength == 0) return std::string();
+    std::string pattern = r.body.empty() ? std::string("x") : r.body;
+    std::string out;
+    out.reserve(r.bodyLength);
+    while (out.size() < r.bodyLength) {
+        out.append(pattern, 0, std::min(pattern.size(), (size_t)r.bodyLength - out.size()));
+    }
+    return out;
+}
+
+static HostRequest buildRequest(const ReplayRequest& r, const char* apiKey) {
+    HostRequest request;
+    request.method = parseMethod(r.method);
+    request.uri = r.path;
+    request.client = parseIp(r.ip);
+    if (r.bodyLength > 0 || r.path == "/type") {
+        request.query = "msg=" + urlEncode(expandBody(r));
+    }
+
+    bool wasUnauthorized = r.result == errorCodeName(ErrorCode::UNAUTHORIZED);
+    request.headers.push_back(std::make_pair(std::string("X-API-Key"),
+                                             std::string(wasUnauthorized ? "replay-wrong-key"
+                                                                         : apiKey)));
+    return request;
+}
+
+/**
+ * @brief Status a captured result was sent with
+ */
+static int capturedStatus(const std::string& result) {
+    for (size_t i = 0; i < ERROR_CODE_COUNT; i++) {
+        ErrorCode code = errorCodeAt(i);
+        if (result == errorCodeName(code)) {
+            return code == ErrorCode::SUCCESS ? 0 : httpStatusCode(code);
+        }
+    }
+    return 0;
+}
+
+// ===== Virtual time =====
+
+static uint64_t hostNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void runUntil(uint64_t untilUs) {
+    HostSim::runUntil(untilUs, MAX_STEP_MS);
+}
+
+// ===== Results =====
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)(p / 100.0 * (double)(values.size() - 1) + 0.5);
+    return values[rank];
+}
+
+static bool writeResults(const char* path, const std::vector<Metric>& metrics) {
+    FILE* f = fopen(path, "wb");
+    if (f == nullptr) return false;
+
+    fprintf(f, "{\"metrics\":[\n");
+    for (size_t i = 0; i < metrics.size(); i++) {
+        fprintf(f, "{\"name\":\"%s\",\"value\":%.3f,\"kind\":\"%s\"}%s\n",
+                metrics[i].name.c_str(), metrics[i].value, metrics[i].kind,
+                i + 1 < metrics.size() ? "," : "");
+    }
+    fprintf(f, "]}\n");
+    return fclose(f) == 0;
+}
+
+/**
+ * @brief Compare against an earlier results file
+ * @return Number of failing metrics, or -1 if the baseline can't be read
+ */
+static int compare(const char* path, const std::vector<Metric>& metrics, double thresholdPct) {
+    std::string contents;
+    if (!readFile(path, contents)) return -1;
+
+    std::map<std::string, double> before;
+    size_t start = 0;
+    while (start < contents.size()) {
+        size_t end = contents.find('\n', start);
+        if (end == std::string::npos) end = contents.size();
+        std::string line = contents.substr(start, end - start);
+        start = end + 1;
+
+        std::string name;
+        double value;
+        if (findString(line, "name", name) && findNumber(line, "value", value)) {
+            before[name] = value;
+        }
+    }
+
+    int failures = 0;
+    printf("\n%-40s %12s %12s\n", "metric", "baseline", "replay");
+    for (size_t i = 0; i < metrics.size(); i++) {
+        const Metric& m = metrics[i];
+        std::map<std::string, double>::iterator it = before.find(m.name);
+        double was = it == before.end() ? 0 : it->second;
+        if (it != before.end()) before.erase(it);
+
+        const char* verdict = "";
+        if (strcmp(m.kind, "exact") == 0 && m.value != was) {
+            verdict = "  CHANGED";
+            failures++;
+        } else if (strcmp(m.kind, "time") == 0 && was > 0 &&
+                   (m.value - was) * 100.0 / was > thresholdPct) {
+            verdict = "  REGRESSION";
+            failures++;
+        }
+        printf("%-40s %12.1f %12.1f%s\n", m.name.c_str(), was, m.value, verdict);
+    }
+
+    // Outcomes that no longer happen at all
+    for (std::map<std::string, double>::iterator it = before.begin(); it != before.end(); ++it) {
+        if (it->first.compare(0, 7, "status ") == 0 && it->second != 0) {
+            printf("%-40s %12.1f %12.1f  CHANGED\n", it->first.c_str(), it->second, 0.0);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    const char* capturePath = nullptr;
+    const char* outPath = "replay-results.json";
+    const char* baselinePath = nullptr;
+    const char* logPath = nullptr;
+    double threshold = 25;
+    uint32_t settleMs = 2000;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--capture") == 0 && hasValue) {
+            capturePath = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && hasValue) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--settle-ms") == 0 && hasValue) {
+            settleMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--log") == 0 && hasValue) {
+            logPath = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    std::vector<ReplayRequest> requests;
+    if (capturePath == nullptr || !loadCapture(capturePath, requests)) {
+        fprintf(stderr, "replay: need a readable --capture file\n");
+        return 2;
+    }
+    if (requests.empty()) {
+        fprintf(stderr, "replay: no records in %s\n", capturePath);
+        return 2;
+    }
+
+    FILE* log = fopen(logPath ? logPath : "/dev/null", "w");
+    if (log == nullptr) {
+        fprintf(stderr, "replay: can't open log %s\n", logPath);
+        return 2;
+    }
+    Serial.setOutput(log);
+
+    CountingHidSink sink;
+    HostHid::setSink(&sink);
+    HostOptions& options = Host::options();
+    options.listen = false;
+    options.bleConnectMs = 0;
+
+    HostClock::useVirtual(0);
+    setup();
+    runUntil(HostClock::nowUs() + (uint64_t)settleMs * 1000ULL);
+
+    // Captured times are relative to the first request
+    uint64_t offsetUs = HostClock::nowUs() - requests[0].atUs;
+
+    std::map<std::string, uint32_t> statusCounts;   // "status METHOD path code"
+    std::map<std::string, std::vector<double> > passNs;
+    std::vector<TypingJob> jobs;
+    uint64_t acceptedChars = 0;
+    uint32_t mismatches = 0;
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        const ReplayRequest& r = requests[i];
+        runUntil(r.atUs + offsetUs);
+
+        if (HostHid::isHostConnected() != r.bleConnected) {
+            HostHid::setHostConnected(r.bleConnected);
+        }
+
+        HostRequest request = buildRequest(r, API_KEY);
+        uint64_t start = hostNs();
+        HostResponse response = HostSim::serve(request);
+        uint64_t elapsed = hostNs() - start;
+
+        std::string route = r.method + " " + r.path;
+        char key[96];
+        snprintf(key, sizeof(key), "status %s %d", route.c_str(), response.status);
+        statusCounts[key]++;
+        passNs[route].push_back((double)elapsed);
+
+        int expected = capturedStatus(r.result);
+        bool matches = expected == 0 ? (response.status >= 200 && response.status < 300)
+                                     : response.status == expected;
+        if (!matches) mismatches++;
+
+        if (r.path == "/type" && response.status == 202) {
+            acceptedChars += r.bodyLength;
+            TypingJob job = { HostClock::nowUs(), acceptedChars };
+            jobs.push_back(job);
+        }
+    }
+
+    // Let accepted typing finish
+    HostHid::setHostConnected(true);
+    uint64_t drainUntil = HostClock::nowUs() + DRAIN_LIMIT_US;
+    while (sink.getTyped() < acceptedChars && HostClock::nowUs() < drainUntil) {
+        runUntil(HostClock::nowUs() + 100000ULL);
+    }
+
+    std::vector<double> jobMs;
+    uint32_t unfinished = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        uint64_t doneUs = sink.reachedAt(jobs[i].charsThrough);
+        if (doneUs == 0) {
+            unfinished++;
+            continue;
+        }
+        jobMs.push_back((double)(doneUs - jobs[i].acceptedUs) / 1000.0);
+    }
+
+    std::vector<Metric> metrics;
+    for (std::map<std::string, uint32_t>::iterator it = statusCounts.begin();
+         it != statusCounts.end(); ++it) {
+        Metric m = { it->first, (double)it->second, "exact" };
+        metrics.push_back(m);
+    }
+    Metric mismatch = { "status_mismatches", (double)mismatches, "exact" };
+    Metric jobsCompleted = { "typing jobs_completed", (double)jobMs.size(), "exact" };
+    Metric jobsUnfinished = { "typing jobs_unfinished", (double)unfinished, "exact" };
+    Metric jobP50 = { "typing latency_p50_ms", percentile(jobMs, 50), "time" };
+    Metric jobP99 = { "typing latency_p99_ms", percentile(jobMs, 99), "time" };
+    Metric jobMax = { "typing latency_max_ms", percentile(jobMs, 100), "time" };
+    metrics.push_back(mismatch);
+    metrics.push_back(jobsCompleted);
+    metrics.push_back(jobsUnfinished);
+    metrics.push_back(jobP50);
+    metrics.push_back(jobP99);
+    metrics.push_back(jobMax);
+    for (std::map<std::string, std::vector<double> >::iterator it = passNs.begin();
+         it != passNs.end(); ++it) {
+        Metric p50 = { "host " + it->first + " p50_ns", percentile(it->second, 50), "info" };
+        Metric p99 = { "host " + it->first + " p99_ns", percentile(it->second, 99), "info" };
+        metrics.push_back(p50);
+        metrics.push_back(p99);
+    }
+
+    printf("Replayed %zu requests over %.1f s of virtual time\n", requests.size(),
+           (double)(requests.back().atUs - requests[0].atUs) / 1e6);
+    for (size_t i = 0; i < metrics.size(); i++) {
+        printf("%-40s %12.1f\n", metrics[i].name.c_str(), metrics[i].value);
+    }
+
+    HostHid::setSink(nullptr);
+    fclose(log);
+
+    if (!writeResults(outPath, metrics)) {
+        fprintf(stderr, "replay: can't write %s\n", outPath);
+        return 2;
+    }
+    printf("\nWrote %s\n", outPath);
+    if (baselinePath == nullptr) return 0;
+
+    int failures = compare(baselinePath, metrics, threshold);
+    if (failures < 0) {
+        fprintf(stderr, "replay: can't read baseline %s\n", baselinePath);
+        return 2;
+    }
+    if (failures > 0) {
+        printf("%d metric(s) changed or regressed more than %.0f%%\n", failures, threshold);
+        return 1;
+    }
+    printf("Same behaviour as %s\n", baselinePath);
+    return 0;
+}
@@ -0,0 +1,556 @@
+#include <Arduino.h>
+#include <BleKeyboard.h>
+#include <WebServer.h>
+#include <WiFi.h>
+#include <malloc.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include "host_options.h"
+#include "host_clock.h"
+#include "host_sim.h"
+#include "hid_sink.h"
+#include "config.h"
+#include "managers/BLEKeyboardManager.h"
+#include "managers/WiFiManager.h"
+#include "managers/WebServerManager.h"
+#include "utils/heartbeat.h"
+#include "utils/timing_wheel.h"
+#include "utils/heap_trap.h"
+
+// The key the firmware was built with (src/secrets.h wins, as for main.cpp)
+#if __has_include("../../src/secrets.h")
+#include "../../src/secrets.h"
+#else
+#include "secrets.h"
+#endif
+
+/**
+ * @file soak_main.cpp
+ * @brief Months of uptime in minutes: the host build under synthetic traffic
+ *
+ *   pio run -e soak
+ *   .pio/build/soak/program --days 60 --seed 7
+ *
+ * Options:
+ *   --days N         Simulated uptime (default 60, past the 49.7-day
+ *                    millis() wrap)
+ *   --seed N         Traffic seed; the same seed gives the same run
+ *   --rate N         Mean requests per minute (default 30)
+ *   --heap-slack N   Bytes heap in use may exceed day 1's peak (default 4096)
+ *   --log PATH       Firmware log output (default: discarded)
+ *
+ * The firmware runs setup()/loop() on a virtual clock (HostSim). Requests
+ * arrive as a Poisson process from a pool of client IPs: status and
+ * metrics reads, LED toggles, typing jobs of random length, bad keys,
+ * missing parameters and bursts over the rate limit (reads are open, so
+ * bursts and probes use the authenticated, rate-limited /led/toggle).
+ * About once a day the WiFi link drops and, separately, the BLE host
+ * disconnects. The last QUIET_S of every simulated hour has no traffic,
+ * so the rate limiter's cleanup has run and every job has finished when
+ * the hour's sample is taken.
+ *
+ * Fails (exit 1) when:
+ *   - Heap in use (mallinfo2) at an hourly sample exceeds the highest
+ *     day-1 sample by more than --heap-slack
+ *   - Rate-limit entries are still tracked after a quiet period
+ *   - The number of armed timers changes between samples
+ *   - WiFi hasn't reconnected or BLE is still busy after a quiet period
+ *   - /status reports an uptime other than the virtual clock's
+ *   - A heartbeat stalls
+ *   - A typing job takes longer than its paced duration plus one chunk
+ *   - A rate-limit probe (MAX_REQUESTS + 2 requests at once, then one
+ *     more a window later) doesn't see exactly MAX_REQUESTS admitted,
+ *     the rest refused and the next window open. Probes run every
+ *     PROBE_INTERVAL_S, and every WRAP_PROBE_S around the millis() wrap.
+ *   - Any response has a status that request can't legitimately get
+ */
+
+static const uint64_t US_PER_S = 1000000ULL;
+static const uint64_t US_PER_HOUR = 3600ULL * US_PER_S;
+static const uint32_t MAX_STEP_MS = 1000;
+static const uint32_t SETTLE_MS = 2000;
+static const uint64_t QUIET_S = 120;         // > 10 windows + one cleanup interval
+static const uint64_t PROBE_INTERVAL_S = 600;
+static const uint64_t WRAP_PROBE_S = 5;
+static const uint64_t WRAP_WINDOW_S = 120;   // Dense probes this close to the wrap
+static const uint64_t MILLIS_WRAP_US = (1ULL << 32) * 1000ULL;
+static const uint32_t CLIENT_POOL = 4096;    // Distinct 10.x.y.z clients
+static const size_t MAX_TYPE_CHARS = 200;
+static const size_t BURST_REQUESTS = Config::RateLimit::MAX_REQUESTS + 3;
+static const uint64_t WIFI_DOWN_MAX_S = 300;
+static const uint64_t BLE_DOWN_MAX_S = 120;
+static const size_t MAX_PRINTED_FAILURES = 20;
+
+static const IPAddress PROBE_IP(10, 255, 0, 1);
+static const IPAddress MONITOR_IP(10, 255, 0, 2);
+
+// Firmware globals from src/main.cpp
+extern BLEKeyboardManager bleManager;
+extern WiFiManager wifiManager;
+extern WebServerManager webServer;
+
+struct SoakOptions {
+    double days;
+    uint32_t seed;
+    double ratePerMinute;
+    size_t heapSlack;
+    const char* logPath;
+};
+
+/**
+ * @brief xorshift64*: the same seed gives the same traffic on any libc
+ */
+class Rng {
+private:
+    uint64_t state;
+
+public:
+    explicit Rng(uint32_t seed) : state(0x9E3779B97F4A7C15ULL ^ seed) {
+        if (state == 0) state = 1;
+    }
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+
+    /**
+     * @brief Uniform in [0, n)
+     */
+    uint32_t below(uint32_t n) {
+        return (uint32_t)(next() % n);
+    }
+
+    /**
+     * @brief Uniform in (0, 1]
+     */
+    double unit() {
+        return ((double)(next() >> 11) + 1.0) / 9007199254740992.0;
+    }
+
+    /**
+     * @brief Exponentially distributed interval with the given mean
+     */
+    uint64_t exponentialUs(double meanUs) {
+        return (uint64_t)(-log(unit()) * meanUs);
+    }
+};
+
+// ===== Failures =====
+
+static uint32_t failureCount = 0;
+
+static void fail(const char* format, ...) {
+    failureCount++;
+    if (failureCount > MAX_PRINTED_FAILURES) return;
+
+    char message[160];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    printf("  FAIL at %.3f h: %s\n", (double)HostClock::nowUs() / (double)US_PER_HOUR, message);
+}
+
+/**
+ * @brief Sink that checks each typing job finishes within its paced time
+ *
+ * Keeps counts only, so it costs nothing per character over a long run.
+ */
+class TypingCheckSink : public HidSink {
+private:
+    uint64_t typed;
+    bool pending;
+    uint64_t acceptedUs;
+    uint64_t target;       // typed once the pending job is done
+    uint64_t boundUs;
+    uint32_t completed;
+    double worstRatio;     // Slowest job as a fraction of its bound
+
+public:
+    TypingCheckSink()
+        : typed(0), pending(false), acceptedUs(0), target(0), boundUs(0), completed(0),
+          worstRatio(0) {}
+
+    void onText(uint64_t us, const char* text, size_t length) override {
+        (void)text;
+        typed += length;
+        if (!pending || typed < target) return;
+
+        pending = false;
+        completed++;
+        uint64_t tookUs = us - acceptedUs;
+        double ratio = (double)tookUs / (double)boundUs;
+        if (ratio > worstRatio) worstRatio = ratio;
+        if (tookUs > boundUs) {
+            fail("typing job took %.1f ms, bound %.1f ms", (double)tookUs / 1000.0,
+                 (double)boundUs / 1000.0);
+        }
+    }
+    void onPress(uint64_t, uint8_t) override {}
+    void onReleaseAll(uint64_t) override {}
+
+    /**
+     * @brief A job of length characters was accepted now
+     */
+    void startJob(size_t length) {
+        if (pending) fail("typing job accepted while the previous one was unfinished");
+
+        size_t chunks = (length + Config::BLE::TEXT_CHUNK_SIZE - 1) / Config::BLE::TEXT_CHUNK_SIZE;
+        pending = true;
+        acceptedUs = HostClock::nowUs();
+        target = typed + length;
+        boundUs = (uint64_t)(chunks + 1) * Config::BLE::CHUNK_DELAY_MS * 1000ULL;
+    }
+
+    /**
+     * @brief The BLE host went away: the pending job fails, unchecked
+     */
+    void abandon() {
+        pending = false;
+    }
+
+    bool hasPending() const { return pending; }
+    uint32_t getCompleted() const { return completed; }
+    double getWorstRatio() const { return worstRatio; }
+};
+
+// ===== Requests =====
+
+struct Totals {
+    uint64_t requests;
+    uint64_t limited;      // 429s
+    uint64_t probes;
+    uint64_t loopPasses;
+    uint32_t wifiDrops;
+    uint32_t bleDrops;
+};
+
+static Totals totals;
+static TypingCheckSink sink;
+
+static HostResponse send(HTTPMethod method, const char* uri, const std::string& query,
+                         const IPAddress& client, const char* apiKey) {
+    HostRequest request;
+    request.method = method;
+    request.uri = uri;
+    request.query = query;
+    request.client = client;
+    request.headers.push_back(std::make_pair(std::string("X-API-Key"), std::string(apiKey)));
+
+    HostResponse response = HostSim::serve(request);
+    totals.requests++;
+    if (response.status == 429) totals.limited++;
+    return response;
+}
+
+static void expectStatus(const HostResponse& response, const char* what, int a, int b = -1,
+                         int c = -1) {
+    int s = response.status;
+    if (s == 429 || s == a || s == b || s == c) return;
+    fail("%s answered %d", what, s);
+}
+
+static IPAddress randomClient(Rng& rng) {
+    uint32_t n = rng.below(CLIENT_POOL);
+    return IPAddress(10, (uint8_t)(n >> 16), (uint8_t)(n >> 8), (uint8_t)n);
+}
+
+/**
+ * @brief One arrival of the synthetic mix
+ */
+static void sendRandomRequest(Rng& rng) {
+    IPAddress client = randomClient(rng);
+    uint32_t pick = rng.below(100);
+
+    if (pick < 40) {
+        expectStatus(send(HTTP_GET, "/status", "", client, API_KEY), "/status", 200);
+    } else if (pick < 50) {
+        expectStatus(send(HTTP_GET, "/metrics", "", client, API_KEY), "/metrics", 200);
+    } else if (pick < 60) {
+        expectStatus(send(HTTP_POST, "/led/toggle", "", client, API_KEY), "/led/toggle", 200);
+    } else if (pick < 80) {
+        size_t length = 1 + rng.below(MAX_TYPE_CHARS);
+        std::string query = "msg=";
+        for (size_t i = 0; i < length; i++) {
+            query += (char)('a' + rng.below(26));
+        }
+        HostResponse response = send(HTTP_POST, "/type", query, client, API_KEY);
+        // 409 while a job runs, 400 while the BLE host is away
+        expectStatus(response, "/type", 202, 409, 400);
+        if (response.status == 202) sink.startJob(length);
+    } else if (pick < 85) {
+        expectStatus(send(HTTP_POST, "/type", "", client, API_KEY), "/type without msg", 400);
+    } else if (pick < 92) {
+        expectStatus(send(HTTP_POST, "/led/toggle", "", client, "soak-wrong-key"), "bad key", 401);
+    } else {
+        // Over the limit from one client in one instant
+        size_t limited = 0;
+        for (size_t i = 0; i < BURST_REQUESTS; i++) {
+            HostResponse response = send(HTTP_POST, "/led/toggle", "", client, API_KEY);
+            expectStatus(response, "burst /led/toggle", 200);
+            if (response.status == 429) limited++;
+        }
+        if (limited < BURST_REQUESTS - Config::RateLimit::MAX_REQUESTS) {
+            fail("burst of %u got only %u refusals", (unsigned)BURST_REQUESTS, (unsigned)limited);
+        }
+    }
+}
+
+/**
+ * @brief Exactly MAX_REQUESTS admitted per window, and the next window opens
+ */
+static void probeRateLimit() {
+    totals.probes++;
+    size_t admitted = 0;
+    for (size_t i = 0; i < Config::RateLimit::MAX_REQUESTS + 2u; i++) {
+        HostResponse response = send(HTTP_POST, "/led/toggle", "", PROBE_IP, API_KEY);
+        if (response.status == 200) admitted++;
+    }
+    if (admitted != Config::RateLimit::MAX_REQUESTS) {
+        fail("rate-limit probe admitted %u of %u (millis %lu)", (unsigned)admitted,
+             (unsigned)(Config::RateLimit::MAX_REQUESTS + 2), (unsigned long)millis());
+    }
+
+    totals.loopPasses += HostSim::runUntil(
+        HostClock::nowUs() + (uint64_t)Config::RateLimit::WINDOW_MS * 1000ULL, MAX_STEP_MS);
+    HostResponse next = send(HTTP_POST, "/led/toggle", "", PROBE_IP, API_KEY);
+    if (next.status != 200) {
+        fail("rate-limit window didn't reopen after %lu ms (status %d, millis %lu)",
+             (unsigned long)Config::RateLimit::WINDOW_MS, next.status, (unsigned long)millis());
+    }
+}
+
+static uint64_t nextProbeAfter(uint64_t us) {
+    uint64_t denseStart = MILLIS_WRAP_US - WRAP_WINDOW_S * US_PER_S;
+    uint64_t denseEnd = MILLIS_WRAP_US + WRAP_WINDOW_S * US_PER_S;
+    if (us >= denseStart && us < denseEnd) return us + WRAP_PROBE_S * US_PER_S;
+
+    uint64_t next = us + PROBE_INTERVAL_S * US_PER_S;
+    return (us < denseStart && next > denseStart) ? denseStart : next;
+}
+
+// ===== Hourly samples =====
+
+struct Sample {
+    size_t heapInUse;
+    size_t heapArena;
+    size_t tracked;
+    size_t armedTimers;
+    uint32_t stalls;
+};
+
+static Sample takeSample() {
+    Sample s;
+    struct mallinfo2 info = mallinfo2();
+    s.heapInUse = info.uordblks;
+    s.heapArena = info.arena + info.hblkhd;
+    s.tracked = webServer.getTrackedClients();
+    s.armedTimers = SystemTimers::wheel().getArmedCount();
+
+    s.stalls = 0;
+    HeartbeatSupervisor& supervisor = Heartbeats::supervisor();
+    for (size_t i = 0; i < supervisor.size(); i++) {
+        s.stalls += supervisor.get(i)->getStallCount();
+    }
+    return s;
+}
+
+static long parseUptime(const std::string& json) {
+    size_t at = json.find("\"uptime\":");
+    if (at == std::string::npos) return -1;
+    return strtol(json.c_str() + at + 9, nullptr, 10);
+}
+
+/**
+ * @brief Checks that must hold once the firmware has been idle for QUIET_S
+ */
+static void checkQuiet(const Sample& s, const Sample& first) {
+    if (s.tracked != 0) fail("%u rate-limit clients still tracked after %us idle",
+                             (unsigned)s.tracked, (unsigned)QUIET_S);
+    if (s.armedTimers != first.armedTimers) {
+        fail("%u timers armed, %u at the first sample", (unsigned)s.armedTimers,
+             (unsigned)first.armedTimers);
+    }
+    if (s.stalls != 0) fail("%u heartbeat stalls", (unsigned)s.stalls);
+    if (!wifiManager.isConnected()) fail("WiFi not reconnected (%s)", wifiManager.getStatusString());
+    if (bleManager.isBusy()) fail("BLE still busy after %us idle", (unsigned)QUIET_S);
+    if (sink.hasPending()) fail("typing job unfinished after %us idle", (unsigned)QUIET_S);
+
+    HostResponse status = send(HTTP_GET, "/status", "", MONITOR_IP, API_KEY);
+    long uptime = parseUptime(status.raw);
+    long expected = (long)(HostClock::nowUs() / US_PER_S);
+    if (status.status != 200 || uptime != expected) {
+        fail("/status uptime %ld (status %d), clock says %ld", uptime, status.status, expected);
+    }
+}
+
+// ===== Main =====
+
+static bool parseOptions(int argc, char** argv, SoakOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--days") == 0 && hasValue) {
+            options.days = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--rate") == 0 && hasValue) {
+            options.ratePerMinute = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--heap-slack") == 0 && hasValue) {
+            options.heapSlack = (size_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--log") == 0 && hasValue) {
+            options.logPath = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return false;
+        }
+    }
+    return options.days > 0 && options.ratePerMinute > 0;
+}
+
+int main(int argc, char** argv) {
+    SoakOptions options = { 60, 1, 30, 4096, nullptr };
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    FILE* log = fopen(options.logPath ? options.logPath : "/dev/null", "w");
+    if (log == nullptr) {
+        fprintf(stderr, "soak: can't open log %s\n", options.logPath);
+        return 2;
+    }
+    Serial.setOutput(log);
+
+    HostHid::setSink(&sink);
+    HostOptions& host = Host::options();
+    host.listen = false;
+    host.bleConnectMs = 0;
+
+    clock_t wallStart = clock();
+    HostClock::useVirtual(0);
+    setup();
+    HeapTrap::Allow driver;  // Traffic and samples; loop() itself stays trapped
+    totals.loopPasses += HostSim::runUntil((uint64_t)SETTLE_MS * 1000ULL, MAX_STEP_MS);
+
+    Rng rng(options.seed);
+    const uint64_t startUs = HostClock::nowUs();
+    const uint32_t hours = (uint32_t)ceil(options.days * 24.0);
+    const uint64_t trafficUs = US_PER_HOUR - QUIET_S * US_PER_S;
+    const double meanGapUs = 60.0 * (double)US_PER_S / options.ratePerMinute;
+
+    printf("Soak: %u h simulated, seed %u, %.0f req/min, heap slack %zu bytes\n", hours,
+           (unsigned)options.seed, options.ratePerMinute, options.heapSlack);
+    printf("%5s %12s %12s %12s %10s %8s %8s %10s\n", "day", "heap_in_use", "heap_peak",
+           "heap_arena", "requests", "429s", "jobs", "worst_job");
+
+    Sample first = takeSample();
+    size_t dayOneMax = 0;
+    size_t peakInUse = 0;
+    uint64_t nextArrival = startUs + rng.exponentialUs(meanGapUs);
+    uint64_t nextProbe = nextProbeAfter(startUs);
+
+    for (uint32_t hour = 0; hour < hours; hour++) {
+        uint64_t hourStart = startUs + hour * US_PER_HOUR;
+        uint64_t trafficEnd = hourStart + trafficUs;
+
+        // About one WiFi drop and one BLE disconnect a day, inside the traffic period
+        uint64_t wifiDownAt = UINT64_MAX, wifiUpAt = UINT64_MAX;
+        uint64_t bleDownAt = UINT64_MAX, bleUpAt = UINT64_MAX;
+        if (rng.below(24) == 0) {
+            uint64_t length = (10 + rng.below(WIFI_DOWN_MAX_S - 10)) * US_PER_S;
+            wifiDownAt = hourStart + rng.next() % (trafficUs - length);
+            wifiUpAt = wifiDownAt + length;
+        }
+        if (rng.below(24) == 0) {
+            uint64_t length = (5 + rng.below(BLE_DOWN_MAX_S - 5)) * US_PER_S;
+            bleDownAt = hourStart + rng.next() % (trafficUs - length);
+            bleUpAt = bleDownAt + length;
+        }
+
+        for (;;) {
+            uint64_t at = nextArrival;
+            if (nextProbe < at) at = nextProbe;
+            if (wifiDownAt < at) at = wifiDownAt;
+            if (wifiUpAt < at) at = wifiUpAt;
+            if (bleDownAt < at) at = bleDownAt;
+            if (bleUpAt < at) at = bleUpAt;
+            if (at >= trafficEnd) break;
+
+            totals.loopPasses += HostSim::runUntil(at, MAX_STEP_MS);
+
+            if (at == wifiDownAt) {
+                WiFi.setLinkUp(false);
+                totals.wifiDrops++;
+                wifiDownAt = UINT64_MAX;
+            } else if (at == wifiUpAt) {
+                WiFi.setLinkUp(true);
+                wifiUpAt = UINT64_MAX;
+            } else if (at == bleDownAt) {
+                HostHid::setHostConnected(false);
+                sink.abandon();
+                totals.bleDrops++;
+                bleDownAt = UINT64_MAX;
+            } else if (at == bleUpAt) {
+                HostHid::setHostConnected(true);
+                bleUpAt = UINT64_MAX;
+            } else if (at == nextProbe) {
+                if (wifiManager.isConnected()) probeRateLimit();
+                nextProbe = nextProbeAfter(HostClock::nowUs());
+            } else {
+                // Clients can't reach the device while it's off the network
+                if (wifiManager.isConnected()) sendRandomRequest(rng);
+                nextArrival = HostClock::nowUs() + rng.exponentialUs(meanGapUs);
+            }
+        }
+
+        // Quiet period: nothing arrives, cleanup runs, jobs finish
+        uint64_t hourEnd = hourStart + US_PER_HOUR;
+        totals.loopPasses += HostSim::runUntil(hourEnd, MAX_STEP_MS);
+        if (nextArrival < hourEnd) nextArrival = hourEnd + rng.exponentialUs(meanGapUs);
+        if (nextProbe < hourEnd) nextProbe = nextProbeAfter(hourEnd);
+
+        Sample s = takeSample();
+        if (hour == 0) first = s;
+        checkQuiet(s, first);
+
+        if (s.heapInUse > peakInUse) peakInUse = s.heapInUse;
+        if (hour < 24) {
+            if (s.heapInUse > dayOneMax) dayOneMax = s.heapInUse;
+        } else if (s.heapInUse > dayOneMax + options.heapSlack) {
+            fail("heap in use %zu bytes, day-1 peak %zu", s.heapInUse, dayOneMax);
+        }
+
+        if ((hour + 1) % 24 == 0 || hour + 1 == hours) {
+            printf("%5.1f %12zu %12zu %12zu %10llu %8llu %8u %9.0f%%\n",
+                   (double)(hour + 1) / 24.0, s.heapInUse, peakInUse, s.heapArena,
+                   (unsigned long long)totals.requests, (unsigned long long)totals.limited,
+                   (unsigned)sink.getCompleted(), sink.getWorstRatio() * 100.0);
+            fflush(stdout);
+        }
+    }
+
+    double wallSeconds = (double)(clock() - wallStart) / CLOCKS_PER_SEC;
+    uint64_t endMs = HostClock::nowUs() / 1000ULL;
+    printf("\n%.1f days in %.1f s: %llu loop passes, millis() wrapped %llu time(s)\n",
+           (double)HostClock::nowUs() / (24.0 * (double)US_PER_HOUR), wallSeconds,
+           (unsigned long long)totals.loopPasses, (unsigned long long)(endMs >> 32));
+    printf("%llu rate-limit probes, %u WiFi drops, %u BLE disconnects\n",
+           (unsigned long long)totals.probes, (unsigned)totals.wifiDrops,
+           (unsigned)totals.bleDrops);
+
+    HostHid::setSink(nullptr);
+    fclose(log);
+
+    if (failureCount > 0) {
+        printf("%u check(s) failed\n", (unsigned)failureCount);
+        return 1;
+    }
+    printf("No growth or timing faults\n");
+    return 0;
+}